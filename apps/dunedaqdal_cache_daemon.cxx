@@ -0,0 +1,99 @@
+/**
+ * @file dunedaqdal_cache_daemon.cxx
+ *
+ * Per-node service resolving a Session once and serving it to the local
+ * processes through a snapshot and a Unix socket, see ConfigCache.hpp.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigCache.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+dal::ConfigCacheServer* s_server = nullptr;
+
+void
+on_signal(int)
+{
+  if (s_server != nullptr) {
+    s_server->stop();
+  }
+}
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-S <socket>] [-o <snapshot file>]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -S  Unix socket to serve (default /tmp/dunedaqdal-<session>.sock)\n"
+            << "  -o  snapshot file to publish (default /dev/shm/dunedaqdal-<session>.snap)\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, socket_path, snapshot_path;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:S:o:h")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'S': socket_path = optarg; break;
+      case 'o': snapshot_path = optarg; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (socket_path.empty()) {
+    socket_path = "/tmp/dunedaqdal-" + session_id + ".sock";
+  }
+  if (snapshot_path.empty()) {
+    snapshot_path = "/dev/shm/dunedaqdal-" + session_id + ".snap";
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    dal::ConfigCacheServer server(db, session_id, socket_path, snapshot_path);
+
+    s_server = &server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    server.run();
+
+    s_server = nullptr;
+    TLOG() << "Served " << server.generation() << " generations of session " << session_id;
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
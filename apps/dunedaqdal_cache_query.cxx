@@ -0,0 +1,103 @@
+/**
+ * @file dunedaqdal_cache_query.cxx
+ *
+ * Print the configuration of an application as served by
+ * dunedaqdal_cache_daemon, optionally following its updates.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigCache.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -S <socket> -a <application> [-f]\n"
+            << "\n"
+            << "  -S  Unix socket of dunedaqdal_cache_daemon\n"
+            << "  -a  UID of the application\n"
+            << "  -f  keep printing the application whenever a change affects it\n";
+}
+
+void
+print(const dal::ConfigCacheClient& client, const std::string& application_id)
+{
+  const auto& snap = client.snapshot();
+  const auto* app = client.application();
+  std::cout << "generation " << client.generation() << " of session " << snap.session() << '\n';
+  if (app == nullptr) {
+    std::cout << "  " << application_id << " is not part of the session\n";
+    return;
+  }
+
+  std::cout << "  " << snap.string(app->class_name) << ' ' << snap.string(app->uid);
+  if (app->kind == dal::snapshot::ApplicationKind::daq) {
+    std::cout << " on " << snap.string(app->host) << ':' << app->port;
+  }
+  std::cout << '\n';
+  for (auto m : snap.indices(app->modules)) {
+    const auto& mod = snap.module(m);
+    std::cout << "    module " << snap.string(mod.uid) << " (" << snap.string(mod.plugin) << "), "
+              << mod.inputs.count << " inputs, " << mod.outputs.count << " outputs\n";
+  }
+  for (auto* e = snap.environment_begin(*app); e != snap.environment_end(*app); ++e) {
+    std::cout << "    " << snap.string(e->name) << '=' << snap.string(e->value) << '\n';
+  }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string socket_path, application_id;
+  bool follow = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "S:a:fh")) != -1) {
+    switch (opt) {
+      case 'S': socket_path = optarg; break;
+      case 'a': application_id = optarg; break;
+      case 'f': follow = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (socket_path.empty() || application_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    dal::ConfigCacheClient client(socket_path, application_id);
+    print(client, application_id);
+    while (follow) {
+      if (client.poll(-1)) {
+        print(client, application_id);
+      }
+      std::cout.flush();
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file dunedaqdal_control_tree.cxx
+ *
+ * Report the control hierarchy of a Session and propose a balanced tree of
+ * RCApplications for a target fan-out.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ControlTree.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-t] [-f <fan-out>] [-p <prefix>]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -t  print the current tree\n"
+            << "  -f  propose a balanced tree with at most this many children per controller\n"
+            << "  -p  name prefix of the controllers the proposal adds (default rc-segment-)\n";
+}
+
+void
+print(const dal::ControlTree& tree, uint32_t idx, size_t indent)
+{
+  std::cout << std::string(2 * indent, ' ') << tree.application(idx)->UID();
+  if (!tree.children(idx).empty()) {
+    std::cout << " (" << tree.children(idx).size() << ')';
+  }
+  std::cout << '\n';
+  for (uint32_t c : tree.children(idx)) {
+    print(tree, c, indent + 1);
+  }
+}
+
+void
+print(const std::map<std::string, const dal::ProposedController*>& controllers, const std::string& uid, size_t indent)
+{
+  std::cout << std::string(2 * indent, ' ') << uid;
+  auto it = controllers.find(uid);
+  if (it == controllers.end()) {
+    std::cout << '\n';
+    return;
+  }
+  std::cout << " (" << it->second->children.size() << (it->second->existing ? "" : ", new") << ")\n";
+  for (const auto& child : it->second->children) {
+    print(controllers, child, indent + 1);
+  }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, prefix = "rc-segment-";
+  unsigned int fan_out = 0;
+  bool show_tree = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:tf:p:h")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 't': show_tree = true; break;
+      case 'f': fan_out = std::atoi(optarg); break;
+      case 'p': prefix = optarg; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    const dal::ControlTree tree(*session);
+    const auto stats = tree.fan_out();
+    std::cout << tree.size() << " applications, height " << tree.height() << ", " << stats.controllers
+              << " controllers, fan-out min/mean/max " << stats.min << '/' << std::fixed << std::setprecision(1)
+              << stats.mean << '/' << stats.max << '\n';
+    for (const auto& issue : tree.issues()) {
+      std::cout << "WARNING: " << issue.application << ' ' << issue.message() << '\n';
+    }
+
+    if (show_tree && tree.root() != dal::ControlTree::npos) {
+      std::cout << '\n';
+      print(tree, tree.root(), 0);
+    }
+
+    if (fan_out != 0) {
+      const auto proposal = dal::propose_balanced_tree(*session, fan_out, prefix);
+      std::map<std::string, const dal::ProposedController*> controllers;
+      size_t added = 0;
+      for (const auto& c : proposal.controllers) {
+        controllers[c.uid] = &c;
+        added += c.existing ? 0 : 1;
+      }
+
+      std::cout << "\nProposed tree for fan-out " << proposal.fan_out << ": " << proposal.leaves << " applications, "
+                << proposal.controllers.size() << " controllers (" << added << " new), height "
+                << proposal.height + 1 << '\n';
+      if (!proposal.controllers.empty()) {
+        print(controllers, proposal.controllers.front().uid, 0);
+      }
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file dunedaqdal_export_tables.cxx
+ *
+ * Export the columnar tables of a Session as one CSV file per table, e.g.
+ * for conversion to Parquet by the configuration history dashboards.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/SessionTables.hpp"
+
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> -o <directory>\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -o  existing directory to write <table>.csv files into\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, directory;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:o:h")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'o': directory = optarg; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty() || directory.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::ConnectivityIndex index(*session);
+    const auto tables = dal::make_tables(*session, index);
+    dal::write_csv(tables, directory);
+
+    tables.for_each_table([](const char* name, const auto& table) {
+      std::cout << name << ": " << table.size() << " rows\n";
+    });
+    TLOG() << "Exported the tables of session " << session_id << " to " << directory;
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
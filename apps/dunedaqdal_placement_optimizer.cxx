@@ -0,0 +1,151 @@
+/**
+ * @file dunedaqdal_placement_optimizer.cxx
+ *
+ * Propose, and optionally apply, DaqApplication.host values that minimise
+ * the network traffic between the hosts of a Session. Applying them also
+ * reassigns the ports and NetworkConnection uris of the moved applications.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/PlacementOptimizer.hpp"
+#include "dunedaqdal/PortAllocator.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/ProcessPlacement.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-r <rate profile>] [-l <load>] [-w]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -r  file with \"<connection UID> <rate in Hz>\" lines overriding the DataTypeProfile rates\n"
+            << "  -l  fraction of the cpus and memory of each Host to use (default 1)\n"
+            << "  -w  write the new hosts back to the database, with the ports and NetworkConnection uris\n"
+            << "      reassigned for the applications which move\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, rates_file;
+  dal::PlacementOptimizerParameters parameters;
+  bool write = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:r:l:wh")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'r': rates_file = optarg; break;
+      case 'l': parameters.max_load = std::atof(optarg); break;
+      case 'w': write = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+    if (session->get_hosts().empty()) {
+      std::cerr << "Session \"" << session_id << "\" has no hosts to place applications on" << std::endl;
+      return 1;
+    }
+
+    dal::RateProfile rates;
+    if (!rates_file.empty()) {
+      rates = dal::read_rate_profile(rates_file);
+    }
+
+    dal::ConnectivityIndex index(*session);
+    const auto plan = dal::optimize_placement(*session, index, rates, parameters);
+
+    size_t changes = 0;
+    for (const auto& a : plan.assignments) {
+      if (!a.changed()) {
+        continue;
+      }
+      ++changes;
+      std::cout << std::left << std::setw(40) << a.application->UID() << ' ' << a.application->get_host() << " -> "
+                << a.host << '\n';
+      const auto* placement = a.application->get_placement();
+      if (placement != nullptr && !placement->get_cpu_set().empty()) {
+        std::cout << "WARNING: " << a.application->UID() << " is pinned to cpus " << placement->get_cpu_set()
+                  << " of its current host\n";
+      }
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << plan.assignments.size() << " applications, " << changes
+              << " to move, traffic between hosts " << plan.traffic_before / 1e6 << " -> "
+              << plan.traffic_after / 1e6 << " MB/s\n";
+    if (!plan.feasible) {
+      std::cout << "WARNING: the applications do not fit the cpus and memory of the hosts\n";
+    }
+
+    if (write && changes != 0) {
+      if (!plan.feasible) {
+        std::cerr << "Not writing a placement exceeding the host capacity" << std::endl;
+        return 1;
+      }
+
+      // the ports and uris bound on the new hosts, computed before any DAL object changes
+      dal::PortAssignmentParameters port_parameters;
+      for (const auto& a : plan.assignments) {
+        if (a.changed()) {
+          port_parameters.hosts.emplace(a.application->UID(), a.host);
+        }
+      }
+      const auto ports = dal::assign_ports(*session, index, port_parameters);
+      size_t port_changes = 0;
+      for (const auto& pa : ports) {
+        port_changes += pa.changed() ? 1 : 0;
+      }
+
+      dal::apply(plan);
+      dal::apply(ports);
+      db.commit("dunedaqdal_placement_optimizer: moved " + std::to_string(changes) + " applications, reassigned " +
+                std::to_string(port_changes) + " ports");
+      TLOG() << "Committed " << changes << " host changes and " << port_changes << " port and uri changes";
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
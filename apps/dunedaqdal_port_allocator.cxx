@@ -0,0 +1,110 @@
+/**
+ * @file dunedaqdal_port_allocator.cxx
+ *
+ * Assign conflict-free ports to the DaqApplications and NetworkConnections
+ * of a Session, and optionally write them back.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/PortAllocator.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-a] [-w]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -a  reassign every port instead of keeping the valid current ones\n"
+            << "  -w  write the new ports back to the database\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id;
+  dal::PortAssignmentParameters parameters;
+  bool write = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:awh")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'a': parameters.reassign_all = true; break;
+      case 'w': write = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::ConnectivityIndex index(*session);
+    const auto assignments = dal::assign_ports(*session, index, parameters);
+
+    size_t changes = 0;
+    for (const auto& pa : assignments) {
+      if (!pa.changed()) {
+        continue;
+      }
+      ++changes;
+      if (pa.application != nullptr) {
+        std::cout << std::left << std::setw(40) << pa.application->UID() << ' ' << pa.host << ':' << pa.old_port
+                  << " -> " << pa.port << '\n';
+      } else {
+        std::cout << std::left << std::setw(40) << pa.connection->UID() << ' ' << pa.connection->get_uri() << " -> "
+                  << pa.uri << '\n';
+      }
+    }
+    std::cout << assignments.size() << " endpoints, " << changes << " to change\n";
+
+    if (write && changes != 0) {
+      dal::apply(assignments);
+      db.commit("dunedaqdal_port_allocator: changed " + std::to_string(changes) + " ports");
+      TLOG() << "Committed " << changes << " port changes";
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file dunedaqdal_queue_advisor.cxx
+ *
+ * Report, and optionally apply, recommended Queue capacities and types for
+ * a Session.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/QueueAdvisor.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-r <rate profile>] [-b <ms>] [-w]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -r  file with \"<queue UID> <rate in Hz>\" lines\n"
+            << "  -b  time in milliseconds a queue must buffer at its rate (default 10)\n"
+            << "  -w  write the recommendations back to the database\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, rates_file;
+  dal::QueueAdvisorParameters parameters;
+  bool write = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:r:b:wh")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'r': rates_file = optarg; break;
+      case 'b': parameters.buffer_time_ms = std::atof(optarg); break;
+      case 'w': write = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::RateProfile rates;
+    if (!rates_file.empty()) {
+      rates = dal::read_rate_profile(rates_file);
+    }
+
+    dal::ConnectivityIndex index(*session);
+    auto advice = dal::advise_queues(index, rates, parameters);
+
+    size_t changes = 0, unsafe = 0;
+    for (const auto& a : advice) {
+      if (a.unsafe_type) {
+        ++unsafe;
+        std::cout << "WARNING: " << a.queue->get_queue_type() << " queue " << a.queue->UID() << " has "
+                  << a.producers << " producer(s) and " << a.consumers << " consumer(s)\n";
+      }
+      if (a.changed()) {
+        ++changes;
+        std::cout << std::left << std::setw(40) << a.queue->UID() << ' ' << a.queue->get_queue_type() << '/'
+                  << a.queue->get_capacity() << " -> " << a.queue_type << '/' << a.capacity << '\n';
+      }
+    }
+
+    std::cout << advice.size() << " queues, " << changes << " to change, " << unsafe
+              << " with a type unsafe for their producers/consumers\n";
+
+    if (write && changes != 0) {
+      dal::apply(advice);
+      db.commit("dunedaqdal_queue_advisor: resized " + std::to_string(changes) + " queues");
+      TLOG() << "Committed " << changes << " queue changes";
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file dunedaqdal_resource_estimate.cxx
+ *
+ * Report the estimated memory and network bandwidth of a Session per host
+ * and, optionally, per application; the exit status is 2 when a host is
+ * oversubscribed.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/ResourceEstimator.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Host.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-r <rate profile>] [-a]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -r  file with \"<connection UID> <rate in Hz>\" lines overriding the DataTypeProfile rates\n"
+            << "  -a  also report every application\n";
+}
+
+void
+print_row(const std::string& name, const dal::ResourceUsage& usage)
+{
+  constexpr double MiB = 1 << 20;
+  std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << usage.memory() / MiB << std::setw(12) << usage.network_in / 1e6 << std::setw(12)
+            << usage.network_out / 1e6 << std::setw(8) << usage.modules << std::setw(6) << usage.applications;
+}
+
+void
+print_header(const std::string& name)
+{
+  std::cout << std::left << std::setw(32) << name << std::right << std::setw(12) << "mem MiB" << std::setw(12)
+            << "in MB/s" << std::setw(12) << "out MB/s" << std::setw(8) << "modules" << std::setw(6) << "apps"
+            << '\n';
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, rates_file;
+  bool per_application = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:r:ah")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'r': rates_file = optarg; break;
+      case 'a': per_application = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  size_t oversubscribed = 0;
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::RateProfile rates;
+    if (!rates_file.empty()) {
+      rates = dal::read_rate_profile(rates_file);
+    }
+
+    dal::ConnectivityIndex index(*session);
+    const auto estimate = dal::estimate_resources(*session, index, rates);
+
+    if (per_application) {
+      print_header("application");
+      for (const auto& app : estimate.applications) {
+        print_row(app.application->UID(), app.usage);
+        std::cout << "  " << app.application->get_host() << '\n';
+      }
+      std::cout << '\n';
+    }
+
+    print_header("host");
+    for (const auto& host : estimate.hosts) {
+      print_row(host.host, host.usage);
+      if (host.memory_oversubscribed) {
+        std::cout << "  memory above " << host.limits->get_memory_mb() << " MiB";
+      }
+      if (host.network_oversubscribed) {
+        std::cout << "  network above " << host.limits->get_network_gbps() << " Gbit/s";
+      }
+      if (host.limits == nullptr) {
+        std::cout << "  (no Host)";
+      }
+      std::cout << '\n';
+      oversubscribed += host.oversubscribed() ? 1 : 0;
+    }
+
+    for (const auto& type : estimate.unknown_data_types) {
+      std::cout << "WARNING: no DataTypeProfile for data type \"" << type << "\"\n";
+    }
+    std::cout << estimate.hosts.size() << " hosts, " << oversubscribed << " oversubscribed\n";
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return oversubscribed == 0 ? 0 : 2;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file dunedaqdal_simulate.cxx
+ *
+ * Simulate the dataflow of a Session and report its throughput, queue
+ * occupancy and back-pressure points.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/DataflowSimulator.hpp"
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/ResourceEstimator.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0
+            << " -d <database> -s <session> [-m <service models>] [-t <seconds>] [-r <replications>] [-j <threads>]"
+               " [-a]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -m  file with \"<plugin> <mean service time in us> [<coefficient of variation>]\" lines\n"
+            << "  -t  simulated seconds per replication, the first tenth as warm-up (default 1)\n"
+            << "  -r  number of independent replications (default 8)\n"
+            << "  -j  threads running the replications (default one per hardware thread)\n"
+            << "  -a  report every module and connection, not only the back-pressure points\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, models_file;
+  dal::SimulationParameters parameters;
+  bool report_all = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:m:t:r:j:ah")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'm': models_file = optarg; break;
+      case 't':
+        parameters.duration_s = std::atof(optarg);
+        parameters.warmup_s = parameters.duration_s / 10;
+        break;
+      case 'r': parameters.replications = std::atoi(optarg); break;
+      case 'j': parameters.n_threads = std::atoi(optarg); break;
+      case 'a': report_all = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::ServiceModels models;
+    if (!models_file.empty()) {
+      models = dal::read_service_models(models_file);
+    }
+
+    dal::ConnectivityIndex index(*session);
+    const auto result = dal::simulate(index, models, parameters, dal::data_type_registry(*session));
+
+    std::cout << std::fixed;
+    if (report_all) {
+      std::cout << std::left << std::setw(40) << "module" << std::right << std::setw(14) << "Hz" << std::setw(10)
+                << "+-" << std::setw(8) << "busy" << std::setw(8) << "blocked" << std::setw(8) << "starved" << '\n';
+      for (uint32_t m = 0; m < index.num_modules(); ++m) {
+        const auto& s = result.modules[m];
+        std::cout << std::left << std::setw(40) << index.module(m)->UID() << std::right << std::setprecision(1)
+                  << std::setw(14) << s.throughput_hz << std::setw(10) << s.throughput_error << std::setprecision(3)
+                  << std::setw(8) << s.busy << std::setw(8) << s.blocked << std::setw(8) << s.starved << '\n';
+      }
+      std::cout << '\n';
+
+      std::cout << std::left << std::setw(40) << "connection" << std::right << std::setw(14) << "Hz" << std::setw(12)
+                << "dropped Hz" << std::setw(10) << "capacity" << std::setw(10) << "mean" << std::setw(8) << "max"
+                << std::setw(8) << "full" << '\n';
+      for (uint32_t c = 0; c < index.num_connections(); ++c) {
+        const auto& s = result.connections[c];
+        std::cout << std::left << std::setw(40) << index.connection(c)->UID() << std::right << std::setprecision(1)
+                  << std::setw(14) << s.throughput_hz << std::setw(12) << s.dropped_hz << std::setw(10) << s.capacity
+                  << std::setw(10) << s.mean_occupancy << std::setw(8) << s.max_occupancy << std::setprecision(3)
+                  << std::setw(8) << s.full << '\n';
+      }
+      std::cout << '\n';
+    }
+
+    for (auto c : result.backpressure) {
+      const auto& s = result.connections[c];
+      std::cout << "back-pressure: " << index.connection(c)->UID() << " full " << std::setprecision(1)
+                << 100 * s.full << "% of the time, mean occupancy " << s.mean_occupancy << '/' << s.capacity << '\n';
+    }
+    if (result.bottleneck != dal::ConnectivityIndex::npos) {
+      const auto& s = result.modules[result.bottleneck];
+      std::cout << "busiest module: " << index.module(result.bottleneck)->UID() << " ("
+                << index.module(result.bottleneck)->get_plugin() << "), busy " << std::setprecision(1)
+                << 100 * s.busy << "% at " << s.throughput_hz << " Hz\n";
+    }
+    for (const auto& plugin : result.unknown_plugins) {
+      std::cout << "WARNING: no service model for plugin \"" << plugin << "\", using the default\n";
+    }
+    std::cout << std::setprecision(3) << result.simulated_s << " s simulated " << std::max(parameters.replications, 1u)
+              << " times, " << result.events << " events, " << result.backpressure.size()
+              << " back-pressure points\n";
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file dunedaqdal_snapshot.cxx
+ *
+ * Write a binary snapshot of a resolved Session, or print the content of an
+ * existing one.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigHash.hpp"
+#include "dunedaqdal/EnvironmentResolver.hpp"
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/Snapshot.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> -o <snapshot file>\n"
+            << "       " << argv0 << " -r <snapshot file>\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -o  output snapshot file, replaced atomically\n"
+            << "  -r  print the content of a snapshot file\n";
+}
+
+void
+dump(const dal::snapshot::Reader& snap)
+{
+  std::cout << "Session " << snap.session() << " (format " << snap.header().version << ", " << snap.header().size
+            << " bytes, hash " << snap.header().hash << ")\n";
+
+  for (uint32_t a = 0; a < snap.num_applications(); ++a) {
+    const auto& app = snap.application(a);
+    std::cout << "  " << snap.string(app.class_name) << ' ' << snap.string(app.uid);
+    if (app.kind == dal::snapshot::ApplicationKind::daq) {
+      std::cout << " on " << snap.string(app.host) << ':' << app.port;
+    }
+    std::cout << " hash " << app.hash << '\n';
+
+    for (auto m : snap.indices(app.modules)) {
+      const auto& mod = snap.module(m);
+      std::cout << "    module " << snap.string(mod.uid) << " (" << snap.string(mod.plugin) << ")\n";
+      for (auto c : snap.indices(mod.inputs)) {
+        std::cout << "      < " << snap.string(snap.connection(c).uid) << '\n';
+      }
+      for (auto c : snap.indices(mod.outputs)) {
+        std::cout << "      > " << snap.string(snap.connection(c).uid) << '\n';
+      }
+    }
+
+    for (auto c : snap.indices(app.controlled)) {
+      std::cout << "    controls " << snap.string(snap.application(c).uid) << '\n';
+    }
+
+    for (auto* e = snap.environment_begin(app); e != snap.environment_end(app); ++e) {
+      std::cout << "    " << snap.string(e->name) << '=' << snap.string(e->value) << '\n';
+    }
+  }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id, output, input;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:o:r:h")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'o': output = optarg; break;
+      case 'r': input = optarg; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  try {
+    if (!input.empty()) {
+      dump(dal::snapshot::Reader(input));
+      return 0;
+    }
+
+    if (db_spec.empty() || session_id.empty() || output.empty()) {
+      usage(argv[0]);
+      return 1;
+    }
+
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::EnvironmentResolver resolver(db);
+    dal::ConfigHasher hashes(db, session_id);
+    dal::snapshot::write(*session, resolver, output, &hashes);
+    TLOG() << "Wrote snapshot of session " << session_id << " to " << output;
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  return 0;
+}
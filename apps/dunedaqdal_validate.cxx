@@ -0,0 +1,119 @@
+/**
+ * @file dunedaqdal_validate.cxx
+ *
+ * Validate a Session with the dunedaqdal rules; the exit status is 2 when
+ * errors are found, so that the tool can gate configuration commits.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/Validator.hpp"
+
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0 << " -d <database> -s <session> [-j <threads>] [-r <rule,...>] [-W] [-l]\n"
+            << "\n"
+            << "  -d  database specification, e.g. oksconfig:sessions/test.data.xml\n"
+            << "  -s  UID of the Session object\n"
+            << "  -j  number of threads (default: one per core)\n"
+            << "  -r  comma separated list of the rules to run (default: all)\n"
+            << "  -W  treat warnings as errors\n"
+            << "  -l  list the rules and exit\n";
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  std::string db_spec, session_id;
+  std::set<std::string> selected;
+  unsigned int n_threads = 0;
+  bool strict = false, list = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:s:j:r:Wlh")) != -1) {
+    switch (opt) {
+      case 'd': db_spec = optarg; break;
+      case 's': session_id = optarg; break;
+      case 'j': n_threads = std::atoi(optarg); break;
+      case 'r': {
+        std::istringstream rules(optarg);
+        for (std::string rule; std::getline(rules, rule, ',');) {
+          selected.insert(rule);
+        }
+        break;
+      }
+      case 'W': strict = true; break;
+      case 'l': list = true; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  std::vector<std::unique_ptr<dal::Rule>> rules;
+  for (auto& rule : dal::default_rules()) {
+    if (list) {
+      std::cout << rule->name() << '\n';
+    } else if (selected.empty() || selected.erase(rule->name())) {
+      rules.push_back(std::move(rule));
+    }
+  }
+  if (list) {
+    return 0;
+  }
+  if (!selected.empty()) {
+    std::cerr << "Unknown rule " << *selected.begin() << std::endl;
+    return 1;
+  }
+
+  if (db_spec.empty() || session_id.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  size_t errors = 0, warnings = 0;
+  try {
+    oksdbinterfaces::Configuration db(db_spec);
+    const auto* session = db.get<dal::Session>(session_id);
+    if (session == nullptr) {
+      std::cerr << "Cannot find Session \"" << session_id << "\" in " << db_spec << std::endl;
+      return 1;
+    }
+
+    dal::Validator validator(std::move(rules));
+    for (const auto& d : validator.run(db, *session, n_threads)) {
+      (d.severity == dal::Diagnostic::Severity::error ? errors : warnings)++;
+      std::cout << dal::to_string(d.severity) << " [" << d.rule << "] " << d.object << ": " << d.message << '\n';
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    return 1;
+  }
+
+  std::cout << errors << " error(s), " << warnings << " warning(s)\n";
+  return (errors != 0 || (strict && warnings != 0)) ? 2 : 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file ApplicationView.hpp
+ *
+ * Slice of a Session restricted to what a single application needs
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_APPLICATIONVIEW_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_APPLICATIONVIEW_HPP_
+
+#include "dunedaqdal/EnvironmentResolver.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Application;
+class Connection;
+class DaqModule;
+class Parameter;
+
+/**
+ * @brief Lazily loaded closure of one application of a Session
+ *
+ * Only the application object itself is read on construction. Its modules
+ * and their connections, the applications it controls (transitively, when
+ * it is an RCApplication) and the session-level environment parameters are
+ * each loaded on first use. The Session is accessed through its
+ * ConfigObject only, so the DAL objects of the other applications are never
+ * created.
+ *
+ * The view holds plain pointers to DAL objects owned by the Configuration.
+ */
+class ApplicationView
+{
+public:
+  /// Throws dal::ApplicationNotFound if the application is not listed in Session.applications
+  ApplicationView(dunedaq::oksdbinterfaces::Configuration& db,
+                  const std::string& session_uid,
+                  const std::string& application_uid);
+
+  const Application& application() const noexcept { return *m_application; }
+
+  /// DaqApplication.modules; empty for other application types
+  const std::vector<const DaqModule*>& modules() const;
+
+  /// Union of the inputs and outputs of modules(), each connection once
+  const std::vector<const Connection*>& connections() const;
+
+  /// Transitive closure of RCApplication.ApplicationsControlled; empty for other application types
+  const std::vector<const Application*>& controlled() const;
+
+  /// Session.ProcessEnvironment, read without instantiating the Session DAL object
+  const std::vector<const Parameter*>& session_environment() const;
+
+  /// Flattened session and application environment
+  Environment environment(EnvironmentResolver& resolver) const;
+
+private:
+  void load_modules() const;
+  void load_controlled() const;
+  void load_session_environment() const;
+
+  dunedaq::oksdbinterfaces::Configuration& m_db;
+  mutable dunedaq::oksdbinterfaces::ConfigObject m_session;
+  const Application* m_application = nullptr;
+
+  mutable std::once_flag m_modules_flag;
+  mutable std::vector<const DaqModule*> m_modules;
+  mutable std::vector<const Connection*> m_connections;
+
+  mutable std::once_flag m_controlled_flag;
+  mutable std::vector<const Application*> m_controlled;
+
+  mutable std::once_flag m_environment_flag;
+  mutable std::vector<const Parameter*> m_session_environment;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_APPLICATIONVIEW_HPP_
@@ -0,0 +1,90 @@
+/**
+ * @file ChangeSet.hpp
+ *
+ * Object-level differences between two versions of a Session and the
+ * applications they affect.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CHANGESET_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CHANGESET_HPP_
+
+#include "oksdbinterfaces/Change.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+struct ObjectChange
+{
+  enum class Kind
+  {
+    added,
+    removed,
+    modified
+  };
+
+  Kind kind;
+  std::string uid;
+  std::string class_name;
+
+  /// Names of the modified attributes and relationships; empty unless known
+  std::vector<std::string> attributes;
+  std::vector<std::string> relationships;
+};
+
+struct ChangeSet
+{
+  /// Sorted by class name, then UID
+  std::vector<ObjectChange> changes;
+
+  /// UIDs of the applications of the session which depend on a changed object, sorted
+  std::vector<std::string> applications;
+
+  bool empty() const noexcept { return changes.empty(); }
+
+  /// The change of the given object, or nullptr
+  const ObjectChange* find(const std::string& uid, const std::string& class_name) const noexcept;
+};
+
+/**
+ * @brief Compare two versions of a session object by object and attribute by attribute
+ *
+ * Only objects reachable from the session through relationships take part.
+ * Objects are matched by UID and class. An application is affected when it
+ * is added, removed or modified itself, or when a changed object is reachable
+ * from it without crossing another application (its modules, their
+ * connections, its environment and placement, ...). Changes reachable only
+ * through the session itself, such as the Session.ProcessEnvironment or a
+ * Session attribute, affect all applications.
+ *
+ * Neither configuration is modified, so DAL objects obtained from either
+ * remain valid.
+ */
+ChangeSet
+diff(dunedaq::oksdbinterfaces::Configuration& before,
+     dunedaq::oksdbinterfaces::Configuration& after,
+     const std::string& session_uid);
+
+/**
+ * @brief Change set of a configuration update notification
+ *
+ * Converts the changes reported to a subscription or ConfigAction after the
+ * database was reloaded, and determines the affected applications in the
+ * updated configuration. The configuration only refreshes the DAL objects
+ * reported as changed; all others stay as they are. The notification does
+ * not name modified attributes.
+ */
+ChangeSet
+make_change_set(dunedaq::oksdbinterfaces::Configuration& db,
+                const std::string& session_uid,
+                const std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CHANGESET_HPP_
@@ -0,0 +1,177 @@
+/**
+ * @file ConfigCache.hpp
+ *
+ * Per-node cache of a resolved Session: a server resolves the session once,
+ * publishes it as a snapshot and notifies the local processes, which map the
+ * snapshot instead of loading the configuration themselves.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONFIGCACHE_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONFIGCACHE_HPP_
+
+#include "dunedaqdal/ChangeSet.hpp"
+#include "dunedaqdal/ConfigHash.hpp"
+#include "dunedaqdal/EnvironmentResolver.hpp"
+#include "dunedaqdal/Snapshot.hpp"
+
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+/**
+ * Protocol
+ *
+ * Line-based text over a SOCK_STREAM Unix socket. The server sends
+ *
+ *     snapshot <generation> <path> <affected>
+ *
+ * when a client connects (affected is 1) and after each configuration
+ * change that was republished. affected is 0 when the client watches an
+ * application which the change does not touch, see make_change_set(). A
+ * client may send
+ *
+ *     watch <application UID>
+ *
+ * at any time to receive only the updates relevant to that application.
+ * The snapshot file is replaced atomically, so mappings of an older
+ * generation stay valid until the client drops them.
+ */
+
+/**
+ * @brief Serve a resolved Session to the processes of a node
+ *
+ * The constructor resolves the session, writes the snapshot and listens on
+ * the socket; run() then serves clients and republishes the snapshot
+ * whenever the configuration reports a change. The snapshot carries the
+ * ConfigHasher hashes, which are updated incrementally from the change
+ * notifications; a change that leaves the session hash as published, e.g.
+ * to an object the session does not reach, is not republished. Clients
+ * that do not read their notifications until the socket buffer fills up
+ * are disconnected.
+ */
+class ConfigCacheServer
+{
+public:
+  /// Throws dal::CacheError on socket errors and dal::BadSnapshot if the snapshot cannot be written
+  ConfigCacheServer(dunedaq::oksdbinterfaces::Configuration& db,
+                    const std::string& session_uid,
+                    const std::string& socket_path,
+                    const std::string& snapshot_path);
+  ~ConfigCacheServer();
+
+  ConfigCacheServer(const ConfigCacheServer&) = delete;
+  ConfigCacheServer& operator=(const ConfigCacheServer&) = delete;
+
+  /// Serve clients until stop() is called
+  void run();
+
+  /// Make run() return; async-signal-safe
+  void stop() noexcept;
+
+  uint64_t generation() const noexcept { return m_generation; }
+  size_t num_clients() const noexcept { return m_num_clients; }
+
+private:
+  struct Client
+  {
+    int fd = -1;
+    std::string input;
+    std::string application; ///< watched application, empty for all
+  };
+
+  static void on_change(const std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes, void* self);
+
+  /// Returns false if the session hash is the one already published
+  bool publish(bool all, const std::vector<ObjectChange>& changes);
+  void accept_client();
+  bool read_client(Client& client);
+  bool send(Client& client, bool affected);
+  void wake() noexcept;
+
+  dunedaq::oksdbinterfaces::Configuration& m_db;
+  EnvironmentResolver m_resolver;
+  const std::string m_session_uid;
+  const std::string m_socket_path;
+  const std::string m_snapshot_path;
+
+  int m_listen_fd = -1;
+  int m_wake_fd[2] = { -1, -1 };
+  dunedaq::oksdbinterfaces::Configuration::CallbackId m_subscription = nullptr;
+
+  std::unique_ptr<ConfigHasher> m_hasher;
+  ConfigHash m_published;
+
+  std::vector<Client> m_clients;
+  std::atomic<uint64_t> m_generation{ 0 };
+  std::atomic<size_t> m_num_clients{ 0 };
+  std::atomic<bool> m_stop{ false };
+
+  std::mutex m_mutex; ///< protects the pending change, set by the subscription thread
+  bool m_pending = false;
+  bool m_pending_all = false;
+  std::set<std::string> m_pending_applications;
+  std::vector<ObjectChange> m_pending_changes;
+};
+
+/**
+ * @brief Access to the Session published by a ConfigCacheServer
+ *
+ * Connects to the server and maps the current snapshot. Updates are only
+ * picked up by poll(), so the snapshot and the records obtained from it
+ * stay valid between two calls; integrate fd() into an event loop to call
+ * poll() when the server has something to say.
+ */
+class ConfigCacheClient
+{
+public:
+  /// Throws dal::CacheError if the server cannot be reached and dal::BadSnapshot if its snapshot is unusable
+  explicit ConfigCacheClient(const std::string& socket_path, const std::string& application_uid = "");
+  ~ConfigCacheClient();
+
+  ConfigCacheClient(const ConfigCacheClient&) = delete;
+  ConfigCacheClient& operator=(const ConfigCacheClient&) = delete;
+
+  /**
+   * @brief Process the notifications received within timeout_ms (-1 waits indefinitely)
+   *
+   * Maps the latest snapshot if the server republished it. Returns true if
+   * the snapshot was replaced and the change affects the watched
+   * application. Throws dal::CacheError when the server went away.
+   */
+  bool poll(int timeout_ms = 0);
+
+  /// Readable when poll() has notifications to process
+  int fd() const noexcept { return m_fd; }
+
+  const snapshot::Reader& snapshot() const noexcept { return *m_snapshot; }
+  uint64_t generation() const noexcept { return m_generation; }
+
+  /// Record of the watched application, nullptr if none or no longer part of the session
+  const snapshot::ApplicationRecord* application() const noexcept;
+
+private:
+  bool read_line(std::string& line, int timeout_ms);
+
+  const std::string m_socket_path;
+  const std::string m_application_uid;
+  int m_fd = -1;
+  std::string m_input;
+  std::unique_ptr<snapshot::Reader> m_snapshot;
+  uint64_t m_generation = 0;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONFIGCACHE_HPP_
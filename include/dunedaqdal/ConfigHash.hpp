@@ -0,0 +1,135 @@
+/**
+ * @file ConfigHash.hpp
+ *
+ * Content hashes of the objects reachable from a Session, for change
+ * detection and as cache keys.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONFIGHASH_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONFIGHASH_HPP_
+
+#include "dunedaqdal/ChangeSet.hpp"
+
+#include "oksdbinterfaces/Change.hpp"
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+namespace detail {
+class ThreadPool;
+}
+
+/// 128-bit content hash; all zero means not computed
+struct ConfigHash
+{
+  uint64_t hi = 0;
+  uint64_t lo = 0;
+
+  bool empty() const noexcept { return hi == 0 && lo == 0; }
+  bool operator==(const ConfigHash& other) const noexcept { return hi == other.hi && lo == other.lo; }
+  bool operator!=(const ConfigHash& other) const noexcept { return !(*this == other); }
+
+  /// 32 hexadecimal digits
+  std::string str() const;
+};
+
+std::ostream&
+operator<<(std::ostream& out, const ConfigHash& hash);
+
+/**
+ * @brief Merkle hashes of the object graph of a Session
+ *
+ * The hash of an object covers its class, UID, attribute values and the
+ * hashes of its relationship targets in order, so it changes exactly when
+ * something reachable from the object changes: equal hashes of a
+ * DaqApplication in two versions of a configuration mean its modules,
+ * connections and environment are the same. Objects on a cycle, such as
+ * RCApplications controlling each other, are hashed together per strongly
+ * connected component, each member's hash combining the component's with
+ * its own identity.
+ *
+ * Objects are read in breadth-first waves and the components hashed level
+ * by level, sinks first, each wave and level spread over a pool of
+ * threads. update() re-reads only the objects reported as changed and
+ * rehashes them and the objects they are reachable from.
+ *
+ * The hash function is not cryptographic; it detects changes, it does not
+ * authenticate configurations.
+ */
+class ConfigHasher
+{
+public:
+  /// Read and hash everything reachable from the session; n_threads 0 means one per hardware thread
+  ConfigHasher(dunedaq::oksdbinterfaces::Configuration& db, const std::string& session_uid, unsigned int n_threads = 0);
+  ~ConfigHasher();
+
+  ConfigHasher(const ConfigHasher&) = delete;
+  ConfigHasher& operator=(const ConfigHasher&) = delete;
+
+  const ConfigHash& session() const noexcept { return m_nodes[0].hash; }
+
+  /// Hash of an object reachable from the session, nullptr if it is not
+  const ConfigHash* find(const std::string& uid, const std::string& class_name) const;
+
+  /// Hash of an entry of Session.applications, nullptr if there is none with that UID
+  const ConfigHash* application(const std::string& uid) const;
+
+  /// Number of objects reachable from the session
+  size_t size() const noexcept { return m_index.size(); }
+
+  /**
+   * @brief Bring the hashes up to date after the database was reloaded
+   *
+   * Only added objects referenced by a modified one are read: an object
+   * becomes reachable through a change of its referrer. Objects no longer
+   * reachable are dropped, and their storage reclaimed once they exceed half
+   * of the reachable ones. Returns the number of objects rehashed.
+   */
+  size_t update(const std::vector<ObjectChange>& changes);
+
+  /// update() from a subscription or ConfigAction notification
+  size_t update(const std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes);
+
+private:
+  struct Node
+  {
+    dunedaq::oksdbinterfaces::ConfigObject obj;
+    std::string key;                                ///< full name
+    std::string content;                            ///< canonical encoding of the class, UID and attributes
+    std::vector<std::string> relationships;         ///< names, in schema order
+    std::vector<std::vector<uint32_t>> targets;     ///< node indices, per relationship
+    std::vector<uint32_t> referrers;                ///< node indices having this one as target, possibly repeated
+    ConfigHash hash;
+    bool alive = true;
+  };
+
+  uint32_t add_node(dunedaq::oksdbinterfaces::ConfigObject obj);
+  void read(std::vector<uint32_t> wave, std::vector<uint32_t>& added);
+  void rehash(const std::vector<uint32_t>& dirty);
+  void hash_component(const std::vector<uint32_t>& members);
+  void collect_garbage();
+  void compact();
+
+  dunedaq::oksdbinterfaces::Configuration& m_db;
+  std::unique_ptr<detail::ThreadPool> m_pool;
+
+  std::vector<Node> m_nodes; ///< the session is node 0; dead nodes are dropped by compact()
+  std::unordered_map<std::string, uint32_t> m_index;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONFIGHASH_HPP_
@@ -0,0 +1,153 @@
+/**
+ * @file ConnectionResolver.hpp
+ *
+ * Batched publication and lookup of the NetworkConnection URIs of one
+ * application through the connectivity service, with a local cache.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONNECTIONRESOLVER_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONNECTIONRESOLVER_HPP_
+
+#include "dunedaqdal/PollingScheduler.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class DaqApplication;
+class NetworkConnection;
+class Session;
+
+struct ConnectionEntry
+{
+  std::string uid;
+  std::string uri;
+};
+
+/**
+ * @brief Client side of the connectivity service
+ *
+ * Implemented by the transport (e.g. the HTTP client of the connectivity
+ * server). Each call is one request; errors are reported by throwing.
+ */
+class ConnectivityBackend
+{
+public:
+  virtual ~ConnectivityBackend() = default;
+
+  /// Publish all entries in one request
+  virtual void publish(const std::vector<ConnectionEntry>& entries) = 0;
+
+  /// Look up all UIDs in one request; unknown UIDs are omitted from the result
+  virtual std::vector<ConnectionEntry> lookup(const std::vector<std::string>& uids) = 0;
+};
+
+struct ConnectionResolverParameters
+{
+  bool use_connectivity_server = true;
+
+  /// Maximum number of entries per request, 0 for no limit
+  uint32_t batch_size = 1000;
+
+  /// Time a looked up URI is used before it is looked up again
+  std::chrono::milliseconds cache_ttl{ 60000 };
+
+  /// Session.use_connectivity_server, connectivity_batch_size and connectivity_cache_ttl_ms
+  static ConnectionResolverParameters from(const Session& session);
+};
+
+/**
+ * @brief Resolves the NetworkConnection URIs of one DaqApplication
+ *
+ * The application binds the kSendRecv connections it consumes and the
+ * kPubSub connections it produces; it publishes those and looks up all
+ * other network connections its modules use. Both are sent in as few
+ * requests as the batch size allows instead of one request per connection.
+ *
+ * Looked up URIs are cached for the configured time. A lookup of a missing
+ * or expired connection refreshes every missing or expired connection of the
+ * application in the same batch. Without the connectivity server all URIs
+ * come from the configuration and the backend is never called.
+ *
+ * All member functions are thread safe.
+ */
+class ConnectionResolver
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Statistics
+  {
+    size_t publish_requests = 0;
+    size_t lookup_requests = 0;
+    size_t hits = 0;   ///< uri() answered from the cache
+    size_t misses = 0; ///< uri() had to look up
+  };
+
+  ConnectionResolver(ConnectivityBackend& backend, const Session& session, const DaqApplication& application);
+
+  ConnectionResolver(ConnectivityBackend& backend,
+                     const DaqApplication& application,
+                     const ConnectionResolverParameters& parameters);
+
+  ConnectionResolver(const ConnectionResolver&) = delete;
+  ConnectionResolver& operator=(const ConnectionResolver&) = delete;
+
+  /// Connections bound, and published, by the application
+  const std::vector<const NetworkConnection*>& bound() const noexcept { return m_bound; }
+
+  /// Connections the application connects to, and looks up
+  const std::vector<const NetworkConnection*>& connected() const noexcept { return m_connected; }
+
+  /// Publish all bound connections with their configured URIs
+  void publish();
+
+  /// Look up all connected connections which are missing or expired; returns the number still unknown
+  size_t refresh(Clock::time_point now = Clock::now());
+
+  /// refresh() restricted to connections of one type, as scheduled by a PollingScheduler
+  size_t refresh(ConnectionType type, Clock::time_point now = Clock::now());
+
+  /// URI of a bound or connected connection, looked up if needed; std::nullopt if unknown
+  std::optional<std::string> uri(const std::string& connection_uid, Clock::time_point now = Clock::now());
+
+  /// Forget the cached URI, e.g. after a failure to connect to it
+  void invalidate(const std::string& connection_uid);
+
+  Statistics statistics() const;
+
+private:
+  struct CacheEntry
+  {
+    std::string uri;
+    Clock::time_point expires;
+    bool known = false;
+  };
+
+  size_t refresh_locked(Clock::time_point now, const ConnectionType* type);
+
+  ConnectivityBackend& m_backend;
+  const ConnectionResolverParameters m_parameters;
+
+  std::vector<const NetworkConnection*> m_bound;
+  std::vector<const NetworkConnection*> m_connected;
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<std::string, CacheEntry> m_cache; ///< configured URIs of bound connections never expire
+  Statistics m_statistics;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONNECTIONRESOLVER_HPP_
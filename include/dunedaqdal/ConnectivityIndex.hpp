@@ -0,0 +1,153 @@
+/**
+ * @file ConnectivityIndex.hpp
+ *
+ * Precomputed producer/consumer index over the DaqModule inputs and outputs
+ * of a Session.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONNECTIVITYINDEX_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONNECTIVITYINDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Connection;
+class DaqApplication;
+class DaqModule;
+class Session;
+
+/**
+ * @brief Module connectivity graph of a Session in compressed sparse row form
+ *
+ * The schema only stores the forward DaqModule.inputs and DaqModule.outputs
+ * relationships. The index is built in a single pass over the
+ * DaqApplication.modules of a Session and additionally provides the reverse
+ * direction, i.e. the producers and consumers of each Connection.
+ *
+ * Applications, modules and connections are numbered densely in order of
+ * first appearance; all adjacency queries take and return these indices.
+ * An object listed twice in the same relationship appears once in its row.
+ * The index holds plain pointers to DAL objects and must be rebuilt when the
+ * configuration changes.
+ */
+class ConnectivityIndex
+{
+public:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  /// Contiguous run of indices in one of the adjacency arrays
+  class Range
+  {
+  public:
+    Range(const uint32_t* begin, const uint32_t* end) noexcept
+      : m_begin(begin)
+      , m_end(end)
+    {
+    }
+
+    const uint32_t* begin() const noexcept { return m_begin; }
+    const uint32_t* end() const noexcept { return m_end; }
+    size_t size() const noexcept { return m_end - m_begin; }
+    bool empty() const noexcept { return m_begin == m_end; }
+    uint32_t operator[](size_t i) const noexcept { return m_begin[i]; }
+
+  private:
+    const uint32_t* m_begin;
+    const uint32_t* m_end;
+  };
+
+  explicit ConnectivityIndex(const Session& session);
+
+  size_t num_applications() const noexcept { return m_applications.size(); }
+  size_t num_modules() const noexcept { return m_modules.size(); }
+  size_t num_connections() const noexcept { return m_connections.size(); }
+
+  const DaqApplication* application(uint32_t idx) const { return m_applications[idx]; }
+  const DaqModule* module(uint32_t idx) const { return m_modules[idx]; }
+  const Connection* connection(uint32_t idx) const { return m_connections[idx]; }
+
+  /// Index of the object with given UID, or npos
+  uint32_t application_index(const std::string& uid) const noexcept { return find(m_application_ids, uid); }
+  uint32_t module_index(const std::string& uid) const noexcept { return find(m_module_ids, uid); }
+  uint32_t connection_index(const std::string& uid) const noexcept { return find(m_connection_ids, uid); }
+
+  /// Modules listing the connection in their outputs
+  Range producers(uint32_t connection) const noexcept { return slice(m_producer_offsets, m_producers, connection); }
+
+  /// Modules listing the connection in their inputs
+  Range consumers(uint32_t connection) const noexcept { return slice(m_consumer_offsets, m_consumers, connection); }
+
+  /// Connections in DaqModule.inputs
+  Range inputs(uint32_t module) const noexcept { return slice(m_input_offsets, m_inputs, module); }
+
+  /// Connections in DaqModule.outputs
+  Range outputs(uint32_t module) const noexcept { return slice(m_output_offsets, m_outputs, module); }
+
+  /// Modules in DaqApplication.modules
+  Range modules_of(uint32_t application) const noexcept
+  {
+    return slice(m_module_offsets, m_application_modules, application);
+  }
+
+  /// Application owning the module (the first one, should a module be shared)
+  uint32_t application_of(uint32_t module) const noexcept { return m_module_application[module]; }
+
+  /// Convenience lookups by connection UID
+  std::vector<const DaqModule*> producers(const std::string& connection_uid) const;
+  std::vector<const DaqModule*> consumers(const std::string& connection_uid) const;
+
+private:
+  static uint32_t find(const std::unordered_map<std::string, uint32_t>& ids, const std::string& uid) noexcept
+  {
+    auto it = ids.find(uid);
+    return it == ids.end() ? npos : it->second;
+  }
+
+  static Range slice(const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& values, uint32_t idx) noexcept
+  {
+    return Range(values.data() + offsets[idx], values.data() + offsets[idx + 1]);
+  }
+
+  static void invert(const std::vector<uint32_t>& offsets,
+                     const std::vector<uint32_t>& values,
+                     size_t num_targets,
+                     std::vector<uint32_t>& reverse_offsets,
+                     std::vector<uint32_t>& reverse_values);
+
+  std::vector<const DaqApplication*> m_applications;
+  std::vector<const DaqModule*> m_modules;
+  std::vector<const Connection*> m_connections;
+
+  std::unordered_map<std::string, uint32_t> m_application_ids;
+  std::unordered_map<std::string, uint32_t> m_module_ids;
+  std::unordered_map<std::string, uint32_t> m_connection_ids;
+
+  std::vector<uint32_t> m_module_application;
+
+  std::vector<uint32_t> m_module_offsets;
+  std::vector<uint32_t> m_application_modules;
+
+  std::vector<uint32_t> m_input_offsets;
+  std::vector<uint32_t> m_inputs;
+  std::vector<uint32_t> m_output_offsets;
+  std::vector<uint32_t> m_outputs;
+
+  std::vector<uint32_t> m_producer_offsets;
+  std::vector<uint32_t> m_producers;
+  std::vector<uint32_t> m_consumer_offsets;
+  std::vector<uint32_t> m_consumers;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONNECTIVITYINDEX_HPP_
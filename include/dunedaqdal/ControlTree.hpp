@@ -0,0 +1,157 @@
+/**
+ * @file ControlTree.hpp
+ *
+ * Control hierarchy of the RCApplications of a Session, built once from
+ * their ApplicationsControlled, and balanced trees for a target fan-out.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONTROLTREE_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONTROLTREE_HPP_
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Application;
+class Session;
+
+struct ControlTreeIssue
+{
+  enum class Kind
+  {
+    controlled_twice, ///< application in the ApplicationsControlled of several controllers
+    uncontrolled,     ///< application of the session controlled by no RCApplication, other than the root
+    not_in_session,   ///< controlled application missing from Session.applications
+    cycle             ///< application not reachable from any root because its controllers form a cycle
+  };
+
+  Kind kind;
+  std::string application;
+  std::vector<std::string> controllers; ///< for controlled_twice and not_in_session
+
+  std::string message() const;
+};
+
+/// Fan-out of the controllers, i.e. the applications with children
+struct FanOutStatistics
+{
+  size_t controllers = 0;
+  size_t min = 0;
+  size_t max = 0;
+  double mean = 0;
+};
+
+/**
+ * @brief Control hierarchy of a Session
+ *
+ * The applications of Session.applications are numbered in session order.
+ * The parent of an application is the first RCApplication listing it in
+ * ApplicationsControlled; the tree is stored as a parent array and, for the
+ * children, in compressed sparse row form. The root is the uncontrolled
+ * RCApplication with the largest subtree; every other uncontrolled
+ * application is reported as an issue.
+ *
+ * The tree holds plain pointers to DAL objects and must be rebuilt when the
+ * configuration changes.
+ */
+class ControlTree
+{
+public:
+  static constexpr uint32_t npos = ConnectivityIndex::npos;
+  using Range = ConnectivityIndex::Range;
+
+  explicit ControlTree(const Session& session);
+
+  size_t size() const noexcept { return m_applications.size(); }
+  const Application* application(uint32_t idx) const { return m_applications[idx]; }
+
+  /// Index of the application with given UID, or npos
+  uint32_t index(const std::string& uid) const noexcept;
+
+  /// Root of the tree, or npos if no RCApplication is uncontrolled
+  uint32_t root() const noexcept { return m_root; }
+
+  /// Controller of the application, npos for uncontrolled ones
+  uint32_t parent(uint32_t idx) const noexcept { return m_parent[idx]; }
+
+  /// Applications controlled by the application, in ApplicationsControlled order
+  Range children(uint32_t idx) const noexcept
+  {
+    return Range(m_children.data() + m_child_offsets[idx], m_children.data() + m_child_offsets[idx + 1]);
+  }
+
+  /// Distance from the root, npos when the application is not below the root
+  uint32_t depth(uint32_t idx) const noexcept { return m_depth[idx]; }
+
+  /// Number of levels of the tree, 1 for a root alone and 0 without root
+  size_t height() const noexcept { return m_height; }
+
+  /// Applications below the application, itself included
+  size_t subtree_size(uint32_t idx) const noexcept { return m_subtree_size[idx]; }
+
+  FanOutStatistics fan_out() const;
+
+  const std::vector<ControlTreeIssue>& issues() const noexcept { return m_issues; }
+
+private:
+  std::vector<const Application*> m_applications;
+  std::unordered_map<std::string, uint32_t> m_ids;
+
+  std::vector<uint32_t> m_parent;
+  std::vector<uint32_t> m_child_offsets;
+  std::vector<uint32_t> m_children;
+  std::vector<uint32_t> m_depth;
+  std::vector<uint32_t> m_subtree_size;
+
+  uint32_t m_root = npos;
+  size_t m_height = 0;
+  std::vector<ControlTreeIssue> m_issues;
+};
+
+/// One controller of a proposed tree
+struct ProposedController
+{
+  std::string uid;                   ///< existing RCApplication, or a new name
+  bool existing = false;             ///< uid is an RCApplication of the session
+  std::string parent;                ///< empty for the root
+  std::vector<std::string> children; ///< controllers or, on the last level, the leaf applications
+};
+
+struct ControlTreeProposal
+{
+  unsigned int fan_out = 0;
+  size_t leaves = 0;
+  size_t height = 0;                          ///< levels of controllers
+  std::vector<ProposedController> controllers; ///< root first, then level by level
+};
+
+/**
+ * @brief Balanced control tree with at most fan_out children per controller
+ *
+ * The leaves are the applications of the session which are not
+ * RCApplications, in depth-first order of the current tree so that
+ * existing segments stay together. They are grouped bottom-up into as few
+ * controllers per level as the fan-out allows, with group sizes differing by
+ * at most one, which gives a height of ceil(log_fan_out(leaves)).
+ * Controllers reuse the RCApplications of the current tree in breadth-first
+ * order and are named new_prefix + level + '-' + index when more are needed;
+ * a name already used by an Application of the database gets a further '-'
+ * and the first number from 2 which makes it unique.
+ * A fan_out below 2 is treated as 2.
+ */
+ControlTreeProposal
+propose_balanced_tree(const Session& session, unsigned int fan_out, const std::string& new_prefix = "rc-segment-");
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_CONTROLTREE_HPP_
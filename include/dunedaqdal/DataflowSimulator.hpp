@@ -0,0 +1,144 @@
+/**
+ * @file DataflowSimulator.hpp
+ *
+ * Discrete-event simulation of the message flow between the DaqModules of
+ * a Session, to find its throughput and back-pressure points before it is
+ * deployed.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_DATAFLOWSIMULATOR_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_DATAFLOWSIMULATOR_HPP_
+
+#include "dunedaqdal/ResourceEstimator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+
+/**
+ * @brief Time a module of a plugin takes to handle one message
+ *
+ * Service times follow a gamma distribution with the given mean and
+ * coefficient of variation: cv 0 is a fixed time, cv 1 an exponential
+ * distribution. For a module without inputs, a source such as a
+ * RandomListGenerator, it is the time to produce one message.
+ */
+struct ServiceModel
+{
+  double mean_us = 10.;
+  double cv = 1.;
+};
+
+/// Service model per DaqModule.plugin
+using ServiceModels = std::unordered_map<std::string, ServiceModel>;
+
+/**
+ * @brief Read service models
+ *
+ * One "<plugin> <mean service time in us> [<coefficient of variation>]"
+ * line per plugin, the coefficient defaulting to 1; empty lines and lines
+ * starting with '#' are ignored. Throws dal::BadServiceModel.
+ */
+ServiceModels
+read_service_models(const std::string& path);
+
+struct SimulationParameters
+{
+  double duration_s = 1.; ///< simulated time, including the warm-up
+  double warmup_s = 0.1;  ///< initial time left out of the statistics
+
+  unsigned int replications = 8; ///< independent runs, averaged
+  unsigned int n_threads = 0;    ///< threads running the replications; 0 means one per hardware thread
+  uint64_t seed = 1;
+
+  /// Model of the plugins missing from the ServiceModels
+  ServiceModel default_model;
+
+  /// Time from push to pop of a Queue message, per Queue.queue_type; unlisted types take none
+  std::unordered_map<std::string, double> queue_latency_us = {
+    { "kStdDeQueue", 1. }, { "kFollySPSCQueue", 0.05 }, { "kFollyMPMCQueue", 0.2 }, { "kLockFreeMPSCRing", 0.1 }
+  };
+
+  double network_latency_us = 50.; ///< NetworkConnection latency, to which the transfer time is added
+  double link_gbps = 10.;          ///< for the transfer time of DataTypeProfile.payload_size bytes
+  uint32_t network_buffer = 1000;  ///< messages buffered per NetworkConnection receiver, the ZeroMQ high-water mark
+
+  /// Connections full at least this fraction of the time are reported as back-pressure points
+  double backpressure_threshold = 0.05;
+};
+
+struct ModuleStatistics
+{
+  double throughput_hz = 0;    ///< messages handled per second
+  double throughput_error = 0; ///< standard error of the mean over the replications
+  double busy = 0;             ///< fraction of the time spent handling messages
+  double blocked = 0;          ///< fraction of the time waiting for room in an output
+  double starved = 0;          ///< fraction of the time waiting for input
+};
+
+struct ConnectionStatistics
+{
+  uint32_t capacity = 0;     ///< messages per receiver; 0 for a connection nothing reads
+  double throughput_hz = 0;  ///< messages sent per second
+  double dropped_hz = 0;     ///< messages per second a kPubSub connection dropped for full subscribers
+  double mean_occupancy = 0; ///< of the fullest receiver
+  uint32_t max_occupancy = 0;
+  double full = 0;           ///< fraction of the time the fullest receiver was at capacity
+};
+
+struct SimulationResult
+{
+  std::vector<ModuleStatistics> modules;         ///< by ConnectivityIndex module index
+  std::vector<ConnectionStatistics> connections; ///< by ConnectivityIndex connection index
+
+  /// Connections full at least SimulationParameters::backpressure_threshold of the time, fullest first
+  std::vector<uint32_t> backpressure;
+
+  /// Module busy the largest fraction of the time, ConnectivityIndex::npos without modules
+  uint32_t bottleneck = 0;
+
+  std::vector<std::string> unknown_plugins; ///< plugins simulated with the default model, sorted
+  double simulated_s = 0;                   ///< measured time per replication
+  uint64_t events = 0;                      ///< over all replications
+};
+
+/**
+ * @brief Simulate the message flow through the modules of the index
+ *
+ * Every module handles one message at a time and sends one message on each
+ * of its outputs per message handled; modules without inputs produce
+ * messages continuously. A module waits while any output it must not drop
+ * from is full, which is how back-pressure propagates upstream:
+ * - a Queue holds Queue.capacity messages shared by its consumers, each
+ *   message delayed by the latency of its queue_type;
+ * - a SharedMemoryConnection holds slot_count messages, per consumer in
+ *   kMultiConsumer mode;
+ * - kSendRecv NetworkConnection receivers share the messages and kPubSub
+ *   subscribers each receive all of them, every receiver buffering
+ *   network_buffer messages; a publisher drops the messages of full
+ *   subscribers instead of waiting, as ZeroMQ does.
+ * Network messages are delayed by the latency plus the transfer time of the
+ * payload_size of their data type, if the registry has it.
+ *
+ * The replications run in parallel with different seeds, on a copy of the
+ * topology made before they start, and the statistics are their averages.
+ */
+SimulationResult
+simulate(const ConnectivityIndex& index,
+         const ServiceModels& models,
+         const SimulationParameters& parameters = {},
+         const DataTypeRegistry& data_types = {});
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_DATAFLOWSIMULATOR_HPP_
@@ -0,0 +1,120 @@
+/**
+ * @file EnvironmentResolver.hpp
+ *
+ * Cached resolution of the process environment defined by the
+ * Session.ProcessEnvironment and Application.ApplicationEnvironment
+ * relationships.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_ENVIRONMENTRESOLVER_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_ENVIRONMENTRESOLVER_HPP_
+
+#include "dunedaqdal/StringPool.hpp"
+
+#include "oksdbinterfaces/ConfigAction.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Application;
+class Parameter;
+class Session;
+class VariableSet;
+
+/// Flattened process environment: variable name -> value
+using Environment = std::map<std::string, std::string>;
+
+/// Flattened process environment with names and values interned in the resolver's StringPool
+using InternedEnvironment = std::map<std::string_view, std::string_view>;
+
+/**
+ * @brief Resolves VariableSet trees into flat environments and caches them
+ *
+ * Each VariableSet is flattened at most once; the result is shared by every
+ * Session or Application that refers to the set, directly or through other
+ * sets. When the same variable name is defined more than once the later
+ * definition wins, so application variables override session ones.
+ *
+ * Cached environments refer to names and values interned in a StringPool
+ * owned by the resolver, so a variable shared by many sets is stored once.
+ * clear(), load() and unload() start a new pool; the old one lives on until
+ * the last environment returned from it is released.
+ *
+ * The resolver registers itself as an action on the configuration and drops
+ * only the cache entries depending on objects reported as modified or
+ * removed.
+ */
+class EnvironmentResolver : public dunedaq::oksdbinterfaces::ConfigAction
+{
+public:
+  explicit EnvironmentResolver(dunedaq::oksdbinterfaces::Configuration& db);
+  ~EnvironmentResolver();
+
+  EnvironmentResolver(const EnvironmentResolver&) = delete;
+  EnvironmentResolver& operator=(const EnvironmentResolver&) = delete;
+
+  /// Flattened environment of one variable set; throws dal::CircularDependency
+  std::shared_ptr<const InternedEnvironment> get(const VariableSet& set);
+
+  /// Flattened environment of a list of parameters, as used by the relationships
+  Environment get(const std::vector<const Parameter*>& parameters);
+
+  /// Environment of an application run in the given session
+  Environment get(const Session& session, const Application& application);
+
+  /// Drop the cached result for the given Variable or VariableSet and for all sets containing it
+  void invalidate(const std::string& uid);
+
+  /// Drop all cached results
+  void clear();
+
+  /// Number of variable sets currently cached
+  size_t size() const;
+
+  /// Pool of the current cache generation, kept alive by the caller after clear(), load() or unload()
+  std::shared_ptr<const StringPool> strings() const;
+
+  void notify(std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes) noexcept override;
+  void load() noexcept override;
+  void unload() noexcept override;
+  void update(const dunedaq::oksdbinterfaces::ConfigObject& obj, const std::string& name) noexcept override;
+
+private:
+  std::shared_ptr<const InternedEnvironment> resolve(const VariableSet& set, std::vector<std::string>& stack);
+  void add(const std::vector<const Parameter*>& parameters,
+           InternedEnvironment& env,
+           const std::string* parent,
+           std::vector<std::string>& stack);
+  void invalidate_nolock(const std::string& uid);
+  static Environment copy(const InternedEnvironment& env);
+
+  dunedaq::oksdbinterfaces::Configuration& m_db;
+
+  mutable std::mutex m_mutex;
+
+  /// Pool of the current cache generation, shared with the environments interned in it
+  std::shared_ptr<StringPool> m_strings = std::make_shared<StringPool>();
+
+  /// VariableSet UID -> flattened environment
+  std::unordered_map<std::string, std::shared_ptr<const InternedEnvironment>> m_cache;
+
+  /// Parameter UID -> UIDs of the variable sets directly containing it
+  std::unordered_map<std::string, std::unordered_set<std::string>> m_parents;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_ENVIRONMENTRESOLVER_HPP_
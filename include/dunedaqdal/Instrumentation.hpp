@@ -0,0 +1,119 @@
+/**
+ * @file Instrumentation.hpp
+ *
+ * Optional per-class counters of DAL object instantiations, cache hits and
+ * misses and relationship traversals.
+ *
+ * Counting is compiled in when DUNEDAQDAL_INSTRUMENTATION is defined (CMake
+ * option of the same name) and is then switched on at run time with
+ * instrumentation::enable() or by setting the DUNEDAQDAL_INSTRUMENTATION
+ * environment variable. While switched off a counting point costs one
+ * relaxed atomic load; compiled out it costs nothing.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_INSTRUMENTATION_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_INSTRUMENTATION_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal::instrumentation {
+
+enum class Counter : uint8_t
+{
+  instantiations, ///< DAL objects created or first initialised
+  cache_hits,     ///< results served from one of the dunedaqdal caches
+  cache_misses,   ///< results computed and inserted into a cache
+  traversals,     ///< relationships followed
+  num_counters
+};
+
+constexpr size_t num_counters = static_cast<size_t>(Counter::num_counters);
+
+/// Classes beyond this many share the last slot, reported as "other"
+constexpr size_t max_classes = 64;
+
+struct ClassCounters
+{
+  std::string class_name;
+  std::array<uint64_t, num_counters> counts{};
+
+  uint64_t operator[](Counter c) const noexcept { return counts[static_cast<size_t>(c)]; }
+};
+
+namespace detail {
+
+extern std::atomic<bool> g_enabled;
+
+/// Slot of the class, allocated on first use and cached per thread by the address of the name
+size_t
+class_slot(const std::string& class_name);
+
+void
+record(size_t slot, Counter counter, uint64_t n) noexcept;
+
+} // namespace detail
+
+inline bool
+enabled() noexcept
+{
+  return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+void
+enable(bool on = true) noexcept;
+
+/// Sum of the counters of all threads, past and present, for every class seen; sorted by class name
+std::vector<ClassCounters>
+collect();
+
+/// Zero all counters
+void
+reset();
+
+/// Table of collect()
+void
+dump(std::ostream& out);
+
+/// dump() through TLOG
+void
+log();
+
+} // namespace dunedaq::dal::instrumentation
+
+#ifdef DUNEDAQDAL_INSTRUMENTATION
+
+/**
+ * Add n to a counter of the class. The slot is looked up on every pass, so
+ * class_name can be the dynamic class of an object, obj->class_name(); it
+ * must refer to a string living as long as the class, such as s_class_name.
+ */
+#define DUNEDAQDAL_COUNT_N(class_name, counter, n)                                                                    \
+  do {                                                                                                                 \
+    if (::dunedaq::dal::instrumentation::enabled()) {                                                                 \
+      ::dunedaq::dal::instrumentation::detail::record(::dunedaq::dal::instrumentation::detail::class_slot(class_name), \
+                                                      ::dunedaq::dal::instrumentation::Counter::counter,               \
+                                                      (n));                                                            \
+    }                                                                                                                  \
+  } while (0)
+
+#else
+
+#define DUNEDAQDAL_COUNT_N(class_name, counter, n)                                                                    \
+  do {                                                                                                                 \
+  } while (0)
+
+#endif
+
+#define DUNEDAQDAL_COUNT(class_name, counter) DUNEDAQDAL_COUNT_N(class_name, counter, 1)
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_INSTRUMENTATION_HPP_
@@ -0,0 +1,93 @@
+/**
+ * @file Issues.hpp
+ *
+ * ERS issues raised by the hand-written dunedaqdal algorithms
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_ISSUES_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_ISSUES_HPP_
+
+#include "ers/Issue.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace dunedaq {
+
+ERS_DECLARE_ISSUE(dal,
+                  CircularDependency,
+                  "Circular dependency detected while resolving " << what << ": " << path,
+                  ((std::string)what)((std::string)path))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadSnapshot,
+                  "Cannot use snapshot " << name << ": " << reason,
+                  ((std::string)name)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadDataFile,
+                  "Cannot load " << file << ':' << line << ": " << reason,
+                  ((std::string)file)((size_t)line)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  CacheError,
+                  "Configuration cache " << endpoint << ": " << reason,
+                  ((std::string)endpoint)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadTableExport,
+                  "Cannot export table to " << file << ": " << reason,
+                  ((std::string)file)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadTraceExport,
+                  "Cannot write profile trace to " << file << ": " << reason,
+                  ((std::string)file)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  ApplicationNotFound,
+                  "Application \"" << application << "\" is not part of session \"" << session << '"',
+                  ((std::string)application)((std::string)session))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadRateProfile,
+                  "Cannot read rate profile " << file << ": " << reason,
+                  ((std::string)file)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadServiceModel,
+                  "Cannot read service models " << file << ": " << reason,
+                  ((std::string)file)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadControlDependency,
+                  "Bad control dependency \"" << dependency << "\" of " << controller << ": " << reason,
+                  ((std::string)dependency)((std::string)controller)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  TransitionFailed,
+                  "Transition " << transition << " of " << application << " failed: " << reason,
+                  ((std::string)transition)((std::string)application)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadPortList,
+                  "Bad port list \"" << list << "\": " << reason,
+                  ((std::string)list)((std::string)reason))
+
+ERS_DECLARE_ISSUE(dal,
+                  PortsExhausted,
+                  "No free port left on host " << host << " in " << first << ".." << last,
+                  ((std::string)host)((uint16_t)first)((uint16_t)last))
+
+ERS_DECLARE_ISSUE(dal,
+                  BadCpuList,
+                  "Bad cpu list \"" << list << "\": " << reason,
+                  ((std::string)list)((std::string)reason))
+
+} // namespace dunedaq
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_ISSUES_HPP_
@@ -0,0 +1,282 @@
+/**
+ * @file LazyRelationship.hpp
+ *
+ * Handles on objects and relationship vectors which instantiate the DAL
+ * objects behind them only when dereferenced, e.g.
+ *
+ *     for (const auto& app : dal::lazy_applications(db, "my-session").handles()) {
+ *       std::cout << app.attribute<std::string>("host") << ':' << app.attribute<uint16_t>("port") << '\n';
+ *     }
+ *
+ * reads the host and port of every application without creating a single
+ * DaqModule or Connection object.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_LAZYRELATIONSHIP_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_LAZYRELATIONSHIP_HPP_
+
+#include "dunedaqdal/Instrumentation.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Application;
+
+template<class T>
+class LazyRelationship;
+
+/**
+ * @brief Object of class T, or of a subclass, not necessarily instantiated as a DAL object
+ *
+ * Attributes and relationships are read through the ConfigObject. The
+ * generated DAL classes read all their relationships when they are
+ * initialised, so that e.g. a DaqApplication creates the DaqModule objects
+ * of DaqApplication.modules; a handle creates nothing until get().
+ * Like a ConfigObject, a handle is meant for one thread at a time.
+ */
+template<class T>
+class LazyObject
+{
+public:
+  LazyObject(dunedaq::oksdbinterfaces::Configuration& db, dunedaq::oksdbinterfaces::ConfigObject obj) noexcept
+    : m_db(&db)
+    , m_obj(std::move(obj))
+  {
+  }
+
+  const std::string& UID() const noexcept { return m_obj.UID(); }
+  const std::string& class_name() const noexcept { return m_obj.class_name(); }
+  const dunedaq::oksdbinterfaces::ConfigObject& config_object() const noexcept { return m_obj; }
+
+  /// Value of an attribute, e.g. attribute<uint16_t>("port")
+  template<class V>
+  V attribute(const std::string& name) const
+  {
+    V value{};
+    m_obj.get(name, value);
+    return value;
+  }
+
+  /// Targets of a relationship, e.g. relationship<DaqModule>("modules")
+  template<class U>
+  LazyRelationship<U> relationship(const std::string& name,
+                                   size_t page_size = LazyRelationship<U>::default_page_size) const
+  {
+    return LazyRelationship<U>(*m_db, m_obj, name, page_size);
+  }
+
+  /// Same object seen as a U, which must be its class or one of its bases
+  template<class U>
+  LazyObject<U> as() const noexcept
+  {
+    return LazyObject<U>(*m_db, m_obj);
+  }
+
+  /// The DAL object, instantiated, timed and counted by the first call only; copies made after it share the object
+  const T* get() const
+  {
+    if (m_dal == nullptr) {
+      DUNEDAQDAL_PROFILE_SCOPE("instantiate", T::s_class_name);
+      m_dal = m_db->template get<T>(m_obj);
+      DUNEDAQDAL_COUNT(m_obj.class_name(), instantiations);
+    }
+    return m_dal;
+  }
+
+private:
+  dunedaq::oksdbinterfaces::Configuration* m_db;
+  mutable dunedaq::oksdbinterfaces::ConfigObject m_obj;
+  mutable const T* m_dal = nullptr;
+};
+
+/**
+ * @brief Relationship vector whose targets are instantiated page by page
+ *
+ * The list of targets is read on first use, as ConfigObjects. The DAL
+ * object of a target is created when it is dereferenced, together with the
+ * other targets of its page of page_size entries; a page size of 1 makes
+ * every target independent. prefetch() tells the handle which targets are
+ * about to be used, so that their pages are loaded in one go.
+ *
+ * Copies share their state, and all members may be called from several
+ * threads. The DAL objects are owned by the Configuration.
+ */
+template<class T>
+class LazyRelationship
+{
+public:
+  static constexpr size_t default_page_size = 16;
+
+  /// Forward iterator over the DAL objects of the targets
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const T*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    iterator(const LazyRelationship* relationship, size_t i) noexcept
+      : m_relationship(relationship)
+      , m_i(i)
+    {
+    }
+
+    const T* operator*() const { return (*m_relationship)[m_i]; }
+    iterator& operator++() noexcept
+    {
+      ++m_i;
+      return *this;
+    }
+    iterator operator++(int) noexcept { return iterator(m_relationship, m_i++); }
+    bool operator==(const iterator& other) const noexcept { return m_i == other.m_i; }
+    bool operator!=(const iterator& other) const noexcept { return m_i != other.m_i; }
+
+  private:
+    const LazyRelationship* m_relationship;
+    size_t m_i;
+  };
+
+  LazyRelationship(dunedaq::oksdbinterfaces::Configuration& db,
+                   dunedaq::oksdbinterfaces::ConfigObject owner,
+                   std::string name,
+                   size_t page_size = default_page_size)
+    : m_state(std::make_shared<State>(db, std::move(owner), std::move(name), std::max<size_t>(page_size, 1)))
+  {
+  }
+
+  /// Number of targets; reads the relationship, but none of the targets
+  size_t size() const { return targets().size(); }
+  bool empty() const { return size() == 0; }
+
+  const std::string& uid(size_t i) const { return targets()[i].UID(); }
+
+  /// Handle on target i, which does not instantiate it
+  LazyObject<T> handle(size_t i) const { return LazyObject<T>(m_state->db, targets()[i]); }
+
+  /// Handles on all targets
+  std::vector<LazyObject<T>> handles() const
+  {
+    std::vector<LazyObject<T>> result;
+    result.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+      result.push_back(handle(i));
+    }
+    return result;
+  }
+
+  /// DAL object of target i; loads its page on first access
+  const T* operator[](size_t i) const
+  {
+    targets();
+    load_page(i / m_state->page_size);
+    return m_state->objects[i];
+  }
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, size()); }
+
+  /// Hint that targets first .. first + count - 1 are about to be dereferenced: load their pages now
+  void prefetch(size_t first, size_t count) const
+  {
+    const size_t n = size();
+    if (first >= n || count == 0) {
+      return;
+    }
+    const size_t last = std::min(n, first + count) - 1;
+    for (size_t page = first / m_state->page_size; page <= last / m_state->page_size; ++page) {
+      load_page(page);
+    }
+  }
+
+  /// Load all pages
+  void prefetch() const { prefetch(0, size()); }
+
+  size_t page_size() const noexcept { return m_state->page_size; }
+  size_t pages_loaded() const noexcept { return m_state->pages_loaded; }
+
+private:
+  struct State
+  {
+    State(dunedaq::oksdbinterfaces::Configuration& db_,
+          dunedaq::oksdbinterfaces::ConfigObject owner_,
+          std::string name_,
+          size_t page_size_)
+      : db(db_)
+      , owner(std::move(owner_))
+      , name(std::move(name_))
+      , page_size(page_size_)
+    {
+    }
+
+    dunedaq::oksdbinterfaces::Configuration& db;
+    dunedaq::oksdbinterfaces::ConfigObject owner;
+    const std::string name;
+    const size_t page_size;
+
+    std::once_flag targets_flag;
+    std::vector<dunedaq::oksdbinterfaces::ConfigObject> targets;
+
+    // sized by the targets_flag call, one flag per page
+    std::unique_ptr<std::once_flag[]> page_flags;
+    std::vector<const T*> objects;
+    std::atomic<size_t> pages_loaded{ 0 };
+  };
+
+  std::vector<dunedaq::oksdbinterfaces::ConfigObject>& targets() const
+  {
+    State& s = *m_state;
+    std::call_once(s.targets_flag, [&s] {
+      s.owner.get(s.name, s.targets);
+      s.objects.resize(s.targets.size(), nullptr);
+      s.page_flags.reset(new std::once_flag[(s.targets.size() + s.page_size - 1) / s.page_size]);
+      DUNEDAQDAL_COUNT(s.owner.class_name(), traversals);
+    });
+    return s.targets;
+  }
+
+  void load_page(size_t page) const
+  {
+    State& s = *m_state;
+    std::call_once(s.page_flags[page], [&s, page] {
+      DUNEDAQDAL_PROFILE_SCOPE("instantiate", T::s_class_name);
+      const size_t first = page * s.page_size;
+      const size_t last = std::min(s.targets.size(), first + s.page_size);
+      for (size_t i = first; i < last; ++i) {
+        s.objects[i] = s.db.template get<T>(s.targets[i]);
+        DUNEDAQDAL_COUNT(s.targets[i].class_name(), instantiations);
+      }
+      ++s.pages_loaded;
+    });
+  }
+
+  std::shared_ptr<State> m_state;
+};
+
+/// Session.applications, read without instantiating the Session DAL object
+LazyRelationship<Application>
+lazy_applications(dunedaq::oksdbinterfaces::Configuration& db,
+                  const std::string& session_uid,
+                  size_t page_size = LazyRelationship<Application>::default_page_size);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_LAZYRELATIONSHIP_HPP_
@@ -0,0 +1,80 @@
+/**
+ * @file Placement.hpp
+ *
+ * CPU list handling and per-host validation of the ProcessPlacement of
+ * DaqApplications and the thread affinity of their DaqModules.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PLACEMENT_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PLACEMENT_HPP_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Session;
+
+/// Sorted, duplicate-free CPU numbers
+using CpuSet = std::vector<uint32_t>;
+
+/// Parse a Linux cpu list such as "0-3,8,10-11"; throws dal::BadCpuList
+CpuSet
+parse_cpu_list(const std::string& list);
+
+/// Inverse of parse_cpu_list(), using ranges where possible
+std::string
+format_cpu_list(const CpuSet& cpus);
+
+/// CPUs of each host by host name, e.g. from /sys/devices/system/cpu/online
+using HostCpus = std::map<std::string, CpuSet>;
+
+/// CPUs present in both sets
+CpuSet
+intersection(const CpuSet& a, const CpuSet& b);
+
+struct PlacementIssue
+{
+  enum class Kind
+  {
+    bad_cpu_list,        ///< object: the ProcessPlacement or DaqModule with a malformed list
+    overlapping_cpus,    ///< object and other: two applications on host pinned to the same cpus
+    overlapping_module,  ///< object: module of an unpinned application sharing cpus with other, an application/module
+    module_outside_app,  ///< object: module whose thread_affinity is not within the cpu_set of application other
+    outside_host,        ///< object: the ProcessPlacement or DaqModule using cpus that host does not have
+    missing_numa_nodes   ///< object: placement with a binding memory policy but no numa_nodes
+  };
+
+  Kind kind;
+  std::string host;
+  std::string object;
+  std::string other;
+  CpuSet cpus; ///< offending cpus, when applicable
+
+  std::string message() const;
+};
+
+/**
+ * @brief Check the placement of all DaqApplications of the session
+ *
+ * Applications without a placement, or with an empty cpu_set, are not
+ * pinned. The modules of such applications may use any CPU, but a module
+ * with a thread_affinity must not share CPUs with other applications on the
+ * same host, whether they are pinned as a whole or through their modules.
+ * Every pair of applications or modules sharing CPUs is reported once.
+ *
+ * When the CPUs of a host are given, cpu_sets and thread affinities of the
+ * applications on it are also checked against them.
+ */
+std::vector<PlacementIssue>
+check_placement(const Session& session, const HostCpus& host_cpus = {});
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PLACEMENT_HPP_
@@ -0,0 +1,99 @@
+/**
+ * @file PlacementOptimizer.hpp
+ *
+ * Assignment of the DaqApplications of a Session to the hosts of its Host
+ * inventory, minimising the network traffic between hosts.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PLACEMENTOPTIMIZER_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PLACEMENTOPTIMIZER_HPP_
+
+#include "dunedaqdal/QueueAdvisor.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+class DaqApplication;
+class Session;
+
+struct PlacementOptimizerParameters
+{
+  /// Fraction of the cpus and memory_mb of each Host the applications may use
+  double max_load = 1.;
+
+  /// Hosts without cpus or memory_mb take at most this multiple of an even share of the demand
+  double imbalance = 1.1;
+
+  /// Refinement passes per level
+  unsigned int refinement_passes = 8;
+
+  /// Stop coarsening at this many vertices, 0 for 8 per host
+  size_t coarsest_size = 0;
+};
+
+struct HostAssignment
+{
+  const DaqApplication* application = nullptr;
+  std::string host; ///< proposed DaqApplication.host
+
+  bool changed() const;
+};
+
+struct PlacementPlan
+{
+  std::vector<HostAssignment> assignments; ///< in ConnectivityIndex order
+  double traffic_before = 0;               ///< bytes/s between hosts with the current DaqApplication.host
+  double traffic_after = 0;                ///< bytes/s between hosts with the proposed one
+  size_t levels = 0;                       ///< coarsening levels used
+  bool feasible = true;                    ///< every host within its cpus and memory_mb
+};
+
+/**
+ * @brief Partition the DaqApplications of the session across Session.hosts
+ *
+ * The applications form a graph weighted by their network_flows(); pairs
+ * sharing a SharedMemoryConnection get a weight above the total traffic,
+ * so they end up on the same host whenever capacity allows. An application
+ * needs the CPUs of its ProcessPlacement.cpu_set, or one per module without
+ * one, and the memory given by estimate_resources(). Where a Host gives no
+ * limit the applications are balanced instead, within the imbalance.
+ *
+ * Multilevel partitioning: heavy-edge matching coarsens the graph until
+ * about coarsest_size vertices remain, the coarsest graph is assigned
+ * greedily to the host each vertex communicates most with, and the
+ * assignment is projected back level by level and refined by moving
+ * vertices to the host with the largest traffic gain that has room. A
+ * final pass moves vertices off hosts that are still over capacity.
+ *
+ * Returns an empty plan when the session has no hosts. Pinned cpu_sets
+ * refer to the CPUs of the current host and must be revisited for the
+ * applications that move.
+ */
+PlacementPlan
+optimize_placement(const Session& session,
+                   const ConnectivityIndex& index,
+                   const RateProfile& rates = {},
+                   const PlacementOptimizerParameters& parameters = {});
+
+/**
+ * @brief Write the proposed hosts into the DaqApplication objects; the caller commits the configuration
+ *
+ * Only DaqApplication.host is written. The ports and NetworkConnection uris
+ * of the applications which move must be reassigned as well, by computing
+ * assign_ports() with the proposed hosts in PortAssignmentParameters::hosts
+ * before applying both.
+ */
+void
+apply(const PlacementPlan& plan);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PLACEMENTOPTIMIZER_HPP_
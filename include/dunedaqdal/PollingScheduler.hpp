@@ -0,0 +1,122 @@
+/**
+ * @file PollingScheduler.hpp
+ *
+ * Adaptive scheduling of connectivity service lookups: exponential backoff
+ * between a minimum and a maximum interval, per connection type.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_POLLINGSCHEDULER_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_POLLINGSCHEDULER_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace dunedaq::dal {
+
+class NetworkConnection;
+class Session;
+
+/// NetworkConnection.connection_type
+enum class ConnectionType
+{
+  send_recv,
+  pub_sub
+};
+
+/// kPubSub or kSendRecv (the default)
+ConnectionType
+to_connection_type(const std::string& value) noexcept;
+
+ConnectionType
+connection_type(const NetworkConnection& connection);
+
+struct PollingInterval
+{
+  /// Largest backoff factor taken from the configuration, the upper end of its schema range
+  static constexpr double max_backoff = 16.;
+
+  std::chrono::milliseconds min{ 50 };
+  std::chrono::milliseconds max{ 30000 };
+  double backoff = 2.;
+};
+
+struct PollingParameters
+{
+  /// Indexed by ConnectionType
+  std::array<PollingInterval, 2> intervals;
+
+  /**
+   * Session.connectivity_poll_min_ms, connectivity_poll_max_ms and
+   * connectivity_poll_backoff for all types, overridden by the
+   * Session.polling_policies of each type (the last one wins).
+   */
+  static PollingParameters from(const Session& session);
+};
+
+/**
+ * @brief Decides when to look up connections of each type
+ *
+ * After every lookup without misses the interval grows by the backoff factor
+ * up to the maximum; a lookup miss or a run control transition snaps it back
+ * to the minimum, so that peers are discovered quickly while they start and
+ * the service is hardly polled in steady state.
+ *
+ * Typical use in the lookup loop of a process:
+ *
+ *     auto now = PollingScheduler::Clock::now();
+ *     for (auto type : { ConnectionType::send_recv, ConnectionType::pub_sub }) {
+ *       if (scheduler.due(type, now)) {
+ *         scheduler.polled(type, now, resolver.refresh(type, now) > 0);
+ *       }
+ *     }
+ *     sleep_until(scheduler.next());
+ *
+ * All member functions are thread safe.
+ */
+class PollingScheduler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit PollingScheduler(const PollingParameters& parameters, Clock::time_point now = Clock::now());
+  explicit PollingScheduler(const Session& session, Clock::time_point now = Clock::now());
+
+  /// Current interval for the type
+  std::chrono::milliseconds interval(ConnectionType type) const;
+
+  /// Time of the next lookup of connections of the type
+  Clock::time_point next(ConnectionType type) const;
+
+  /// Earliest next lookup of any type
+  Clock::time_point next() const;
+
+  bool due(ConnectionType type, Clock::time_point now = Clock::now()) const { return next(type) <= now; }
+
+  /// Record a lookup done at now; misses are connections which were still unknown
+  void polled(ConnectionType type, Clock::time_point now, bool misses);
+
+  /// A run control transition started: look up everything at the minimum interval again
+  void transition(Clock::time_point now = Clock::now());
+
+private:
+  struct State
+  {
+    PollingInterval limits;
+    std::chrono::milliseconds interval;
+    Clock::time_point next;
+  };
+
+  mutable std::mutex m_mutex;
+  std::array<State, 2> m_states;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_POLLINGSCHEDULER_HPP_
@@ -0,0 +1,95 @@
+/**
+ * @file PortAllocator.hpp
+ *
+ * Conflict-free assignment of DaqApplication.port and of the ports in
+ * NetworkConnection.uri, per host.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PORTALLOCATOR_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PORTALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+class DaqApplication;
+class NetworkConnection;
+class Session;
+
+/// Sorted, non-overlapping inclusive port ranges
+using PortRanges = std::vector<std::pair<uint16_t, uint16_t>>;
+
+/// Parse a list of ports and ranges such as "5432,8000-8100"; throws dal::BadPortList
+PortRanges
+parse_port_list(const std::string& list);
+
+/// Whether the port is in one of the ranges
+bool
+contains(const PortRanges& ranges, uint16_t port) noexcept;
+
+struct PortAssignment
+{
+  /// Exactly one of application and connection is set
+  const DaqApplication* application = nullptr;
+  const NetworkConnection* connection = nullptr;
+
+  std::string host; ///< host whose port space the port belongs to
+  uint16_t old_port = 0;
+  uint16_t port = 0;
+  std::string uri; ///< rewritten NetworkConnection.uri
+
+  bool changed() const;
+};
+
+struct PortAssignmentParameters
+{
+  /// Assign every port afresh instead of keeping the valid current ones
+  bool reassign_all = false;
+
+  /// DaqApplication UID to the host to use instead of its DaqApplication.host, e.g. for a placement not applied yet
+  std::map<std::string, std::string> hosts;
+};
+
+/**
+ * @brief Assign a port to every DaqApplication and NetworkConnection of the session
+ *
+ * A NetworkConnection uses the port space of the host of the application
+ * binding it: the first consumer of a kSendRecv connection, the first
+ * publisher of a kPubSub one, or the host in its uri when it has neither.
+ * Its uri is rewritten to scheme://host:port, keeping the path; uris
+ * without a port, such as inproc:// ones, are left alone. The host of an
+ * application listed in PortAssignmentParameters::hosts is the one given
+ * there.
+ *
+ * Endpoints are sorted by host, then applications before connections and by
+ * UID. Each keeps its current port if it is set, not reserved and not taken
+ * by an earlier endpoint on the same host, so that incremental edits leave
+ * unchanged endpoints alone; the others get the lowest free port of
+ * Session.first_port..last_port in the same order. Ports of
+ * Session.reserved_ports and Host.reserved_ports are never assigned.
+ *
+ * Throws dal::PortsExhausted when a host runs out of ports and
+ * dal::BadPortList for a malformed reserved_ports.
+ *
+ * @return the assignments in endpoint order
+ */
+std::vector<PortAssignment>
+assign_ports(const Session& session, const ConnectivityIndex& index, const PortAssignmentParameters& parameters = {});
+
+/// Write the changed ports and uris into the DAL objects; the caller commits the configuration
+void
+apply(const std::vector<PortAssignment>& assignments);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PORTALLOCATOR_HPP_
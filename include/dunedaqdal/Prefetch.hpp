@@ -0,0 +1,51 @@
+/**
+ * @file Prefetch.hpp
+ *
+ * Parallel instantiation of the DAL objects reachable from a Session
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PREFETCH_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PREFETCH_HPP_
+
+#include <cstddef>
+
+namespace dunedaq::dal {
+
+class Session;
+
+/// Number of DAL objects initialised by prefetch(), per kind
+struct PrefetchStatistics
+{
+  size_t applications = 0;
+  size_t modules = 0;
+  size_t connections = 0;
+  size_t parameters = 0;
+};
+
+/**
+ * @brief Initialise all DAL objects reachable from the session using worker threads
+ *
+ * The work is split by relationship subtree: one task per
+ * Session.applications entry, one task per DaqApplication.modules entry
+ * (initialising its inputs and outputs) and one task per environment
+ * Parameter. Each object reached is initialised exactly once; the objects
+ * end up in the template object cache of the Configuration, which
+ * serialises insertions internally, so later accesses from any thread
+ * find them ready.
+ *
+ * @param session   root of the object tree
+ * @param n_threads number of worker threads, 0 for one per hardware thread
+ *
+ * Exceptions thrown while reading an object are rethrown to the caller once
+ * all workers are idle.
+ */
+PrefetchStatistics
+prefetch(const Session& session, unsigned int n_threads = 0);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PREFETCH_HPP_
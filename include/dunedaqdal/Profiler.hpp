@@ -0,0 +1,212 @@
+/**
+ * @file Profiler.hpp
+ *
+ * Optional timeline of the phases of configuring a process: file parsing,
+ * DAL object instantiation per class, environment resolution per
+ * Session/Application and connectivity lookups per NetworkConnection,
+ * exported as Chrome trace JSON for chrome://tracing or Perfetto.
+ *
+ * Like the access counters of Instrumentation.hpp, recording is compiled in
+ * when DUNEDAQDAL_PROFILING is defined (CMake option of the same name) and
+ * is switched on at run time with profiling::enable() or by setting the
+ * DUNEDAQDAL_PROFILE environment variable to the path of the trace, which
+ * is then written by flush(), or when the process exits if nothing called
+ * it; "%p" in the path is replaced by the process id, so that every process
+ * of a partition writes its own. A
+ * scope costs one relaxed atomic load while switched off, nothing when
+ * compiled out.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PROFILER_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PROFILER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dal::profiling {
+
+/// Recorded scopes beyond this many per process are counted but not kept
+constexpr size_t max_events = size_t(1) << 22;
+
+/// One completed scope
+struct TraceEvent
+{
+  const char* category = nullptr; ///< "parse", "instantiate", "resolve", "connectivity", ...
+  std::string name;
+  int64_t start_ns = 0;    ///< wall clock, nanoseconds since the epoch, so that processes line up
+  int64_t duration_ns = 0; ///< measured with the steady clock
+  uint32_t thread = 0;     ///< sequence number of the thread in the process, from 1
+};
+
+/// Total time of the scopes of a category and name
+struct ScopeSummary
+{
+  const char* category = nullptr;
+  std::string name;
+  uint64_t count = 0;
+  int64_t total_ns = 0;
+  int64_t max_ns = 0;
+};
+
+namespace detail {
+
+extern std::atomic<bool> g_enabled;
+
+int64_t
+now_ns() noexcept;
+int64_t
+steady_ns() noexcept;
+
+void
+record(const char* category, std::string name, int64_t start_ns, int64_t duration_ns);
+
+} // namespace detail
+
+inline bool
+enabled() noexcept
+{
+  return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+void
+enable(bool on = true) noexcept;
+
+/**
+ * @brief Records the time from its construction to its destruction
+ *
+ * The name may be passed as a callable returning it, which is only called
+ * when profiling is switched on, so that building it costs nothing
+ * otherwise.
+ */
+class Scope
+{
+public:
+  Scope(const char* category, std::string_view name)
+  {
+    if (enabled()) {
+      start(category, std::string(name));
+    }
+  }
+
+  template<class F, class = std::enable_if_t<std::is_invocable_v<F>>>
+  Scope(const char* category, F&& name)
+  {
+    if (enabled()) {
+      start(category, std::string(std::forward<F>(name)()));
+    }
+  }
+
+  ~Scope()
+  {
+    if (m_category != nullptr) {
+      detail::record(m_category, std::move(m_name), m_wall_ns, detail::steady_ns() - m_steady_ns);
+    }
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  void start(const char* category, std::string name)
+  {
+    m_category = category;
+    m_name = std::move(name);
+    m_wall_ns = detail::now_ns();
+    m_steady_ns = detail::steady_ns();
+  }
+
+  const char* m_category = nullptr; ///< nullptr when not recording
+  std::string m_name;
+  int64_t m_wall_ns = 0;
+  int64_t m_steady_ns = 0;
+};
+
+/// Name of the process in the trace, e.g. the UID of its application; the executable name by default
+void
+set_process_name(std::string name);
+
+/// Scopes completed so far by all threads, past and present, in order of start
+std::vector<TraceEvent>
+collect();
+
+/// Number of scopes not kept because max_events was reached
+uint64_t
+dropped();
+
+/// Forget all recorded scopes
+void
+reset();
+
+/// Scopes of collect() grouped by category and name, longest total first
+std::vector<ScopeSummary>
+summarize();
+
+/// Table of summarize()
+void
+dump(std::ostream& out);
+
+/// Chrome trace event JSON of collect(), one complete event per scope
+void
+write_trace(std::ostream& out);
+
+/// write_trace() to a file; throws dal::BadTraceExport
+void
+write_trace(const std::string& path);
+
+/**
+ * @brief write_trace() to the path of DUNEDAQDAL_PROFILE, if it is set; throws dal::BadTraceExport
+ *
+ * Without it the trace is written at exit, during static destruction, where
+ * a failure can only be reported on std::cerr. Once flush() was called,
+ * successfully or not, the exit fallback does nothing, so the scopes
+ * recorded later are only written by another flush().
+ */
+void
+flush();
+
+/// Calls flush() on destruction and reports a failure with ers::error; meant to be the first object of main()
+class FlushOnExit
+{
+public:
+  FlushOnExit() = default;
+  ~FlushOnExit();
+
+  FlushOnExit(const FlushOnExit&) = delete;
+  FlushOnExit& operator=(const FlushOnExit&) = delete;
+};
+
+} // namespace dunedaq::dal::profiling
+
+#define DUNEDAQDAL_PROFILE_CONCAT2_(a, b) a##b
+#define DUNEDAQDAL_PROFILE_CONCAT_(a, b) DUNEDAQDAL_PROFILE_CONCAT2_(a, b)
+
+#ifdef DUNEDAQDAL_PROFILING
+
+/**
+ * Record the rest of the enclosing block as a scope of the category. The
+ * name expression is only evaluated when profiling is switched on.
+ */
+#define DUNEDAQDAL_PROFILE_SCOPE(category, name)                                                                      \
+  const ::dunedaq::dal::profiling::Scope DUNEDAQDAL_PROFILE_CONCAT_(dunedaqdal_scope_, __LINE__)(                      \
+    (category), [&]() -> std::string { return (name); })
+
+#else
+
+#define DUNEDAQDAL_PROFILE_SCOPE(category, name)                                                                      \
+  do {                                                                                                                 \
+  } while (0)
+
+#endif
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_PROFILER_HPP_
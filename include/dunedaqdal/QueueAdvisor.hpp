@@ -0,0 +1,87 @@
+/**
+ * @file QueueAdvisor.hpp
+ *
+ * Queue capacity and type recommendations derived from the connectivity
+ * graph and, optionally, from measured message rates.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_QUEUEADVISOR_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_QUEUEADVISOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+class Queue;
+
+/// Measured message rate in Hz per Queue UID
+using RateProfile = std::unordered_map<std::string, double>;
+
+/**
+ * @brief Read a rate profile
+ *
+ * One "<queue UID> <rate in Hz>" pair per line; empty lines and lines
+ * starting with '#' are ignored. Negative, infinite and NaN rates are
+ * rejected. Throws dal::BadRateProfile.
+ */
+RateProfile
+read_rate_profile(const std::string& path);
+
+struct QueueAdvisorParameters
+{
+  /// Time the queue must be able to buffer at the measured rate
+  double buffer_time_ms = 10.;
+
+  /// Smallest recommended capacity: one 64-byte cache line of 8-byte slots
+  uint32_t min_capacity = 8;
+};
+
+struct QueueAdvice
+{
+  const Queue* queue = nullptr;
+  size_t producers = 0;
+  size_t consumers = 0;
+  double rate_hz = 0.; ///< 0 when not in the profile
+
+  uint32_t capacity = 0;  ///< recommended Queue.capacity
+  std::string queue_type; ///< recommended Queue.queue_type
+
+  /// The current queue type does not support this many producers or consumers
+  bool unsafe_type = false;
+
+  /// Whether the recommendation differs from the current configuration
+  bool changed() const;
+};
+
+/**
+ * @brief Recommend capacity and type for every Queue of the index
+ *
+ * The queue type follows the fan-in and fan-out: kFollySPSCQueue for one
+ * producer and one consumer, kLockFreeMPSCRing for several producers and one
+ * consumer, kFollyMPMCQueue otherwise. The capacity is a power of two, at
+ * least QueueAdvisorParameters::min_capacity; with a rate it is sized to
+ * buffer QueueAdvisorParameters::buffer_time_ms worth of messages, without
+ * one the current capacity is only rounded up. Capacities are capped at
+ * 2^31; a negative or NaN rate counts as zero.
+ */
+std::vector<QueueAdvice>
+advise_queues(const ConnectivityIndex& index,
+              const RateProfile& rates = {},
+              const QueueAdvisorParameters& parameters = {});
+
+/// Write the recommendations into the Queue objects; the caller commits the configuration
+void
+apply(const std::vector<QueueAdvice>& advice);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_QUEUEADVISOR_HPP_
@@ -0,0 +1,72 @@
+/**
+ * @file QueueSettings.hpp
+ *
+ * Typed view on the Queue attributes used to build an in-process queue
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_QUEUESETTINGS_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_QUEUESETTINGS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq::dal {
+
+class Queue;
+
+/// Queue.queue_type
+enum class QueueType
+{
+  unknown,
+  std_deque,
+  folly_spsc,
+  folly_mpmc,
+  mpsc_ring
+};
+
+/// Queue.wait_strategy
+enum class WaitStrategy
+{
+  busy_spin,
+  yield,
+  futex
+};
+
+/// Enum values as spelled in the schema; unrecognised strings map to unknown and futex respectively
+QueueType
+to_queue_type(const std::string& value) noexcept;
+WaitStrategy
+to_wait_strategy(const std::string& value) noexcept;
+
+const std::string&
+to_string(QueueType type) noexcept;
+const std::string&
+to_string(WaitStrategy strategy) noexcept;
+
+/// Whether a queue of that type may be shared by the given number of producers and consumers
+bool
+supports(QueueType type, size_t producers, size_t consumers) noexcept;
+
+/// All the parameters needed to construct the queue of one Queue object
+struct QueueSettings
+{
+  QueueType type = QueueType::unknown;
+  uint32_t capacity = 0;
+  uint16_t push_batch_size = 1;
+  uint16_t pop_batch_size = 1;
+  bool cache_line_padding = false;
+  int16_t numa_node = -1; ///< -1: default memory policy
+  WaitStrategy wait_strategy = WaitStrategy::futex;
+};
+
+QueueSettings
+get_queue_settings(const Queue& queue);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_QUEUESETTINGS_HPP_
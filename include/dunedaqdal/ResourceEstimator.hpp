@@ -0,0 +1,121 @@
+/**
+ * @file ResourceEstimator.hpp
+ *
+ * Estimate of the memory and network bandwidth used by the applications of
+ * a Session on each host, from the DataTypeProfile and Host objects of the
+ * session.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_RESOURCEESTIMATOR_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_RESOURCEESTIMATOR_HPP_
+
+#include "dunedaqdal/QueueAdvisor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+class DaqApplication;
+class Host;
+class Session;
+
+struct DataTypeRate
+{
+  uint64_t payload_size = 0; ///< bytes per message
+  double rate_hz = 0;        ///< messages per second through one connection
+};
+
+/// DataTypeProfile of each Connection.data_type
+using DataTypeRegistry = std::unordered_map<std::string, DataTypeRate>;
+
+/// Session.data_type_profiles by data type; the first profile of a data type wins
+DataTypeRegistry
+data_type_registry(const Session& session);
+
+/// Traffic of one NetworkConnection from a producing to a consuming application
+struct NetworkFlow
+{
+  uint32_t from = 0; ///< ConnectivityIndex application index
+  uint32_t to = 0;
+  double bytes_per_s = 0;
+};
+
+/**
+ * @brief Traffic between the applications of the index over its NetworkConnections
+ *
+ * A NetworkConnection carries rate_hz x payload_size bytes/s, shared by its
+ * producers; every subscriber of a kPubSub connection receives all of it
+ * while kSendRecv receivers share it. Rates in the profile, keyed by
+ * connection UID, override those of the DataTypeProfile. Flows within an
+ * application and connections without traffic are left out.
+ */
+std::vector<NetworkFlow>
+network_flows(const Session& session, const ConnectivityIndex& index, const RateProfile& rates = {});
+
+struct ResourceUsage
+{
+  double queue_memory = 0; ///< bytes of Queue buffers and shared memory segments
+  double hugepages = 0;    ///< bytes of huge pages reserved by ProcessPlacement
+  double network_in = 0;   ///< bytes/s received from other hosts
+  double network_out = 0;  ///< bytes/s sent to other hosts
+  size_t modules = 0;
+  size_t applications = 0;
+
+  double memory() const noexcept { return queue_memory + hugepages; }
+
+  ResourceUsage& operator+=(const ResourceUsage& other) noexcept;
+};
+
+struct ApplicationResources
+{
+  const DaqApplication* application = nullptr;
+  ResourceUsage usage;
+};
+
+struct HostResources
+{
+  std::string host;
+  const Host* limits = nullptr; ///< nullptr when the session has no Host for it
+  ResourceUsage usage;
+
+  bool memory_oversubscribed = false;
+  bool network_oversubscribed = false; ///< in either direction
+
+  bool oversubscribed() const noexcept { return memory_oversubscribed || network_oversubscribed; }
+};
+
+struct ResourceEstimate
+{
+  std::vector<ApplicationResources> applications; ///< in ConnectivityIndex order
+  std::vector<HostResources> hosts;               ///< sorted by host name
+  std::vector<std::string> unknown_data_types;    ///< data types without DataTypeProfile, sorted
+};
+
+/**
+ * @brief Estimate the resources of every DaqApplication and host of the session
+ *
+ * One pass over the connections of the index:
+ * - a Queue uses capacity x payload_size bytes and a SharedMemoryConnection
+ *   its segment_size, both in the application of the first consumer, or of
+ *   the first producer if it has none;
+ * - the network_flows() between applications on different hosts count as
+ *   network traffic.
+ *
+ * Hosts are oversubscribed when their Host gives a limit and the estimate
+ * exceeds it.
+ */
+ResourceEstimate
+estimate_resources(const Session& session, const ConnectivityIndex& index, const RateProfile& rates = {});
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_RESOURCEESTIMATOR_HPP_
@@ -0,0 +1,348 @@
+/**
+ * @file SessionTables.hpp
+ *
+ * Structure-of-arrays tables of the concrete classes of a Session, with
+ * relationships as row numbers, for scans and bulk export.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SESSIONTABLES_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SESSIONTABLES_HPP_
+
+#include "dunedaqdal/StringPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+class Session;
+
+namespace columns {
+
+constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+/// Dictionary-encoded strings: row i holds dictionary[codes[i]]
+class StringColumn
+{
+public:
+  std::vector<uint32_t> codes;
+  std::vector<std::string_view> dictionary; ///< distinct values in order of first use
+
+  size_t size() const noexcept { return codes.size(); }
+  std::string_view operator[](size_t row) const noexcept { return dictionary[codes[row]]; }
+
+  /// Append a row; the value must outlive the column
+  void push_back(std::string_view value);
+
+private:
+  std::unordered_map<std::string_view, uint32_t> m_codes;
+};
+
+/// Row numbers in another table, npos for none
+struct IndexColumn
+{
+  std::vector<uint32_t> rows;
+
+  size_t size() const noexcept { return rows.size(); }
+  uint32_t operator[](size_t row) const noexcept { return rows[row]; }
+};
+
+/// Lists of row numbers in another table, in compressed sparse row form
+struct IndexListColumn
+{
+  /// Rows of one list
+  class Range
+  {
+  public:
+    Range(const uint32_t* begin, const uint32_t* end) noexcept
+      : m_begin(begin)
+      , m_end(end)
+    {
+    }
+
+    const uint32_t* begin() const noexcept { return m_begin; }
+    const uint32_t* end() const noexcept { return m_end; }
+    size_t size() const noexcept { return m_end - m_begin; }
+    bool empty() const noexcept { return m_begin == m_end; }
+    uint32_t operator[](size_t i) const noexcept { return m_begin[i]; }
+
+  private:
+    const uint32_t* m_begin;
+    const uint32_t* m_end;
+  };
+
+  std::vector<uint32_t> offsets{ 0 }; ///< list i is rows[offsets[i]] .. rows[offsets[i + 1]]
+  std::vector<uint32_t> rows;
+
+  size_t size() const noexcept { return offsets.size() - 1; }
+  Range operator[](size_t row) const noexcept
+  {
+    return Range(rows.data() + offsets[row], rows.data() + offsets[row + 1]);
+  }
+
+  /// Close the list of the next row, made of the rows appended since the previous one
+  void end_row() { offsets.push_back(rows.size()); }
+};
+
+} // namespace columns
+
+/// Every DaqApplication of the session, in ConnectivityIndex order
+struct ApplicationTable
+{
+  columns::StringColumn uid;
+  columns::StringColumn host;
+  std::vector<uint16_t> port;
+  columns::IndexListColumn modules;   ///< ModuleTable rows
+  columns::IndexListColumn variables; ///< VariableTable rows of ApplicationEnvironment, VariableSets expanded
+
+  size_t size() const noexcept { return uid.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("uid", uid);
+    f("host", host);
+    f("port", port);
+    f("modules", modules);
+    f("variables", variables);
+  }
+};
+
+/// Every DaqModule of the session, in ConnectivityIndex order
+struct ModuleTable
+{
+  columns::StringColumn uid;
+  columns::StringColumn plugin;
+  columns::IndexColumn application; ///< ApplicationTable row
+  columns::IndexListColumn inputs;  ///< ConnectionTable rows
+  columns::IndexListColumn outputs; ///< ConnectionTable rows
+
+  size_t size() const noexcept { return uid.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("uid", uid);
+    f("plugin", plugin);
+    f("application", application);
+    f("inputs", inputs);
+    f("outputs", outputs);
+  }
+};
+
+/// Every Connection used by a module, in ConnectivityIndex order; the concrete tables refer to these rows
+struct ConnectionTable
+{
+  columns::StringColumn uid;
+  columns::StringColumn class_name;
+  columns::StringColumn data_type;
+  columns::IndexListColumn producers; ///< ModuleTable rows
+  columns::IndexListColumn consumers; ///< ModuleTable rows
+
+  size_t size() const noexcept { return uid.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("uid", uid);
+    f("class_name", class_name);
+    f("data_type", data_type);
+    f("producers", producers);
+    f("consumers", consumers);
+  }
+};
+
+struct QueueTable
+{
+  columns::IndexColumn connection; ///< ConnectionTable row
+  std::vector<uint32_t> capacity;
+  columns::StringColumn queue_type;
+  std::vector<uint16_t> push_batch_size;
+  std::vector<uint16_t> pop_batch_size;
+  std::vector<uint8_t> cache_line_padding;
+  std::vector<int16_t> numa_node;
+  columns::StringColumn wait_strategy;
+
+  size_t size() const noexcept { return connection.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("connection", connection);
+    f("capacity", capacity);
+    f("queue_type", queue_type);
+    f("push_batch_size", push_batch_size);
+    f("pop_batch_size", pop_batch_size);
+    f("cache_line_padding", cache_line_padding);
+    f("numa_node", numa_node);
+    f("wait_strategy", wait_strategy);
+  }
+};
+
+struct NetworkConnectionTable
+{
+  columns::IndexColumn connection; ///< ConnectionTable row
+  columns::StringColumn connection_type;
+  columns::StringColumn uri;
+
+  size_t size() const noexcept { return connection.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("connection", connection);
+    f("connection_type", connection_type);
+    f("uri", uri);
+  }
+};
+
+struct SharedMemoryConnectionTable
+{
+  columns::IndexColumn connection; ///< ConnectionTable row
+  columns::StringColumn segment_name;
+  std::vector<uint64_t> segment_size;
+  std::vector<uint32_t> slot_count;
+  columns::StringColumn consumer_mode;
+
+  size_t size() const noexcept { return connection.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("connection", connection);
+    f("segment_name", segment_name);
+    f("segment_size", segment_size);
+    f("slot_count", slot_count);
+    f("consumer_mode", consumer_mode);
+  }
+};
+
+/// Variables of Session.ProcessEnvironment and of the applications' ApplicationEnvironment, each once
+struct VariableTable
+{
+  columns::StringColumn uid;
+  columns::StringColumn name;
+  columns::StringColumn value;
+  std::vector<uint8_t> session; ///< 1 for the variables of Session.ProcessEnvironment
+
+  size_t size() const noexcept { return uid.size(); }
+
+  template<class F>
+  void for_each_column(F&& f) const
+  {
+    f("uid", uid);
+    f("name", name);
+    f("value", value);
+    f("session", session);
+  }
+};
+
+/**
+ * @brief Columnar copy of a Session
+ *
+ * One table per concrete class, each column a contiguous array; strings are
+ * dictionary encoded and relationships are row numbers, so scans such as
+ * summing QueueTable::capacity or grouping applications by host code run
+ * over plain arrays. The tables do not refer to the DAL objects and stay
+ * valid after the configuration is unloaded.
+ */
+struct SessionTables
+{
+  ApplicationTable applications;
+  ModuleTable modules;
+  ConnectionTable connections;
+  QueueTable queues;
+  NetworkConnectionTable network_connections;
+  SharedMemoryConnectionTable shared_memory_connections;
+  VariableTable variables;
+
+  std::unique_ptr<StringPool> strings; ///< storage of the dictionaries
+
+  /// Call f(name, table) for every table
+  template<class F>
+  void for_each_table(F&& f) const
+  {
+    f("applications", applications);
+    f("modules", modules);
+    f("connections", connections);
+    f("queues", queues);
+    f("network_connections", network_connections);
+    f("shared_memory_connections", shared_memory_connections);
+    f("variables", variables);
+  }
+};
+
+/// Build the tables in the order of the connectivity index of the session
+SessionTables
+make_tables(const Session& session, const ConnectivityIndex& index);
+
+/**
+ * @brief Write a table as CSV with a header line
+ *
+ * Index columns leave npos empty, lists are written as space-separated row
+ * numbers, and strings are quoted when needed.
+ */
+template<class Table>
+void
+write_csv(std::ostream& out, const Table& table);
+
+/// One <table>.csv per table in the directory, which must exist; throws dal::BadTableExport
+void
+write_csv(const SessionTables& tables, const std::string& directory);
+
+namespace columns {
+
+void
+write_cell(std::ostream& out, const StringColumn& column, size_t row);
+void
+write_cell(std::ostream& out, const IndexColumn& column, size_t row);
+void
+write_cell(std::ostream& out, const IndexListColumn& column, size_t row);
+
+template<class T>
+void
+write_cell(std::ostream& out, const std::vector<T>& column, size_t row)
+{
+  // widen the 8 and 16 bit types, which would otherwise print as characters
+  out << +column[row];
+}
+
+} // namespace columns
+
+template<class Table>
+void
+write_csv(std::ostream& out, const Table& table)
+{
+  const char* separator = "";
+  table.for_each_column([&](const char* name, const auto&) {
+    out << separator << name;
+    separator = ",";
+  });
+  out << '\n';
+
+  for (size_t row = 0; row < table.size(); ++row) {
+    separator = "";
+    table.for_each_column([&](const char*, const auto& column) {
+      out << separator;
+      columns::write_cell(out, column, row);
+      separator = ",";
+    });
+    out << '\n';
+  }
+}
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SESSIONTABLES_HPP_
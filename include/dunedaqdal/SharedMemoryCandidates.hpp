@@ -0,0 +1,49 @@
+/**
+ * @file SharedMemoryCandidates.hpp
+ *
+ * Detection of NetworkConnections which never leave a host and could be
+ * replaced by a SharedMemoryConnection.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SHAREDMEMORYCANDIDATES_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SHAREDMEMORYCANDIDATES_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class ConnectivityIndex;
+class NetworkConnection;
+
+struct SharedMemoryCandidate
+{
+  const NetworkConnection* connection = nullptr;
+  std::string host;
+  size_t producers = 0;
+  size_t consumers = 0;
+
+  /// Producers and consumers all belong to one application, so a Queue would do
+  bool same_application = false;
+
+  /// SharedMemoryConnection.consumer_mode matching the connection_type: kMultiConsumer for kPubSub
+  std::string consumer_mode;
+};
+
+/**
+ * @brief NetworkConnections whose producer and consumer applications all run on one host
+ *
+ * Connections missing either producers or consumers in the session are not
+ * reported, since their other end is unknown.
+ */
+std::vector<SharedMemoryCandidate>
+find_shared_memory_candidates(const ConnectivityIndex& index);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SHAREDMEMORYCANDIDATES_HPP_
@@ -0,0 +1,276 @@
+/**
+ * @file Snapshot.hpp
+ *
+ * Position-independent binary snapshot of a resolved Session, designed to be
+ * memory-mapped read-only and queried without parsing or heap allocation.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SNAPSHOT_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SNAPSHOT_HPP_
+
+#include "dunedaqdal/ConfigHash.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class EnvironmentResolver;
+class Session;
+
+namespace snapshot {
+
+/**
+ * Layout
+ *
+ * The blob starts with a Header followed by sections of fixed-size records.
+ * All references are 32-bit offsets or indices relative to the start of the
+ * blob or of a section, so the blob can be mapped at any address and shared
+ * between processes. Strings are stored once in the string table and are
+ * NUL terminated. Variable length lists (modules of an application, inputs
+ * of a module, ...) are Spans into the shared index section. The *_by_uid
+ * sections hold record indices sorted by UID for binary search. The header
+ * and the application records carry the ConfigHasher hashes of the session
+ * and of each application when they were given to make(), so that a client
+ * can tell whether its application changed without comparing records.
+ *
+ * The format is host-native; readers reject blobs written with another byte
+ * order or format version.
+ */
+
+constexpr char magic[8] = { 'D', 'D', 'A', 'L', 'S', 'N', 'A', 'P' };
+constexpr uint32_t format_version = 4;
+constexpr uint32_t byte_order_mark = 0x01020304;
+constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+struct StringRef
+{
+  uint32_t offset; ///< into the string section
+  uint32_t size;
+};
+
+struct Span
+{
+  uint32_t begin; ///< into the index section
+  uint32_t count;
+};
+
+enum Section : uint32_t
+{
+  strings,
+  indices,
+  applications,
+  modules,
+  connections,
+  environment,
+  applications_by_uid,
+  modules_by_uid,
+  connections_by_uid,
+  num_sections
+};
+
+struct SectionRef
+{
+  uint64_t offset; ///< from the start of the blob, 8-byte aligned
+  uint64_t count;  ///< number of records (bytes for the string section)
+};
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t size; ///< of the whole blob
+  StringRef session;
+  uint32_t use_connectivity_server;
+  uint32_t connectivity_service_interval_ms;
+  ConfigHash hash; ///< of the session, empty if not computed
+  SectionRef sections[num_sections];
+};
+
+enum class ApplicationKind : uint32_t
+{
+  other,
+  daq,
+  run_control
+};
+
+struct ApplicationRecord
+{
+  StringRef uid;
+  StringRef class_name;
+  ApplicationKind kind;
+  StringRef host;    ///< DaqApplication only
+  uint32_t port;     ///< DaqApplication only
+  uint32_t timeout;  ///< RCApplication only
+  Span modules;      ///< module indices
+  Span controlled;   ///< application indices, RCApplication only
+  uint32_t env_begin; ///< into the environment section
+  uint32_t env_count;
+  ConfigHash hash;    ///< of the application, empty if not computed
+};
+
+struct ModuleRecord
+{
+  StringRef uid;
+  StringRef plugin;
+  uint32_t application;
+  Span inputs;  ///< connection indices
+  Span outputs; ///< connection indices
+};
+
+enum class ConnectionKind : uint32_t
+{
+  other,
+  queue,
+  network,
+  shared_memory
+};
+
+struct ConnectionRecord
+{
+  StringRef uid;
+  StringRef class_name;
+  ConnectionKind kind;
+  StringRef data_type;
+  uint32_t capacity;             ///< Queue only
+  StringRef queue_type;          ///< Queue only
+  uint32_t push_batch_size;      ///< Queue only
+  uint32_t pop_batch_size;       ///< Queue only
+  uint32_t cache_line_padding;   ///< Queue only
+  int32_t numa_node;             ///< Queue only
+  StringRef wait_strategy;       ///< Queue only
+  StringRef connection_type;     ///< NetworkConnection only
+  StringRef uri;                 ///< NetworkConnection only
+  StringRef segment_name;        ///< SharedMemoryConnection only
+  uint64_t segment_size;         ///< SharedMemoryConnection only
+  uint32_t slot_count;           ///< SharedMemoryConnection only
+  StringRef consumer_mode;       ///< SharedMemoryConnection only
+  Span producers;                ///< module indices
+  Span consumers;                ///< module indices
+};
+
+struct EnvironmentRecord
+{
+  StringRef name;
+  StringRef value;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "snapshot header must keep sections aligned");
+
+/// Serialise the session, including the flattened environment of every application and, if given, the hashes
+std::vector<char>
+make(const Session& session, EnvironmentResolver& resolver, const ConfigHasher* hashes = nullptr);
+
+/// make() and write the result to path; the file is replaced atomically so mapped readers are unaffected
+void
+write(const Session& session,
+      EnvironmentResolver& resolver,
+      const std::string& path,
+      const ConfigHasher* hashes = nullptr);
+
+/**
+ * @brief Read-only view on a snapshot blob
+ *
+ * All accessors return references or string views into the mapped memory
+ * and never allocate. Opening a snapshot checks the section bounds and every
+ * stored record index, so a corrupt file throws dal::BadSnapshot rather than
+ * leading the accessors out of bounds.
+ */
+class Reader
+{
+public:
+  /// Contiguous indices taken from the index section
+  class IndexRange
+  {
+  public:
+    IndexRange(const uint32_t* begin, const uint32_t* end) noexcept
+      : m_begin(begin)
+      , m_end(end)
+    {
+    }
+
+    const uint32_t* begin() const noexcept { return m_begin; }
+    const uint32_t* end() const noexcept { return m_end; }
+    size_t size() const noexcept { return m_end - m_begin; }
+    bool empty() const noexcept { return m_begin == m_end; }
+    uint32_t operator[](size_t i) const noexcept { return m_begin[i]; }
+
+  private:
+    const uint32_t* m_begin;
+    const uint32_t* m_end;
+  };
+
+  /// Map the file read-only; throws dal::BadSnapshot
+  explicit Reader(const std::string& path);
+
+  /// View on a blob owned by the caller; throws dal::BadSnapshot
+  Reader(const void* data, size_t size);
+
+  ~Reader();
+
+  Reader(Reader&& other) noexcept;
+  Reader& operator=(Reader&& other) noexcept;
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  const Header& header() const noexcept { return *m_header; }
+  std::string_view session() const noexcept { return string(m_header->session); }
+
+  size_t num_applications() const noexcept { return m_header->sections[Section::applications].count; }
+  size_t num_modules() const noexcept { return m_header->sections[Section::modules].count; }
+  size_t num_connections() const noexcept { return m_header->sections[Section::connections].count; }
+
+  const ApplicationRecord& application(uint32_t idx) const noexcept { return m_applications[idx]; }
+  const ModuleRecord& module(uint32_t idx) const noexcept { return m_modules[idx]; }
+  const ConnectionRecord& connection(uint32_t idx) const noexcept { return m_connections[idx]; }
+
+  /// Index of the record with given UID, or npos
+  uint32_t find_application(std::string_view uid) const noexcept;
+  uint32_t find_module(std::string_view uid) const noexcept;
+  uint32_t find_connection(std::string_view uid) const noexcept;
+
+  /// The string, or an empty view if the reference is out of bounds
+  std::string_view string(const StringRef& ref) const noexcept;
+
+  /// The indices, or an empty range if the span is out of bounds
+  IndexRange indices(const Span& span) const noexcept;
+
+  /// Environment entries of the application
+  const EnvironmentRecord* environment_begin(const ApplicationRecord& app) const noexcept;
+  const EnvironmentRecord* environment_end(const ApplicationRecord& app) const noexcept;
+
+  /// Value of an environment variable of the application; sets found to false if undefined
+  std::string_view getenv(const ApplicationRecord& app, std::string_view name, bool* found = nullptr) const noexcept;
+
+private:
+  void attach(const void* data, size_t size, const std::string& name);
+
+  template<class R>
+  uint32_t find(Section by_uid, const R* records, std::string_view uid) const noexcept;
+
+  void* m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+
+  const Header* m_header = nullptr;
+  const char* m_strings = nullptr;
+  const uint32_t* m_indices = nullptr;
+  const ApplicationRecord* m_applications = nullptr;
+  const ModuleRecord* m_modules = nullptr;
+  const ConnectionRecord* m_connections = nullptr;
+  const EnvironmentRecord* m_environment = nullptr;
+};
+
+} // namespace snapshot
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_SNAPSHOT_HPP_
@@ -0,0 +1,247 @@
+/**
+ * @file StreamingLoader.hpp
+ *
+ * Single-pass reader of OKS data files which keeps only the objects, not
+ * the document, in memory.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_STREAMINGLOADER_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_STREAMINGLOADER_HPP_
+
+#include "dunedaqdal/StringPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::dal {
+
+/// Contiguous run of records in one of the arrays of a StreamingLoader
+template<class T>
+class StreamedRange
+{
+public:
+  StreamedRange(const T* begin, const T* end) noexcept
+    : m_begin(begin)
+    , m_end(end)
+  {
+  }
+
+  const T* begin() const noexcept { return m_begin; }
+  const T* end() const noexcept { return m_end; }
+  size_t size() const noexcept { return m_end - m_begin; }
+  bool empty() const noexcept { return m_begin == m_end; }
+  const T& operator[](size_t i) const noexcept { return m_begin[i]; }
+
+private:
+  const T* m_begin;
+  const T* m_end;
+};
+
+/// Position of a run of records in one of the arrays of a StreamingLoader
+struct StreamedSpan
+{
+  uint32_t begin = 0;
+  uint32_t count = 0;
+};
+
+struct StreamedAttribute
+{
+  std::string_view name;
+  std::string_view type; ///< OKS type as written in the file, e.g. u32 or string
+  StreamedSpan values;   ///< one for single-value attributes
+};
+
+struct StreamedRelationship
+{
+  std::string_view name;
+  StreamedSpan targets; ///< object indices; StreamingLoader::npos while or if unresolved
+};
+
+/// One OKS object; all strings are views into the string pool of the loader
+struct StreamedObject
+{
+  std::string_view class_name;
+  std::string_view uid;
+  StreamedSpan attributes;
+  StreamedSpan relationships;
+};
+
+struct UnresolvedReference
+{
+  uint32_t object = 0; ///< index of the referencing object
+  std::string_view relationship;
+  std::string_view class_name; ///< of the missing object
+  std::string_view uid;
+};
+
+struct StreamingLoaderParameters
+{
+  /// Keep only the objects of these classes (exact names, no subclasses); all when empty
+  std::vector<std::string> classes;
+
+  /// Load the data files named by <include>; schema files are always skipped
+  bool follow_includes = true;
+
+  /// Bytes read from the file at a time
+  size_t chunk_size = 1 << 20;
+};
+
+/**
+ * @brief Build the objects of OKS data files while parsing them
+ *
+ * The file is read in chunks and tokenised in place, so the memory used
+ * beyond the objects themselves is one chunk plus the largest tag. Objects
+ * are read one after the other, so their attributes, values, relationships
+ * and targets are appended to one array each and an object only holds the
+ * spans of its records. Strings are interned, which also shares the class
+ * and attribute names and the repeated values such as DaqModule.plugin or
+ * Connection.data_type.
+ *
+ * References are resolved as they are read when the target is already
+ * known. References to objects further down, or in a later included file,
+ * are kept in a fix-up table keyed by class and UID and patched when the
+ * target is defined, so the table only ever holds the references which are
+ * still outstanding. Whatever is left at the end of load() is reported by
+ * unresolved(); references to classes filtered out are left at npos
+ * without being reported.
+ *
+ * The format is the one written by oksdbinterfaces: <obj class id>
+ * elements holding <attr name type val> or <attr><data val/></attr>, and
+ * <rel name class id> or <rel><ref class id/></rel>. Throws
+ * dal::BadDataFile on malformed input.
+ */
+class StreamingLoader
+{
+public:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  /// Called when the closing tag of an object was read; its forward references may still be unresolved
+  using Callback = std::function<void(uint32_t object)>;
+
+  explicit StreamingLoader(StreamingLoaderParameters parameters = {});
+
+  StreamingLoader(const StreamingLoader&) = delete;
+  StreamingLoader& operator=(const StreamingLoader&) = delete;
+
+  void on_object(Callback callback) { m_callback = std::move(callback); }
+
+  /// Load the file and, with follow_includes, the data files it includes; files already loaded are skipped
+  void load(const std::string& path);
+
+  size_t size() const noexcept { return m_objects.size(); }
+
+  /// The object; references are invalidated by load()
+  const StreamedObject& object(uint32_t idx) const noexcept { return m_objects[idx]; }
+  const std::vector<StreamedObject>& objects() const noexcept { return m_objects; }
+
+  /// Index of the object, or npos
+  uint32_t find(std::string_view class_name, std::string_view uid) const noexcept;
+
+  StreamedRange<StreamedAttribute> attributes(const StreamedObject& obj) const noexcept
+  {
+    return range(m_attributes, obj.attributes);
+  }
+  StreamedRange<StreamedRelationship> relationships(const StreamedObject& obj) const noexcept
+  {
+    return range(m_relationships, obj.relationships);
+  }
+  StreamedRange<std::string_view> values(const StreamedAttribute& attr) const noexcept
+  {
+    return range(m_values, attr.values);
+  }
+  StreamedRange<uint32_t> targets(const StreamedRelationship& rel) const noexcept
+  {
+    return range(m_targets, rel.targets);
+  }
+
+  /// First value of the attribute, or an empty view
+  std::string_view attribute(const StreamedObject& obj, std::string_view name) const noexcept;
+
+  /// Targets of the relationship, empty if the object has none of that name
+  StreamedRange<uint32_t> relationship(const StreamedObject& obj, std::string_view name) const noexcept;
+
+  /// References whose target was not found by the end of the last load()
+  const std::vector<UnresolvedReference>& unresolved() const noexcept { return m_unresolved; }
+
+  /// Files loaded so far, in order
+  const std::vector<std::string>& files() const noexcept { return m_files; }
+
+  const StringPool& strings() const noexcept { return m_strings; }
+
+private:
+  struct Key
+  {
+    std::string_view class_name;
+    std::string_view uid;
+
+    bool operator==(const Key& other) const noexcept
+    {
+      return class_name == other.class_name && uid == other.uid;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& k) const noexcept
+    {
+      return std::hash<std::string_view>()(k.class_name) * 31 + std::hash<std::string_view>()(k.uid);
+    }
+  };
+
+  /// Position of an outstanding reference
+  struct FixUp
+  {
+    uint32_t object;
+    uint32_t relationship; ///< into m_relationships
+    uint32_t target;       ///< into m_targets
+  };
+
+  template<class T>
+  static StreamedRange<T> range(const std::vector<T>& records, const StreamedSpan& span) noexcept
+  {
+    return StreamedRange<T>(records.data() + span.begin, records.data() + span.begin + span.count);
+  }
+
+  class Parser;
+  friend class Parser;
+
+  bool wanted(std::string_view class_name) const noexcept;
+  void begin_object(std::string_view class_name, std::string_view uid);
+  void add_attribute(std::string_view name, std::string_view type);
+  void add_value(std::string_view value);
+  void add_relationship(std::string_view name);
+  void add_reference(std::string_view class_name, std::string_view uid);
+  void end_object();
+
+  const StreamingLoaderParameters m_parameters;
+  std::set<std::string, std::less<>> m_classes;
+  Callback m_callback;
+
+  StringPool m_strings;
+  std::vector<StreamedObject> m_objects;
+  std::vector<StreamedAttribute> m_attributes;
+  std::vector<std::string_view> m_values;
+  std::vector<StreamedRelationship> m_relationships;
+  std::vector<uint32_t> m_targets;
+  std::unordered_map<Key, uint32_t, KeyHash> m_index;
+  std::unordered_map<Key, std::vector<FixUp>, KeyHash> m_fix_ups;
+  std::vector<UnresolvedReference> m_unresolved;
+  std::vector<std::string> m_files;
+
+  uint32_t m_current = npos; ///< object being read, npos outside <obj> or for skipped classes
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_STREAMINGLOADER_HPP_
@@ -0,0 +1,87 @@
+/**
+ * @file StringPool.hpp
+ *
+ * Arena-allocated string interning for attribute values
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_STRINGPOOL_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_STRINGPOOL_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Connection;
+class DaqApplication;
+class DaqModule;
+class NetworkConnection;
+class Variable;
+
+/**
+ * @brief Thread-safe pool storing each distinct string once
+ *
+ * Interned strings are copied into large arena blocks and returned as
+ * views which stay valid for the lifetime of the pool; nothing is freed
+ * before the pool is destroyed. Strings are NUL terminated inside the arena
+ * so the views can be passed to C interfaces via data().
+ *
+ * Attribute values such as Connection.data_type, DaqApplication.host or
+ * DaqModule.plugin repeat across many objects; structures keeping them
+ * beyond a single access should store interned views rather than copies.
+ */
+class StringPool
+{
+public:
+  explicit StringPool(size_t block_size = 64 * 1024);
+
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  /// View on the pooled copy of s, adding it on first use
+  std::string_view intern(std::string_view s);
+
+  /// Number of distinct strings
+  size_t size() const;
+
+  /// Bytes reserved by the arena blocks
+  size_t capacity() const;
+
+private:
+  const char* store(std::string_view s);
+
+  const size_t m_block_size;
+
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<char[]>> m_blocks;
+  std::vector<std::unique_ptr<char[]>> m_large_blocks;
+  size_t m_block_used = 0;
+  size_t m_capacity = 0;
+  std::unordered_set<std::string_view> m_strings;
+};
+
+/// Interned string attributes of the generated classes
+std::string_view
+interned_data_type(const Connection& c, StringPool& pool);
+std::string_view
+interned_uri(const NetworkConnection& c, StringPool& pool);
+std::string_view
+interned_plugin(const DaqModule& m, StringPool& pool);
+std::string_view
+interned_host(const DaqApplication& a, StringPool& pool);
+std::string_view
+interned_name(const Variable& v, StringPool& pool);
+std::string_view
+interned_value(const Variable& v, StringPool& pool);
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_STRINGPOOL_HPP_
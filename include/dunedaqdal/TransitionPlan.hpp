@@ -0,0 +1,124 @@
+/**
+ * @file TransitionPlan.hpp
+ *
+ * Parallel dispatch of run control transitions to the ApplicationsControlled
+ * of an RCApplication, ordered by its ControlDependency objects.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_TRANSITIONPLAN_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_TRANSITIONPLAN_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Application;
+class RCApplication;
+class Session;
+
+/**
+ * @brief Order in which one transition is sent to the applications of a controller
+ *
+ * The applications are split into levels: every application of a level
+ * depends only on applications of earlier levels, so all applications of a
+ * level may receive the transition at the same time, up to
+ * max_concurrent(). A transition then takes about as long as its slowest
+ * application per level rather than the sum over all applications.
+ *
+ * A ControlDependency applies to the transitions it lists (all of them when
+ * the list is empty) and, reversed, to those in its reversed_for list.
+ */
+class TransitionPlan
+{
+public:
+  /// Send the transition to one application; false or an exception for a failure
+  using Command = std::function<bool(const Application& application, std::chrono::seconds timeout)>;
+
+  /**
+   * Throws dal::BadControlDependency when a dependency refers to an
+   * application not controlled by the controller and dal::CircularDependency
+   * when the dependencies of the transition form a cycle.
+   */
+  TransitionPlan(const RCApplication& controller, const std::string& transition);
+
+  const RCApplication& controller() const noexcept { return m_controller; }
+  const std::string& transition() const noexcept { return m_transition; }
+
+  /// Dependency levels; within a level applications keep the order of ApplicationsControlled
+  const std::vector<std::vector<const Application*>>& levels() const noexcept { return m_levels; }
+
+  /// Number of applications in all levels
+  size_t size() const noexcept { return m_size; }
+
+  /// Applications receiving the transition at the same time, 0 for no limit
+  unsigned int max_concurrent() const noexcept { return m_max_concurrent; }
+
+  /// Time each application has to complete the transition
+  std::chrono::seconds timeout() const noexcept { return m_timeout; }
+
+  /// Longest duration of the transition when every application uses its full timeout
+  std::chrono::seconds worst_case_duration() const noexcept;
+
+  /**
+   * @brief Send the transition to all applications, level by level
+   *
+   * The applications of a level are dispatched in parallel, at most
+   * max_concurrent() at a time, and the next level is started once all of
+   * them have returned. Levels after one with failures are not dispatched.
+   * A command fails when it returns false or throws anything; each failure
+   * is reported with ers::error as dal::TransitionFailed.
+   *
+   * @return the applications for which the command failed
+   */
+  std::vector<const Application*> execute(const Command& command) const;
+
+private:
+  const RCApplication& m_controller;
+  std::string m_transition;
+  std::vector<std::vector<const Application*>> m_levels;
+  size_t m_size = 0;
+  unsigned int m_max_concurrent = 0;
+  std::chrono::seconds m_timeout;
+};
+
+/**
+ * @brief TransitionPlan of every RCApplication of a session, computed once per transition
+ *
+ * Safe to use from several threads. Plans are shared with the callers, so a
+ * plan obtained before clear() stays valid for as long as it is held.
+ */
+class TransitionPlans
+{
+public:
+  explicit TransitionPlans(const Session& session);
+
+  TransitionPlans(const TransitionPlans&) = delete;
+  TransitionPlans& operator=(const TransitionPlans&) = delete;
+
+  /// Plan of the controller for the transition; throws dal::ApplicationNotFound if it is not part of the session
+  std::shared_ptr<const TransitionPlan> get(const RCApplication& controller, const std::string& transition);
+
+  /// Drop all plans, e.g. after a configuration change
+  void clear();
+
+private:
+  const Session& m_session;
+  std::mutex m_mutex;
+  std::map<std::pair<std::string, std::string>, std::shared_ptr<const TransitionPlan>> m_plans;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_TRANSITIONPLAN_HPP_
@@ -0,0 +1,150 @@
+/**
+ * @file Validator.hpp
+ *
+ * Rule based validation of a Session, run in parallel over the objects of
+ * the session.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_VALIDATOR_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_VALIDATOR_HPP_
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dal {
+
+class Application;
+class Session;
+
+struct Diagnostic
+{
+  enum class Severity
+  {
+    warning,
+    error
+  };
+
+  Severity severity;
+  std::string rule;
+  std::string object; ///< full name (UID@class) of the offending object, or its UID when the class is unknown
+  std::string message;
+};
+
+const char*
+to_string(Diagnostic::Severity severity) noexcept;
+
+/// Everything a rule may look at, built once per validation
+class ValidationContext
+{
+public:
+  ValidationContext(dunedaq::oksdbinterfaces::Configuration& db, const Session& session);
+
+  dunedaq::oksdbinterfaces::Configuration& configuration() const noexcept { return m_db; }
+  const Session& session() const noexcept { return m_session; }
+  const ConnectivityIndex& index() const noexcept { return m_index; }
+
+  /// Session.applications
+  const std::vector<const Application*>& applications() const noexcept { return m_applications; }
+
+  /// All objects reachable from the session
+  const std::vector<dunedaq::oksdbinterfaces::ConfigObject>& objects() const noexcept { return m_objects; }
+
+private:
+  dunedaq::oksdbinterfaces::Configuration& m_db;
+  const Session& m_session;
+  ConnectivityIndex m_index;
+  std::vector<const Application*> m_applications;
+  std::vector<dunedaq::oksdbinterfaces::ConfigObject> m_objects;
+};
+
+/**
+ * @brief One validation rule
+ *
+ * A rule checks the items of one domain. prepare() is called once, before
+ * any check(); check() is then called for disjoint ranges of items from
+ * several threads at once and must only read the rule's state.
+ */
+class Rule
+{
+public:
+  enum class Domain
+  {
+    session,      ///< a single item
+    applications, ///< ValidationContext::applications()
+    modules,      ///< ConnectivityIndex modules
+    connections,  ///< ConnectivityIndex connections
+    objects       ///< ValidationContext::objects()
+  };
+
+  virtual ~Rule() = default;
+
+  virtual std::string name() const = 0;
+  virtual Domain domain() const = 0;
+
+  virtual void prepare(const ValidationContext&) {}
+
+  /// Append the diagnostics of items [begin, end) in item order
+  virtual void check(const ValidationContext& context,
+                     size_t begin,
+                     size_t end,
+                     std::vector<Diagnostic>& out) const = 0;
+};
+
+/**
+ * The built-in rules:
+ * - cardinality: relationships with a lower cardinality of one are not empty
+ * - unique-host-port: no two DaqApplications share host and port
+ * - connection-endpoints: connections have producers and consumers, queues
+ *   have a type supporting them and network connections have a single
+ *   binding end
+ * - timeout-range: RCApplication.Timeout within 1..3600 s
+ * - control-dependencies: a TransitionPlan can be built for every transition
+ * - control-tree: every application is controlled exactly once, see ControlTree
+ * - uri-syntax: NetworkConnection.uri is scheme://host[:port][/path]
+ * - placement: check_placement()
+ * - host-resources: no host is oversubscribed, see estimate_resources()
+ */
+std::vector<std::unique_ptr<Rule>>
+default_rules();
+
+class Validator
+{
+public:
+  /// With the default rules
+  Validator();
+
+  explicit Validator(std::vector<std::unique_ptr<Rule>> rules);
+
+  void add(std::unique_ptr<Rule> rule) { m_rules.push_back(std::move(rule)); }
+
+  const std::vector<std::unique_ptr<Rule>>& rules() const noexcept { return m_rules; }
+
+  /**
+   * @brief Run all rules on the session
+   *
+   * Items are sharded over n_threads threads (0 for the number of cores).
+   * Diagnostics are returned in rule order and, within a rule, in item
+   * order, independently of the number of threads.
+   */
+  std::vector<Diagnostic> run(dunedaq::oksdbinterfaces::Configuration& db,
+                              const Session& session,
+                              unsigned int n_threads = 0);
+
+private:
+  std::vector<std::unique_ptr<Rule>> m_rules;
+};
+
+} // namespace dunedaq::dal
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_VALIDATOR_HPP_
@@ -0,0 +1,284 @@
+/**
+ * @file traverse.hpp
+ *
+ * Typed traversal of relationship chains, e.g.
+ *
+ *     dal::traverse::for_each<Session, DaqApplication, DaqModule, Outputs<Queue>>(session, [](const Queue& q) { ... });
+ *
+ * visits every Queue in the outputs of every module of every DaqApplication
+ * of the session. The relationship followed at each step is chosen at compile
+ * time from the pair of types; objects not of the requested type are
+ * skipped. Steps to a base of the relationship's class need no check at all;
+ * downcasts are resolved through a small per-thread cache keyed by the
+ * dynamic type, so the inner loop performs neither dynamic_cast nor class
+ * name comparisons once each concrete type has been seen.
+ *
+ * Objects reachable along several paths are visited once per path.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_INCLUDE_DUNEDAQDAL_TRAVERSE_HPP_
+#define DUNEDAQDAL_INCLUDE_DUNEDAQDAL_TRAVERSE_HPP_
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Parameter.hpp"
+#include "dunedaqdal/PollingPolicy.hpp"
+#include "dunedaqdal/ProcessPlacement.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/VariableSet.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace dunedaq::dal::traverse {
+
+/// Step selecting only DaqModule.inputs
+template<class T>
+struct Inputs
+{};
+
+/// Step selecting only DaqModule.outputs
+template<class T>
+struct Outputs
+{};
+
+namespace detail {
+
+template<class Step>
+struct target
+{
+  using type = Step;
+};
+
+template<class T>
+struct target<Inputs<T>>
+{
+  using type = T;
+};
+
+template<class T>
+struct target<Outputs<T>>
+{
+  using type = T;
+};
+
+template<class Step>
+using target_t = typename target<Step>::type;
+
+/// Remembers, per dynamic type, whether and where a To subobject is found
+template<class To, class From>
+struct CastCache
+{
+  struct Entry
+  {
+    const std::type_info* type = nullptr;
+    std::ptrdiff_t offset = 0;
+    bool convertible = false;
+  };
+
+  static constexpr size_t size = 4;
+
+  Entry entries[size];
+  size_t next = 0;
+};
+
+/// Downcast of a DAL object; nullptr when it is not a To
+template<class To, class From>
+inline const To*
+as(const From* obj)
+{
+  if constexpr (std::is_base_of_v<To, From>) {
+    return obj;
+  } else {
+    thread_local CastCache<To, From> cache;
+
+    const std::type_info* type = &typeid(*obj);
+    const char* complete = static_cast<const char*>(dynamic_cast<const void*>(obj));
+    for (const auto& entry : cache.entries) {
+      if (entry.type == type) {
+        return entry.convertible ? reinterpret_cast<const To*>(complete + entry.offset) : nullptr;
+      }
+    }
+
+    // first object of this dynamic type: the layout of a complete object is fixed, so is the offset
+    const To* result = dynamic_cast<const To*>(obj);
+    auto& entry = cache.entries[cache.next++ % CastCache<To, From>::size];
+    entry.type = type;
+    entry.convertible = result != nullptr;
+    entry.offset = result ? reinterpret_cast<const char*>(result) - complete : 0;
+    return result;
+  }
+}
+
+template<class Base, class T>
+constexpr bool is_a = std::is_base_of_v<Base, T>;
+
+template<class R, class F>
+inline void
+visit_all(const std::vector<const R*>& objects, F& f)
+{
+  for (const R* obj : objects) {
+    f(obj);
+  }
+}
+
+template<class R, class F>
+inline void
+visit_all(const R* obj, F& f)
+{
+  if (obj != nullptr) {
+    f(obj);
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Relationship followed from Parent to reach objects of type Step
+ *
+ * Specialisations provide visit(parent, f), calling f with each related
+ * object as a pointer to the relationship's class. Add specialisations to
+ * traverse relationships of other classes.
+ */
+template<class Parent, class Step, class Enable = void>
+struct edge;
+
+template<class C>
+struct edge<Session, C, std::enable_if_t<detail::is_a<Application, C>>>
+{
+  template<class F>
+  static void visit(const Session& s, F& f) { detail::visit_all(s.get_applications(), f); }
+};
+
+template<class C>
+struct edge<Session, C, std::enable_if_t<detail::is_a<Parameter, C>>>
+{
+  template<class F>
+  static void visit(const Session& s, F& f) { detail::visit_all(s.get_ProcessEnvironment(), f); }
+};
+
+template<>
+struct edge<Session, PollingPolicy>
+{
+  template<class F>
+  static void visit(const Session& s, F& f) { detail::visit_all(s.get_polling_policies(), f); }
+};
+
+template<class P, class C>
+struct edge<P, C, std::enable_if_t<detail::is_a<Application, P> && detail::is_a<Parameter, C>>>
+{
+  template<class F>
+  static void visit(const P& app, F& f) { detail::visit_all(app.get_ApplicationEnvironment(), f); }
+};
+
+template<class P, class C>
+struct edge<P, C, std::enable_if_t<detail::is_a<RCApplication, P> && detail::is_a<Application, C>>>
+{
+  template<class F>
+  static void visit(const P& rc, F& f) { detail::visit_all(rc.get_ApplicationsControlled(), f); }
+};
+
+template<class P, class C>
+struct edge<P, C, std::enable_if_t<detail::is_a<DaqApplication, P> && detail::is_a<DaqModule, C>>>
+{
+  template<class F>
+  static void visit(const P& app, F& f) { detail::visit_all(app.get_modules(), f); }
+};
+
+template<class P>
+struct edge<P, ProcessPlacement, std::enable_if_t<detail::is_a<DaqApplication, P>>>
+{
+  template<class F>
+  static void visit(const P& app, F& f) { detail::visit_all(app.get_placement(), f); }
+};
+
+/// Both DaqModule.inputs and DaqModule.outputs, in this order
+template<class P, class C>
+struct edge<P, C, std::enable_if_t<detail::is_a<DaqModule, P> && detail::is_a<Connection, C>>>
+{
+  template<class F>
+  static void visit(const P& mod, F& f)
+  {
+    detail::visit_all(mod.get_inputs(), f);
+    detail::visit_all(mod.get_outputs(), f);
+  }
+};
+
+template<class P, class C>
+struct edge<P, Inputs<C>, std::enable_if_t<detail::is_a<DaqModule, P> && detail::is_a<Connection, C>>>
+{
+  template<class F>
+  static void visit(const P& mod, F& f) { detail::visit_all(mod.get_inputs(), f); }
+};
+
+template<class P, class C>
+struct edge<P, Outputs<C>, std::enable_if_t<detail::is_a<DaqModule, P> && detail::is_a<Connection, C>>>
+{
+  template<class F>
+  static void visit(const P& mod, F& f) { detail::visit_all(mod.get_outputs(), f); }
+};
+
+template<class P, class C>
+struct edge<P, C, std::enable_if_t<detail::is_a<VariableSet, P> && detail::is_a<Parameter, C>>>
+{
+  template<class F>
+  static void visit(const P& set, F& f) { detail::visit_all(set.get_Contains(), f); }
+};
+
+namespace detail {
+
+template<class P, class Step, class... Rest, class F>
+inline void
+walk(const P& parent, F& fn)
+{
+  using C = target_t<Step>;
+  auto step = [&fn](const auto* related) {
+    if (const C* obj = as<C>(related)) {
+      if constexpr (sizeof...(Rest) == 0) {
+        fn(*obj);
+      } else {
+        walk<C, Rest...>(*obj, fn);
+      }
+    }
+  };
+  edge<P, Step>::visit(parent, step);
+}
+
+} // namespace detail
+
+/**
+ * @brief Call fn(const Last&) for every object at the end of the chain Root -> Path...
+ *
+ * Each type of Path is either a class or Inputs<T> / Outputs<T> for the
+ * connections of a DaqModule; consecutive types must be linked by an edge.
+ */
+template<class Root, class... Path, class F>
+inline void
+for_each(const Root& root, F&& fn)
+{
+  static_assert(sizeof...(Path) > 0, "for_each needs at least one step after the root");
+  detail::walk<Root, Path...>(root, fn);
+}
+
+/// Number of objects at the end of the chain Root -> Path...
+template<class Root, class... Path>
+inline size_t
+count(const Root& root)
+{
+  size_t n = 0;
+  for_each<Root, Path...>(root, [&n](const auto&) { ++n; });
+  return n;
+}
+
+} // namespace dunedaq::dal::traverse
+
+#endif // DUNEDAQDAL_INCLUDE_DUNEDAQDAL_TRAVERSE_HPP_
@@ -0,0 +1,247 @@
+/**
+ * @file bulk_accessors.cpp
+ *
+ * Column accessors returning one attribute of all applications, modules,
+ * connections, queues or variables of a Session in a single call, taken
+ * from its SessionTables: numbers as read-only NumPy arrays viewing the
+ * tables without copying them, strings as lists.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "registrators.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/SessionTables.hpp"
+
+#include "dunedaqdal/Session.hpp"
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace dunedaq::dal::python {
+
+namespace {
+
+/// NumPy array owning the vector's buffer, without copying it
+template<class T>
+py::array_t<T>
+to_array(std::vector<T>&& values)
+{
+  auto* owner = new std::vector<T>(std::move(values));
+  py::capsule capsule(owner, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+  return py::array_t<T>(owner->size(), owner->data(), capsule);
+}
+
+/// Read-only NumPy view of a column, keeping base, the owner of the column, alive
+template<class T>
+py::array_t<T>
+to_array(const std::vector<T>& values, py::handle base)
+{
+  py::array_t<T> result(values.size(), values.data(), base);
+  result.attr("setflags")(py::arg("write") = false);
+  return result;
+}
+
+py::array_t<uint32_t>
+to_array(const columns::IndexColumn& column, py::handle base)
+{
+  return to_array(column.rows, base);
+}
+
+/// Python list of a dictionary-encoded column, converting each distinct string once
+py::list
+to_list(const columns::StringColumn& column)
+{
+  std::vector<py::str> dictionary;
+  dictionary.reserve(column.dictionary.size());
+  for (auto value : column.dictionary) {
+    dictionary.emplace_back(value.data(), value.size());
+  }
+
+  py::list result(column.size());
+  for (size_t i = 0; i < column.size(); ++i) {
+    result[i] = dictionary[column.codes[i]];
+  }
+  return result;
+}
+
+/// Number of entries of every list of the column
+py::array_t<uint32_t>
+to_counts(const columns::IndexListColumn& column)
+{
+  std::vector<uint32_t> counts(column.size());
+  for (size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = column.offsets[i + 1] - column.offsets[i];
+  }
+  return to_array(std::move(counts));
+}
+
+/**
+ * Columns of a Session in the order of its ConnectivityIndex, so that the
+ * row numbers of one accessor can be used as indices into the others.
+ */
+class SessionColumns
+{
+public:
+  explicit SessionColumns(const Session& session)
+    : m_tables(make_tables(session, ConnectivityIndex(session)))
+  {
+  }
+
+  py::dict applications() const
+  {
+    const auto& t = m_tables.applications;
+    py::dict result;
+    result["uid"] = to_list(t.uid);
+    result["host"] = to_list(t.host);
+    result["port"] = to_array(t.port, self());
+    return result;
+  }
+
+  py::dict modules() const
+  {
+    const auto& t = m_tables.modules;
+    py::dict result;
+    result["uid"] = to_list(t.uid);
+    result["plugin"] = to_list(t.plugin);
+    result["application"] = to_array(t.application, self());
+    return result;
+  }
+
+  py::dict connections() const
+  {
+    const auto& t = m_tables.connections;
+    py::dict result;
+    result["uid"] = to_list(t.uid);
+    result["class_name"] = to_list(t.class_name);
+    result["data_type"] = to_list(t.data_type);
+    result["producers"] = to_counts(t.producers);
+    result["consumers"] = to_counts(t.consumers);
+    return result;
+  }
+
+  py::dict queues() const
+  {
+    const auto& t = m_tables.queues;
+    py::dict result;
+    result["connection"] = to_array(t.connection, self());
+    result["uid"] = connection_uids(t.connection);
+    result["queue_type"] = to_list(t.queue_type);
+    result["capacity"] = to_array(t.capacity, self());
+    result["push_batch_size"] = to_array(t.push_batch_size, self());
+    result["pop_batch_size"] = to_array(t.pop_batch_size, self());
+    result["numa_node"] = to_array(t.numa_node, self());
+    result["wait_strategy"] = to_list(t.wait_strategy);
+    return result;
+  }
+
+  py::dict network_connections() const
+  {
+    const auto& t = m_tables.network_connections;
+    py::dict result;
+    result["connection"] = to_array(t.connection, self());
+    result["uid"] = connection_uids(t.connection);
+    result["connection_type"] = to_list(t.connection_type);
+    result["uri"] = to_list(t.uri);
+    return result;
+  }
+
+  py::dict shared_memory_connections() const
+  {
+    const auto& t = m_tables.shared_memory_connections;
+    py::dict result;
+    result["connection"] = to_array(t.connection, self());
+    result["uid"] = connection_uids(t.connection);
+    result["segment_name"] = to_list(t.segment_name);
+    result["segment_size"] = to_array(t.segment_size, self());
+    result["slot_count"] = to_array(t.slot_count, self());
+    result["consumer_mode"] = to_list(t.consumer_mode);
+    return result;
+  }
+
+  py::dict variables() const
+  {
+    const auto& t = m_tables.variables;
+    py::dict result;
+    result["uid"] = to_list(t.uid);
+    result["name"] = to_list(t.name);
+    result["value"] = to_list(t.value);
+    result["session"] = to_array(t.session, self()).attr("view")("bool");
+    return result;
+  }
+
+  /// One row per DaqModule.inputs and DaqModule.outputs entry
+  py::dict edges() const
+  {
+    const auto& t = m_tables.modules;
+    std::vector<uint32_t> modules;
+    std::vector<uint32_t> connections;
+    std::vector<uint8_t> outputs;
+    for (uint32_t m = 0; m < t.size(); ++m) {
+      for (bool output : { false, true }) {
+        for (auto c : output ? t.outputs[m] : t.inputs[m]) {
+          modules.push_back(m);
+          connections.push_back(c);
+          outputs.push_back(output);
+        }
+      }
+    }
+
+    py::dict result;
+    result["module"] = to_array(std::move(modules));
+    result["connection"] = to_array(std::move(connections));
+    result["output"] = to_array(std::move(outputs)).attr("view")("bool");
+    return result;
+  }
+
+private:
+  /// Python object of this SessionColumns, the base of the arrays viewing its tables
+  py::object self() const { return py::cast(this, py::return_value_policy::reference); }
+
+  py::list connection_uids(const columns::IndexColumn& rows) const
+  {
+    const auto& uids = m_tables.connections.uid;
+    py::list result(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      const auto uid = uids[rows[i]];
+      result[i] = py::str(uid.data(), uid.size());
+    }
+    return result;
+  }
+
+  SessionTables m_tables;
+};
+
+} // namespace
+
+void
+register_bulk_accessors(py::module& m)
+{
+  py::class_<SessionColumns>(m, "SessionColumns")
+    .def(py::init<const Session&>(), py::arg("session"))
+    .def("applications", &SessionColumns::applications, "uid, host and port of every DaqApplication")
+    .def("modules", &SessionColumns::modules, "uid, plugin and application row of every DaqModule")
+    .def("connections", &SessionColumns::connections, "uid, class_name, data_type, producers and consumers")
+    .def("queues", &SessionColumns::queues, "connection row, uid and settings of every Queue")
+    .def("network_connections",
+         &SessionColumns::network_connections,
+         "connection row, uid, connection_type and uri of every NetworkConnection")
+    .def("shared_memory_connections",
+         &SessionColumns::shared_memory_connections,
+         "connection row, uid and segment settings of every SharedMemoryConnection")
+    .def("variables",
+         &SessionColumns::variables,
+         "uid, name, value and session flag of every Variable of the session and its applications")
+    .def("edges", &SessionColumns::edges, "module row, connection row and direction of every module input and output");
+}
+
+} // namespace dunedaq::dal::python
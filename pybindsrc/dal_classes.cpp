@@ -0,0 +1,203 @@
+/**
+ * @file dal_classes.cpp
+ *
+ * Bindings of the classes generated from schema/dunedaqdal/dunedaq.schema.xml.
+ * DAL objects are owned by their Configuration: they are returned by
+ * reference and keep the Configuration alive.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "registrators.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/ControlDependency.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/DataTypeProfile.hpp"
+#include "dunedaqdal/Host.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Parameter.hpp"
+#include "dunedaqdal/PollingPolicy.hpp"
+#include "dunedaqdal/ProcessPlacement.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+#include "dunedaqdal/TransitionTimeout.hpp"
+#include "dunedaqdal/Variable.hpp"
+#include "dunedaqdal/VariableSet.hpp"
+
+#include "oksdbinterfaces/Configuration.hpp"
+#include "oksdbinterfaces/DalObject.hpp"
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <string>
+
+namespace py = pybind11;
+
+using dunedaq::oksdbinterfaces::Configuration;
+using dunedaq::oksdbinterfaces::DalObject;
+
+namespace dunedaq::dal::python {
+
+namespace {
+
+// related objects are owned by the Configuration; each one returned keeps the object it came from, and through
+// it the Configuration, alive
+constexpr auto ref = py::return_value_policy::reference_internal;
+
+template<class T>
+void
+def_get(py::class_<Configuration>& db, const char* name)
+{
+  db.def(
+    name,
+    [](Configuration& self, const std::string& uid) { return self.get<T>(uid); },
+    py::return_value_policy::reference_internal,
+    py::arg("uid"));
+}
+
+} // namespace
+
+void
+register_dal_classes(py::module& m)
+{
+  // module_local: the oksdbinterfaces bindings may register their own
+  py::class_<Configuration> db(m, "Configuration", py::module_local());
+  db.def(py::init<const std::string&>(), py::arg("spec"))
+    .def("commit", &Configuration::commit, py::arg("log_message") = "");
+
+  py::class_<DalObject>(m, "DalObject", py::module_local())
+    .def("UID", &DalObject::UID)
+    .def("class_name", &DalObject::class_name)
+    .def("full_name", &DalObject::full_name)
+    .def("__repr__", &DalObject::full_name);
+
+  py::class_<Parameter, DalObject>(m, "Parameter").def("get_Description", &Parameter::get_Description);
+
+  py::class_<Variable, Parameter>(m, "Variable")
+    .def("get_Name", &Variable::get_Name)
+    .def("get_Value", &Variable::get_Value);
+
+  py::class_<VariableSet, Parameter>(m, "VariableSet").def("get_Contains", &VariableSet::get_Contains, ref);
+
+  py::class_<Connection, DalObject>(m, "Connection").def("get_data_type", &Connection::get_data_type);
+
+  py::class_<Queue, Connection>(m, "Queue")
+    .def("get_capacity", &Queue::get_capacity)
+    .def("get_queue_type", &Queue::get_queue_type)
+    .def("get_push_batch_size", &Queue::get_push_batch_size)
+    .def("get_pop_batch_size", &Queue::get_pop_batch_size)
+    .def("get_cache_line_padding", &Queue::get_cache_line_padding)
+    .def("get_numa_node", &Queue::get_numa_node)
+    .def("get_wait_strategy", &Queue::get_wait_strategy);
+
+  py::class_<NetworkConnection, Connection>(m, "NetworkConnection")
+    .def("get_connection_type", &NetworkConnection::get_connection_type)
+    .def("get_uri", &NetworkConnection::get_uri);
+
+  py::class_<SharedMemoryConnection, Connection>(m, "SharedMemoryConnection")
+    .def("get_segment_name", &SharedMemoryConnection::get_segment_name)
+    .def("get_segment_size", &SharedMemoryConnection::get_segment_size)
+    .def("get_slot_count", &SharedMemoryConnection::get_slot_count)
+    .def("get_consumer_mode", &SharedMemoryConnection::get_consumer_mode);
+
+  py::class_<DaqModule, DalObject>(m, "DaqModule")
+    .def("get_plugin", &DaqModule::get_plugin)
+    .def("get_thread_affinity", &DaqModule::get_thread_affinity)
+    .def("get_inputs", &DaqModule::get_inputs, ref)
+    .def("get_outputs", &DaqModule::get_outputs, ref);
+
+  py::class_<ProcessPlacement, DalObject>(m, "ProcessPlacement")
+    .def("get_cpu_set", &ProcessPlacement::get_cpu_set)
+    .def("get_memory_policy", &ProcessPlacement::get_memory_policy)
+    .def("get_numa_nodes", &ProcessPlacement::get_numa_nodes)
+    .def("get_hugepages_2M", &ProcessPlacement::get_hugepages_2M)
+    .def("get_hugepages_1G", &ProcessPlacement::get_hugepages_1G);
+
+  py::class_<Application, DalObject>(m, "Application")
+    .def("get_ApplicationEnvironment", &Application::get_ApplicationEnvironment, ref);
+
+  py::class_<DaqApplication, Application>(m, "DaqApplication")
+    .def("get_host", &DaqApplication::get_host)
+    .def("get_port", &DaqApplication::get_port)
+    .def("get_modules", &DaqApplication::get_modules, ref)
+    .def("get_placement", &DaqApplication::get_placement, ref);
+
+  py::class_<RCApplication, Application>(m, "RCApplication")
+    .def("get_Timeout", &RCApplication::get_Timeout)
+    .def("get_max_concurrent_commands", &RCApplication::get_max_concurrent_commands)
+    .def("get_ApplicationsControlled", &RCApplication::get_ApplicationsControlled, ref)
+    .def("get_dependencies", &RCApplication::get_dependencies, ref)
+    .def("get_transition_timeouts", &RCApplication::get_transition_timeouts, ref);
+
+  py::class_<ControlDependency, DalObject>(m, "ControlDependency")
+    .def("get_transitions", &ControlDependency::get_transitions)
+    .def("get_reversed_for", &ControlDependency::get_reversed_for)
+    .def("get_application", &ControlDependency::get_application, ref)
+    .def("get_depends_on", &ControlDependency::get_depends_on, ref);
+
+  py::class_<TransitionTimeout, DalObject>(m, "TransitionTimeout")
+    .def("get_transition", &TransitionTimeout::get_transition)
+    .def("get_timeout", &TransitionTimeout::get_timeout);
+
+  py::class_<PollingPolicy, DalObject>(m, "PollingPolicy")
+    .def("get_connection_type", &PollingPolicy::get_connection_type)
+    .def("get_min_interval_ms", &PollingPolicy::get_min_interval_ms)
+    .def("get_max_interval_ms", &PollingPolicy::get_max_interval_ms)
+    .def("get_backoff_factor", &PollingPolicy::get_backoff_factor);
+
+  py::class_<Session, DalObject>(m, "Session")
+    .def("get_Description", &Session::get_Description)
+    .def("get_use_connectivity_server", &Session::get_use_connectivity_server)
+    .def("get_connectivity_service_interval_ms", &Session::get_connectivity_service_interval_ms)
+    .def("get_connectivity_batch_size", &Session::get_connectivity_batch_size)
+    .def("get_connectivity_cache_ttl_ms", &Session::get_connectivity_cache_ttl_ms)
+    .def("get_connectivity_poll_min_ms", &Session::get_connectivity_poll_min_ms)
+    .def("get_connectivity_poll_max_ms", &Session::get_connectivity_poll_max_ms)
+    .def("get_connectivity_poll_backoff", &Session::get_connectivity_poll_backoff)
+    .def("get_first_port", &Session::get_first_port)
+    .def("get_last_port", &Session::get_last_port)
+    .def("get_reserved_ports", &Session::get_reserved_ports)
+    .def("get_applications", &Session::get_applications, ref)
+    .def("get_ProcessEnvironment", &Session::get_ProcessEnvironment, ref)
+    .def("get_polling_policies", &Session::get_polling_policies, ref)
+    .def("get_data_type_profiles", &Session::get_data_type_profiles, ref)
+    .def("get_hosts", &Session::get_hosts, ref);
+
+  py::class_<DataTypeProfile, DalObject>(m, "DataTypeProfile")
+    .def("get_data_type", &DataTypeProfile::get_data_type)
+    .def("get_payload_size", &DataTypeProfile::get_payload_size)
+    .def("get_rate_hz", &DataTypeProfile::get_rate_hz);
+
+  py::class_<Host, DalObject>(m, "Host")
+    .def("get_hostname", &Host::get_hostname)
+    .def("get_cpus", &Host::get_cpus)
+    .def("get_memory_mb", &Host::get_memory_mb)
+    .def("get_network_gbps", &Host::get_network_gbps)
+    .def("get_reserved_ports", &Host::get_reserved_ports);
+
+  def_get<Session>(db, "get_Session");
+  def_get<DaqApplication>(db, "get_DaqApplication");
+  def_get<RCApplication>(db, "get_RCApplication");
+  def_get<DaqModule>(db, "get_DaqModule");
+  def_get<Queue>(db, "get_Queue");
+  def_get<NetworkConnection>(db, "get_NetworkConnection");
+  def_get<SharedMemoryConnection>(db, "get_SharedMemoryConnection");
+  def_get<ProcessPlacement>(db, "get_ProcessPlacement");
+  def_get<PollingPolicy>(db, "get_PollingPolicy");
+  def_get<ControlDependency>(db, "get_ControlDependency");
+  def_get<TransitionTimeout>(db, "get_TransitionTimeout");
+  def_get<DataTypeProfile>(db, "get_DataTypeProfile");
+  def_get<Host>(db, "get_Host");
+  def_get<Variable>(db, "get_Variable");
+  def_get<VariableSet>(db, "get_VariableSet");
+}
+
+} // namespace dunedaq::dal::python
@@ -0,0 +1,25 @@
+/**
+ * @file module.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "registrators.hpp"
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace dunedaq::dal::python {
+
+PYBIND11_MODULE(_daq_dunedaqdal_py, m)
+{
+  m.doc() = "Python bindings of the dunedaqdal configuration classes";
+
+  register_dal_classes(m);
+  register_bulk_accessors(m);
+}
+
+} // namespace dunedaq::dal::python
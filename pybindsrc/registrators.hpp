@@ -0,0 +1,26 @@
+/**
+ * @file registrators.hpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_PYBINDSRC_REGISTRATORS_HPP_
+#define DUNEDAQDAL_PYBINDSRC_REGISTRATORS_HPP_
+
+#include <pybind11/pybind11.h>
+
+namespace dunedaq::dal::python {
+
+/// Configuration and the classes generated from the schema
+void
+register_dal_classes(pybind11::module& m);
+
+/// Whole-column accessors over the objects of a Session
+void
+register_bulk_accessors(pybind11::module& m);
+
+} // namespace dunedaq::dal::python
+
+#endif // DUNEDAQDAL_PYBINDSRC_REGISTRATORS_HPP_
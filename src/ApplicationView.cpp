@@ -0,0 +1,150 @@
+/**
+ * @file ApplicationView.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ApplicationView.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Parameter.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <unordered_set>
+
+namespace dunedaq::dal {
+
+ApplicationView::ApplicationView(dunedaq::oksdbinterfaces::Configuration& db,
+                                 const std::string& session_uid,
+                                 const std::string& application_uid)
+  : m_db(db)
+{
+  m_db.get(Session::s_class_name, session_uid, m_session);
+
+  std::vector<dunedaq::oksdbinterfaces::ConfigObject> apps;
+  m_session.get("applications", apps);
+
+  for (auto& obj : apps) {
+    if (obj.UID() == application_uid) {
+      m_application = m_db.get<Application>(obj);
+      break;
+    }
+  }
+
+  if (m_application == nullptr) {
+    throw ApplicationNotFound(ERS_HERE, application_uid, session_uid);
+  }
+}
+
+const std::vector<const DaqModule*>&
+ApplicationView::modules() const
+{
+  std::call_once(m_modules_flag, [this] { load_modules(); });
+  return m_modules;
+}
+
+const std::vector<const Connection*>&
+ApplicationView::connections() const
+{
+  std::call_once(m_modules_flag, [this] { load_modules(); });
+  return m_connections;
+}
+
+const std::vector<const Application*>&
+ApplicationView::controlled() const
+{
+  std::call_once(m_controlled_flag, [this] { load_controlled(); });
+  return m_controlled;
+}
+
+const std::vector<const Parameter*>&
+ApplicationView::session_environment() const
+{
+  std::call_once(m_environment_flag, [this] { load_session_environment(); });
+  return m_session_environment;
+}
+
+Environment
+ApplicationView::environment(EnvironmentResolver& resolver) const
+{
+  auto env = resolver.get(session_environment());
+  for (auto& [name, value] : resolver.get(m_application->get_ApplicationEnvironment())) {
+    env[name] = std::move(value);
+  }
+  return env;
+}
+
+void
+ApplicationView::load_modules() const
+{
+  const auto* daq_app = m_application->cast<DaqApplication>();
+  if (daq_app == nullptr) {
+    return;
+  }
+
+  m_modules = daq_app->get_modules();
+
+  std::unordered_set<const Connection*> seen;
+  for (const auto* mod : m_modules) {
+    for (const auto* list : { &mod->get_inputs(), &mod->get_outputs() }) {
+      for (const auto* c : *list) {
+        if (seen.insert(c).second) {
+          m_connections.push_back(c);
+        }
+      }
+    }
+  }
+
+  TLOG_DEBUG(5) << "loaded " << m_modules.size() << " modules and " << m_connections.size() << " connections of "
+                << m_application->full_name();
+}
+
+void
+ApplicationView::load_controlled() const
+{
+  const auto* rc_app = m_application->cast<RCApplication>();
+  if (rc_app == nullptr) {
+    return;
+  }
+
+  std::unordered_set<const Application*> seen{ m_application };
+  std::vector<const RCApplication*> pending{ rc_app };
+
+  while (!pending.empty()) {
+    const auto* rc = pending.back();
+    pending.pop_back();
+
+    for (const auto* app : rc->get_ApplicationsControlled()) {
+      if (!seen.insert(app).second) {
+        continue;
+      }
+      m_controlled.push_back(app);
+      if (const auto* nested = app->cast<RCApplication>()) {
+        pending.push_back(nested);
+      }
+    }
+  }
+}
+
+void
+ApplicationView::load_session_environment() const
+{
+  std::vector<dunedaq::oksdbinterfaces::ConfigObject> params;
+  m_session.get("ProcessEnvironment", params);
+
+  m_session_environment.reserve(params.size());
+  for (auto& obj : params) {
+    m_session_environment.push_back(m_db.get<Parameter>(obj));
+  }
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,322 @@
+/**
+ * @file ChangeSet.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ChangeSet.hpp"
+
+#include "ObjectGraph.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace dunedaq::dal {
+
+namespace {
+
+using dunedaq::oksdbinterfaces::ConfigObject;
+using dunedaq::oksdbinterfaces::Configuration;
+
+const std::string application_class = "Application";
+const std::string applications_relationship = "applications";
+
+bool
+is_application(Configuration& db, const std::string& class_name)
+{
+  if (class_name == application_class) {
+    return true;
+  }
+  const auto& supers = db.get_class_info(class_name).p_superclasses;
+  return std::find(supers.begin(), supers.end(), application_class) != supers.end();
+}
+
+/**
+ * Objects reachable from a session, with their values and the reverse
+ * relationship edges needed to find the applications depending on them.
+ */
+class SessionGraph
+{
+public:
+  struct Node
+  {
+    ConfigObject object;
+    detail::ObjectData data;
+    bool application = false;
+    std::vector<std::pair<std::string, const std::string*>> parents; ///< parent key, relationship name
+  };
+
+  SessionGraph(Configuration& db, const std::string& session_uid, bool with_attributes)
+  {
+    ConfigObject session;
+    db.get("Session", session_uid, session);
+    m_session = session.full_name();
+
+    std::unordered_map<std::string, bool> application_classes;
+    std::vector<std::string> queue{ m_session };
+    m_nodes[m_session].object = session;
+
+    for (size_t i = 0; i < queue.size(); ++i) {
+      Node& node = m_nodes[queue[i]];
+      auto cls = application_classes.try_emplace(node.object.class_name());
+      if (cls.second) {
+        cls.first->second = is_application(db, node.object.class_name());
+      }
+      node.application = cls.first->second;
+      node.data = detail::read_object(db, node.object, with_attributes);
+
+      for (auto& [name, targets] : node.data.relationships) {
+        for (auto& target : targets) {
+          auto key = target.full_name();
+          auto [it, added] = m_nodes.try_emplace(key);
+          if (added) {
+            it->second.object = target;
+            queue.push_back(key);
+          }
+          it->second.parents.emplace_back(queue[i], &name);
+        }
+      }
+    }
+
+    for (const auto& [key, node] : m_nodes) {
+      if (node.application) {
+        m_applications.insert(node.object.UID());
+      }
+    }
+  }
+
+  SessionGraph(const SessionGraph&) = delete;
+  SessionGraph& operator=(const SessionGraph&) = delete;
+
+  const std::string& session() const noexcept { return m_session; }
+  const std::set<std::string>& applications() const noexcept { return m_applications; }
+  const std::unordered_map<std::string, Node>& nodes() const noexcept { return m_nodes; }
+
+  /**
+   * Add the applications depending on the object to apps, walking the
+   * relationships backwards up to the first application. Returns true when
+   * the object is reached from the session other than through its
+   * applications, i.e. when all applications depend on it.
+   */
+  bool collect(const std::string& key, std::set<std::string>& apps) const
+  {
+    std::vector<const std::string*> stack{ &key };
+    std::unordered_set<std::string_view> visited{ key };
+
+    while (!stack.empty()) {
+      auto it = m_nodes.find(*stack.back());
+      stack.pop_back();
+      if (it == m_nodes.end()) {
+        continue;
+      }
+      if (it->second.application) {
+        apps.insert(it->second.object.UID());
+        continue;
+      }
+      for (const auto& [parent, relationship] : it->second.parents) {
+        if (parent == m_session) {
+          if (*relationship != applications_relationship) {
+            return true;
+          }
+        } else if (visited.insert(parent).second) {
+          stack.push_back(&parent);
+        }
+      }
+    }
+    return false;
+  }
+
+private:
+  std::string m_session;
+  std::unordered_map<std::string, Node> m_nodes;
+  std::set<std::string> m_applications;
+};
+
+bool
+same(const std::string& a, const std::string& b)
+{
+  return a == b;
+}
+
+/// References compare by identity, which is not shared between two configurations
+bool
+same(const std::vector<ConfigObject>& a, const std::vector<ConfigObject>& b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const ConfigObject& x, const ConfigObject& y) {
+    return x.UID() == y.UID() && x.class_name() == y.class_name();
+  });
+}
+
+/// Names of the entries differing between two name/value lists
+template<class T>
+std::vector<std::string>
+changed_names(const std::vector<std::pair<std::string, T>>& before, const std::vector<std::pair<std::string, T>>& after)
+{
+  std::unordered_map<std::string_view, const T*> old_values;
+  for (const auto& [name, value] : before) {
+    old_values.emplace(name, &value);
+  }
+
+  std::vector<std::string> result;
+  for (const auto& [name, value] : after) {
+    auto it = old_values.find(name);
+    if (it == old_values.end() || !same(*it->second, value)) {
+      result.push_back(name);
+    }
+    if (it != old_values.end()) {
+      old_values.erase(it);
+    }
+  }
+  for (const auto& [name, value] : before) {
+    if (old_values.count(name)) {
+      result.push_back(name); // no longer in the schema
+    }
+  }
+  return result;
+}
+
+/// Whether a modification of the session itself concerns more than the list of applications
+bool
+affects_all(const ObjectChange& session_change)
+{
+  return !session_change.attributes.empty() || session_change.relationships.size() > 1 ||
+         session_change.relationships.front() != applications_relationship;
+}
+
+void
+sort(std::vector<ObjectChange>& changes)
+{
+  std::sort(changes.begin(), changes.end(), [](const ObjectChange& a, const ObjectChange& b) {
+    return std::tie(a.class_name, a.uid) < std::tie(b.class_name, b.uid);
+  });
+}
+
+} // namespace
+
+const ObjectChange*
+ChangeSet::find(const std::string& uid, const std::string& class_name) const noexcept
+{
+  auto it =
+    std::lower_bound(changes.begin(), changes.end(), std::tie(class_name, uid), [](const auto& c, const auto& key) {
+      return std::tie(c.class_name, c.uid) < key;
+    });
+  return (it != changes.end() && it->uid == uid && it->class_name == class_name) ? &*it : nullptr;
+}
+
+ChangeSet
+diff(Configuration& before, Configuration& after, const std::string& session_uid)
+{
+  const SessionGraph old_graph(before, session_uid, true);
+  const SessionGraph new_graph(after, session_uid, true);
+
+  ChangeSet result;
+  std::set<std::string> apps;
+  bool all = false;
+
+  for (const auto& [key, node] : new_graph.nodes()) {
+    auto it = old_graph.nodes().find(key);
+    if (it == old_graph.nodes().end()) {
+      result.changes.push_back({ ObjectChange::Kind::added, node.object.UID(), node.object.class_name(), {}, {} });
+      all |= new_graph.collect(key, apps);
+      continue;
+    }
+
+    auto attributes = changed_names(it->second.data.attributes, node.data.attributes);
+    auto relationships = changed_names(it->second.data.relationships, node.data.relationships);
+    if (attributes.empty() && relationships.empty()) {
+      continue;
+    }
+
+    result.changes.push_back({ ObjectChange::Kind::modified,
+                               node.object.UID(),
+                               node.object.class_name(),
+                               std::move(attributes),
+                               std::move(relationships) });
+    if (key == new_graph.session()) {
+      all |= affects_all(result.changes.back());
+    } else {
+      all |= new_graph.collect(key, apps);
+      all |= old_graph.collect(key, apps);
+    }
+  }
+
+  for (const auto& [key, node] : old_graph.nodes()) {
+    if (new_graph.nodes().count(key) == 0) {
+      result.changes.push_back({ ObjectChange::Kind::removed, node.object.UID(), node.object.class_name(), {}, {} });
+      all |= old_graph.collect(key, apps);
+    }
+  }
+
+  if (all) {
+    apps.insert(old_graph.applications().begin(), old_graph.applications().end());
+    apps.insert(new_graph.applications().begin(), new_graph.applications().end());
+  }
+
+  sort(result.changes);
+  result.applications.assign(apps.begin(), apps.end());
+
+  TLOG_DEBUG(3) << "session " << session_uid << ": " << result.changes.size() << " changed objects affecting "
+                << result.applications.size() << " applications";
+  return result;
+}
+
+ChangeSet
+make_change_set(Configuration& db,
+                const std::string& session_uid,
+                const std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes)
+{
+  const SessionGraph graph(db, session_uid, false);
+
+  ChangeSet result;
+  std::set<std::string> apps;
+  std::unordered_set<std::string> seen;
+  bool all = false;
+
+  auto add = [&](ObjectChange::Kind kind, const std::string& uid, const std::string& class_name) {
+    std::string key = uid + '@' + class_name;
+    if (!seen.insert(key).second) {
+      return;
+    }
+    result.changes.push_back({ kind, uid, class_name, {}, {} });
+    if (kind == ObjectChange::Kind::removed) {
+      if (is_application(db, class_name)) {
+        apps.insert(uid);
+      }
+    } else if (key == graph.session()) {
+      all = true; // modified attributes are not known
+
+    } else {
+      all |= graph.collect(key, apps);
+    }
+  };
+
+  for (const auto* change : changes) {
+    for (const auto& uid : change->get_created_objs()) {
+      add(ObjectChange::Kind::added, uid, change->get_class_name());
+    }
+    for (const auto& uid : change->get_modified_objs()) {
+      add(ObjectChange::Kind::modified, uid, change->get_class_name());
+    }
+    for (const auto& uid : change->get_removed_objs()) {
+      add(ObjectChange::Kind::removed, uid, change->get_class_name());
+    }
+  }
+
+  if (all) {
+    apps.insert(graph.applications().begin(), graph.applications().end());
+  }
+
+  sort(result.changes);
+  result.applications.assign(apps.begin(), apps.end());
+  return result;
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,176 @@
+/**
+ * @file ConfigCacheClient.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigCache.hpp"
+
+#include "dunedaqdal/Issues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dunedaq::dal {
+
+namespace {
+
+/// How long the constructor waits for the server to announce its snapshot
+constexpr int connect_timeout_ms = 10000;
+
+struct Announcement
+{
+  uint64_t generation = 0;
+  std::string path;
+  bool affected = false;
+};
+
+bool
+parse(const std::string& line, Announcement& a)
+{
+  std::istringstream in(line);
+  std::string word;
+  int affected = 0;
+  if (!(in >> word >> a.generation >> a.path >> affected) || word != "snapshot") {
+    return false;
+  }
+  a.affected = affected != 0;
+  return true;
+}
+
+} // namespace
+
+ConfigCacheClient::ConfigCacheClient(const std::string& socket_path, const std::string& application_uid)
+  : m_socket_path(socket_path)
+  , m_application_uid(application_uid)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    throw CacheError(ERS_HERE, socket_path, "socket path too long");
+  }
+  std::strcpy(addr.sun_path, socket_path.c_str());
+
+  m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (m_fd < 0) {
+    throw CacheError(ERS_HERE, socket_path, std::string("socket: ") + std::strerror(errno));
+  }
+
+  try {
+    if (::connect(m_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+      throw CacheError(ERS_HERE, socket_path, std::string("connect: ") + std::strerror(errno));
+    }
+
+    if (!application_uid.empty()) {
+      const std::string msg = "watch " + application_uid + '\n';
+      if (::send(m_fd, msg.data(), msg.size(), MSG_NOSIGNAL) != ssize_t(msg.size())) {
+        throw CacheError(ERS_HERE, socket_path, std::string("send: ") + std::strerror(errno));
+      }
+    }
+
+    std::string line;
+    Announcement a;
+    do {
+      if (!read_line(line, connect_timeout_ms)) {
+        throw CacheError(ERS_HERE, socket_path, "no snapshot announced by the server");
+      }
+    } while (!parse(line, a));
+
+    m_snapshot = std::make_unique<snapshot::Reader>(a.path);
+    m_generation = a.generation;
+  } catch (...) {
+    ::close(m_fd);
+    throw;
+  }
+
+  TLOG_DEBUG(2) << "mapped generation " << m_generation << " of session " << m_snapshot->session() << " from "
+                << socket_path;
+}
+
+ConfigCacheClient::~ConfigCacheClient()
+{
+  ::close(m_fd);
+}
+
+bool
+ConfigCacheClient::poll(int timeout_ms)
+{
+  // only the latest snapshot is mapped, however many were announced meanwhile
+  Announcement latest;
+  bool announced = false, affected = false;
+
+  std::string line;
+  Announcement a;
+  while (read_line(line, timeout_ms)) {
+    timeout_ms = 0;
+    if (parse(line, a) && a.generation > m_generation) {
+      affected |= a.affected;
+      latest = a;
+      announced = true;
+    }
+  }
+
+  if (!announced) {
+    return false;
+  }
+
+  m_snapshot = std::make_unique<snapshot::Reader>(latest.path);
+  m_generation = latest.generation;
+  TLOG_DEBUG(2) << "mapped generation " << m_generation << " from " << m_socket_path;
+  return affected;
+}
+
+const snapshot::ApplicationRecord*
+ConfigCacheClient::application() const noexcept
+{
+  if (m_application_uid.empty()) {
+    return nullptr;
+  }
+  const uint32_t idx = m_snapshot->find_application(m_application_uid);
+  return idx != snapshot::npos ? &m_snapshot->application(idx) : nullptr;
+}
+
+bool
+ConfigCacheClient::read_line(std::string& line, int timeout_ms)
+{
+  size_t eol;
+  while ((eol = m_input.find('\n')) == std::string::npos) {
+    pollfd pfd{ m_fd, POLLIN, 0 };
+    const int n = ::poll(&pfd, 1, timeout_ms);
+    if (n < 0 && errno != EINTR) {
+      throw CacheError(ERS_HERE, m_socket_path, std::string("poll: ") + std::strerror(errno));
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    char buf[1024];
+    const ssize_t got = ::recv(m_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (got == 0) {
+      throw CacheError(ERS_HERE, m_socket_path, "connection closed by the server");
+    }
+    if (got < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        continue;
+      }
+      throw CacheError(ERS_HERE, m_socket_path, std::string("recv: ") + std::strerror(errno));
+    }
+    m_input.append(buf, got);
+  }
+
+  line = m_input.substr(0, eol);
+  m_input.erase(0, eol + 1);
+  return true;
+}
+
+} // namespace dunedaq::dal
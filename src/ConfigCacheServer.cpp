@@ -0,0 +1,316 @@
+/**
+ * @file ConfigCacheServer.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigCache.hpp"
+
+#include "dunedaqdal/ChangeSet.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/SubscriptionCriteria.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dunedaq::dal {
+
+namespace {
+
+/// Longest line a client may send
+constexpr size_t max_line = 4096;
+
+} // namespace
+
+ConfigCacheServer::ConfigCacheServer(dunedaq::oksdbinterfaces::Configuration& db,
+                                     const std::string& session_uid,
+                                     const std::string& socket_path,
+                                     const std::string& snapshot_path)
+  : m_db(db)
+  , m_resolver(db)
+  , m_session_uid(session_uid)
+  , m_socket_path(socket_path)
+  , m_snapshot_path(snapshot_path)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    throw CacheError(ERS_HERE, socket_path, "socket path too long");
+  }
+  std::strcpy(addr.sun_path, socket_path.c_str());
+
+  publish(true, {});
+
+  try {
+    if (::pipe2(m_wake_fd, O_CLOEXEC | O_NONBLOCK) != 0) {
+      throw CacheError(ERS_HERE, socket_path, std::string("pipe: ") + std::strerror(errno));
+    }
+
+    m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_listen_fd < 0) {
+      throw CacheError(ERS_HERE, socket_path, std::string("socket: ") + std::strerror(errno));
+    }
+    ::unlink(socket_path.c_str()); // left behind by a server that did not exit cleanly
+    if (::bind(m_listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(m_listen_fd, SOMAXCONN) != 0) {
+      throw CacheError(ERS_HERE, socket_path, std::strerror(errno));
+    }
+
+    // all changes; those not reaching the session are filtered by make_change_set()
+    m_subscription = m_db.subscribe(dunedaq::oksdbinterfaces::ConfigurationSubscriptionCriteria(), on_change, this);
+  } catch (...) {
+    for (int fd : { m_listen_fd, m_wake_fd[0], m_wake_fd[1] }) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+    throw;
+  }
+
+  TLOG() << "Serving session " << session_uid << " on " << socket_path << ", snapshot " << snapshot_path;
+}
+
+ConfigCacheServer::~ConfigCacheServer()
+{
+  if (m_subscription != nullptr) {
+    m_db.unsubscribe(m_subscription);
+  }
+  for (auto& c : m_clients) {
+    ::close(c.fd);
+  }
+  ::close(m_listen_fd);
+  ::unlink(m_socket_path.c_str());
+  ::close(m_wake_fd[0]);
+  ::close(m_wake_fd[1]);
+}
+
+void
+ConfigCacheServer::run()
+{
+  std::vector<pollfd> fds;
+  while (!m_stop) {
+    fds.clear();
+    fds.push_back({ m_wake_fd[0], POLLIN, 0 });
+    fds.push_back({ m_listen_fd, POLLIN, 0 });
+    for (const auto& c : m_clients) {
+      fds.push_back({ c.fd, POLLIN, 0 });
+    }
+
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw CacheError(ERS_HERE, m_socket_path, std::string("poll: ") + std::strerror(errno));
+    }
+
+    if (fds[0].revents != 0) {
+      char buf[64];
+      while (::read(m_wake_fd[0], buf, sizeof(buf)) > 0) {
+      }
+    }
+    if (m_stop) {
+      break;
+    }
+
+    // the clients polled are the first ones of m_clients, new ones are only appended below
+    for (size_t i = 0; i + 2 < fds.size(); ++i) {
+      if (fds[i + 2].revents != 0 && !read_client(m_clients[i])) {
+        ::close(m_clients[i].fd);
+        m_clients[i].fd = -1;
+      }
+    }
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(), [](const Client& c) { return c.fd < 0; }),
+                    m_clients.end());
+
+    if (fds[1].revents & POLLIN) {
+      accept_client();
+    }
+
+    bool all;
+    std::set<std::string> applications;
+    std::vector<ObjectChange> changes;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_pending) {
+        m_num_clients = m_clients.size();
+        continue;
+      }
+      m_pending = false;
+      all = std::exchange(m_pending_all, false);
+      applications.swap(m_pending_applications);
+      changes.swap(m_pending_changes);
+    }
+
+    try {
+      if (!publish(all, changes)) {
+        continue;
+      }
+    } catch (const ers::Issue& ex) {
+      // keep serving the previous generation
+      ers::error(ex);
+      continue;
+    }
+
+    size_t notified = 0;
+    for (auto& c : m_clients) {
+      const bool affected = all || c.application.empty() || applications.count(c.application) != 0;
+      notified += affected ? 1 : 0;
+      if (!send(c, affected)) {
+        ::close(c.fd);
+        c.fd = -1;
+      }
+    }
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(), [](const Client& c) { return c.fd < 0; }),
+                    m_clients.end());
+    m_num_clients = m_clients.size();
+
+    TLOG() << "Published generation " << m_generation << " of session " << m_session_uid << ", " << notified
+           << " of " << m_clients.size() << " clients affected";
+  }
+}
+
+void
+ConfigCacheServer::stop() noexcept
+{
+  m_stop = true;
+  wake();
+}
+
+void
+ConfigCacheServer::wake() noexcept
+{
+  const char c = 1;
+  // a full pipe already wakes the loop
+  [[maybe_unused]] auto n = ::write(m_wake_fd[1], &c, 1);
+}
+
+void
+ConfigCacheServer::on_change(const std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes, void* self)
+{
+  auto* server = static_cast<ConfigCacheServer*>(self);
+
+  ChangeSet change_set;
+  bool all = false;
+  try {
+    change_set = make_change_set(server->m_db, server->m_session_uid, changes);
+    if (change_set.empty()) {
+      return;
+    }
+  } catch (const ers::Issue& ex) {
+    ers::warning(ex);
+    all = true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(server->m_mutex);
+    server->m_pending = true;
+    server->m_pending_all |= all;
+    server->m_pending_applications.insert(change_set.applications.begin(), change_set.applications.end());
+    server->m_pending_changes.insert(server->m_pending_changes.end(),
+                                     std::make_move_iterator(change_set.changes.begin()),
+                                     std::make_move_iterator(change_set.changes.end()));
+  }
+  server->wake();
+}
+
+bool
+ConfigCacheServer::publish(bool all, const std::vector<ObjectChange>& changes)
+{
+  const auto* session = m_db.get<Session>(m_session_uid);
+  if (session == nullptr) {
+    throw CacheError(ERS_HERE, m_socket_path, "cannot find Session \"" + m_session_uid + '"');
+  }
+
+  if (all || m_hasher == nullptr) {
+    m_hasher = std::make_unique<ConfigHasher>(m_db, m_session_uid);
+  } else {
+    m_hasher->update(changes);
+  }
+  if (m_generation != 0 && m_hasher->session() == m_published) {
+    TLOG_DEBUG(2) << "session " << m_session_uid << " unchanged at " << m_published << ", not republished";
+    return false;
+  }
+
+  snapshot::write(*session, m_resolver, m_snapshot_path, m_hasher.get());
+  m_published = m_hasher->session();
+  ++m_generation;
+  return true;
+}
+
+void
+ConfigCacheServer::accept_client()
+{
+  while (true) {
+    int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        ers::warning(CacheError(ERS_HERE, m_socket_path, std::string("accept: ") + std::strerror(errno)));
+      }
+      return;
+    }
+
+    Client& c = m_clients.emplace_back();
+    c.fd = fd;
+    if (!send(c, true)) {
+      ::close(fd);
+      m_clients.pop_back();
+    }
+    TLOG_DEBUG(2) << "client connected, " << m_clients.size() << " clients";
+  }
+}
+
+bool
+ConfigCacheServer::read_client(Client& client)
+{
+  char buf[1024];
+  while (true) {
+    const ssize_t n = ::recv(client.fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0) {
+      return false;
+    }
+    if (n < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    client.input.append(buf, n);
+
+    size_t eol;
+    while ((eol = client.input.find('\n')) != std::string::npos) {
+      const std::string line = client.input.substr(0, eol);
+      client.input.erase(0, eol + 1);
+      if (line.compare(0, 6, "watch ") == 0) {
+        client.application = line.substr(6);
+      } else {
+        TLOG_DEBUG(2) << "ignoring client request \"" << line << '"';
+      }
+    }
+    if (client.input.size() > max_line) {
+      return false;
+    }
+  }
+}
+
+bool
+ConfigCacheServer::send(Client& client, bool affected)
+{
+  const std::string msg = "snapshot " + std::to_string(m_generation) + ' ' + m_snapshot_path + ' ' +
+                          (affected ? '1' : '0') + '\n';
+  // a short write means the client stopped reading
+  return ::send(client.fd, msg.data(), msg.size(), MSG_NOSIGNAL | MSG_DONTWAIT) == ssize_t(msg.size());
+}
+
+} // namespace dunedaq::dal
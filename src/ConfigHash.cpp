@@ -0,0 +1,619 @@
+/**
+ * @file ConfigHash.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigHash.hpp"
+
+#include "ObjectGraph.hpp"
+#include "ThreadPool.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace dunedaq::dal {
+
+namespace {
+
+using dunedaq::oksdbinterfaces::ConfigObject;
+
+constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+// seeds separating the hashes of single objects, of components and of component members
+constexpr uint64_t object_seed = 0;
+constexpr uint64_t component_seed = 1;
+constexpr uint64_t member_seed = 2;
+
+inline uint64_t
+rotl(uint64_t x, int r) noexcept
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t
+fmix(uint64_t k) noexcept
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+/// MurmurHash3 x64 128
+ConfigHash
+hash_bytes(std::string_view data, uint64_t seed) noexcept
+{
+  constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+  constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+
+  const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+  const size_t n = data.size();
+  uint64_t h1 = seed;
+  uint64_t h2 = seed;
+
+  const size_t blocks = n / 16;
+  for (size_t i = 0; i < blocks; ++i) {
+    uint64_t k1, k2;
+    std::memcpy(&k1, p + i * 16, 8);
+    std::memcpy(&k2, p + i * 16 + 8, 8);
+
+    k1 *= c1;
+    k1 = rotl(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+    h1 = rotl(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2;
+    k2 = rotl(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+    h2 = rotl(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const unsigned char* tail = p + blocks * 16;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  switch (n & 15) {
+    case 15: k2 ^= uint64_t(tail[14]) << 48; [[fallthrough]];
+    case 14: k2 ^= uint64_t(tail[13]) << 40; [[fallthrough]];
+    case 13: k2 ^= uint64_t(tail[12]) << 32; [[fallthrough]];
+    case 12: k2 ^= uint64_t(tail[11]) << 24; [[fallthrough]];
+    case 11: k2 ^= uint64_t(tail[10]) << 16; [[fallthrough]];
+    case 10: k2 ^= uint64_t(tail[9]) << 8; [[fallthrough]];
+    case 9:
+      k2 ^= uint64_t(tail[8]);
+      k2 *= c2;
+      k2 = rotl(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+      [[fallthrough]];
+    case 8: k1 ^= uint64_t(tail[7]) << 56; [[fallthrough]];
+    case 7: k1 ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+    case 6: k1 ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+    case 5: k1 ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+    case 4: k1 ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+    case 3: k1 ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+    case 2: k1 ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+    case 1:
+      k1 ^= uint64_t(tail[0]);
+      k1 *= c1;
+      k1 = rotl(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+  }
+
+  h1 ^= n;
+  h2 ^= n;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  h2 += h1;
+
+  ConfigHash result{ h1, h2 };
+  if (result.empty()) {
+    result.lo = 1; // zero means not computed
+  }
+  return result;
+}
+
+/// Length-prefixed, so that concatenations are unambiguous
+void
+append(std::string& out, std::string_view s)
+{
+  out += std::to_string(s.size());
+  out += ':';
+  out += s;
+}
+
+void
+append(std::string& out, const ConfigHash& hash)
+{
+  out += '#';
+  out.append(reinterpret_cast<const char*>(&hash.hi), sizeof(hash.hi));
+  out.append(reinterpret_cast<const char*>(&hash.lo), sizeof(hash.lo));
+}
+
+void
+erase_one(std::vector<uint32_t>& v, uint32_t value)
+{
+  auto it = std::find(v.begin(), v.end(), value);
+  if (it != v.end()) {
+    *it = v.back();
+    v.pop_back();
+  }
+}
+
+} // namespace
+
+std::string
+ConfigHash::str() const
+{
+  char buf[33];
+  std::snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi),
+                static_cast<unsigned long long>(lo));
+  return buf;
+}
+
+std::ostream&
+operator<<(std::ostream& out, const ConfigHash& hash)
+{
+  return out << hash.str();
+}
+
+ConfigHasher::ConfigHasher(dunedaq::oksdbinterfaces::Configuration& db,
+                           const std::string& session_uid,
+                           unsigned int n_threads)
+  : m_db(db)
+  , m_pool(std::make_unique<detail::ThreadPool>(n_threads))
+{
+  ConfigObject root;
+  m_db.get("Session", session_uid, root);
+  add_node(std::move(root));
+
+  std::vector<uint32_t> added;
+  read({ 0 }, added);
+
+  std::vector<uint32_t> all(m_nodes.size());
+  for (uint32_t i = 0; i < all.size(); ++i) {
+    all[i] = i;
+  }
+  rehash(all);
+
+  TLOG_DEBUG(3) << "hashed " << m_nodes.size() << " objects of session " << session_uid << ": " << session();
+}
+
+ConfigHasher::~ConfigHasher() = default;
+
+const ConfigHash*
+ConfigHasher::find(const std::string& uid, const std::string& class_name) const
+{
+  auto it = m_index.find(uid + '@' + class_name);
+  return it == m_index.end() ? nullptr : &m_nodes[it->second].hash;
+}
+
+const ConfigHash*
+ConfigHasher::application(const std::string& uid) const
+{
+  const Node& session = m_nodes[0];
+  for (size_t r = 0; r < session.relationships.size(); ++r) {
+    if (session.relationships[r] == "applications") {
+      for (auto t : session.targets[r]) {
+        if (m_nodes[t].obj.UID() == uid) {
+          return &m_nodes[t].hash;
+        }
+      }
+    }
+  }
+  return nullptr;
+}
+
+size_t
+ConfigHasher::update(const std::vector<ObjectChange>& changes)
+{
+  std::vector<uint32_t> changed;
+  for (const auto& change : changes) {
+    auto it = m_index.find(change.uid + '@' + change.class_name);
+    if (it == m_index.end()) {
+      continue; // an added object, or one not reachable from the session
+    }
+    const uint32_t n = it->second;
+
+    if (change.kind == ObjectChange::Kind::removed && n != 0) {
+      // the referrers are normally reported as modified too; re-read them anyway so none keeps a stale target
+      Node& node = m_nodes[n];
+      for (auto& targets : node.targets) {
+        for (auto t : targets) {
+          erase_one(m_nodes[t].referrers, n);
+        }
+      }
+      for (auto r : node.referrers) {
+        changed.push_back(r);
+      }
+      node = Node{};
+      node.alive = false;
+      m_index.erase(it);
+    } else {
+      m_db.get(change.class_name, change.uid, m_nodes[n].obj);
+      changed.push_back(n);
+    }
+  }
+
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  changed.erase(std::remove_if(changed.begin(), changed.end(), [this](uint32_t n) { return !m_nodes[n].alive; }),
+                changed.end());
+  if (changed.empty()) {
+    compact();
+    return 0;
+  }
+
+  std::vector<uint32_t> dirty;
+  read(changed, dirty);
+  dirty.insert(dirty.end(), changed.begin(), changed.end());
+
+  // everything the changed objects are reachable from
+  std::vector<bool> marked(m_nodes.size(), false);
+  for (auto n : dirty) {
+    marked[n] = true;
+  }
+  for (size_t i = 0; i < dirty.size(); ++i) {
+    for (auto r : m_nodes[dirty[i]].referrers) {
+      if (!marked[r] && m_nodes[r].alive) {
+        marked[r] = true;
+        dirty.push_back(r);
+      }
+    }
+  }
+
+  collect_garbage();
+  dirty.erase(std::remove_if(dirty.begin(), dirty.end(), [this](uint32_t n) { return !m_nodes[n].alive; }),
+              dirty.end());
+  rehash(dirty);
+  compact();
+
+  TLOG_DEBUG(3) << "rehashed " << dirty.size() << " of " << m_index.size() << " objects after " << changes.size()
+                << " changes: " << session();
+  return dirty.size();
+}
+
+size_t
+ConfigHasher::update(const std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes)
+{
+  std::vector<ObjectChange> result;
+  for (const auto* change : changes) {
+    for (const auto& uid : change->get_created_objs()) {
+      result.push_back({ ObjectChange::Kind::added, uid, change->get_class_name(), {}, {} });
+    }
+    for (const auto& uid : change->get_modified_objs()) {
+      result.push_back({ ObjectChange::Kind::modified, uid, change->get_class_name(), {}, {} });
+    }
+    for (const auto& uid : change->get_removed_objs()) {
+      result.push_back({ ObjectChange::Kind::removed, uid, change->get_class_name(), {}, {} });
+    }
+  }
+  return update(result);
+}
+
+uint32_t
+ConfigHasher::add_node(ConfigObject obj)
+{
+  const uint32_t n = m_nodes.size();
+  Node& node = m_nodes.emplace_back();
+  node.key = obj.full_name();
+  node.obj = std::move(obj);
+  m_index.emplace(node.key, n);
+  return n;
+}
+
+void
+ConfigHasher::read(std::vector<uint32_t> wave, std::vector<uint32_t>& added)
+{
+  while (!wave.empty()) {
+    // the database is read in parallel; the graph is only modified below, by this thread
+    std::vector<detail::ObjectData> data(wave.size());
+    m_pool->parallel_for(wave.size(), [&](size_t i) { data[i] = detail::read_object(m_db, m_nodes[wave[i]].obj); });
+
+    std::vector<uint32_t> next;
+    for (size_t i = 0; i < wave.size(); ++i) {
+      const uint32_t n = wave[i];
+
+      for (auto& targets : m_nodes[n].targets) {
+        for (auto t : targets) {
+          erase_one(m_nodes[t].referrers, n);
+        }
+      }
+
+      std::string content;
+      append(content, m_nodes[n].obj.class_name());
+      append(content, m_nodes[n].obj.UID());
+      for (const auto& [name, value] : data[i].attributes) {
+        append(content, name);
+        append(content, value);
+      }
+
+      std::vector<std::string> relationships;
+      std::vector<std::vector<uint32_t>> targets;
+      for (auto& [name, objects] : data[i].relationships) {
+        relationships.push_back(name);
+        auto& rows = targets.emplace_back();
+        for (auto& obj : objects) {
+          auto it = m_index.find(obj.full_name());
+          uint32_t t;
+          if (it != m_index.end()) {
+            t = it->second;
+          } else {
+            t = add_node(std::move(obj));
+            next.push_back(t);
+            added.push_back(t);
+          }
+          rows.push_back(t);
+          m_nodes[t].referrers.push_back(n);
+        }
+      }
+
+      Node& node = m_nodes[n];
+      node.content = std::move(content);
+      node.relationships = std::move(relationships);
+      node.targets = std::move(targets);
+    }
+    wave = std::move(next);
+  }
+}
+
+void
+ConfigHasher::rehash(const std::vector<uint32_t>& dirty)
+{
+  // strongly connected components of the dirty subgraph; the other objects cannot reach a dirty one
+  std::vector<uint32_t> local(m_nodes.size(), npos);
+  for (uint32_t i = 0; i < dirty.size(); ++i) {
+    local[dirty[i]] = i;
+  }
+
+  const uint32_t n = dirty.size();
+  std::vector<uint32_t> order(n, npos);
+  std::vector<uint32_t> low(n, 0);
+  std::vector<uint32_t> component(n, npos);
+  std::vector<bool> on_stack(n, false);
+  std::vector<uint32_t> stack;
+  std::vector<std::vector<uint32_t>> components; // emitted sinks first
+
+  struct Frame
+  {
+    uint32_t v;
+    size_t r; ///< relationship being followed
+    size_t t; ///< next target within it
+  };
+  std::vector<Frame> frames;
+  uint32_t counter = 0;
+
+  for (uint32_t root = 0; root < n; ++root) {
+    if (order[root] != npos) {
+      continue;
+    }
+    frames.push_back({ root, 0, 0 });
+    order[root] = low[root] = counter++;
+    stack.push_back(root);
+    on_stack[root] = true;
+
+    while (!frames.empty()) {
+      Frame& f = frames.back();
+      const Node& node = m_nodes[dirty[f.v]];
+
+      uint32_t next = npos;
+      while (f.r < node.targets.size() && next == npos) {
+        if (f.t == node.targets[f.r].size()) {
+          ++f.r;
+          f.t = 0;
+          continue;
+        }
+        const uint32_t w = local[node.targets[f.r][f.t++]];
+        if (w == npos) {
+          continue;
+        }
+        if (order[w] == npos) {
+          next = w;
+        } else if (on_stack[w]) {
+          low[f.v] = std::min(low[f.v], order[w]);
+        }
+      }
+
+      if (next != npos) {
+        order[next] = low[next] = counter++;
+        stack.push_back(next);
+        on_stack[next] = true;
+        frames.push_back({ next, 0, 0 });
+        continue;
+      }
+
+      const uint32_t v = f.v;
+      frames.pop_back();
+      if (!frames.empty()) {
+        low[frames.back().v] = std::min(low[frames.back().v], low[v]);
+      }
+      if (low[v] == order[v]) {
+        auto& members = components.emplace_back();
+        uint32_t w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          on_stack[w] = false;
+          component[w] = components.size() - 1;
+          members.push_back(dirty[w]);
+        } while (w != v);
+      }
+    }
+  }
+
+  // a component depends only on components emitted before it; level 0 holds those without dirty targets
+  std::vector<uint32_t> level(components.size(), 0);
+  std::vector<std::vector<uint32_t>> levels(1);
+  for (uint32_t c = 0; c < components.size(); ++c) {
+    for (auto m : components[c]) {
+      for (const auto& targets : m_nodes[m].targets) {
+        for (auto t : targets) {
+          if (local[t] != npos && component[local[t]] != c) {
+            level[c] = std::max(level[c], level[component[local[t]]] + 1);
+          }
+        }
+      }
+    }
+    if (level[c] >= levels.size()) {
+      levels.resize(level[c] + 1);
+    }
+    levels[level[c]].push_back(c);
+  }
+
+  for (const auto& cs : levels) {
+    m_pool->parallel_for(cs.size(), [&](size_t i) { hash_component(components[cs[i]]); });
+  }
+}
+
+void
+ConfigHasher::hash_component(const std::vector<uint32_t>& members)
+{
+  std::vector<uint32_t> sorted(members);
+  std::sort(sorted.begin(), sorted.end());
+  auto in_component = [&sorted](uint32_t t) { return std::binary_search(sorted.begin(), sorted.end(), t); };
+
+  auto encode = [&](const Node& node) {
+    std::string out = node.content;
+    for (size_t r = 0; r < node.relationships.size(); ++r) {
+      append(out, node.relationships[r]);
+      out += std::to_string(node.targets[r].size());
+      for (auto t : node.targets[r]) {
+        if (in_component(t)) {
+          out += '~'; // the member's identity; its hash depends on this one
+          append(out, m_nodes[t].key);
+        } else {
+          append(out, m_nodes[t].hash);
+        }
+      }
+    }
+    return out;
+  };
+
+  if (members.size() == 1) {
+    Node& node = m_nodes[members[0]];
+    bool self = false;
+    for (const auto& targets : node.targets) {
+      self |= std::find(targets.begin(), targets.end(), members[0]) != targets.end();
+    }
+    if (!self) {
+      node.hash = hash_bytes(encode(node), object_seed);
+      return;
+    }
+  }
+
+  // a cycle: hash the members together, in key order so that the result does not depend on where the walk started
+  std::sort(sorted.begin(), sorted.end(), [this](uint32_t a, uint32_t b) { return m_nodes[a].key < m_nodes[b].key; });
+  std::string all;
+  for (auto m : sorted) {
+    append(all, m_nodes[m].key);
+    append(all, encode(m_nodes[m]));
+  }
+  const ConfigHash shared = hash_bytes(all, component_seed);
+
+  for (auto m : members) {
+    std::string own;
+    append(own, shared);
+    append(own, m_nodes[m].key);
+    m_nodes[m].hash = hash_bytes(own, member_seed);
+  }
+}
+
+void
+ConfigHasher::collect_garbage()
+{
+  std::vector<bool> reached(m_nodes.size(), false);
+  std::vector<uint32_t> queue{ 0 };
+  reached[0] = true;
+  for (size_t i = 0; i < queue.size(); ++i) {
+    for (const auto& targets : m_nodes[queue[i]].targets) {
+      for (auto t : targets) {
+        if (!reached[t]) {
+          reached[t] = true;
+          queue.push_back(t);
+        }
+      }
+    }
+  }
+
+  size_t collected = 0;
+  for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+    if (reached[n] || !m_nodes[n].alive) {
+      continue;
+    }
+    for (auto& targets : m_nodes[n].targets) {
+      for (auto t : targets) {
+        erase_one(m_nodes[t].referrers, n);
+      }
+    }
+    m_index.erase(m_nodes[n].key);
+    m_nodes[n] = Node{};
+    m_nodes[n].alive = false;
+    ++collected;
+  }
+  if (collected != 0) {
+    TLOG_DEBUG(5) << "dropped " << collected << " objects no longer reachable from the session";
+  }
+}
+
+void
+ConfigHasher::compact()
+{
+  // dead nodes are only reused by compaction; keep them below half of the live ones so that m_nodes stays bounded
+  const size_t live = m_index.size();
+  if (m_nodes.size() - live <= live / 2) {
+    return;
+  }
+
+  // node order is kept, so the session stays node 0
+  std::vector<uint32_t> remap(m_nodes.size(), npos);
+  uint32_t next = 0;
+  for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+    if (m_nodes[n].alive) {
+      remap[n] = next++;
+    }
+  }
+
+  std::vector<Node> nodes;
+  nodes.reserve(live);
+  m_index.clear();
+  for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+    if (!m_nodes[n].alive) {
+      continue;
+    }
+    Node& node = nodes.emplace_back(std::move(m_nodes[n]));
+    for (auto& targets : node.targets) {
+      for (auto& t : targets) {
+        t = remap[t];
+      }
+    }
+    for (auto& r : node.referrers) {
+      r = remap[r];
+    }
+    m_index.emplace(node.key, remap[n]);
+  }
+
+  TLOG_DEBUG(5) << "compacted " << m_nodes.size() << " nodes to " << nodes.size();
+  m_nodes = std::move(nodes);
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,222 @@
+/**
+ * @file ConnectionResolver.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectionResolver.hpp"
+#include "dunedaqdal/Instrumentation.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace dunedaq::dal {
+
+namespace {
+
+/// Call fn for consecutive slices of at most batch_size elements (all of them for 0)
+template<class T, class F>
+void
+for_each_batch(const std::vector<T>& items, uint32_t batch_size, F fn)
+{
+  const size_t step = batch_size == 0 ? items.size() : batch_size;
+  for (size_t begin = 0; begin < items.size(); begin += step) {
+    auto first = items.begin() + begin;
+    fn(std::vector<T>(first, first + std::min(step, items.size() - begin)));
+  }
+}
+
+} // namespace
+
+ConnectionResolverParameters
+ConnectionResolverParameters::from(const Session& session)
+{
+  ConnectionResolverParameters parameters;
+  parameters.use_connectivity_server = session.get_use_connectivity_server();
+  parameters.batch_size = session.get_connectivity_batch_size();
+  parameters.cache_ttl = std::chrono::milliseconds(session.get_connectivity_cache_ttl_ms());
+  return parameters;
+}
+
+ConnectionResolver::ConnectionResolver(ConnectivityBackend& backend,
+                                       const Session& session,
+                                       const DaqApplication& application)
+  : ConnectionResolver(backend, application, ConnectionResolverParameters::from(session))
+{
+}
+
+ConnectionResolver::ConnectionResolver(ConnectivityBackend& backend,
+                                       const DaqApplication& application,
+                                       const ConnectionResolverParameters& parameters)
+  : m_backend(backend)
+  , m_parameters(parameters)
+{
+  DUNEDAQDAL_PROFILE_SCOPE("connectivity", application.UID());
+  std::unordered_map<const NetworkConnection*, bool> binds;
+  std::vector<const NetworkConnection*> order;
+
+  for (const auto* module : application.get_modules()) {
+    for (bool output : { false, true }) {
+      for (const auto* connection : output ? module->get_outputs() : module->get_inputs()) {
+        const auto* nc = connection->cast<NetworkConnection>();
+        if (nc == nullptr) {
+          continue;
+        }
+        const bool pub_sub = connection_type(*nc) == ConnectionType::pub_sub;
+        auto [it, added] = binds.try_emplace(nc, false);
+        if (added) {
+          order.push_back(nc);
+        }
+        it->second = it->second || pub_sub == output;
+      }
+    }
+  }
+
+  for (const auto* nc : order) {
+    const bool bound = binds[nc];
+    (bound ? m_bound : m_connected).push_back(nc);
+
+    CacheEntry& entry = m_cache[nc->UID()];
+    if (bound || !m_parameters.use_connectivity_server) {
+      entry.uri = nc->get_uri();
+      entry.expires = Clock::time_point::max();
+      entry.known = true;
+    }
+  }
+
+  TLOG_DEBUG(3) << "application " << application.UID() << " binds " << m_bound.size() << " and connects to "
+                << m_connected.size() << " network connections";
+}
+
+void
+ConnectionResolver::publish()
+{
+  if (!m_parameters.use_connectivity_server || m_bound.empty()) {
+    return;
+  }
+
+  std::vector<ConnectionEntry> entries;
+  entries.reserve(m_bound.size());
+  for (const auto* nc : m_bound) {
+    entries.push_back({ nc->UID(), nc->get_uri() });
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for_each_batch(entries, m_parameters.batch_size, [this](const std::vector<ConnectionEntry>& batch) {
+    DUNEDAQDAL_PROFILE_SCOPE("connectivity", "publish of " + std::to_string(batch.size()) + " connections");
+    m_backend.publish(batch);
+    ++m_statistics.publish_requests;
+  });
+}
+
+size_t
+ConnectionResolver::refresh(Clock::time_point now)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return refresh_locked(now, nullptr);
+}
+
+size_t
+ConnectionResolver::refresh(ConnectionType type, Clock::time_point now)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return refresh_locked(now, &type);
+}
+
+size_t
+ConnectionResolver::refresh_locked(Clock::time_point now, const ConnectionType* type)
+{
+  std::vector<std::string> stale;
+  for (const auto* nc : m_connected) {
+    if (type != nullptr && connection_type(*nc) != *type) {
+      continue;
+    }
+    const CacheEntry& entry = m_cache[nc->UID()];
+    if (!entry.known || entry.expires <= now) {
+      stale.push_back(nc->UID());
+    }
+  }
+  if (stale.empty()) {
+    return 0;
+  }
+
+  std::unordered_set<std::string> found;
+  for_each_batch(stale, m_parameters.batch_size, [&](const std::vector<std::string>& batch) {
+    DUNEDAQDAL_PROFILE_SCOPE("connectivity", "lookup of " + std::to_string(batch.size()) + " connections");
+    ++m_statistics.lookup_requests;
+    for (auto& result : m_backend.lookup(batch)) {
+      auto it = m_cache.find(result.uid);
+      if (it != m_cache.end()) {
+        it->second.uri = std::move(result.uri);
+        it->second.expires = now + m_parameters.cache_ttl;
+        it->second.known = true;
+        found.insert(it->first);
+      }
+    }
+  });
+
+  size_t unknown = 0;
+  for (const auto& uid : stale) {
+    if (found.count(uid) == 0) {
+      m_cache[uid].known = false; // never or no longer published
+      ++unknown;
+    }
+  }
+
+  TLOG_DEBUG(5) << "looked up " << stale.size() << " connections, " << unknown << " unknown";
+  return unknown;
+}
+
+std::optional<std::string>
+ConnectionResolver::uri(const std::string& connection_uid, Clock::time_point now)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_cache.find(connection_uid);
+  if (it == m_cache.end()) {
+    return std::nullopt;
+  }
+  if (it->second.known && it->second.expires > now) {
+    ++m_statistics.hits;
+    DUNEDAQDAL_COUNT(NetworkConnection::s_class_name, cache_hits);
+    return it->second.uri;
+  }
+
+  DUNEDAQDAL_PROFILE_SCOPE("connectivity", connection_uid);
+  ++m_statistics.misses;
+  DUNEDAQDAL_COUNT(NetworkConnection::s_class_name, cache_misses);
+  refresh_locked(now, nullptr);
+  if (it->second.known) {
+    return it->second.uri;
+  }
+  return std::nullopt;
+}
+
+void
+ConnectionResolver::invalidate(const std::string& connection_uid)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_cache.find(connection_uid);
+  if (it != m_cache.end() && it->second.expires != Clock::time_point::max()) {
+    it->second.known = false;
+  }
+}
+
+ConnectionResolver::Statistics
+ConnectionResolver::statistics() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,155 @@
+/**
+ * @file ConnectivityIndex.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Instrumentation.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+
+namespace dunedaq::dal {
+
+namespace {
+
+/// Whether the row starting at first, the last one of values, already holds value; rows are short
+bool
+contains(const std::vector<uint32_t>& values, uint32_t first, uint32_t value)
+{
+  return std::find(values.begin() + first, values.end(), value) != values.end();
+}
+
+} // namespace
+
+ConnectivityIndex::ConnectivityIndex(const Session& session)
+{
+  DUNEDAQDAL_PROFILE_SCOPE("index", session.UID());
+  m_module_offsets.push_back(0);
+  m_input_offsets.push_back(0);
+  m_output_offsets.push_back(0);
+
+  auto connection_id = [this](const Connection* c) {
+    auto [it, inserted] = m_connection_ids.emplace(c->UID(), m_connections.size());
+    if (inserted) {
+      m_connections.push_back(c);
+    }
+    return it->second;
+  };
+
+  DUNEDAQDAL_COUNT(session.class_name(), traversals);
+  for (const auto* app : session.get_applications()) {
+    const auto* daq_app = app->cast<DaqApplication>();
+    if (daq_app == nullptr || !m_application_ids.emplace(daq_app->UID(), m_applications.size()).second) {
+      continue;
+    }
+
+    const uint32_t app_idx = m_applications.size();
+    m_applications.push_back(daq_app);
+
+    DUNEDAQDAL_COUNT(app->class_name(), traversals);
+    for (const auto* mod : daq_app->get_modules()) {
+      auto [it, inserted] = m_module_ids.emplace(mod->UID(), m_modules.size());
+      // a module listed twice in the application is one row
+      if (inserted || !contains(m_application_modules, m_module_offsets.back(), it->second)) {
+        m_application_modules.push_back(it->second);
+      }
+      if (!inserted) {
+        continue;
+      }
+
+      m_modules.push_back(mod);
+      m_module_application.push_back(app_idx);
+
+      DUNEDAQDAL_COUNT(mod->class_name(), traversals);
+      for (const auto* c : mod->get_inputs()) {
+        const uint32_t id = connection_id(c);
+        if (!contains(m_inputs, m_input_offsets.back(), id)) {
+          m_inputs.push_back(id);
+        }
+      }
+      m_input_offsets.push_back(m_inputs.size());
+
+      DUNEDAQDAL_COUNT(mod->class_name(), traversals);
+      for (const auto* c : mod->get_outputs()) {
+        const uint32_t id = connection_id(c);
+        if (!contains(m_outputs, m_output_offsets.back(), id)) {
+          m_outputs.push_back(id);
+        }
+      }
+      m_output_offsets.push_back(m_outputs.size());
+    }
+
+    m_module_offsets.push_back(m_application_modules.size());
+  }
+
+  invert(m_output_offsets, m_outputs, m_connections.size(), m_producer_offsets, m_producers);
+  invert(m_input_offsets, m_inputs, m_connections.size(), m_consumer_offsets, m_consumers);
+
+  TLOG_DEBUG(5) << "indexed session " << session.UID() << ": " << m_applications.size() << " applications, "
+                << m_modules.size() << " modules, " << m_connections.size() << " connections";
+}
+
+void
+ConnectivityIndex::invert(const std::vector<uint32_t>& offsets,
+                          const std::vector<uint32_t>& values,
+                          size_t num_targets,
+                          std::vector<uint32_t>& reverse_offsets,
+                          std::vector<uint32_t>& reverse_values)
+{
+  // counting sort of the (source, target) pairs by target
+  reverse_offsets.assign(num_targets + 1, 0);
+  for (auto target : values) {
+    ++reverse_offsets[target + 1];
+  }
+  for (size_t i = 1; i <= num_targets; ++i) {
+    reverse_offsets[i] += reverse_offsets[i - 1];
+  }
+
+  reverse_values.resize(values.size());
+  std::vector<uint32_t> fill(reverse_offsets.begin(), reverse_offsets.end() - 1);
+  for (uint32_t source = 0; source + 1 < offsets.size(); ++source) {
+    for (uint32_t i = offsets[source]; i < offsets[source + 1]; ++i) {
+      reverse_values[fill[values[i]]++] = source;
+    }
+  }
+}
+
+std::vector<const DaqModule*>
+ConnectivityIndex::producers(const std::string& connection_uid) const
+{
+  std::vector<const DaqModule*> result;
+  auto idx = connection_index(connection_uid);
+  if (idx != npos) {
+    for (auto m : producers(idx)) {
+      result.push_back(m_modules[m]);
+    }
+  }
+  return result;
+}
+
+std::vector<const DaqModule*>
+ConnectivityIndex::consumers(const std::string& connection_uid) const
+{
+  std::vector<const DaqModule*> result;
+  auto idx = connection_index(connection_uid);
+  if (idx != npos) {
+    for (auto m : consumers(idx)) {
+      result.push_back(m_modules[m]);
+    }
+  }
+  return result;
+}
+
+} // namespace dunedaq::dal
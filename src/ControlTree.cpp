@@ -0,0 +1,308 @@
+/**
+ * @file ControlTree.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ControlTree.hpp"
+#include "dunedaqdal/Instrumentation.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <sstream>
+
+namespace dunedaq::dal {
+
+std::string
+ControlTreeIssue::message() const
+{
+  std::ostringstream s;
+  switch (kind) {
+    case Kind::controlled_twice: s << "controlled by"; break;
+    case Kind::uncontrolled: s << "not controlled by any RCApplication"; break;
+    case Kind::not_in_session: s << "not part of the session but controlled by"; break;
+    case Kind::cycle: s << "not below the root: its controllers form a cycle"; break;
+  }
+  for (size_t i = 0; i < controllers.size(); ++i) {
+    s << (i == 0 ? " " : ", ") << controllers[i];
+  }
+  return s.str();
+}
+
+ControlTree::ControlTree(const Session& session)
+{
+  for (const auto* app : session.get_applications()) {
+    if (m_ids.emplace(app->UID(), m_applications.size()).second) {
+      m_applications.push_back(app);
+    }
+  }
+  const size_t n = m_applications.size();
+
+  // controllers of each application, in session order
+  std::vector<std::vector<uint32_t>> controllers(n);
+  std::unordered_map<std::string, size_t> foreign;
+  for (uint32_t i = 0; i < n; ++i) {
+    const auto* rc = m_applications[i]->cast<RCApplication>();
+    if (rc == nullptr) {
+      continue;
+    }
+    DUNEDAQDAL_COUNT(rc->class_name(), traversals);
+    for (const auto* app : rc->get_ApplicationsControlled()) {
+      const uint32_t j = index(app->UID());
+      if (j == npos) {
+        auto [it, inserted] = foreign.emplace(app->UID(), m_issues.size());
+        if (inserted) {
+          m_issues.push_back({ ControlTreeIssue::Kind::not_in_session, app->UID(), {} });
+        }
+        m_issues[it->second].controllers.push_back(rc->UID());
+      } else if (controllers[j].empty() || controllers[j].back() != i) {
+        controllers[j].push_back(i);
+      }
+    }
+  }
+
+  m_parent.assign(n, npos);
+  for (uint32_t j = 0; j < n; ++j) {
+    if (!controllers[j].empty()) {
+      m_parent[j] = controllers[j].front();
+    }
+    if (controllers[j].size() > 1) {
+      ControlTreeIssue issue{ ControlTreeIssue::Kind::controlled_twice, m_applications[j]->UID(), {} };
+      for (uint32_t c : controllers[j]) {
+        issue.controllers.push_back(m_applications[c]->UID());
+      }
+      m_issues.push_back(std::move(issue));
+    }
+  }
+
+  m_child_offsets.push_back(0);
+  for (uint32_t i = 0; i < n; ++i) {
+    if (const auto* rc = m_applications[i]->cast<RCApplication>()) {
+      const size_t first = m_children.size();
+      for (const auto* app : rc->get_ApplicationsControlled()) {
+        const uint32_t j = index(app->UID());
+        if (j != npos && m_parent[j] == i &&
+            std::find(m_children.begin() + first, m_children.end(), j) == m_children.end()) {
+          m_children.push_back(j);
+        }
+      }
+    }
+    m_child_offsets.push_back(m_children.size());
+  }
+
+  // breadth-first from every uncontrolled application; what is left hangs off a cycle
+  std::vector<uint32_t> order, root_of(n, npos);
+  m_depth.assign(n, npos);
+  for (uint32_t i = 0; i < n; ++i) {
+    if (m_parent[i] == npos) {
+      root_of[i] = i;
+      m_depth[i] = 0;
+      order.push_back(i);
+    }
+  }
+  for (size_t k = 0; k < order.size(); ++k) {
+    for (uint32_t c : children(order[k])) {
+      root_of[c] = root_of[order[k]];
+      m_depth[c] = m_depth[order[k]] + 1;
+      order.push_back(c);
+    }
+  }
+
+  m_subtree_size.assign(n, 1);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    if (m_parent[*it] != npos) {
+      m_subtree_size[m_parent[*it]] += m_subtree_size[*it];
+    }
+  }
+
+  for (uint32_t i = 0; i < n; ++i) {
+    if (m_parent[i] == npos && m_applications[i]->cast<RCApplication>() != nullptr &&
+        (m_root == npos || m_subtree_size[i] > m_subtree_size[m_root])) {
+      m_root = i;
+    }
+  }
+
+  for (uint32_t i = 0; i < n; ++i) {
+    if (root_of[i] == npos) {
+      m_issues.push_back({ ControlTreeIssue::Kind::cycle, m_applications[i]->UID(), {} });
+    } else if (m_parent[i] == npos && i != m_root) {
+      m_issues.push_back({ ControlTreeIssue::Kind::uncontrolled, m_applications[i]->UID(), {} });
+    }
+    if (root_of[i] != m_root || m_root == npos) {
+      m_depth[i] = npos;
+    } else {
+      m_height = std::max<size_t>(m_height, m_depth[i] + 1);
+    }
+  }
+
+  TLOG_DEBUG(3) << "control tree of session " << session.UID() << ": " << n << " applications, height " << m_height
+                << ", " << m_issues.size() << " issues";
+}
+
+uint32_t
+ControlTree::index(const std::string& uid) const noexcept
+{
+  auto it = m_ids.find(uid);
+  return it == m_ids.end() ? npos : it->second;
+}
+
+FanOutStatistics
+ControlTree::fan_out() const
+{
+  FanOutStatistics stats;
+  size_t total = 0;
+  stats.min = std::numeric_limits<size_t>::max();
+  for (uint32_t i = 0; i < size(); ++i) {
+    const size_t k = children(i).size();
+    if (k != 0) {
+      ++stats.controllers;
+      total += k;
+      stats.min = std::min(stats.min, k);
+      stats.max = std::max(stats.max, k);
+    }
+  }
+  if (stats.controllers == 0) {
+    stats.min = 0;
+  } else {
+    stats.mean = static_cast<double>(total) / stats.controllers;
+  }
+  return stats;
+}
+
+ControlTreeProposal
+propose_balanced_tree(const Session& session, unsigned int fan_out, const std::string& new_prefix)
+{
+  const ControlTree tree(session);
+
+  ControlTreeProposal proposal;
+  proposal.fan_out = std::max(fan_out, 2u);
+
+  // leaves depth-first from the root, then everything else; controllers breadth-first
+  std::vector<std::string> leaves, existing;
+  std::vector<bool> seen(tree.size(), false);
+  auto visit = [&](uint32_t start) {
+    std::vector<uint32_t> stack{ start };
+    while (!stack.empty()) {
+      const uint32_t i = stack.back();
+      stack.pop_back();
+      if (seen[i]) {
+        continue;
+      }
+      seen[i] = true;
+      if (tree.application(i)->cast<RCApplication>() == nullptr) {
+        leaves.push_back(tree.application(i)->UID());
+      }
+      const auto children = tree.children(i);
+      for (size_t c = children.size(); c-- > 0;) {
+        stack.push_back(children[c]);
+      }
+    }
+  };
+  if (tree.root() != ControlTree::npos) {
+    visit(tree.root());
+  }
+  for (uint32_t i = 0; i < tree.size(); ++i) {
+    visit(i);
+  }
+
+  std::vector<uint32_t> order;
+  std::vector<bool> queued(tree.size(), false);
+  auto breadth_first = [&](uint32_t start) {
+    if (queued[start]) {
+      return;
+    }
+    queued[start] = true;
+    order.push_back(start);
+    for (size_t k = order.size() - 1; k < order.size(); ++k) {
+      for (uint32_t c : tree.children(order[k])) {
+        if (!queued[c]) {
+          queued[c] = true;
+          order.push_back(c);
+        }
+      }
+    }
+  };
+  if (tree.root() != ControlTree::npos) {
+    breadth_first(tree.root());
+  }
+  for (uint32_t i = 0; i < tree.size(); ++i) {
+    breadth_first(i);
+  }
+  for (uint32_t i : order) {
+    if (tree.application(i)->cast<RCApplication>() != nullptr) {
+      existing.push_back(tree.application(i)->UID());
+    }
+  }
+
+  proposal.leaves = leaves.size();
+  if (leaves.empty()) {
+    return proposal;
+  }
+
+  // controllers per level, top-down: 1, ..., ceil(leaves / fan_out)
+  std::vector<size_t> counts;
+  for (size_t m = leaves.size(); counts.empty() || m > 1;) {
+    m = (m + proposal.fan_out - 1) / proposal.fan_out;
+    counts.push_back(m);
+  }
+  std::reverse(counts.begin(), counts.end());
+  proposal.height = counts.size();
+
+  // a new name taken by an application, of the session or not, or by an earlier new name gets a suffix
+  auto& db = session.configuration();
+  std::set<std::string> generated;
+  auto unused = [&](const std::string& name) {
+    std::string uid = name;
+    for (unsigned int n = 2; tree.index(uid) != ControlTree::npos || generated.count(uid) != 0 ||
+                             db.test_object(Application::s_class_name, uid);
+         ++n) {
+      uid = name + '-' + std::to_string(n);
+    }
+    generated.insert(uid);
+    return uid;
+  };
+
+  size_t reused = 0;
+  std::vector<std::vector<size_t>> levels(counts.size());
+  for (size_t l = 0; l < counts.size(); ++l) {
+    for (size_t j = 0; j < counts[l]; ++j) {
+      ProposedController c;
+      c.existing = reused < existing.size();
+      c.uid = c.existing ? existing[reused++] : unused(new_prefix + std::to_string(l) + '-' + std::to_string(j));
+      levels[l].push_back(proposal.controllers.size());
+      proposal.controllers.push_back(std::move(c));
+    }
+  }
+
+  // split the next level, or the leaves, evenly between the controllers of each level
+  for (size_t l = 0; l < counts.size(); ++l) {
+    const size_t items = l + 1 < counts.size() ? counts[l + 1] : leaves.size();
+    for (size_t j = 0; j < counts[l]; ++j) {
+      auto& c = proposal.controllers[levels[l][j]];
+      for (size_t k = items * j / counts[l]; k < items * (j + 1) / counts[l]; ++k) {
+        if (l + 1 < counts.size()) {
+          auto& child = proposal.controllers[levels[l + 1][k]];
+          child.parent = c.uid;
+          c.children.push_back(child.uid);
+        } else {
+          c.children.push_back(leaves[k]);
+        }
+      }
+    }
+  }
+
+  return proposal;
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,557 @@
+/**
+ * @file DataflowSimulator.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/DataflowSimulator.hpp"
+
+#include "ThreadPool.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace dunedaq::dal {
+
+ServiceModels
+read_service_models(const std::string& path)
+{
+  std::ifstream in(path);
+  if (!in) {
+    throw BadServiceModel(ERS_HERE, path, "cannot open file");
+  }
+
+  ServiceModels models;
+  std::string line;
+  for (size_t n = 1; std::getline(in, line); ++n) {
+    std::istringstream fields(line);
+    std::string plugin;
+    ServiceModel model;
+    if (!(fields >> plugin) || plugin[0] == '#') {
+      continue;
+    }
+    if (!(fields >> model.mean_us) || model.mean_us <= 0) {
+      throw BadServiceModel(ERS_HERE, path, "bad service time on line " + std::to_string(n));
+    }
+    if (!(fields >> model.cv)) {
+      model.cv = 1.;
+    } else if (model.cv < 0) {
+      throw BadServiceModel(ERS_HERE, path, "bad coefficient of variation on line " + std::to_string(n));
+    }
+    models[plugin] = model;
+  }
+  return models;
+}
+
+namespace {
+
+/**
+ * A buffer read by some of the consumers of a connection: all of them when
+ * they share its messages, a single one when each receives a copy.
+ */
+struct Channel
+{
+  uint32_t capacity = 0;
+  double latency_s = 0;
+  bool drop_when_full = false;
+  std::vector<uint32_t> consumers;
+};
+
+struct SimModule
+{
+  std::vector<uint32_t> inputs;  ///< channels
+  std::vector<uint32_t> outputs; ///< connections
+  double mean_s = 0;
+  double cv = 0;
+};
+
+/// What the replications simulate, copied out of the DAL objects
+struct Topology
+{
+  std::vector<SimModule> modules;
+  std::vector<std::vector<uint32_t>> connection_channels; ///< empty for a connection nothing reads
+  std::vector<Channel> channels;
+};
+
+Topology
+make_topology(const ConnectivityIndex& index,
+              const ServiceModels& models,
+              const SimulationParameters& parameters,
+              const DataTypeRegistry& data_types,
+              std::vector<std::string>& unknown_plugins)
+{
+  Topology topo;
+  topo.connection_channels.resize(index.num_connections());
+
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* conn = index.connection(c);
+    const auto consumers = index.consumers(c);
+    if (consumers.empty()) {
+      continue;
+    }
+
+    Channel channel;
+    bool copy_per_consumer = false;
+    if (const auto* q = conn->cast<Queue>()) {
+      channel.capacity = q->get_capacity();
+      auto it = parameters.queue_latency_us.find(q->get_queue_type());
+      if (it != parameters.queue_latency_us.end()) {
+        channel.latency_s = it->second * 1e-6;
+      }
+    } else if (const auto* shm = conn->cast<SharedMemoryConnection>()) {
+      channel.capacity = shm->get_slot_count();
+      copy_per_consumer = shm->get_consumer_mode() == "kMultiConsumer";
+    } else {
+      channel.capacity = parameters.network_buffer;
+      channel.latency_s = parameters.network_latency_us * 1e-6;
+      auto it = data_types.find(conn->get_data_type());
+      if (it != data_types.end() && parameters.link_gbps > 0) {
+        channel.latency_s += it->second.payload_size * 8 / (parameters.link_gbps * 1e9);
+      }
+      if (const auto* nc = conn->cast<NetworkConnection>()) {
+        copy_per_consumer = channel.drop_when_full = nc->get_connection_type() == "kPubSub";
+      }
+    }
+    // a capacity of 0 would block the producers forever
+    channel.capacity = std::max<uint32_t>(channel.capacity, 1);
+
+    auto& ids = topo.connection_channels[c];
+    if (copy_per_consumer) {
+      for (auto m : consumers) {
+        ids.push_back(topo.channels.size());
+        topo.channels.push_back(channel);
+        topo.channels.back().consumers.push_back(m);
+      }
+    } else {
+      ids.push_back(topo.channels.size());
+      channel.consumers.assign(consumers.begin(), consumers.end());
+      topo.channels.push_back(std::move(channel));
+    }
+  }
+
+  std::set<std::string> unknown;
+  topo.modules.resize(index.num_modules());
+  for (uint32_t m = 0; m < index.num_modules(); ++m) {
+    auto& mod = topo.modules[m];
+    const std::string& plugin = index.module(m)->get_plugin();
+    auto it = models.find(plugin);
+    const ServiceModel* model = &parameters.default_model;
+    if (it != models.end()) {
+      model = &it->second;
+    } else {
+      unknown.insert(plugin);
+    }
+    mod.mean_s = model->mean_us * 1e-6;
+    mod.cv = model->cv;
+
+    for (auto c : index.inputs(m)) {
+      for (auto ch : topo.connection_channels[c]) {
+        const auto& readers = topo.channels[ch].consumers;
+        if (std::find(readers.begin(), readers.end(), m) != readers.end()) {
+          mod.inputs.push_back(ch);
+        }
+      }
+    }
+    mod.outputs.assign(index.outputs(m).begin(), index.outputs(m).end());
+  }
+
+  unknown_plugins.assign(unknown.begin(), unknown.end());
+  return topo;
+}
+
+/// Statistics of one replication, before averaging
+struct RunStatistics
+{
+  std::vector<ModuleStatistics> modules;
+  std::vector<ConnectionStatistics> connections;
+  uint64_t events = 0;
+};
+
+/// One replication: an event loop over the topology with its own random numbers
+class Replication
+{
+public:
+  Replication(const Topology& topo, const SimulationParameters& parameters, uint64_t seed)
+    : m_topo(topo)
+    , m_warmup(std::clamp(parameters.warmup_s, 0., parameters.duration_s))
+    , m_end(parameters.duration_s)
+    , m_rng(seed)
+    , m_modules(topo.modules.size())
+    , m_channels(topo.channels.size())
+    , m_sent(topo.connection_channels.size(), 0)
+  {
+    m_service.reserve(topo.modules.size());
+    for (const auto& mod : topo.modules) {
+      // gamma with shape 1/cv^2 and scale mean*cv^2; cv 0 is handled in service_time()
+      const double cv2 = std::max(mod.cv * mod.cv, 1e-12);
+      m_service.emplace_back(1. / cv2, mod.mean_s * cv2);
+    }
+  }
+
+  RunStatistics run()
+  {
+    for (uint32_t m = 0; m < m_modules.size(); ++m) {
+      retry(m);
+    }
+
+    uint64_t events = 0;
+    while (!m_events.empty() && m_events.top().t <= m_end) {
+      const Event e = m_events.top();
+      m_events.pop();
+      m_now = e.t;
+      ++events;
+      switch (e.kind) {
+        case Event::done: done(e.index); break;
+        case Event::arrival: arrive(e.index); break;
+        case Event::retry: wake(e.index); break;
+      }
+    }
+
+    m_now = m_end;
+    for (uint32_t m = 0; m < m_modules.size(); ++m) {
+      set_state(m, m_modules[m].state);
+    }
+    for (uint32_t ch = 0; ch < m_channels.size(); ++ch) {
+      change_occupancy(ch, 0);
+    }
+    return statistics(events);
+  }
+
+private:
+  enum class State
+  {
+    starved,
+    busy,
+    blocked
+  };
+
+  struct ModuleState
+  {
+    State state = State::starved;
+    double since = 0;
+    double time[3] = { 0, 0, 0 }; ///< per State
+    uint64_t handled = 0;
+    size_t next_input = 0;
+    bool retry_pending = false;
+  };
+
+  struct ChannelState
+  {
+    uint32_t occupancy = 0; ///< messages sent and not yet received, including those in flight
+    uint32_t available = 0; ///< messages which can be received
+    uint32_t max_occupancy = 0;
+    double since = 0;
+    double area = 0;
+    double full_time = 0;
+    uint64_t dropped = 0;
+    std::vector<uint32_t> blocked; ///< producers waiting for room
+  };
+
+  struct Event
+  {
+    enum Kind : uint8_t
+    {
+      done,    ///< module finished handling a message
+      arrival, ///< message reaches the channel
+      retry    ///< module looks again for input or room
+    };
+
+    double t;
+    uint64_t seq; ///< keeps simultaneous events in order of scheduling, for reproducibility
+    Kind kind;
+    uint32_t index;
+
+    bool operator>(const Event& other) const noexcept { return t > other.t || (t == other.t && seq > other.seq); }
+  };
+
+  void schedule(double t, Event::Kind kind, uint32_t index) { m_events.push(Event{ t, m_seq++, kind, index }); }
+
+  /// Length of [from, m_now] within the measurement
+  double measured(double from) const noexcept { return std::max(0., m_now - std::max(from, m_warmup)); }
+  bool measuring() const noexcept { return m_now >= m_warmup; }
+
+  void set_state(uint32_t m, State state)
+  {
+    auto& ms = m_modules[m];
+    ms.time[static_cast<int>(ms.state)] += measured(ms.since);
+    ms.since = m_now;
+    ms.state = state;
+  }
+
+  void change_occupancy(uint32_t ch, int delta)
+  {
+    auto& cs = m_channels[ch];
+    const double dt = measured(cs.since);
+    cs.area += cs.occupancy * dt;
+    if (cs.occupancy >= m_topo.channels[ch].capacity) {
+      cs.full_time += dt;
+    }
+    cs.since = m_now;
+    if (measuring()) {
+      cs.max_occupancy = std::max(cs.max_occupancy, cs.occupancy);
+    }
+    cs.occupancy += delta;
+  }
+
+  double service_time(uint32_t m)
+  {
+    const auto& mod = m_topo.modules[m];
+    return mod.cv <= 0 ? mod.mean_s : m_service[m](m_rng);
+  }
+
+  void retry(uint32_t m)
+  {
+    if (!m_modules[m].retry_pending) {
+      m_modules[m].retry_pending = true;
+      schedule(m_now, Event::retry, m);
+    }
+  }
+
+  void wake(uint32_t m)
+  {
+    m_modules[m].retry_pending = false;
+    if (m_modules[m].state == State::starved) {
+      receive(m);
+    } else if (m_modules[m].state == State::blocked) {
+      send(m);
+    }
+  }
+
+  /// Take the next message, from the inputs in turn, and start handling it
+  void receive(uint32_t m)
+  {
+    const auto& inputs = m_topo.modules[m].inputs;
+    auto& ms = m_modules[m];
+    if (!inputs.empty()) {
+      size_t k = 0;
+      while (k < inputs.size() && m_channels[inputs[(ms.next_input + k) % inputs.size()]].available == 0) {
+        ++k;
+      }
+      if (k == inputs.size()) {
+        set_state(m, State::starved);
+        return;
+      }
+      const uint32_t ch = inputs[(ms.next_input + k) % inputs.size()];
+      ms.next_input = (ms.next_input + k + 1) % inputs.size();
+      --m_channels[ch].available;
+      change_occupancy(ch, -1);
+      for (auto producer : m_channels[ch].blocked) {
+        retry(producer);
+      }
+      m_channels[ch].blocked.clear();
+    } else if (m_topo.modules[m].outputs.empty()) {
+      // neither receives nor sends: nothing to simulate
+      set_state(m, State::starved);
+      return;
+    }
+    set_state(m, State::busy);
+    schedule(m_now + service_time(m), Event::done, m);
+  }
+
+  void done(uint32_t m)
+  {
+    if (measuring()) {
+      ++m_modules[m].handled;
+    }
+    send(m);
+  }
+
+  /// Send the message handled on every output, or wait for the first full channel that must not drop it
+  void send(uint32_t m)
+  {
+    const auto& outputs = m_topo.modules[m].outputs;
+    for (auto c : outputs) {
+      for (auto ch : m_topo.connection_channels[c]) {
+        const auto& channel = m_topo.channels[ch];
+        if (!channel.drop_when_full && m_channels[ch].occupancy >= channel.capacity) {
+          set_state(m, State::blocked);
+          m_channels[ch].blocked.push_back(m);
+          return;
+        }
+      }
+    }
+
+    for (auto c : outputs) {
+      if (measuring()) {
+        ++m_sent[c];
+      }
+      for (auto ch : m_topo.connection_channels[c]) {
+        const auto& channel = m_topo.channels[ch];
+        if (m_channels[ch].occupancy >= channel.capacity) {
+          if (measuring()) {
+            ++m_channels[ch].dropped;
+          }
+          continue;
+        }
+        change_occupancy(ch, 1);
+        if (channel.latency_s > 0) {
+          schedule(m_now + channel.latency_s, Event::arrival, ch);
+        } else {
+          arrive(ch);
+        }
+      }
+    }
+    receive(m);
+  }
+
+  void arrive(uint32_t ch)
+  {
+    ++m_channels[ch].available;
+    for (auto consumer : m_topo.channels[ch].consumers) {
+      if (m_modules[consumer].state == State::starved) {
+        retry(consumer);
+      }
+    }
+  }
+
+  RunStatistics statistics(uint64_t events) const
+  {
+    const double span = m_end - m_warmup;
+    const double scale = span > 0 ? 1. / span : 0.;
+
+    RunStatistics s;
+    s.events = events;
+    s.modules.resize(m_modules.size());
+    for (size_t m = 0; m < m_modules.size(); ++m) {
+      const auto& ms = m_modules[m];
+      auto& out = s.modules[m];
+      out.throughput_hz = ms.handled * scale;
+      out.starved = ms.time[static_cast<int>(State::starved)] * scale;
+      out.busy = ms.time[static_cast<int>(State::busy)] * scale;
+      out.blocked = ms.time[static_cast<int>(State::blocked)] * scale;
+    }
+
+    s.connections.resize(m_sent.size());
+    for (size_t c = 0; c < m_sent.size(); ++c) {
+      auto& out = s.connections[c];
+      out.throughput_hz = m_sent[c] * scale;
+      for (auto ch : m_topo.connection_channels[c]) {
+        const auto& cs = m_channels[ch];
+        out.capacity = m_topo.channels[ch].capacity;
+        out.dropped_hz += cs.dropped * scale;
+        out.mean_occupancy = std::max(out.mean_occupancy, cs.area * scale);
+        out.max_occupancy = std::max(out.max_occupancy, cs.max_occupancy);
+        out.full = std::max(out.full, cs.full_time * scale);
+      }
+    }
+    return s;
+  }
+
+  const Topology& m_topo;
+  const double m_warmup;
+  const double m_end;
+
+  std::mt19937_64 m_rng;
+  std::vector<std::gamma_distribution<double>> m_service;
+
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+  uint64_t m_seq = 0;
+  double m_now = 0;
+
+  std::vector<ModuleState> m_modules;
+  std::vector<ChannelState> m_channels;
+  std::vector<uint64_t> m_sent; ///< per connection
+};
+
+} // namespace
+
+SimulationResult
+simulate(const ConnectivityIndex& index,
+         const ServiceModels& models,
+         const SimulationParameters& parameters,
+         const DataTypeRegistry& data_types)
+{
+  SimulationResult result;
+  const Topology topo = make_topology(index, models, parameters, data_types, result.unknown_plugins);
+
+  const unsigned int n = std::max(parameters.replications, 1u);
+  std::vector<RunStatistics> runs(n);
+  {
+    const unsigned int n_threads =
+      parameters.n_threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : parameters.n_threads;
+    detail::ThreadPool pool(std::min(n_threads, n));
+    pool.parallel_for(n, [&](size_t r) {
+      std::seed_seq seed{ parameters.seed, static_cast<uint64_t>(r) };
+      std::mt19937_64 rng(seed);
+      runs[r] = Replication(topo, parameters, rng()).run();
+    });
+  }
+
+  result.simulated_s = std::max(0., parameters.duration_s - parameters.warmup_s);
+  result.modules.resize(topo.modules.size());
+  result.connections.resize(topo.connection_channels.size());
+  for (const auto& run : runs) {
+    result.events += run.events;
+    for (size_t m = 0; m < run.modules.size(); ++m) {
+      auto& out = result.modules[m];
+      out.throughput_hz += run.modules[m].throughput_hz / n;
+      out.busy += run.modules[m].busy / n;
+      out.blocked += run.modules[m].blocked / n;
+      out.starved += run.modules[m].starved / n;
+    }
+    for (size_t c = 0; c < run.connections.size(); ++c) {
+      auto& out = result.connections[c];
+      const auto& in = run.connections[c];
+      out.capacity = in.capacity;
+      out.throughput_hz += in.throughput_hz / n;
+      out.dropped_hz += in.dropped_hz / n;
+      out.mean_occupancy += in.mean_occupancy / n;
+      out.max_occupancy = std::max(out.max_occupancy, in.max_occupancy);
+      out.full += in.full / n;
+    }
+  }
+  if (n > 1) {
+    for (size_t m = 0; m < result.modules.size(); ++m) {
+      double variance = 0;
+      for (const auto& run : runs) {
+        const double d = run.modules[m].throughput_hz - result.modules[m].throughput_hz;
+        variance += d * d / (n - 1);
+      }
+      result.modules[m].throughput_error = std::sqrt(variance / n);
+    }
+  }
+
+  for (uint32_t c = 0; c < result.connections.size(); ++c) {
+    if (result.connections[c].full >= parameters.backpressure_threshold && result.connections[c].full > 0) {
+      result.backpressure.push_back(c);
+    }
+  }
+  std::stable_sort(result.backpressure.begin(), result.backpressure.end(), [&](uint32_t a, uint32_t b) {
+    return result.connections[a].full > result.connections[b].full;
+  });
+
+  result.bottleneck = ConnectivityIndex::npos;
+  if (!result.modules.empty()) {
+    auto busiest = std::max_element(result.modules.begin(), result.modules.end(), [](const auto& a, const auto& b) {
+      return a.busy < b.busy;
+    });
+    result.bottleneck = busiest - result.modules.begin();
+  }
+
+  TLOG_DEBUG(3) << "simulated " << n << " x " << result.simulated_s << " s of " << topo.modules.size()
+                << " modules and " << topo.channels.size() << " channels: " << result.events << " events, "
+                << result.backpressure.size() << " back-pressure points";
+  return result;
+}
+
+} // namespace dunedaq::dal
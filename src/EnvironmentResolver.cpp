@@ -0,0 +1,220 @@
+/**
+ * @file EnvironmentResolver.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/EnvironmentResolver.hpp"
+#include "dunedaqdal/Instrumentation.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Parameter.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/Variable.hpp"
+#include "dunedaqdal/VariableSet.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+
+namespace dunedaq::dal {
+
+EnvironmentResolver::EnvironmentResolver(dunedaq::oksdbinterfaces::Configuration& db)
+  : m_db(db)
+{
+  m_db.add_action(this);
+}
+
+EnvironmentResolver::~EnvironmentResolver()
+{
+  m_db.remove_action(this);
+}
+
+std::shared_ptr<const InternedEnvironment>
+EnvironmentResolver::get(const VariableSet& set)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::string> stack;
+  return resolve(set, stack);
+}
+
+Environment
+EnvironmentResolver::get(const std::vector<const Parameter*>& parameters)
+{
+  InternedEnvironment env;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::string> stack;
+  add(parameters, env, nullptr, stack);
+  return copy(env);
+}
+
+Environment
+EnvironmentResolver::get(const Session& session, const Application& application)
+{
+  DUNEDAQDAL_PROFILE_SCOPE("resolve", session.UID() + '/' + application.UID());
+  InternedEnvironment env;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::string> stack;
+  add(session.get_ProcessEnvironment(), env, nullptr, stack);
+  add(application.get_ApplicationEnvironment(), env, nullptr, stack);
+  return copy(env);
+}
+
+Environment
+EnvironmentResolver::copy(const InternedEnvironment& env)
+{
+  Environment result;
+  for (const auto& [name, value] : env) {
+    result.emplace_hint(result.end(), name, value);
+  }
+  return result;
+}
+
+std::shared_ptr<const InternedEnvironment>
+EnvironmentResolver::resolve(const VariableSet& set, std::vector<std::string>& stack)
+{
+  auto it = m_cache.find(set.UID());
+  if (it != m_cache.end()) {
+    DUNEDAQDAL_COUNT(set.class_name(), cache_hits);
+    return it->second;
+  }
+  DUNEDAQDAL_COUNT(set.class_name(), cache_misses);
+
+  if (std::find(stack.begin(), stack.end(), set.UID()) != stack.end()) {
+    std::string path;
+    for (const auto& uid : stack) {
+      path += uid + " -> ";
+    }
+    path += set.UID();
+    throw CircularDependency(ERS_HERE, set.full_name(), path);
+  }
+
+  DUNEDAQDAL_PROFILE_SCOPE("resolve", set.full_name());
+  stack.push_back(set.UID());
+  // the environment keeps the pool of its strings alive beyond a clear()
+  std::shared_ptr<InternedEnvironment> env(new InternedEnvironment, [pool = m_strings](InternedEnvironment* e) {
+    delete e;
+  });
+  DUNEDAQDAL_COUNT(set.class_name(), traversals);
+  add(set.get_Contains(), *env, &set.UID(), stack);
+  stack.pop_back();
+
+  TLOG_DEBUG(5) << "resolved " << env->size() << " variables of " << set.full_name();
+
+  m_cache[set.UID()] = env;
+  return env;
+}
+
+void
+EnvironmentResolver::add(const std::vector<const Parameter*>& parameters,
+                         InternedEnvironment& env,
+                         const std::string* parent,
+                         std::vector<std::string>& stack)
+{
+  for (const auto* parameter : parameters) {
+    if (parent != nullptr) {
+      m_parents[parameter->UID()].insert(*parent);
+    }
+
+    if (const auto* var = parameter->cast<Variable>()) {
+      env[m_strings->intern(var->get_Name())] = m_strings->intern(var->get_Value());
+    } else if (const auto* set = parameter->cast<VariableSet>()) {
+      for (const auto& [name, value] : *resolve(*set, stack)) {
+        env[name] = value;
+      }
+    }
+  }
+}
+
+void
+EnvironmentResolver::invalidate(const std::string& uid)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  invalidate_nolock(uid);
+}
+
+void
+EnvironmentResolver::invalidate_nolock(const std::string& uid)
+{
+  // walk up the containment edges; a set already dropped needs no second visit
+  std::vector<std::string> pending{ uid };
+  std::unordered_set<std::string> visited;
+
+  while (!pending.empty()) {
+    std::string current = std::move(pending.back());
+    pending.pop_back();
+
+    if (!visited.insert(current).second) {
+      continue;
+    }
+
+    m_cache.erase(current);
+
+    auto parents = m_parents.find(current);
+    if (parents != m_parents.end()) {
+      pending.insert(pending.end(), parents->second.begin(), parents->second.end());
+    }
+  }
+}
+
+void
+EnvironmentResolver::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_cache.clear();
+  m_parents.clear();
+  m_strings = std::make_shared<StringPool>();
+}
+
+size_t
+EnvironmentResolver::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cache.size();
+}
+
+std::shared_ptr<const StringPool>
+EnvironmentResolver::strings() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_strings;
+}
+
+void
+EnvironmentResolver::notify(std::vector<dunedaq::oksdbinterfaces::ConfigurationChange*>& changes) noexcept
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto* change : changes) {
+    for (const auto& uid : change->get_modified_objs()) {
+      invalidate_nolock(uid);
+    }
+    for (const auto& uid : change->get_removed_objs()) {
+      invalidate_nolock(uid);
+      m_parents.erase(uid);
+    }
+  }
+}
+
+void
+EnvironmentResolver::load() noexcept
+{
+  clear();
+}
+
+void
+EnvironmentResolver::unload() noexcept
+{
+  clear();
+}
+
+void
+EnvironmentResolver::update(const dunedaq::oksdbinterfaces::ConfigObject& obj, const std::string& /*name*/) noexcept
+{
+  invalidate(obj.UID());
+}
+
+} // namespace dunedaq::dal
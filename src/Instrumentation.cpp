@@ -0,0 +1,199 @@
+/**
+ * @file Instrumentation.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Instrumentation.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace dunedaq::dal::instrumentation {
+
+namespace detail {
+
+std::atomic<bool> g_enabled{ std::getenv("DUNEDAQDAL_INSTRUMENTATION") != nullptr };
+
+} // namespace detail
+
+namespace {
+
+using Table = std::array<std::array<std::atomic<uint64_t>, num_counters>, max_classes>;
+using Totals = std::array<std::array<uint64_t, num_counters>, max_classes>;
+
+const char* const counter_names[] = { "instantiations", "cache_hits", "cache_misses", "traversals" };
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::string> names; ///< by slot; the last slot is shared by all further classes
+  std::vector<const Table*> threads;
+  Totals retired{}; ///< counts of exited threads
+};
+
+/// Never destroyed, so that threads exiting during static destruction can still fold their counts
+Registry&
+registry()
+{
+  static Registry* r = new Registry;
+  return *r;
+}
+
+struct ThreadTable
+{
+  Table table{};
+
+  ThreadTable()
+  {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().threads.push_back(&table);
+  }
+
+  ~ThreadTable()
+  {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t s = 0; s < max_classes; ++s) {
+      for (size_t c = 0; c < num_counters; ++c) {
+        r.retired[s][c] += table[s][c].load(std::memory_order_relaxed);
+      }
+    }
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &table));
+  }
+};
+
+Table&
+local_table()
+{
+  thread_local ThreadTable t;
+  return t.table;
+}
+
+size_t
+registered_slot(const std::string& class_name)
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  auto it = std::find(r.names.begin(), r.names.end(), class_name);
+  if (it != r.names.end()) {
+    return it - r.names.begin();
+  }
+  if (r.names.size() < max_classes - 1) {
+    r.names.push_back(class_name);
+    return r.names.size() - 1;
+  }
+  if (r.names.size() == max_classes - 1) {
+    r.names.push_back("other");
+  }
+  return max_classes - 1;
+}
+
+} // namespace
+
+size_t
+detail::class_slot(const std::string& class_name)
+{
+  // the copy of the name catches an address reused for another class, e.g. after a schema reload
+  struct Entry
+  {
+    std::string name;
+    size_t slot;
+  };
+  thread_local std::unordered_map<const std::string*, Entry> slots;
+
+  auto it = slots.find(&class_name);
+  if (it != slots.end() && it->second.name == class_name) {
+    return it->second.slot;
+  }
+  const size_t slot = registered_slot(class_name);
+  slots[&class_name] = Entry{ class_name, slot };
+  return slot;
+}
+
+void
+detail::record(size_t slot, Counter counter, uint64_t n) noexcept
+{
+  local_table()[slot][static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+
+void
+enable(bool on) noexcept
+{
+  detail::g_enabled.store(on, std::memory_order_relaxed);
+}
+
+std::vector<ClassCounters>
+collect()
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  std::vector<ClassCounters> result(r.names.size());
+  for (size_t s = 0; s < result.size(); ++s) {
+    result[s].class_name = r.names[s];
+    result[s].counts = r.retired[s];
+    for (const auto* table : r.threads) {
+      for (size_t c = 0; c < num_counters; ++c) {
+        result[s].counts[c] += (*table)[s][c].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::sort(result.begin(), result.end(), [](const ClassCounters& a, const ClassCounters& b) {
+    return a.class_name < b.class_name;
+  });
+  return result;
+}
+
+void
+reset()
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.retired = Totals{};
+  for (const auto* table : r.threads) {
+    for (auto& slot : const_cast<Table&>(*table)) {
+      for (auto& counter : slot) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+void
+dump(std::ostream& out)
+{
+  out << std::left << std::setw(24) << "class";
+  for (const char* name : counter_names) {
+    out << std::right << std::setw(16) << name;
+  }
+  out << '\n';
+
+  for (const auto& cls : collect()) {
+    out << std::left << std::setw(24) << cls.class_name;
+    for (auto count : cls.counts) {
+      out << std::right << std::setw(16) << count;
+    }
+    out << '\n';
+  }
+}
+
+void
+log()
+{
+  std::ostringstream out;
+  dump(out);
+  TLOG() << "DAL access counters:\n" << out.str();
+}
+
+} // namespace dunedaq::dal::instrumentation
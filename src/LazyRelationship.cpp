@@ -0,0 +1,24 @@
+/**
+ * @file LazyRelationship.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/LazyRelationship.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Session.hpp"
+
+namespace dunedaq::dal {
+
+LazyRelationship<Application>
+lazy_applications(dunedaq::oksdbinterfaces::Configuration& db, const std::string& session_uid, size_t page_size)
+{
+  dunedaq::oksdbinterfaces::ConfigObject session;
+  db.get(Session::s_class_name, session_uid, session);
+  return LazyRelationship<Application>(db, std::move(session), "applications", page_size);
+}
+
+} // namespace dunedaq::dal
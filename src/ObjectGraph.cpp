@@ -0,0 +1,147 @@
+/**
+ * @file ObjectGraph.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "ObjectGraph.hpp"
+
+#include "oksdbinterfaces/Schema.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <unordered_set>
+
+namespace dunedaq::dal::detail {
+
+namespace {
+
+using dunedaq::oksdbinterfaces::ConfigObject;
+
+template<class T>
+void
+put(std::ostringstream& out, const T& value)
+{
+  if constexpr (std::is_same_v<T, std::string>) {
+    out << value.size() << ':' << value;
+  } else if constexpr (sizeof(T) == 1 && !std::is_same_v<T, bool>) {
+    out << static_cast<int>(value); // int8_t/uint8_t are characters to streams
+  } else {
+    out.precision(17);
+    out << value;
+  }
+}
+
+template<class T>
+std::string
+encode(ConfigObject& obj, const dunedaq::oksdbinterfaces::attribute_t& attr)
+{
+  std::ostringstream out;
+  if (attr.p_is_multi_value) {
+    std::vector<T> values;
+    obj.get(attr.p_name, values);
+    out << '[' << values.size() << ']';
+    for (const auto& v : values) {
+      put(out, static_cast<T>(v));
+      out << ';';
+    }
+  } else {
+    T value{};
+    obj.get(attr.p_name, value);
+    put(out, value);
+  }
+  return out.str();
+}
+
+std::string
+encode_attribute(ConfigObject& obj, const dunedaq::oksdbinterfaces::attribute_t& attr)
+{
+  using namespace dunedaq::oksdbinterfaces;
+
+  switch (attr.p_type) {
+    case bool_type: return encode<bool>(obj, attr);
+    case s8_type: return encode<int8_t>(obj, attr);
+    case u8_type: return encode<uint8_t>(obj, attr);
+    case s16_type: return encode<int16_t>(obj, attr);
+    case u16_type: return encode<uint16_t>(obj, attr);
+    case s32_type: return encode<int32_t>(obj, attr);
+    case u32_type: return encode<uint32_t>(obj, attr);
+    case s64_type: return encode<int64_t>(obj, attr);
+    case u64_type: return encode<uint64_t>(obj, attr);
+    case float_type: return encode<float>(obj, attr);
+    case double_type: return encode<double>(obj, attr);
+    default: return encode<std::string>(obj, attr); // string, enum, date, time, class
+  }
+}
+
+std::vector<ConfigObject>
+targets(ConfigObject& obj, const dunedaq::oksdbinterfaces::relationship_t& rel)
+{
+  using namespace dunedaq::oksdbinterfaces;
+
+  std::vector<ConfigObject> result;
+  if (rel.p_cardinality == zero_or_many || rel.p_cardinality == one_or_many) {
+    obj.get(rel.p_name, result);
+  } else {
+    ConfigObject target;
+    obj.get(rel.p_name, target);
+    if (!target.is_null()) {
+      result.push_back(target);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+ObjectData
+read_object(dunedaq::oksdbinterfaces::Configuration& db, ConfigObject& obj, bool with_attributes)
+{
+  const auto& info = db.get_class_info(obj.class_name());
+
+  ObjectData data;
+  if (with_attributes) {
+    data.attributes.reserve(info.p_attributes.size());
+    for (const auto& attr : info.p_attributes) {
+      data.attributes.emplace_back(attr.p_name, encode_attribute(obj, attr));
+    }
+  }
+
+  data.relationships.reserve(info.p_relationships.size());
+  for (const auto& rel : info.p_relationships) {
+    data.relationships.emplace_back(rel.p_name, targets(obj, rel));
+  }
+  return data;
+}
+
+std::vector<ConfigObject>
+read_references(dunedaq::oksdbinterfaces::Configuration& db, ConfigObject& obj)
+{
+  std::vector<ConfigObject> result;
+  for (const auto& rel : db.get_class_info(obj.class_name()).p_relationships) {
+    for (auto& target : targets(obj, rel)) {
+      result.push_back(std::move(target));
+    }
+  }
+  return result;
+}
+
+std::vector<ConfigObject>
+reachable(dunedaq::oksdbinterfaces::Configuration& db, const ConfigObject& root)
+{
+  std::vector<ConfigObject> result{ root };
+  std::unordered_set<std::string> seen{ root.full_name() };
+
+  for (size_t i = 0; i < result.size(); ++i) {
+    for (auto& target : read_references(db, result[i])) {
+      if (seen.insert(target.full_name()).second) {
+        result.push_back(std::move(target));
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace dunedaq::dal::detail
@@ -0,0 +1,56 @@
+/**
+ * @file ObjectGraph.hpp
+ *
+ * Schema-driven access to the attributes and relationships of arbitrary
+ * configuration objects, used by the algorithms which must treat every
+ * class alike (diff, hashing).
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_SRC_OBJECTGRAPH_HPP_
+#define DUNEDAQDAL_SRC_OBJECTGRAPH_HPP_
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dal::detail {
+
+/// Values of one object, in schema order
+struct ObjectData
+{
+  /// attribute name -> canonical encoding of its value(s)
+  std::vector<std::pair<std::string, std::string>> attributes;
+
+  /// relationship name -> targets in relationship order
+  std::vector<std::pair<std::string, std::vector<dunedaq::oksdbinterfaces::ConfigObject>>> relationships;
+};
+
+/**
+ * Read all attributes and relationships of the object as described by the
+ * schema of its class. Values are encoded unambiguously: multi-value
+ * attributes as a count followed by length-prefixed items. Attributes are
+ * skipped when with_attributes is false.
+ */
+ObjectData
+read_object(dunedaq::oksdbinterfaces::Configuration& db,
+            dunedaq::oksdbinterfaces::ConfigObject& obj,
+            bool with_attributes = true);
+
+/// Relationship targets only
+std::vector<dunedaq::oksdbinterfaces::ConfigObject>
+read_references(dunedaq::oksdbinterfaces::Configuration& db, dunedaq::oksdbinterfaces::ConfigObject& obj);
+
+/// Root and every object reachable from it through relationships, in breadth-first order
+std::vector<dunedaq::oksdbinterfaces::ConfigObject>
+reachable(dunedaq::oksdbinterfaces::Configuration& db, const dunedaq::oksdbinterfaces::ConfigObject& root);
+
+} // namespace dunedaq::dal::detail
+
+#endif // DUNEDAQDAL_SRC_OBJECTGRAPH_HPP_
@@ -0,0 +1,258 @@
+/**
+ * @file Placement.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Placement.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/ProcessPlacement.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+namespace dunedaq::dal {
+
+namespace {
+
+// far above any real machine, but keeps a typo such as "0-4000000000" from exhausting memory
+constexpr uint32_t max_cpu = 1 << 16;
+
+uint32_t
+parse_cpu(const std::string& list, const std::string& token)
+{
+  if (token.empty() || !std::all_of(token.begin(), token.end(), [](unsigned char c) { return std::isdigit(c); })) {
+    throw BadCpuList(ERS_HERE, list, "\"" + token + "\" is not a cpu number");
+  }
+  if (token.size() > 6 || std::stoul(token) >= max_cpu) {
+    throw BadCpuList(ERS_HERE, list, "cpu " + token + " is out of range");
+  }
+  return std::stoul(token);
+}
+
+std::string
+trim(const std::string& s)
+{
+  auto begin = s.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return {};
+  }
+  return s.substr(begin, s.find_last_not_of(" \t") - begin + 1);
+}
+
+} // namespace
+
+CpuSet
+parse_cpu_list(const std::string& list)
+{
+  CpuSet cpus;
+  std::istringstream in(list);
+  std::string item;
+
+  while (std::getline(in, item, ',')) {
+    item = trim(item);
+    if (item.empty()) {
+      if (in.eof() && cpus.empty()) {
+        break; // an empty list
+      }
+      throw BadCpuList(ERS_HERE, list, "empty item");
+    }
+
+    const auto dash = item.find('-');
+    const uint32_t first = parse_cpu(list, trim(item.substr(0, dash)));
+    const uint32_t last = dash == std::string::npos ? first : parse_cpu(list, trim(item.substr(dash + 1)));
+    if (last < first) {
+      throw BadCpuList(ERS_HERE, list, "decreasing range " + item);
+    }
+    for (uint32_t cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+std::string
+format_cpu_list(const CpuSet& cpus)
+{
+  std::string result;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    if (!result.empty()) {
+      result += ',';
+    }
+    result += std::to_string(cpus[i]);
+    if (j != i) {
+      result += '-' + std::to_string(cpus[j]);
+    }
+    i = j + 1;
+  }
+  return result;
+}
+
+CpuSet
+intersection(const CpuSet& a, const CpuSet& b)
+{
+  CpuSet result;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+  return result;
+}
+
+std::string
+PlacementIssue::message() const
+{
+  std::ostringstream s;
+  switch (kind) {
+    case Kind::bad_cpu_list:
+      s << "bad cpu list in " << object << ": " << other;
+      break;
+    case Kind::overlapping_cpus:
+      s << "applications " << object << " and " << other << " on host " << host << " are both pinned to cpus "
+        << format_cpu_list(cpus);
+      break;
+    case Kind::overlapping_module:
+      s << "thread affinity of module " << object << " on host " << host << " shares cpus " << format_cpu_list(cpus)
+        << " with " << other;
+      break;
+    case Kind::module_outside_app:
+      s << "thread affinity of module " << object << " uses cpus " << format_cpu_list(cpus)
+        << " outside the cpu_set of application " << other;
+      break;
+    case Kind::outside_host:
+      s << object << " uses cpus " << format_cpu_list(cpus) << " that host " << host << " does not have";
+      break;
+    case Kind::missing_numa_nodes:
+      s << "placement " << object << " has a binding memory policy but no numa_nodes";
+      break;
+  }
+  return s.str();
+}
+
+std::vector<PlacementIssue>
+check_placement(const Session& session, const HostCpus& host_cpus)
+{
+  std::vector<PlacementIssue> issues;
+
+  auto cpus_of = [&issues](const std::string& list, const std::string& owner, const std::string& host, CpuSet& cpus) {
+    try {
+      cpus = parse_cpu_list(list);
+      return true;
+    } catch (const BadCpuList& ex) {
+      issues.push_back({ PlacementIssue::Kind::bad_cpu_list, host, owner, ex.what(), {} });
+      return false;
+    }
+  };
+
+  auto check_host = [&issues, &host_cpus](const CpuSet& cpus, const std::string& owner, const std::string& host) {
+    auto available = host_cpus.find(host);
+    if (available == host_cpus.end()) {
+      return;
+    }
+    CpuSet missing;
+    std::set_difference(
+      cpus.begin(), cpus.end(), available->second.begin(), available->second.end(), std::back_inserter(missing));
+    if (!missing.empty()) {
+      issues.push_back({ PlacementIssue::Kind::outside_host, host, owner, {}, missing });
+    }
+  };
+
+  /// CPUs reserved by an application, or by one of the modules of an unpinned application
+  struct Pinned
+  {
+    const DaqApplication* app;
+    const DaqModule* module; ///< nullptr for the cpu_set of the application
+    CpuSet cpus;
+  };
+  std::map<std::string, std::vector<Pinned>> hosts;
+
+  for (const auto* a : session.get_applications()) {
+    const auto* app = a->cast<DaqApplication>();
+    if (app == nullptr) {
+      continue;
+    }
+
+    CpuSet app_cpus;
+    if (const auto* placement = app->get_placement()) {
+      if (placement->get_memory_policy() != "kDefault" && placement->get_numa_nodes().empty()) {
+        issues.push_back({ PlacementIssue::Kind::missing_numa_nodes, app->get_host(), placement->UID(), {}, {} });
+      }
+      if (cpus_of(placement->get_cpu_set(), placement->UID(), app->get_host(), app_cpus) && !app_cpus.empty()) {
+        check_host(app_cpus, placement->UID(), app->get_host());
+        hosts[app->get_host()].push_back({ app, nullptr, app_cpus });
+      }
+    }
+
+    for (const auto* mod : app->get_modules()) {
+      CpuSet mod_cpus;
+      if (!cpus_of(mod->get_thread_affinity(), mod->UID(), app->get_host(), mod_cpus) || mod_cpus.empty()) {
+        continue;
+      }
+      if (app_cpus.empty()) {
+        check_host(mod_cpus, mod->UID(), app->get_host());
+        hosts[app->get_host()].push_back({ app, mod, mod_cpus });
+        continue;
+      }
+      CpuSet outside;
+      std::set_difference(
+        mod_cpus.begin(), mod_cpus.end(), app_cpus.begin(), app_cpus.end(), std::back_inserter(outside));
+      if (!outside.empty()) {
+        issues.push_back(
+          { PlacementIssue::Kind::module_outside_app, app->get_host(), mod->UID(), app->UID(), outside });
+      }
+    }
+  }
+
+  for (const auto& [host, pinned] : hosts) {
+    // cpu -> every entry pinned to it; overlaps collected per pair of entries of different applications
+    std::unordered_map<uint32_t, std::vector<size_t>> owners;
+    std::map<std::pair<size_t, size_t>, CpuSet> overlaps;
+
+    for (size_t i = 0; i < pinned.size(); ++i) {
+      for (auto cpu : pinned[i].cpus) {
+        auto& list = owners[cpu];
+        for (auto j : list) {
+          if (pinned[j].app != pinned[i].app) {
+            overlaps[{ j, i }].push_back(cpu);
+          }
+        }
+        list.push_back(i);
+      }
+    }
+
+    for (const auto& [pair, cpus] : overlaps) {
+      const auto& first = pinned[pair.first];
+      const auto& second = pinned[pair.second];
+      if (first.module == nullptr && second.module == nullptr) {
+        issues.push_back({ PlacementIssue::Kind::overlapping_cpus, host, first.app->UID(), second.app->UID(), cpus });
+        continue;
+      }
+      const auto& mod = second.module != nullptr ? second : first;
+      const auto& other = second.module != nullptr ? first : second;
+      issues.push_back({ PlacementIssue::Kind::overlapping_module,
+                         host,
+                         mod.module->UID(),
+                         other.module != nullptr ? "module " + other.module->UID() : "application " + other.app->UID(),
+                         cpus });
+    }
+  }
+
+  return issues;
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,474 @@
+/**
+ * @file PlacementOptimizer.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/PlacementOptimizer.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Placement.hpp"
+#include "dunedaqdal/ResourceEstimator.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Host.hpp"
+#include "dunedaqdal/ProcessPlacement.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/ConfigObject.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace dunedaq::dal {
+
+bool
+HostAssignment::changed() const
+{
+  return application->get_host() != host;
+}
+
+namespace {
+
+constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+constexpr double unlimited = std::numeric_limits<double>::infinity();
+
+using Adjacency = std::vector<std::unordered_map<uint32_t, double>>;
+
+/// Application graph of one level; vertex weights are CPUs and bytes of memory
+struct Graph
+{
+  std::vector<double> cpus;
+  std::vector<double> memory;
+  std::vector<std::vector<std::pair<uint32_t, double>>> edges;
+
+  size_t size() const noexcept { return cpus.size(); }
+
+  void set_edges(const Adjacency& adjacency)
+  {
+    edges.assign(adjacency.size(), {});
+    for (size_t v = 0; v < adjacency.size(); ++v) {
+      edges[v].assign(adjacency[v].begin(), adjacency[v].end());
+      std::sort(edges[v].begin(), edges[v].end());
+    }
+  }
+};
+
+void
+add_edge(Adjacency& adjacency, uint32_t a, uint32_t b, double weight)
+{
+  if (a != b) {
+    adjacency[a][b] += weight;
+    adjacency[b][a] += weight;
+  }
+}
+
+struct Capacity
+{
+  double cpus = unlimited;
+  double memory = unlimited;
+};
+
+/// Heavy-edge matching: every vertex is merged with its heaviest unmatched neighbour that still fits a host
+Graph
+coarsen(const Graph& fine, const Capacity& largest, std::vector<uint32_t>& map)
+{
+  std::vector<uint32_t> order(fine.size());
+  std::iota(order.begin(), order.end(), 0);
+  // vertices with few neighbours first, so that they still find a partner
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return fine.edges[a].size() < fine.edges[b].size();
+  });
+
+  map.assign(fine.size(), npos);
+  uint32_t next = 0;
+  for (uint32_t v : order) {
+    if (map[v] != npos) {
+      continue;
+    }
+    uint32_t best = npos;
+    double best_weight = 0;
+    for (const auto& [u, w] : fine.edges[v]) {
+      if (map[u] == npos && w > best_weight && fine.cpus[v] + fine.cpus[u] <= largest.cpus &&
+          fine.memory[v] + fine.memory[u] <= largest.memory) {
+        best = u;
+        best_weight = w;
+      }
+    }
+    map[v] = next;
+    if (best != npos) {
+      map[best] = next;
+    }
+    ++next;
+  }
+
+  Graph coarse;
+  coarse.cpus.assign(next, 0);
+  coarse.memory.assign(next, 0);
+  Adjacency adjacency(next);
+  for (uint32_t v = 0; v < fine.size(); ++v) {
+    coarse.cpus[map[v]] += fine.cpus[v];
+    coarse.memory[map[v]] += fine.memory[v];
+    for (const auto& [u, w] : fine.edges[v]) {
+      if (v < u) {
+        add_edge(adjacency, map[v], map[u], w);
+      }
+    }
+  }
+  coarse.set_edges(adjacency);
+  return coarse;
+}
+
+/// Assignment of the vertices of one level to hosts, with the load of each host
+class Partition
+{
+public:
+  /// Moves respect the limits; the capacity only decides whether a host is overloaded
+  Partition(const std::vector<Capacity>& capacity, const std::vector<Capacity>& limits)
+    : m_capacity(capacity)
+    , m_limits(limits)
+    , m_cpus(capacity.size(), 0)
+    , m_memory(capacity.size(), 0)
+  {
+  }
+
+  size_t hosts() const noexcept { return m_capacity.size(); }
+  std::vector<uint32_t>& part() noexcept { return m_part; }
+
+  bool fits(uint32_t host, double cpus, double memory) const noexcept
+  {
+    return m_cpus[host] + cpus <= m_limits[host].cpus && m_memory[host] + memory <= m_limits[host].memory;
+  }
+
+  bool overloaded(uint32_t host) const noexcept
+  {
+    return m_cpus[host] > m_capacity[host].cpus || m_memory[host] > m_capacity[host].memory;
+  }
+
+  /// Fraction of the limits of the host used with the extra load
+  double load(uint32_t host, double cpus = 0, double memory = 0) const noexcept
+  {
+    auto fraction = [](double used, double limit) { return limit > 0 ? used / limit : 0; };
+    return std::max(fraction(m_cpus[host] + cpus, m_limits[host].cpus),
+                    fraction(m_memory[host] + memory, m_limits[host].memory));
+  }
+
+  void assign(const Graph& g, uint32_t v, uint32_t host)
+  {
+    if (m_part[v] != npos) {
+      m_cpus[m_part[v]] -= g.cpus[v];
+      m_memory[m_part[v]] -= g.memory[v];
+    }
+    m_part[v] = host;
+    m_cpus[host] += g.cpus[v];
+    m_memory[host] += g.memory[v];
+  }
+
+  void reset(size_t vertices) { m_part.assign(vertices, npos); }
+
+private:
+  std::vector<Capacity> m_capacity;
+  std::vector<Capacity> m_limits;
+  std::vector<double> m_cpus;
+  std::vector<double> m_memory;
+  std::vector<uint32_t> m_part;
+};
+
+/// Traffic from v to each host, over the vertices already assigned
+class Connectivity
+{
+public:
+  explicit Connectivity(size_t hosts)
+    : m_traffic(hosts, 0)
+  {
+  }
+
+  const std::vector<uint32_t>& compute(const Graph& g, uint32_t v, const std::vector<uint32_t>& part)
+  {
+    for (uint32_t h : m_touched) {
+      m_traffic[h] = 0;
+    }
+    m_touched.clear();
+    for (const auto& [u, w] : g.edges[v]) {
+      const uint32_t h = part[u];
+      if (h == npos || u == v) {
+        continue;
+      }
+      if (m_traffic[h] == 0) {
+        m_touched.push_back(h);
+      }
+      m_traffic[h] += w;
+    }
+    return m_touched;
+  }
+
+  double operator[](uint32_t host) const noexcept { return m_traffic[host]; }
+
+private:
+  std::vector<double> m_traffic;
+  std::vector<uint32_t> m_touched;
+};
+
+void
+initial_partition(const Graph& g, Partition& partition)
+{
+  std::vector<uint32_t> order(g.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return g.cpus[a] != g.cpus[b] ? g.cpus[a] > g.cpus[b] : g.memory[a] > g.memory[b];
+  });
+
+  partition.reset(g.size());
+  Connectivity connectivity(partition.hosts());
+  for (uint32_t v : order) {
+    connectivity.compute(g, v, partition.part());
+
+    uint32_t best = npos;
+    bool best_fits = false;
+    for (uint32_t h = 0; h < partition.hosts(); ++h) {
+      const bool fits = partition.fits(h, g.cpus[v], g.memory[v]);
+      if (best == npos || (fits && !best_fits)) {
+        best = h;
+        best_fits = fits;
+        continue;
+      }
+      if (fits != best_fits) {
+        continue;
+      }
+      // most traffic first, then the least loaded host
+      if (connectivity[h] > connectivity[best] ||
+          (connectivity[h] == connectivity[best] &&
+           partition.load(h, g.cpus[v], g.memory[v]) < partition.load(best, g.cpus[v], g.memory[v]))) {
+        best = h;
+      }
+    }
+    partition.assign(g, v, best);
+  }
+}
+
+/// Greedy moves to the neighbouring host with the largest positive gain and room for the vertex
+void
+refine(const Graph& g, Partition& partition, unsigned int passes)
+{
+  Connectivity connectivity(partition.hosts());
+  for (unsigned int pass = 0; pass < passes; ++pass) {
+    size_t moves = 0;
+    for (uint32_t v = 0; v < g.size(); ++v) {
+      const uint32_t from = partition.part()[v];
+      uint32_t best = from;
+      double best_gain = 0;
+      for (uint32_t h : connectivity.compute(g, v, partition.part())) {
+        const double gain = connectivity[h] - connectivity[from];
+        if (h != from && gain > best_gain && partition.fits(h, g.cpus[v], g.memory[v])) {
+          best = h;
+          best_gain = gain;
+        }
+      }
+      if (best != from) {
+        partition.assign(g, v, best);
+        ++moves;
+      }
+    }
+    if (moves == 0) {
+      break;
+    }
+  }
+}
+
+/// Move vertices off overloaded hosts, losing as little traffic as possible
+void
+rebalance(const Graph& g, Partition& partition)
+{
+  Connectivity connectivity(partition.hosts());
+  for (uint32_t from = 0; from < partition.hosts(); ++from) {
+    while (partition.overloaded(from)) {
+      uint32_t best_v = npos, best_h = npos;
+      double best_gain = -unlimited;
+      for (uint32_t v = 0; v < g.size(); ++v) {
+        if (partition.part()[v] != from) {
+          continue;
+        }
+        connectivity.compute(g, v, partition.part());
+        for (uint32_t h = 0; h < partition.hosts(); ++h) {
+          const double gain = connectivity[h] - connectivity[from];
+          if (h != from && gain > best_gain && partition.fits(h, g.cpus[v], g.memory[v])) {
+            best_v = v;
+            best_h = h;
+            best_gain = gain;
+          }
+        }
+      }
+      if (best_v == npos) {
+        break;
+      }
+      partition.assign(g, best_v, best_h);
+    }
+  }
+}
+
+double
+cpu_demand(const DaqApplication& app, size_t modules)
+{
+  if (const auto* placement = app.get_placement()) {
+    try {
+      const auto cpus = parse_cpu_list(placement->get_cpu_set());
+      if (!cpus.empty()) {
+        return cpus.size();
+      }
+    } catch (const BadCpuList&) {
+      // check_placement() reports it; fall back to the modules
+    }
+  }
+  return std::max<size_t>(modules, 1);
+}
+
+} // namespace
+
+PlacementPlan
+optimize_placement(const Session& session,
+                   const ConnectivityIndex& index,
+                   const RateProfile& rates,
+                   const PlacementOptimizerParameters& parameters)
+{
+  PlacementPlan plan;
+
+  std::vector<std::string> host_names;
+  std::vector<Capacity> capacity;
+  std::unordered_set<std::string> seen;
+  for (const auto* host : session.get_hosts()) {
+    if (!seen.insert(host->get_hostname()).second) {
+      continue;
+    }
+    host_names.push_back(host->get_hostname());
+    Capacity& c = capacity.emplace_back();
+    if (host->get_cpus() != 0) {
+      c.cpus = host->get_cpus() * parameters.max_load;
+    }
+    if (host->get_memory_mb() != 0) {
+      c.memory = double(host->get_memory_mb()) * (1 << 20) * parameters.max_load;
+    }
+  }
+  if (host_names.empty() || index.num_applications() == 0) {
+    return plan;
+  }
+
+  // the finest graph: one vertex per application
+  Graph graph;
+  const auto estimate = estimate_resources(session, index, rates);
+  for (uint32_t a = 0; a < index.num_applications(); ++a) {
+    graph.cpus.push_back(cpu_demand(*index.application(a), index.modules_of(a).size()));
+    graph.memory.push_back(estimate.applications[a].usage.memory());
+  }
+
+  const auto flows = network_flows(session, index, rates);
+  Adjacency adjacency(index.num_applications());
+  double total_traffic = 0;
+  for (const auto& flow : flows) {
+    add_edge(adjacency, flow.from, flow.to, flow.bytes_per_s);
+    total_traffic += flow.bytes_per_s;
+  }
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    if (index.connection(c)->cast<SharedMemoryConnection>() == nullptr) {
+      continue;
+    }
+    std::vector<uint32_t> apps;
+    for (uint32_t m : index.producers(c)) {
+      apps.push_back(index.application_of(m));
+    }
+    for (uint32_t m : index.consumers(c)) {
+      apps.push_back(index.application_of(m));
+    }
+    for (size_t i = 1; i < apps.size(); ++i) {
+      add_edge(adjacency, apps[0], apps[i], 2 * total_traffic + 1);
+    }
+  }
+  graph.set_edges(adjacency);
+
+  // hosts without a limit take at most an even share of the demand, times the allowed imbalance
+  const double total_cpus = std::accumulate(graph.cpus.begin(), graph.cpus.end(), 0.);
+  const double total_memory = std::accumulate(graph.memory.begin(), graph.memory.end(), 0.);
+  std::vector<Capacity> limits;
+  Capacity largest{ 0, 0 };
+  for (const auto& c : capacity) {
+    Capacity& l = limits.emplace_back();
+    l.cpus = std::isinf(c.cpus) ? total_cpus / capacity.size() * parameters.imbalance : c.cpus;
+    l.memory = std::isinf(c.memory) ? total_memory / capacity.size() * parameters.imbalance : c.memory;
+    largest.cpus = std::max(largest.cpus, l.cpus);
+    largest.memory = std::max(largest.memory, l.memory);
+  }
+
+  // coarsen until small enough or until matching stops making progress
+  const size_t coarsest = parameters.coarsest_size != 0 ? parameters.coarsest_size : 8 * host_names.size();
+  std::vector<Graph> levels{ graph };
+  std::vector<std::vector<uint32_t>> maps;
+  while (levels.back().size() > coarsest) {
+    std::vector<uint32_t> map;
+    Graph coarse = coarsen(levels.back(), largest, map);
+    if (coarse.size() > 0.95 * levels.back().size()) {
+      break;
+    }
+    maps.push_back(std::move(map));
+    levels.push_back(std::move(coarse));
+  }
+  plan.levels = maps.size();
+
+  Partition partition(capacity, limits);
+  initial_partition(levels.back(), partition);
+  refine(levels.back(), partition, parameters.refinement_passes);
+
+  for (size_t l = maps.size(); l-- > 0;) {
+    const std::vector<uint32_t> coarse_part = partition.part();
+    partition = Partition(capacity, limits);
+    partition.reset(levels[l].size());
+    for (uint32_t v = 0; v < levels[l].size(); ++v) {
+      partition.assign(levels[l], v, coarse_part[maps[l][v]]);
+    }
+    refine(levels[l], partition, parameters.refinement_passes);
+  }
+  rebalance(graph, partition);
+
+  for (uint32_t h = 0; h < partition.hosts(); ++h) {
+    plan.feasible = plan.feasible && !partition.overloaded(h);
+  }
+  for (uint32_t a = 0; a < index.num_applications(); ++a) {
+    plan.assignments.push_back({ index.application(a), host_names[partition.part()[a]] });
+  }
+  for (const auto& flow : flows) {
+    if (index.application(flow.from)->get_host() != index.application(flow.to)->get_host()) {
+      plan.traffic_before += flow.bytes_per_s;
+    }
+    if (plan.assignments[flow.from].host != plan.assignments[flow.to].host) {
+      plan.traffic_after += flow.bytes_per_s;
+    }
+  }
+
+  TLOG_DEBUG(3) << "placed " << index.num_applications() << " applications on " << host_names.size() << " hosts in "
+                << plan.levels << " levels: " << plan.traffic_before << " -> " << plan.traffic_after
+                << " bytes/s between hosts" << (plan.feasible ? "" : ", capacity exceeded");
+  return plan;
+}
+
+void
+apply(const PlacementPlan& plan)
+{
+  for (const auto& a : plan.assignments) {
+    if (!a.changed()) {
+      continue;
+    }
+    dunedaq::oksdbinterfaces::ConfigObject obj(a.application->config_object());
+    obj.set_by_val<std::string>("host", a.host);
+  }
+}
+
+} // namespace dunedaq::dal
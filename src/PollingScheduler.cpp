@@ -0,0 +1,133 @@
+/**
+ * @file PollingScheduler.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/PollingScheduler.hpp"
+
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/PollingPolicy.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dunedaq::dal {
+
+namespace {
+
+PollingInterval
+make_interval(uint32_t min_ms, uint32_t max_ms, double backoff)
+{
+  PollingInterval interval;
+  interval.min = std::chrono::milliseconds(min_ms);
+  interval.max = std::chrono::milliseconds(std::max(min_ms, max_ms));
+  interval.backoff = std::min(std::max(1., backoff), PollingInterval::max_backoff);
+  return interval;
+}
+
+} // namespace
+
+ConnectionType
+to_connection_type(const std::string& value) noexcept
+{
+  return value == "kPubSub" ? ConnectionType::pub_sub : ConnectionType::send_recv;
+}
+
+ConnectionType
+connection_type(const NetworkConnection& connection)
+{
+  return to_connection_type(connection.get_connection_type());
+}
+
+PollingParameters
+PollingParameters::from(const Session& session)
+{
+  PollingParameters parameters;
+  parameters.intervals.fill(make_interval(session.get_connectivity_poll_min_ms(),
+                                          session.get_connectivity_poll_max_ms(),
+                                          session.get_connectivity_poll_backoff()));
+
+  for (const auto* policy : session.get_polling_policies()) {
+    parameters.intervals[static_cast<size_t>(to_connection_type(policy->get_connection_type()))] =
+      make_interval(policy->get_min_interval_ms(), policy->get_max_interval_ms(), policy->get_backoff_factor());
+  }
+  return parameters;
+}
+
+PollingScheduler::PollingScheduler(const PollingParameters& parameters, Clock::time_point now)
+{
+  for (size_t i = 0; i < m_states.size(); ++i) {
+    m_states[i].limits = parameters.intervals[i];
+    m_states[i].interval = parameters.intervals[i].min;
+    m_states[i].next = now; // look up right away
+  }
+}
+
+PollingScheduler::PollingScheduler(const Session& session, Clock::time_point now)
+  : PollingScheduler(PollingParameters::from(session), now)
+{
+}
+
+std::chrono::milliseconds
+PollingScheduler::interval(ConnectionType type) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_states[static_cast<size_t>(type)].interval;
+}
+
+PollingScheduler::Clock::time_point
+PollingScheduler::next(ConnectionType type) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_states[static_cast<size_t>(type)].next;
+}
+
+PollingScheduler::Clock::time_point
+PollingScheduler::next() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return std::min(m_states[0].next, m_states[1].next);
+}
+
+void
+PollingScheduler::polled(ConnectionType type, Clock::time_point now, bool misses)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  State& state = m_states[static_cast<size_t>(type)];
+
+  if (misses) {
+    state.interval = state.limits.min;
+  } else {
+    // rounding up, and by at least a millisecond, so that a short interval does not stop growing; clamped
+    // before the conversion, which is undefined for a product out of the range of milliseconds
+    const double product = std::ceil(state.interval.count() * state.limits.backoff);
+    auto grown = std::chrono::milliseconds(
+      static_cast<std::chrono::milliseconds::rep>(std::min(double(state.limits.max.count()), product)));
+    if (state.limits.backoff > 1) {
+      grown = std::max(grown, state.interval + std::chrono::milliseconds(1));
+    }
+    state.interval = std::min(std::max(grown, state.interval), state.limits.max);
+  }
+  state.next = now + state.interval;
+
+  TLOG_DEBUG(5) << "next " << (type == ConnectionType::pub_sub ? "kPubSub" : "kSendRecv") << " lookup in "
+                << state.interval.count() << " ms";
+}
+
+void
+PollingScheduler::transition(Clock::time_point now)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& state : m_states) {
+    state.interval = state.limits.min;
+    state.next = now;
+  }
+}
+
+} // namespace dunedaq::dal
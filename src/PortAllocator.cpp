@@ -0,0 +1,228 @@
+/**
+ * @file PortAllocator.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/PortAllocator.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Host.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/ConfigObject.hpp"
+
+#include <algorithm>
+#include <regex>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+
+namespace dunedaq::dal {
+
+namespace {
+
+/// Sort the ranges and merge the overlapping and adjacent ones
+PortRanges
+merge(PortRanges ranges)
+{
+  std::sort(ranges.begin(), ranges.end());
+  PortRanges merged;
+  for (const auto& r : ranges) {
+    if (!merged.empty() && r.first <= uint32_t(merged.back().second) + 1) {
+      merged.back().second = std::max(merged.back().second, r.second);
+    } else {
+      merged.push_back(r);
+    }
+  }
+  return merged;
+}
+
+} // namespace
+
+PortRanges
+parse_port_list(const std::string& list)
+{
+  PortRanges ranges;
+  std::istringstream items(list);
+  for (std::string item; std::getline(items, item, ',');) {
+    item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+    if (item.empty()) {
+      continue;
+    }
+
+    static const std::regex syntax(R"(([0-9]{1,5})(?:-([0-9]{1,5}))?)");
+    std::smatch match;
+    if (!std::regex_match(item, match, syntax)) {
+      throw BadPortList(ERS_HERE, list, "\"" + item + "\" is not a port or a range");
+    }
+    const unsigned long first = std::stoul(match[1].str());
+    const unsigned long last = match[2].matched ? std::stoul(match[2].str()) : first;
+    if (first == 0 || last > 65535 || first > last) {
+      throw BadPortList(ERS_HERE, list, "\"" + item + "\" is not within 1..65535");
+    }
+    ranges.emplace_back(first, last);
+  }
+  return merge(std::move(ranges));
+}
+
+bool
+contains(const PortRanges& ranges, uint16_t port) noexcept
+{
+  auto it = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(port, uint16_t(65535)));
+  return it != ranges.begin() && std::prev(it)->second >= port;
+}
+
+bool
+PortAssignment::changed() const
+{
+  return port != old_port || (connection != nullptr && uri != connection->get_uri());
+}
+
+namespace {
+
+/// scheme://host:port[/path]; 1: scheme, 2: host, 3: port, 4: path
+const std::regex&
+uri_syntax()
+{
+  static const std::regex syntax(R"(([A-Za-z][A-Za-z0-9+.\-]*)://([^\s:/]+):([0-9]{1,5})(/\S*)?)");
+  return syntax;
+}
+
+/// Ports of one host already taken, and where to look for the next free one
+struct PortSpace
+{
+  std::vector<bool> taken = std::vector<bool>(65536, false);
+  const PortRanges* reserved = nullptr;
+  uint32_t next = 0;
+};
+
+} // namespace
+
+std::vector<PortAssignment>
+assign_ports(const Session& session, const ConnectivityIndex& index, const PortAssignmentParameters& parameters)
+{
+  const PortRanges reserved = parse_port_list(session.get_reserved_ports());
+  std::unordered_map<std::string, PortRanges> host_reserved;
+  for (const auto* host : session.get_hosts()) {
+    auto ranges = parse_port_list(host->get_reserved_ports());
+    ranges.insert(ranges.end(), reserved.begin(), reserved.end());
+    host_reserved.emplace(host->get_hostname(), merge(std::move(ranges)));
+  }
+
+  auto host_of = [&](const DaqApplication* app) -> const std::string& {
+    auto it = parameters.hosts.find(app->UID());
+    return it != parameters.hosts.end() ? it->second : app->get_host();
+  };
+
+  std::vector<PortAssignment> assignments;
+  for (uint32_t a = 0; a < index.num_applications(); ++a) {
+    const auto* app = index.application(a);
+    PortAssignment& pa = assignments.emplace_back();
+    pa.application = app;
+    pa.host = host_of(app);
+    pa.old_port = app->get_port();
+  }
+
+  std::smatch match;
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* nc = index.connection(c)->cast<NetworkConnection>();
+    if (nc == nullptr || !std::regex_match(nc->get_uri(), match, uri_syntax())) {
+      continue;
+    }
+
+    const bool pub_sub = nc->get_connection_type() == "kPubSub";
+    const auto binders = pub_sub ? index.producers(c) : index.consumers(c);
+    PortAssignment& pa = assignments.emplace_back();
+    pa.connection = nc;
+    pa.host = binders.empty() ? match[2].str() : host_of(index.application(index.application_of(binders[0])));
+    const unsigned long port = std::stoul(match[3].str());
+    pa.old_port = port <= 65535 ? port : 0;
+    // keep the scheme and path, the host of the binding end is filled in with the port
+    pa.uri = match[1].str() + "://" + pa.host + ":%" + match[4].str();
+  }
+
+  std::sort(assignments.begin(), assignments.end(), [](const PortAssignment& x, const PortAssignment& y) {
+    auto key = [](const PortAssignment& p) {
+      return std::make_tuple(
+        std::cref(p.host), p.application == nullptr, p.application ? p.application->UID() : p.connection->UID());
+    };
+    return key(x) < key(y);
+  });
+
+  std::unordered_map<std::string, PortSpace> spaces;
+  auto space = [&](const std::string& host) -> PortSpace& {
+    auto [it, inserted] = spaces.try_emplace(host);
+    if (inserted) {
+      auto r = host_reserved.find(host);
+      it->second.reserved = r != host_reserved.end() ? &r->second : &reserved;
+      it->second.next = session.get_first_port();
+    }
+    return it->second;
+  };
+
+  // first keep the valid current ports, in endpoint order, then fill in the others
+  std::vector<bool> kept(assignments.size(), false);
+  if (!parameters.reassign_all) {
+    for (size_t i = 0; i < assignments.size(); ++i) {
+      auto& pa = assignments[i];
+      auto& ports = space(pa.host);
+      if (pa.old_port != 0 && !ports.taken[pa.old_port] && !contains(*ports.reserved, pa.old_port)) {
+        ports.taken[pa.old_port] = true;
+        pa.port = pa.old_port;
+        kept[i] = true;
+      }
+    }
+  }
+
+  size_t changed = 0;
+  for (size_t i = 0; i < assignments.size(); ++i) {
+    auto& pa = assignments[i];
+    if (!kept[i]) {
+      auto& ports = space(pa.host);
+      while (ports.next <= session.get_last_port() &&
+             (ports.taken[ports.next] || contains(*ports.reserved, ports.next))) {
+        ++ports.next;
+      }
+      if (ports.next > session.get_last_port()) {
+        throw PortsExhausted(ERS_HERE, pa.host, session.get_first_port(), session.get_last_port());
+      }
+      pa.port = ports.next;
+      ports.taken[ports.next] = true;
+    }
+    if (pa.connection != nullptr) {
+      pa.uri.replace(pa.uri.find(":%"), 2, ':' + std::to_string(pa.port));
+    }
+    changed += pa.changed() ? 1 : 0;
+  }
+
+  TLOG_DEBUG(3) << "assigned " << assignments.size() << " ports on " << spaces.size() << " hosts, " << changed
+                << " changed";
+  return assignments;
+}
+
+void
+apply(const std::vector<PortAssignment>& assignments)
+{
+  for (const auto& pa : assignments) {
+    if (!pa.changed()) {
+      continue;
+    }
+    if (pa.application != nullptr) {
+      dunedaq::oksdbinterfaces::ConfigObject obj(pa.application->config_object());
+      obj.set_by_val<uint16_t>("port", pa.port);
+    } else {
+      dunedaq::oksdbinterfaces::ConfigObject obj(pa.connection->config_object());
+      obj.set_by_val<std::string>("uri", pa.uri);
+    }
+  }
+}
+
+} // namespace dunedaq::dal
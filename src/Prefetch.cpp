@@ -0,0 +1,160 @@
+/**
+ * @file Prefetch.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Instrumentation.hpp"
+#include "dunedaqdal/Prefetch.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "ThreadPool.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Parameter.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/Variable.hpp"
+#include "dunedaqdal/VariableSet.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace dunedaq::dal {
+
+namespace {
+
+class Prefetcher
+{
+public:
+  explicit Prefetcher(unsigned int n_threads)
+    : m_pool(n_threads)
+  {
+  }
+
+  PrefetchStatistics run(const Session& session)
+  {
+    add_parameters(session.get_ProcessEnvironment());
+
+    for (const auto* app : session.get_applications()) {
+      if (first_visit(app)) {
+        m_pool.submit([this, app] { add_application(app); });
+      }
+    }
+
+    m_pool.wait();
+
+    PrefetchStatistics stats;
+    stats.applications = m_applications;
+    stats.modules = m_modules;
+    stats.connections = m_connections;
+    stats.parameters = m_parameters;
+    return stats;
+  }
+
+private:
+  bool first_visit(const dunedaq::oksdbinterfaces::DalObject* obj)
+  {
+    std::lock_guard<std::mutex> lock(m_visited_mutex);
+    return m_visited.insert(obj).second;
+  }
+
+  void add_parameters(const std::vector<const Parameter*>& parameters)
+  {
+    for (const auto* p : parameters) {
+      if (first_visit(p)) {
+        m_pool.submit([this, p] { add_parameter(p); });
+      }
+    }
+  }
+
+  void add_application(const Application* app)
+  {
+    DUNEDAQDAL_PROFILE_SCOPE("instantiate", app->class_name());
+    ++m_applications;
+    DUNEDAQDAL_COUNT(app->class_name(), instantiations);
+    DUNEDAQDAL_COUNT(app->class_name(), traversals);
+    add_parameters(app->get_ApplicationEnvironment());
+
+    if (const auto* daq_app = app->cast<DaqApplication>()) {
+      DUNEDAQDAL_COUNT(app->class_name(), traversals);
+      for (const auto* mod : daq_app->get_modules()) {
+        if (first_visit(mod)) {
+          m_pool.submit([this, mod] { add_module(mod); });
+        }
+      }
+    }
+  }
+
+  void add_module(const DaqModule* mod)
+  {
+    DUNEDAQDAL_PROFILE_SCOPE("instantiate", mod->class_name());
+    ++m_modules;
+    DUNEDAQDAL_COUNT(mod->class_name(), instantiations);
+    DUNEDAQDAL_COUNT(mod->class_name(), traversals);
+    add_connections(mod->get_inputs());
+    DUNEDAQDAL_COUNT(mod->class_name(), traversals);
+    add_connections(mod->get_outputs());
+  }
+
+  void add_connections(const std::vector<const Connection*>& connections)
+  {
+    // connections are leaves: initialise them in place rather than paying for a task each
+    for (const auto* c : connections) {
+      if (first_visit(c)) {
+        DUNEDAQDAL_PROFILE_SCOPE("instantiate", c->class_name());
+        c->get_data_type();
+        ++m_connections;
+        DUNEDAQDAL_COUNT(c->class_name(), instantiations);
+      }
+    }
+  }
+
+  void add_parameter(const Parameter* p)
+  {
+    DUNEDAQDAL_PROFILE_SCOPE("instantiate", p->class_name());
+    ++m_parameters;
+    DUNEDAQDAL_COUNT(p->class_name(), instantiations);
+    if (const auto* var = p->cast<Variable>()) {
+      var->get_Value();
+    } else if (const auto* set = p->cast<VariableSet>()) {
+      DUNEDAQDAL_COUNT(p->class_name(), traversals);
+      add_parameters(set->get_Contains());
+    }
+  }
+
+  detail::ThreadPool m_pool;
+
+  std::mutex m_visited_mutex;
+  std::unordered_set<const dunedaq::oksdbinterfaces::DalObject*> m_visited;
+
+  std::atomic<size_t> m_applications{ 0 };
+  std::atomic<size_t> m_modules{ 0 };
+  std::atomic<size_t> m_connections{ 0 };
+  std::atomic<size_t> m_parameters{ 0 };
+};
+
+} // namespace
+
+PrefetchStatistics
+prefetch(const Session& session, unsigned int n_threads)
+{
+  Prefetcher prefetcher(n_threads);
+  auto stats = prefetcher.run(session);
+
+  TLOG_DEBUG(3) << "prefetched session " << session.UID() << ": " << stats.applications << " applications, "
+                << stats.modules << " modules, " << stats.connections << " connections, " << stats.parameters
+                << " parameters";
+
+  return stats;
+}
+
+} // namespace dunedaq::dal
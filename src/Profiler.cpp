@@ -0,0 +1,391 @@
+/**
+ * @file Profiler.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Profiler.hpp"
+
+#include "dunedaqdal/Issues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+#include <unistd.h>
+
+namespace dunedaq::dal::profiling {
+
+namespace detail {
+
+std::atomic<bool> g_enabled{ std::getenv("DUNEDAQDAL_PROFILE") != nullptr };
+
+int64_t
+now_ns() noexcept
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+int64_t
+steady_ns() noexcept
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+} // namespace detail
+
+namespace {
+
+struct ThreadBuffer;
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<ThreadBuffer*> threads;
+  std::vector<TraceEvent> retired; ///< events of exited threads
+  uint32_t next_thread = 1;
+  std::string process_name;
+
+  std::atomic<size_t> recorded{ 0 };
+  std::atomic<uint64_t> dropped{ 0 };
+};
+
+/// Never destroyed, so that threads exiting during static destruction can still hand over their events
+Registry&
+registry()
+{
+  static Registry* r = new Registry;
+  return *r;
+}
+
+/// Events of one thread; its own mutex is only contended while collecting
+struct ThreadBuffer
+{
+  std::mutex mutex;
+  std::vector<TraceEvent> events;
+  uint32_t thread = 0;
+
+  ThreadBuffer()
+  {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    thread = r.next_thread++;
+    r.threads.push_back(this);
+  }
+
+  ~ThreadBuffer()
+  {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::lock_guard<std::mutex> own(mutex);
+    r.retired.insert(r.retired.end(), std::make_move_iterator(events.begin()), std::make_move_iterator(events.end()));
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+  }
+};
+
+ThreadBuffer&
+local_buffer()
+{
+  thread_local ThreadBuffer b;
+  return b;
+}
+
+std::string
+default_process_name()
+{
+  std::ifstream comm("/proc/self/comm");
+  std::string name;
+  std::getline(comm, name);
+  return name.empty() ? "dunedaqdal" : name;
+}
+
+std::string
+host_name()
+{
+  char name[256] = {};
+  return gethostname(name, sizeof(name) - 1) == 0 ? name : "";
+}
+
+void
+write_json_string(std::ostream& out, std::string_view s)
+{
+  out << '"';
+  for (char c : s) {
+    switch (c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+/// Nanoseconds as the microseconds of the trace format, without going through a double
+void
+write_us(std::ostream& out, int64_t ns)
+{
+  out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+/// DUNEDAQDAL_PROFILE with "%p" replaced by the process id, empty if it is not set
+std::string
+trace_path()
+{
+  const char* env = std::getenv("DUNEDAQDAL_PROFILE");
+  std::string path = env != nullptr ? env : "";
+  for (size_t at = path.find("%p"); at != std::string::npos; at = path.find("%p", at)) {
+    const std::string pid = std::to_string(getpid());
+    path.replace(at, 2, pid);
+    at += pid.size();
+  }
+  return path;
+}
+
+std::atomic<bool> g_flushed{ false };
+
+/**
+ * Writes the trace of DUNEDAQDAL_PROFILE at exit unless flush() did. This
+ * runs during static destruction, where neither ERS nor TRACE can be
+ * relied upon, so it reports on std::cerr only; <iostream> is included
+ * above, so std::cerr outlives it.
+ */
+struct ExitWriter
+{
+  ExitWriter()
+  {
+    if (std::getenv("DUNEDAQDAL_PROFILE") != nullptr) {
+      std::atexit(write);
+    }
+  }
+
+  static void write()
+  {
+    if (g_flushed) {
+      return;
+    }
+    std::string path;
+    try {
+      path = trace_path();
+      std::ofstream out(path);
+      if (out) {
+        write_trace(out);
+      }
+      if (!out) {
+        std::cerr << "dunedaqdal: cannot write profile trace to " << path << ": " << std::strerror(errno) << std::endl;
+      }
+    } catch (const std::exception& ex) {
+      std::cerr << "dunedaqdal: cannot write profile trace to " << path << ": " << ex.what() << std::endl;
+    }
+  }
+};
+
+const ExitWriter exit_writer;
+
+} // namespace
+
+void
+detail::record(const char* category, std::string name, int64_t start_ns, int64_t duration_ns)
+{
+  auto& r = registry();
+  if (r.recorded.fetch_add(1, std::memory_order_relaxed) >= max_events) {
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto& b = local_buffer();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  b.events.push_back(TraceEvent{ category, std::move(name), start_ns, duration_ns, b.thread });
+}
+
+void
+enable(bool on) noexcept
+{
+  detail::g_enabled.store(on, std::memory_order_relaxed);
+}
+
+void
+set_process_name(std::string name)
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.process_name = std::move(name);
+}
+
+std::vector<TraceEvent>
+collect()
+{
+  auto& r = registry();
+  std::vector<TraceEvent> result;
+  {
+    std::lock_guard<std::mutex> lock(r.mutex);
+    result = r.retired;
+    for (auto* b : r.threads) {
+      std::lock_guard<std::mutex> own(b->mutex);
+      result.insert(result.end(), b->events.begin(), b->events.end());
+    }
+  }
+
+  std::stable_sort(result.begin(), result.end(), [](const TraceEvent& a, const TraceEvent& b) {
+    return a.start_ns < b.start_ns;
+  });
+  return result;
+}
+
+uint64_t
+dropped()
+{
+  return registry().dropped.load(std::memory_order_relaxed);
+}
+
+void
+reset()
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.retired.clear();
+  for (auto* b : r.threads) {
+    std::lock_guard<std::mutex> own(b->mutex);
+    b->events.clear();
+  }
+  r.recorded = 0;
+  r.dropped = 0;
+}
+
+std::vector<ScopeSummary>
+summarize()
+{
+  std::unordered_map<std::string, ScopeSummary> groups;
+  for (auto& e : collect()) {
+    std::string key = std::string(e.category) + '\0' + e.name;
+    auto& s = groups[key];
+    if (s.count == 0) {
+      s.category = e.category;
+      s.name = std::move(e.name);
+    }
+    ++s.count;
+    s.total_ns += e.duration_ns;
+    s.max_ns = std::max(s.max_ns, e.duration_ns);
+  }
+
+  std::vector<ScopeSummary> result;
+  result.reserve(groups.size());
+  for (auto& [key, s] : groups) {
+    result.push_back(std::move(s));
+  }
+  std::sort(result.begin(), result.end(), [](const ScopeSummary& a, const ScopeSummary& b) {
+    return a.total_ns != b.total_ns ? a.total_ns > b.total_ns : a.name < b.name;
+  });
+  return result;
+}
+
+void
+dump(std::ostream& out)
+{
+  out << std::left << std::setw(14) << "category" << std::setw(48) << "name" << std::right << std::setw(10) << "count"
+      << std::setw(14) << "total ms" << std::setw(12) << "mean us" << std::setw(12) << "max us" << '\n';
+  for (const auto& s : summarize()) {
+    out << std::left << std::setw(14) << s.category << std::setw(48) << s.name << std::right << std::setw(10)
+        << s.count << std::fixed << std::setprecision(3) << std::setw(14) << s.total_ns / 1e6 << std::setprecision(1)
+        << std::setw(12) << s.total_ns / 1e3 / s.count << std::setw(12) << s.max_ns / 1e3 << '\n';
+  }
+  out.unsetf(std::ios::floatfield);
+}
+
+void
+write_trace(std::ostream& out)
+{
+  const auto events = collect();
+
+  std::string process_name;
+  std::vector<uint32_t> threads;
+  {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    process_name = r.process_name.empty() ? default_process_name() : r.process_name;
+  }
+  for (const auto& e : events) {
+    threads.push_back(e.thread);
+  }
+  std::sort(threads.begin(), threads.end());
+  threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+  const auto pid = getpid();
+  out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << dropped() << "},\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":";
+  write_json_string(out, process_name);
+  out << "}},\n{\"name\":\"process_labels\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"labels\":";
+  write_json_string(out, host_name());
+  out << "}}";
+  for (auto t : threads) {
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << t
+        << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+  }
+  for (const auto& e : events) {
+    out << ",\n{\"name\":";
+    write_json_string(out, e.name);
+    out << ",\"cat\":";
+    write_json_string(out, e.category);
+    out << ",\"ph\":\"X\",\"ts\":";
+    write_us(out, e.start_ns);
+    out << ",\"dur\":";
+    write_us(out, e.duration_ns);
+    out << ",\"pid\":" << pid << ",\"tid\":" << e.thread << '}';
+  }
+  out << "\n]}\n";
+}
+
+void
+write_trace(const std::string& path)
+{
+  std::ofstream out(path);
+  if (out) {
+    write_trace(out);
+  }
+  if (!out) {
+    throw BadTraceExport(ERS_HERE, path, std::strerror(errno));
+  }
+  TLOG_DEBUG(3) << "wrote DAL profile trace " << path;
+}
+
+void
+flush()
+{
+  const std::string path = trace_path();
+  if (path.empty()) {
+    return;
+  }
+  // a failure is reported to the caller, not again at exit
+  g_flushed = true;
+  write_trace(path);
+}
+
+FlushOnExit::~FlushOnExit()
+{
+  try {
+    flush();
+  } catch (const ers::Issue& ex) {
+    ers::error(ex);
+  }
+}
+
+} // namespace dunedaq::dal::profiling
@@ -0,0 +1,131 @@
+/**
+ * @file QueueAdvisor.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/QueueAdvisor.hpp"
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/QueueSettings.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/Queue.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/ConfigObject.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace dunedaq::dal {
+
+namespace {
+
+uint32_t
+round_up_pow2(uint64_t n)
+{
+  uint64_t p = 1;
+  while (p < n && p < (uint64_t(1) << 31)) {
+    p <<= 1;
+  }
+  return p;
+}
+
+} // namespace
+
+RateProfile
+read_rate_profile(const std::string& path)
+{
+  std::ifstream in(path);
+  if (!in) {
+    throw BadRateProfile(ERS_HERE, path, "cannot open file");
+  }
+
+  RateProfile rates;
+  std::string line;
+  for (size_t n = 1; std::getline(in, line); ++n) {
+    std::istringstream fields(line);
+    std::string uid;
+    double rate;
+    if (!(fields >> uid) || uid[0] == '#') {
+      continue;
+    }
+    if (!(fields >> rate) || !std::isfinite(rate) || rate < 0) {
+      throw BadRateProfile(ERS_HERE, path, "bad rate on line " + std::to_string(n));
+    }
+    rates[uid] = rate;
+  }
+  return rates;
+}
+
+bool
+QueueAdvice::changed() const
+{
+  return queue != nullptr && (capacity != queue->get_capacity() || queue_type != queue->get_queue_type());
+}
+
+std::vector<QueueAdvice>
+advise_queues(const ConnectivityIndex& index, const RateProfile& rates, const QueueAdvisorParameters& parameters)
+{
+  std::vector<QueueAdvice> result;
+
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* q = index.connection(c)->cast<Queue>();
+    if (q == nullptr) {
+      continue;
+    }
+
+    QueueAdvice advice;
+    advice.queue = q;
+    advice.producers = index.producers(c).size();
+    advice.consumers = index.consumers(c).size();
+
+    QueueType type = QueueType::folly_mpmc;
+    if (advice.consumers <= 1) {
+      type = advice.producers <= 1 ? QueueType::folly_spsc : QueueType::mpsc_ring;
+    }
+    advice.queue_type = to_string(type);
+
+    const auto current = to_queue_type(q->get_queue_type());
+    advice.unsafe_type = current != QueueType::unknown && !supports(current, advice.producers, advice.consumers);
+
+    uint64_t needed = q->get_capacity();
+    auto rate = rates.find(q->UID());
+    if (rate != rates.end()) {
+      advice.rate_hz = rate->second;
+      // converting a NaN, negative or out of range double is undefined, so clamp before the cast
+      const double messages = std::ceil(rate->second * parameters.buffer_time_ms / 1000.);
+      needed = messages > 0 ? uint64_t(std::min(messages, double(uint64_t(1) << 32))) : 0;
+    }
+    advice.capacity = round_up_pow2(std::max<uint64_t>(needed, parameters.min_capacity));
+
+    if (advice.unsafe_type) {
+      TLOG_DEBUG(3) << q->get_queue_type() << " queue " << q->UID() << " has " << advice.producers
+                    << " producers and " << advice.consumers << " consumers";
+    }
+
+    result.push_back(std::move(advice));
+  }
+
+  return result;
+}
+
+void
+apply(const std::vector<QueueAdvice>& advice)
+{
+  for (const auto& a : advice) {
+    if (!a.changed()) {
+      continue;
+    }
+    dunedaq::oksdbinterfaces::ConfigObject obj(a.queue->config_object());
+    obj.set_by_val<uint32_t>("capacity", a.capacity);
+    obj.set_enum("queue_type", a.queue_type);
+  }
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,91 @@
+/**
+ * @file QueueSettings.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/QueueSettings.hpp"
+
+#include "dunedaqdal/Queue.hpp"
+
+#include <iterator>
+
+namespace dunedaq::dal {
+
+namespace {
+
+// indexed by the enumerators
+const std::string queue_types[] = {
+  "kUnknown", "kStdDeQueue", "kFollySPSCQueue", "kFollyMPMCQueue", "kLockFreeMPSCRing"
+};
+const std::string wait_strategies[] = { "kBusySpin", "kYield", "kFutex" };
+
+} // namespace
+
+QueueType
+to_queue_type(const std::string& value) noexcept
+{
+  for (size_t i = 0; i < std::size(queue_types); ++i) {
+    if (value == queue_types[i]) {
+      return static_cast<QueueType>(i);
+    }
+  }
+  return QueueType::unknown;
+}
+
+WaitStrategy
+to_wait_strategy(const std::string& value) noexcept
+{
+  for (size_t i = 0; i < std::size(wait_strategies); ++i) {
+    if (value == wait_strategies[i]) {
+      return static_cast<WaitStrategy>(i);
+    }
+  }
+  return WaitStrategy::futex;
+}
+
+const std::string&
+to_string(QueueType type) noexcept
+{
+  return queue_types[static_cast<size_t>(type)];
+}
+
+const std::string&
+to_string(WaitStrategy strategy) noexcept
+{
+  return wait_strategies[static_cast<size_t>(strategy)];
+}
+
+bool
+supports(QueueType type, size_t producers, size_t consumers) noexcept
+{
+  switch (type) {
+    case QueueType::folly_spsc:
+      return producers <= 1 && consumers <= 1;
+    case QueueType::mpsc_ring:
+      return consumers <= 1;
+    case QueueType::std_deque:
+    case QueueType::folly_mpmc:
+      return true;
+    default:
+      return false;
+  }
+}
+
+QueueSettings
+get_queue_settings(const Queue& queue)
+{
+  QueueSettings settings;
+  settings.type = to_queue_type(queue.get_queue_type());
+  settings.capacity = queue.get_capacity();
+  settings.push_batch_size = queue.get_push_batch_size();
+  settings.pop_batch_size = queue.get_pop_batch_size();
+  settings.cache_line_padding = queue.get_cache_line_padding();
+  settings.numa_node = queue.get_numa_node();
+  settings.wait_strategy = to_wait_strategy(queue.get_wait_strategy());
+  return settings;
+}
+
+} // namespace dunedaq::dal
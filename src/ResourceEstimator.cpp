@@ -0,0 +1,180 @@
+/**
+ * @file ResourceEstimator.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ResourceEstimator.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DataTypeProfile.hpp"
+#include "dunedaqdal/Host.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/ProcessPlacement.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+namespace dunedaq::dal {
+
+DataTypeRegistry
+data_type_registry(const Session& session)
+{
+  DataTypeRegistry registry;
+  for (const auto* profile : session.get_data_type_profiles()) {
+    registry.emplace(profile->get_data_type(), DataTypeRate{ profile->get_payload_size(), profile->get_rate_hz() });
+  }
+  return registry;
+}
+
+ResourceUsage&
+ResourceUsage::operator+=(const ResourceUsage& other) noexcept
+{
+  queue_memory += other.queue_memory;
+  hugepages += other.hugepages;
+  network_in += other.network_in;
+  network_out += other.network_out;
+  modules += other.modules;
+  applications += other.applications;
+  return *this;
+}
+
+namespace {
+
+double
+payload_size(const DataTypeRegistry& registry, const Connection& connection)
+{
+  auto it = registry.find(connection.get_data_type());
+  return it == registry.end() ? 0 : it->second.payload_size;
+}
+
+} // namespace
+
+std::vector<NetworkFlow>
+network_flows(const Session& session, const ConnectivityIndex& index, const RateProfile& rates)
+{
+  const auto registry = data_type_registry(session);
+
+  std::vector<NetworkFlow> flows;
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* nc = index.connection(c)->cast<NetworkConnection>();
+    const auto producers = index.producers(c);
+    const auto consumers = index.consumers(c);
+    if (nc == nullptr || producers.empty() || consumers.empty()) {
+      continue;
+    }
+
+    auto profile = registry.find(nc->get_data_type());
+    auto rate = rates.find(nc->UID());
+    const double rate_hz =
+      rate != rates.end() ? rate->second : (profile != registry.end() ? profile->second.rate_hz : 0);
+    const double bytes_per_s = rate_hz * payload_size(registry, *nc);
+    if (bytes_per_s == 0) {
+      continue;
+    }
+
+    const bool pub_sub = nc->get_connection_type() == "kPubSub";
+    const double flow = bytes_per_s / producers.size() / (pub_sub ? 1 : consumers.size());
+    for (uint32_t p : producers) {
+      for (uint32_t q : consumers) {
+        const uint32_t from = index.application_of(p);
+        const uint32_t to = index.application_of(q);
+        if (from != to) {
+          flows.push_back({ from, to, flow });
+        }
+      }
+    }
+  }
+  return flows;
+}
+
+ResourceEstimate
+estimate_resources(const Session& session, const ConnectivityIndex& index, const RateProfile& rates)
+{
+  const auto registry = data_type_registry(session);
+
+  ResourceEstimate estimate;
+  estimate.applications.resize(index.num_applications());
+  for (uint32_t a = 0; a < index.num_applications(); ++a) {
+    const auto* app = index.application(a);
+    auto& usage = estimate.applications[a].usage;
+    estimate.applications[a].application = app;
+    usage.applications = 1;
+    usage.modules = index.modules_of(a).size();
+    if (const auto* placement = app->get_placement()) {
+      usage.hugepages =
+        placement->get_hugepages_2M() * double(1 << 21) + placement->get_hugepages_1G() * double(1 << 30);
+    }
+  }
+
+  std::set<std::string> unknown;
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* connection = index.connection(c);
+    if (registry.count(connection->get_data_type()) == 0) {
+      unknown.insert(connection->get_data_type());
+    }
+
+    // buffers live with the first consumer, or the first producer if there is none
+    const auto consumers = index.consumers(c);
+    const auto producers = index.producers(c);
+    if (consumers.empty() && producers.empty()) {
+      continue;
+    }
+    auto& usage = estimate.applications[index.application_of(consumers.empty() ? producers[0] : consumers[0])].usage;
+
+    if (const auto* q = connection->cast<Queue>()) {
+      usage.queue_memory += double(q->get_capacity()) * payload_size(registry, *q);
+    } else if (const auto* shm = connection->cast<SharedMemoryConnection>()) {
+      usage.queue_memory += double(shm->get_segment_size());
+    }
+  }
+  estimate.unknown_data_types.assign(unknown.begin(), unknown.end());
+
+  for (const auto& flow : network_flows(session, index, rates)) {
+    if (index.application(flow.from)->get_host() != index.application(flow.to)->get_host()) {
+      estimate.applications[flow.from].usage.network_out += flow.bytes_per_s;
+      estimate.applications[flow.to].usage.network_in += flow.bytes_per_s;
+    }
+  }
+
+  std::map<std::string, HostResources> hosts;
+  for (const auto& app : estimate.applications) {
+    auto& host = hosts[app.application->get_host()];
+    host.host = app.application->get_host();
+    host.usage += app.usage;
+  }
+  for (const auto* limits : session.get_hosts()) {
+    auto it = hosts.find(limits->get_hostname());
+    if (it == hosts.end() || it->second.limits != nullptr) {
+      continue;
+    }
+    auto& host = it->second;
+    host.limits = limits;
+    host.memory_oversubscribed =
+      limits->get_memory_mb() != 0 && host.usage.memory() > double(limits->get_memory_mb()) * (1 << 20);
+    const double bandwidth = limits->get_network_gbps() * 1e9 / 8;
+    host.network_oversubscribed =
+      bandwidth > 0 && std::max(host.usage.network_in, host.usage.network_out) > bandwidth;
+  }
+  for (auto& [name, host] : hosts) {
+    estimate.hosts.push_back(std::move(host));
+  }
+
+  TLOG_DEBUG(3) << "estimated resources of session " << session.UID() << ": " << estimate.applications.size()
+                << " applications on " << estimate.hosts.size() << " hosts, " << estimate.unknown_data_types.size()
+                << " data types without profile";
+  return estimate;
+}
+
+} // namespace dunedaq::dal
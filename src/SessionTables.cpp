@@ -0,0 +1,241 @@
+/**
+ * @file SessionTables.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/SessionTables.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Parameter.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+#include "dunedaqdal/Variable.hpp"
+#include "dunedaqdal/VariableSet.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+namespace dunedaq::dal {
+
+namespace columns {
+
+void
+StringColumn::push_back(std::string_view value)
+{
+  auto [it, inserted] = m_codes.try_emplace(value, dictionary.size());
+  if (inserted) {
+    dictionary.push_back(value);
+  }
+  codes.push_back(it->second);
+}
+
+void
+write_cell(std::ostream& out, const StringColumn& column, size_t row)
+{
+  const std::string_view value = column[row];
+  if (value.find_first_of(",\"\n\r") == std::string_view::npos) {
+    out << value;
+    return;
+  }
+  out << '"';
+  for (char c : value) {
+    if (c == '"') {
+      out << '"';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+void
+write_cell(std::ostream& out, const IndexColumn& column, size_t row)
+{
+  if (column[row] != npos) {
+    out << column[row];
+  }
+}
+
+void
+write_cell(std::ostream& out, const IndexListColumn& column, size_t row)
+{
+  const char* separator = "";
+  for (auto r : column[row]) {
+    out << separator << r;
+    separator = " ";
+  }
+}
+
+} // namespace columns
+
+namespace {
+
+/// Assigns VariableTable rows, expanding VariableSets depth first
+class VariableCollector
+{
+public:
+  VariableCollector(VariableTable& table, StringPool& strings)
+    : m_table(table)
+    , m_strings(strings)
+  {
+  }
+
+  /// Append the rows of the variables reachable from the parameters to rows
+  void collect(const std::vector<const Parameter*>& parameters, std::vector<uint32_t>& rows)
+  {
+    m_visited_sets.clear();
+    add(parameters, rows);
+  }
+
+private:
+  void add(const std::vector<const Parameter*>& parameters, std::vector<uint32_t>& rows)
+  {
+    for (const auto* parameter : parameters) {
+      if (const auto* var = parameter->cast<Variable>()) {
+        rows.push_back(row(*var));
+      } else if (const auto* set = parameter->cast<VariableSet>()) {
+        // a set listed twice, or a cycle, contributes once; EnvironmentResolver reports cycles
+        if (m_visited_sets.insert(set).second) {
+          add(set->get_Contains(), rows);
+        }
+      }
+    }
+  }
+
+  uint32_t row(const Variable& var)
+  {
+    auto [it, inserted] = m_rows.try_emplace(&var, m_table.size());
+    if (inserted) {
+      m_table.uid.push_back(m_strings.intern(var.UID()));
+      m_table.name.push_back(m_strings.intern(var.get_Name()));
+      m_table.value.push_back(m_strings.intern(var.get_Value()));
+      m_table.session.push_back(0);
+    }
+    return it->second;
+  }
+
+  VariableTable& m_table;
+  StringPool& m_strings;
+  std::unordered_map<const Variable*, uint32_t> m_rows;
+  std::unordered_set<const VariableSet*> m_visited_sets;
+};
+
+} // namespace
+
+SessionTables
+make_tables(const Session& session, const ConnectivityIndex& index)
+{
+  SessionTables t;
+  t.strings = std::make_unique<StringPool>();
+  StringPool& strings = *t.strings;
+
+  // the session variables come first; which of them an application sees is up to EnvironmentResolver
+  VariableCollector variables(t.variables, strings);
+  std::vector<uint32_t> session_variables;
+  variables.collect(session.get_ProcessEnvironment(), session_variables);
+  for (auto v : session_variables) {
+    t.variables.session[v] = 1;
+  }
+
+  for (uint32_t a = 0; a < index.num_applications(); ++a) {
+    const auto* app = index.application(a);
+    t.applications.uid.push_back(strings.intern(app->UID()));
+    t.applications.host.push_back(strings.intern(app->get_host()));
+    t.applications.port.push_back(app->get_port());
+    for (auto m : index.modules_of(a)) {
+      t.applications.modules.rows.push_back(m);
+    }
+    t.applications.modules.end_row();
+    variables.collect(app->get_ApplicationEnvironment(), t.applications.variables.rows);
+    t.applications.variables.end_row();
+  }
+
+  for (uint32_t m = 0; m < index.num_modules(); ++m) {
+    const auto* mod = index.module(m);
+    t.modules.uid.push_back(strings.intern(mod->UID()));
+    t.modules.plugin.push_back(strings.intern(mod->get_plugin()));
+    t.modules.application.rows.push_back(index.application_of(m));
+    for (auto c : index.inputs(m)) {
+      t.modules.inputs.rows.push_back(c);
+    }
+    t.modules.inputs.end_row();
+    for (auto c : index.outputs(m)) {
+      t.modules.outputs.rows.push_back(c);
+    }
+    t.modules.outputs.end_row();
+  }
+
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* conn = index.connection(c);
+    t.connections.uid.push_back(strings.intern(conn->UID()));
+    t.connections.class_name.push_back(strings.intern(conn->class_name()));
+    t.connections.data_type.push_back(strings.intern(conn->get_data_type()));
+    for (auto m : index.producers(c)) {
+      t.connections.producers.rows.push_back(m);
+    }
+    t.connections.producers.end_row();
+    for (auto m : index.consumers(c)) {
+      t.connections.consumers.rows.push_back(m);
+    }
+    t.connections.consumers.end_row();
+
+    if (const auto* q = conn->cast<Queue>()) {
+      auto& qt = t.queues;
+      qt.connection.rows.push_back(c);
+      qt.capacity.push_back(q->get_capacity());
+      qt.queue_type.push_back(strings.intern(q->get_queue_type()));
+      qt.push_batch_size.push_back(q->get_push_batch_size());
+      qt.pop_batch_size.push_back(q->get_pop_batch_size());
+      qt.cache_line_padding.push_back(q->get_cache_line_padding());
+      qt.numa_node.push_back(q->get_numa_node());
+      qt.wait_strategy.push_back(strings.intern(q->get_wait_strategy()));
+    } else if (const auto* nc = conn->cast<NetworkConnection>()) {
+      auto& nt = t.network_connections;
+      nt.connection.rows.push_back(c);
+      nt.connection_type.push_back(strings.intern(nc->get_connection_type()));
+      nt.uri.push_back(strings.intern(nc->get_uri()));
+    } else if (const auto* shm = conn->cast<SharedMemoryConnection>()) {
+      auto& st = t.shared_memory_connections;
+      st.connection.rows.push_back(c);
+      st.segment_name.push_back(strings.intern(shm->get_segment_name()));
+      st.segment_size.push_back(shm->get_segment_size());
+      st.slot_count.push_back(shm->get_slot_count());
+      st.consumer_mode.push_back(strings.intern(shm->get_consumer_mode()));
+    }
+  }
+
+  TLOG_DEBUG(3) << "tables of session " << session.UID() << ": " << t.applications.size() << " applications, "
+                << t.modules.size() << " modules, " << t.connections.size() << " connections, "
+                << t.variables.size() << " variables";
+  return t;
+}
+
+void
+write_csv(const SessionTables& tables, const std::string& directory)
+{
+  tables.for_each_table([&](const char* name, const auto& table) {
+    const std::string path = directory + '/' + name + ".csv";
+    std::ofstream out(path);
+    if (out) {
+      write_csv(out, table);
+    }
+    if (!out) {
+      throw BadTableExport(ERS_HERE, path, std::strerror(errno));
+    }
+  });
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,72 @@
+/**
+ * @file SharedMemoryCandidates.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/SharedMemoryCandidates.hpp"
+#include "dunedaqdal/ConnectivityIndex.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+
+#include "logging/Logging.hpp"
+
+namespace dunedaq::dal {
+
+std::vector<SharedMemoryCandidate>
+find_shared_memory_candidates(const ConnectivityIndex& index)
+{
+  std::vector<SharedMemoryCandidate> result;
+
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* nc = index.connection(c)->cast<NetworkConnection>();
+    auto producers = index.producers(c);
+    auto consumers = index.consumers(c);
+    if (nc == nullptr || producers.empty() || consumers.empty()) {
+      continue;
+    }
+
+    const uint32_t first_app = index.application_of(producers[0]);
+    const std::string& host = index.application(first_app)->get_host();
+
+    bool same_host = true;
+    bool same_application = true;
+    for (auto range : { producers, consumers }) {
+      for (auto m : range) {
+        const uint32_t app = index.application_of(m);
+        same_application = same_application && app == first_app;
+        same_host = same_host && index.application(app)->get_host() == host;
+      }
+    }
+
+    if (!same_host) {
+      continue;
+    }
+
+    SharedMemoryCandidate candidate;
+    candidate.connection = nc;
+    candidate.host = host;
+    candidate.producers = producers.size();
+    candidate.consumers = consumers.size();
+    candidate.same_application = same_application;
+    // every subscriber sees each published message, while send/recv receivers share them
+    const bool pub_sub = nc->get_connection_type() == "kPubSub";
+    candidate.consumer_mode = pub_sub ? "kMultiConsumer" : "kSingleConsumer";
+    if (!pub_sub && consumers.size() > 1) {
+      TLOG_DEBUG(5) << "the " << consumers.size() << " receivers of kSendRecv connection " << nc->UID()
+                    << " share its messages";
+    }
+
+    TLOG_DEBUG(5) << "network connection " << nc->UID() << " stays on host " << host;
+
+    result.push_back(std::move(candidate));
+  }
+
+  return result;
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,278 @@
+/**
+ * @file SnapshotReader.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Snapshot.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dunedaq::dal::snapshot {
+
+Reader::Reader(const std::string& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw BadSnapshot(ERS_HERE, path, std::strerror(errno));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw BadSnapshot(ERS_HERE, path, std::strerror(error));
+  }
+
+  m_mapping_size = st.st_size;
+  void* mapping = m_mapping_size ? ::mmap(nullptr, m_mapping_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+  int error = errno;
+  ::close(fd);
+
+  if (mapping == MAP_FAILED) {
+    throw BadSnapshot(ERS_HERE, path, m_mapping_size ? std::strerror(error) : "empty file");
+  }
+  m_mapping = mapping;
+
+  try {
+    attach(m_mapping, m_mapping_size, path);
+  } catch (...) {
+    ::munmap(m_mapping, m_mapping_size);
+    throw;
+  }
+}
+
+Reader::Reader(const void* data, size_t size)
+{
+  attach(data, size, "<memory>");
+}
+
+Reader::~Reader()
+{
+  if (m_mapping != nullptr) {
+    ::munmap(m_mapping, m_mapping_size);
+  }
+}
+
+Reader::Reader(Reader&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+Reader&
+Reader::operator=(Reader&& other) noexcept
+{
+  if (this != &other) {
+    if (m_mapping != nullptr) {
+      ::munmap(m_mapping, m_mapping_size);
+    }
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+    m_mapping_size = std::exchange(other.m_mapping_size, 0);
+    m_header = other.m_header;
+    m_strings = other.m_strings;
+    m_indices = other.m_indices;
+    m_applications = other.m_applications;
+    m_modules = other.m_modules;
+    m_connections = other.m_connections;
+    m_environment = other.m_environment;
+  }
+  return *this;
+}
+
+void
+Reader::attach(const void* data, size_t size, const std::string& name)
+{
+  const char* base = static_cast<const char*>(data);
+
+  if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(base) % alignof(Header) != 0) {
+    throw BadSnapshot(ERS_HERE, name, "truncated or misaligned header");
+  }
+
+  m_header = reinterpret_cast<const Header*>(base);
+
+  if (std::memcmp(m_header->magic, magic, sizeof(magic)) != 0) {
+    throw BadSnapshot(ERS_HERE, name, "not a dunedaqdal snapshot");
+  }
+  if (m_header->byte_order != byte_order_mark) {
+    throw BadSnapshot(ERS_HERE, name, "written with a different byte order");
+  }
+  if (m_header->version != format_version) {
+    throw BadSnapshot(ERS_HERE,
+                      name,
+                      "format version " + std::to_string(m_header->version) + ", expected " +
+                        std::to_string(format_version));
+  }
+  if (m_header->size > size) {
+    throw BadSnapshot(ERS_HERE, name, "truncated");
+  }
+
+  const size_t record_size[num_sections] = { 1,
+                                             sizeof(uint32_t),
+                                             sizeof(ApplicationRecord),
+                                             sizeof(ModuleRecord),
+                                             sizeof(ConnectionRecord),
+                                             sizeof(EnvironmentRecord),
+                                             sizeof(uint32_t),
+                                             sizeof(uint32_t),
+                                             sizeof(uint32_t) };
+
+  for (uint32_t s = 0; s < num_sections; ++s) {
+    const auto& sec = m_header->sections[s];
+    if (sec.offset % 8 != 0 || sec.offset > m_header->size ||
+        sec.count > (m_header->size - sec.offset) / record_size[s]) {
+      throw BadSnapshot(ERS_HERE, name, "section " + std::to_string(s) + " out of bounds");
+    }
+  }
+
+  const auto& by_app = m_header->sections[Section::applications_by_uid];
+  const auto& by_mod = m_header->sections[Section::modules_by_uid];
+  const auto& by_con = m_header->sections[Section::connections_by_uid];
+  if (by_app.count != m_header->sections[Section::applications].count ||
+      by_mod.count != m_header->sections[Section::modules].count ||
+      by_con.count != m_header->sections[Section::connections].count) {
+    throw BadSnapshot(ERS_HERE, name, "inconsistent UID index");
+  }
+
+  m_strings = base + m_header->sections[Section::strings].offset;
+  m_indices = reinterpret_cast<const uint32_t*>(base + m_header->sections[Section::indices].offset);
+  m_applications = reinterpret_cast<const ApplicationRecord*>(base + m_header->sections[Section::applications].offset);
+  m_modules = reinterpret_cast<const ModuleRecord*>(base + m_header->sections[Section::modules].offset);
+  m_connections = reinterpret_cast<const ConnectionRecord*>(base + m_header->sections[Section::connections].offset);
+  m_environment = reinterpret_cast<const EnvironmentRecord*>(base + m_header->sections[Section::environment].offset);
+
+  // every stored index is checked once here, so that the accessors can dereference them unchecked
+  const uint64_t n_indices = m_header->sections[Section::indices].count;
+  auto check_span = [&](const Span& span, size_t limit, const char* what) {
+    if (span.begin > n_indices || span.count > n_indices - span.begin) {
+      throw BadSnapshot(ERS_HERE, name, std::string(what) + " list out of bounds");
+    }
+    for (uint32_t i = span.begin; i < span.begin + span.count; ++i) {
+      if (m_indices[i] >= limit) {
+        throw BadSnapshot(ERS_HERE, name, std::string(what) + " index out of range");
+      }
+    }
+  };
+  auto check_uid_index = [&](const SectionRef& sec, size_t limit) {
+    const auto* idx = reinterpret_cast<const uint32_t*>(base + sec.offset);
+    if (std::any_of(idx, idx + sec.count, [limit](uint32_t i) { return i >= limit; })) {
+      throw BadSnapshot(ERS_HERE, name, "UID index out of range");
+    }
+  };
+
+  check_uid_index(by_app, num_applications());
+  check_uid_index(by_mod, num_modules());
+  check_uid_index(by_con, num_connections());
+
+  for (size_t a = 0; a < num_applications(); ++a) {
+    check_span(m_applications[a].modules, num_modules(), "module");
+    check_span(m_applications[a].controlled, num_applications(), "application");
+  }
+  for (size_t m = 0; m < num_modules(); ++m) {
+    if (m_modules[m].application >= num_applications()) {
+      throw BadSnapshot(ERS_HERE, name, "application index out of range");
+    }
+    check_span(m_modules[m].inputs, num_connections(), "connection");
+    check_span(m_modules[m].outputs, num_connections(), "connection");
+  }
+  for (size_t c = 0; c < num_connections(); ++c) {
+    check_span(m_connections[c].producers, num_modules(), "module");
+    check_span(m_connections[c].consumers, num_modules(), "module");
+  }
+}
+
+std::string_view
+Reader::string(const StringRef& ref) const noexcept
+{
+  const uint64_t available = m_header->sections[Section::strings].count;
+  if (ref.offset > available || ref.size > available - ref.offset) {
+    return {};
+  }
+  return std::string_view(m_strings + ref.offset, ref.size);
+}
+
+Reader::IndexRange
+Reader::indices(const Span& span) const noexcept
+{
+  const uint64_t available = m_header->sections[Section::indices].count;
+  if (span.begin > available || span.count > available - span.begin) {
+    return IndexRange(m_indices, m_indices);
+  }
+  return IndexRange(m_indices + span.begin, m_indices + span.begin + span.count);
+}
+
+template<class R>
+uint32_t
+Reader::find(Section by_uid, const R* records, std::string_view uid) const noexcept
+{
+  const auto& sec = m_header->sections[by_uid];
+  const auto* begin = reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(m_header) + sec.offset);
+  const auto* end = begin + sec.count;
+
+  const auto* it = std::lower_bound(
+    begin, end, uid, [&](uint32_t idx, std::string_view key) { return string(records[idx].uid) < key; });
+
+  if (it != end && string(records[*it].uid) == uid) {
+    return *it;
+  }
+  return npos;
+}
+
+uint32_t
+Reader::find_application(std::string_view uid) const noexcept
+{
+  return find(applications_by_uid, m_applications, uid);
+}
+
+uint32_t
+Reader::find_module(std::string_view uid) const noexcept
+{
+  return find(modules_by_uid, m_modules, uid);
+}
+
+uint32_t
+Reader::find_connection(std::string_view uid) const noexcept
+{
+  return find(connections_by_uid, m_connections, uid);
+}
+
+const EnvironmentRecord*
+Reader::environment_begin(const ApplicationRecord& app) const noexcept
+{
+  const uint64_t available = m_header->sections[Section::environment].count;
+  return m_environment + std::min<uint64_t>(app.env_begin, available);
+}
+
+const EnvironmentRecord*
+Reader::environment_end(const ApplicationRecord& app) const noexcept
+{
+  const uint64_t available = m_header->sections[Section::environment].count;
+  return m_environment + std::min<uint64_t>(uint64_t(app.env_begin) + app.env_count, available);
+}
+
+std::string_view
+Reader::getenv(const ApplicationRecord& app, std::string_view name, bool* found) const noexcept
+{
+  const auto* begin = environment_begin(app);
+  const auto* end = environment_end(app);
+
+  const auto* it = std::lower_bound(
+    begin, end, name, [this](const EnvironmentRecord& e, std::string_view key) { return string(e.name) < key; });
+
+  const bool ok = (it != end && string(it->name) == name);
+  if (found != nullptr) {
+    *found = ok;
+  }
+  return ok ? string(it->value) : std::string_view();
+}
+
+} // namespace dunedaq::dal::snapshot
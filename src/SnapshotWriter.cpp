@@ -0,0 +1,299 @@
+/**
+ * @file SnapshotWriter.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Snapshot.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/EnvironmentResolver.hpp"
+#include "dunedaqdal/StringPool.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <unordered_map>
+
+namespace dunedaq::dal::snapshot {
+
+namespace {
+
+class Builder
+{
+public:
+  StringRef add(std::string_view s)
+  {
+    auto it = m_string_ids.find(s);
+    if (it != m_string_ids.end()) {
+      return it->second;
+    }
+
+    StringRef ref{ static_cast<uint32_t>(m_strings.size()), static_cast<uint32_t>(s.size()) };
+    m_strings.append(s);
+    m_strings.push_back('\0');
+    m_string_ids.emplace(m_pool.intern(s), ref);
+    return ref;
+  }
+
+  template<class It>
+  Span add(It begin, It end)
+  {
+    Span span{ static_cast<uint32_t>(m_indices.size()), 0 };
+    for (; begin != end; ++begin) {
+      m_indices.push_back(*begin);
+      ++span.count;
+    }
+    return span;
+  }
+
+  template<class R>
+  std::vector<uint32_t> sorted_by_uid(const std::vector<R>& records) const
+  {
+    std::vector<uint32_t> order(records.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+      return view(records[a].uid) < view(records[b].uid);
+    });
+    return order;
+  }
+
+  std::vector<char> serialise(Header header) const
+  {
+    auto apps_by_uid = sorted_by_uid(applications);
+    auto modules_by_uid = sorted_by_uid(modules);
+    auto connections_by_uid = sorted_by_uid(connections);
+
+    struct Chunk
+    {
+      const void* data;
+      uint64_t bytes;
+      uint64_t count;
+    };
+
+    Chunk chunks[num_sections];
+    chunks[strings] = { m_strings.data(), m_strings.size(), m_strings.size() };
+    chunks[indices] = { m_indices.data(), m_indices.size() * sizeof(uint32_t), m_indices.size() };
+    chunks[Section::applications] = { applications.data(),
+                                      applications.size() * sizeof(ApplicationRecord),
+                                      applications.size() };
+    chunks[Section::modules] = { modules.data(), modules.size() * sizeof(ModuleRecord), modules.size() };
+    chunks[Section::connections] = { connections.data(),
+                                     connections.size() * sizeof(ConnectionRecord),
+                                     connections.size() };
+    chunks[Section::environment] = { environment.data(),
+                                     environment.size() * sizeof(EnvironmentRecord),
+                                     environment.size() };
+    chunks[applications_by_uid] = { apps_by_uid.data(), apps_by_uid.size() * sizeof(uint32_t), apps_by_uid.size() };
+    chunks[Section::modules_by_uid] = { modules_by_uid.data(),
+                                        modules_by_uid.size() * sizeof(uint32_t),
+                                        modules_by_uid.size() };
+    chunks[Section::connections_by_uid] = { connections_by_uid.data(),
+                                            connections_by_uid.size() * sizeof(uint32_t),
+                                            connections_by_uid.size() };
+
+    uint64_t offset = sizeof(Header);
+    for (uint32_t s = 0; s < num_sections; ++s) {
+      header.sections[s] = { offset, chunks[s].count };
+      offset = align(offset + chunks[s].bytes);
+    }
+    header.size = offset;
+
+    std::vector<char> blob(offset, 0);
+    std::memcpy(blob.data(), &header, sizeof(header));
+    for (uint32_t s = 0; s < num_sections; ++s) {
+      if (chunks[s].bytes != 0) {
+        std::memcpy(blob.data() + header.sections[s].offset, chunks[s].data, chunks[s].bytes);
+      }
+    }
+    return blob;
+  }
+
+  std::vector<ApplicationRecord> applications;
+  std::vector<ModuleRecord> modules;
+  std::vector<ConnectionRecord> connections;
+  std::vector<EnvironmentRecord> environment;
+
+private:
+  static uint64_t align(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+  std::string_view view(const StringRef& ref) const
+  {
+    return std::string_view(m_strings.data() + ref.offset, ref.size);
+  }
+
+  std::string m_strings;
+  StringPool m_pool;
+  std::unordered_map<std::string_view, StringRef> m_string_ids;
+  std::vector<uint32_t> m_indices;
+};
+
+} // namespace
+
+std::vector<char>
+make(const Session& session, EnvironmentResolver& resolver, const ConfigHasher* hashes)
+{
+  Builder b;
+  ConnectivityIndex index(session);
+
+  std::vector<const Application*> apps;
+  std::unordered_map<std::string, uint32_t> app_ids;
+  for (const auto* app : session.get_applications()) {
+    if (app_ids.emplace(app->UID(), apps.size()).second) {
+      apps.push_back(app);
+    }
+  }
+
+  const StringRef empty = b.add("");
+
+  for (const auto* app : apps) {
+    ApplicationRecord rec{};
+    rec.uid = b.add(app->UID());
+    rec.class_name = b.add(app->class_name());
+    rec.kind = ApplicationKind::other;
+    rec.host = empty;
+
+    if (const auto* daq_app = app->cast<DaqApplication>()) {
+      rec.kind = ApplicationKind::daq;
+      rec.host = b.add(daq_app->get_host());
+      rec.port = daq_app->get_port();
+      auto modules = index.modules_of(index.application_index(daq_app->UID()));
+      rec.modules = b.add(modules.begin(), modules.end());
+    } else if (const auto* rc_app = app->cast<RCApplication>()) {
+      rec.kind = ApplicationKind::run_control;
+      rec.timeout = rc_app->get_Timeout();
+      std::vector<uint32_t> controlled;
+      for (const auto* c : rc_app->get_ApplicationsControlled()) {
+        auto it = app_ids.find(c->UID());
+        if (it != app_ids.end()) {
+          controlled.push_back(it->second);
+        }
+      }
+      rec.controlled = b.add(controlled.begin(), controlled.end());
+    }
+
+    // std::map keeps the entries sorted by name, as expected by Reader::getenv()
+    rec.env_begin = b.environment.size();
+    for (const auto& [name, value] : resolver.get(session, *app)) {
+      b.environment.push_back({ b.add(name), b.add(value) });
+    }
+    rec.env_count = b.environment.size() - rec.env_begin;
+
+    if (hashes != nullptr) {
+      if (const auto* hash = hashes->application(app->UID())) {
+        rec.hash = *hash;
+      }
+    }
+
+    b.applications.push_back(rec);
+  }
+
+  for (uint32_t m = 0; m < index.num_modules(); ++m) {
+    const auto* mod = index.module(m);
+    ModuleRecord rec{};
+    rec.uid = b.add(mod->UID());
+    rec.plugin = b.add(mod->get_plugin());
+    rec.application = app_ids[index.application(index.application_of(m))->UID()];
+    auto inputs = index.inputs(m);
+    rec.inputs = b.add(inputs.begin(), inputs.end());
+    auto outputs = index.outputs(m);
+    rec.outputs = b.add(outputs.begin(), outputs.end());
+    b.modules.push_back(rec);
+  }
+
+  for (uint32_t c = 0; c < index.num_connections(); ++c) {
+    const auto* con = index.connection(c);
+    ConnectionRecord rec{};
+    rec.uid = b.add(con->UID());
+    rec.class_name = b.add(con->class_name());
+    rec.kind = ConnectionKind::other;
+    rec.data_type = b.add(con->get_data_type());
+    rec.queue_type = rec.wait_strategy = rec.connection_type = rec.uri = empty;
+    rec.segment_name = rec.consumer_mode = empty;
+
+    if (const auto* q = con->cast<Queue>()) {
+      rec.kind = ConnectionKind::queue;
+      rec.capacity = q->get_capacity();
+      rec.queue_type = b.add(q->get_queue_type());
+      rec.push_batch_size = q->get_push_batch_size();
+      rec.pop_batch_size = q->get_pop_batch_size();
+      rec.cache_line_padding = q->get_cache_line_padding();
+      rec.numa_node = q->get_numa_node();
+      rec.wait_strategy = b.add(q->get_wait_strategy());
+    } else if (const auto* nc = con->cast<NetworkConnection>()) {
+      rec.kind = ConnectionKind::network;
+      rec.connection_type = b.add(nc->get_connection_type());
+      rec.uri = b.add(nc->get_uri());
+    } else if (const auto* shm = con->cast<SharedMemoryConnection>()) {
+      rec.kind = ConnectionKind::shared_memory;
+      rec.segment_name = b.add(shm->get_segment_name());
+      rec.segment_size = shm->get_segment_size();
+      rec.slot_count = shm->get_slot_count();
+      rec.consumer_mode = b.add(shm->get_consumer_mode());
+    }
+
+    auto producers = index.producers(c);
+    rec.producers = b.add(producers.begin(), producers.end());
+    auto consumers = index.consumers(c);
+    rec.consumers = b.add(consumers.begin(), consumers.end());
+    b.connections.push_back(rec);
+  }
+
+  Header header{};
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = format_version;
+  header.byte_order = byte_order_mark;
+  header.session = b.add(session.UID());
+  header.use_connectivity_server = session.get_use_connectivity_server();
+  header.connectivity_service_interval_ms = session.get_connectivity_service_interval_ms();
+  if (hashes != nullptr) {
+    header.hash = hashes->session();
+  }
+
+  auto blob = b.serialise(header);
+
+  TLOG_DEBUG(3) << "snapshot of session " << session.UID() << ": " << b.applications.size() << " applications, "
+                << b.modules.size() << " modules, " << b.connections.size() << " connections, " << blob.size()
+                << " bytes";
+
+  return blob;
+}
+
+void
+write(const Session& session, EnvironmentResolver& resolver, const std::string& path, const ConfigHasher* hashes)
+{
+  auto blob = make(session, resolver, hashes);
+
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(blob.data(), blob.size());
+    if (!out) {
+      throw BadSnapshot(ERS_HERE, tmp, "write failed");
+    }
+  }
+
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    throw BadSnapshot(ERS_HERE, path, std::strerror(errno));
+  }
+}
+
+} // namespace dunedaq::dal::snapshot
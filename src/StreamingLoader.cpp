@@ -0,0 +1,588 @@
+/**
+ * @file StreamingLoader.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/StreamingLoader.hpp"
+
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Profiler.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+#include <utility>
+
+namespace dunedaq::dal {
+
+/// Tokeniser of one file, feeding the elements it reads to the loader
+class StreamingLoader::Parser
+{
+public:
+  Parser(StreamingLoader& loader, const std::string& path, std::vector<std::string>& includes)
+    : m_loader(loader)
+    , m_path(path)
+    , m_includes(includes)
+    , m_in(path, std::ios::binary)
+  {
+    if (!m_in) {
+      throw BadDataFile(ERS_HERE, path, 0, std::strerror(errno));
+    }
+  }
+
+  void run()
+  {
+    while (!m_done) {
+      const size_t lt = m_buffer.find('<', m_pos);
+      if (lt == std::string::npos) {
+        advance(m_buffer.size());
+        if (!fill()) {
+          break;
+        }
+        continue;
+      }
+      advance(lt);
+
+      // enough look-ahead to tell comments and CDATA from other markup
+      if (m_buffer.size() - lt < 9 && !m_eof) {
+        fill();
+        continue;
+      }
+
+      const size_t end = markup_end(lt);
+      if (end == std::string::npos) {
+        if (!fill()) {
+          fail("unterminated markup");
+        }
+        continue;
+      }
+
+      const size_t lines = std::count(m_buffer.begin() + lt, m_buffer.begin() + end, '\n');
+      markup(lt, end);
+      m_line += lines;
+      m_pos = end + 1;
+    }
+
+    if (!m_root) {
+      fail("no <oks-data> element");
+    }
+    if (m_loader.m_current != npos) {
+      fail("unterminated <obj>");
+    }
+  }
+
+  /// False when the root element is <oks-schema>
+  bool is_data() const noexcept { return !m_schema; }
+
+private:
+  /// Append a chunk to the buffer, dropping what was consumed; false at the end of the file
+  bool fill()
+  {
+    if (m_eof) {
+      return false;
+    }
+    m_buffer.erase(0, m_pos);
+    m_pos = 0;
+
+    const size_t old_size = m_buffer.size();
+    m_buffer.resize(old_size + m_loader.m_parameters.chunk_size);
+    m_in.read(m_buffer.data() + old_size, m_loader.m_parameters.chunk_size);
+    m_buffer.resize(old_size + m_in.gcount());
+    if (m_in.gcount() == 0 || !m_in) {
+      m_eof = true;
+    }
+    return m_in.gcount() != 0;
+  }
+
+  void advance(size_t to)
+  {
+    m_line += std::count(m_buffer.begin() + m_pos, m_buffer.begin() + to, '\n');
+    m_pos = to;
+  }
+
+  /// Index of the '>' closing the markup opened at lt, or npos if it is not in the buffer yet
+  size_t markup_end(size_t lt) const
+  {
+    auto closing = [&](const char* terminator) {
+      const size_t i = m_buffer.find(terminator, lt);
+      return i == std::string::npos ? i : i + std::strlen(terminator) - 1;
+    };
+
+    const std::string_view head(m_buffer.data() + lt, std::min<size_t>(9, m_buffer.size() - lt));
+    if (head.compare(0, 4, "<!--") == 0) {
+      return closing("-->");
+    }
+    if (head.compare(0, 9, "<![CDATA[") == 0) {
+      return closing("]]>");
+    }
+    if (head.compare(0, 2, "<?") == 0) {
+      return closing("?>");
+    }
+
+    // tags and declarations; the internal subset of <!DOCTYPE> holds markup itself
+    int depth = 0;
+    for (size_t i = lt + 1; i < m_buffer.size(); ++i) {
+      const char c = m_buffer[i];
+      if (c == '"' || c == '\'') {
+        i = m_buffer.find(c, i + 1);
+        if (i == std::string::npos) {
+          return i;
+        }
+      } else if (c == '[') {
+        ++depth;
+      } else if (c == ']') {
+        --depth;
+      } else if (c == '>' && depth <= 0) {
+        return i;
+      }
+    }
+    return std::string::npos;
+  }
+
+  static bool is_space(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+  void markup(size_t lt, size_t end)
+  {
+    char* p = m_buffer.data() + lt + 1;
+    char* const stop = m_buffer.data() + end;
+
+    if (*p == '!' || *p == '?') {
+      return;
+    }
+
+    const bool closing = *p == '/';
+    if (closing) {
+      ++p;
+    }
+    const bool empty = !closing && stop[-1] == '/';
+    char* const last = empty ? stop - 1 : stop;
+
+    char* name_end = p;
+    while (name_end != last && !is_space(*name_end)) {
+      ++name_end;
+    }
+    const std::string_view name(p, name_end - p);
+    if (name.empty()) {
+      fail("tag without a name");
+    }
+
+    if (closing) {
+      end_element(name);
+      return;
+    }
+
+    m_attributes.clear();
+    for (p = name_end;;) {
+      while (p != last && is_space(*p)) {
+        ++p;
+      }
+      if (p == last) {
+        break;
+      }
+
+      char* attr_end = p;
+      while (attr_end != last && *attr_end != '=' && !is_space(*attr_end)) {
+        ++attr_end;
+      }
+      const std::string_view attr(p, attr_end - p);
+      p = attr_end;
+      while (p != last && is_space(*p)) {
+        ++p;
+      }
+      if (p == last || *p != '=') {
+        fail("attribute " + std::string(attr) + " without a value");
+      }
+      ++p;
+      while (p != last && is_space(*p)) {
+        ++p;
+      }
+      if (p == last || (*p != '"' && *p != '\'')) {
+        fail("unquoted value of attribute " + std::string(attr));
+      }
+      char* value_end = static_cast<char*>(std::memchr(p + 1, *p, last - p - 1));
+      if (value_end == nullptr) {
+        fail("unterminated value of attribute " + std::string(attr));
+      }
+      m_attributes.emplace_back(attr, decode(p + 1, value_end));
+      p = value_end + 1;
+    }
+
+    start_element(name, empty);
+    if (empty) {
+      end_element(name);
+    }
+  }
+
+  /// Replace the entity and character references in place; decoding never grows the text
+  std::string_view decode(char* begin, char* end)
+  {
+    char* w = static_cast<char*>(std::memchr(begin, '&', end - begin));
+    if (w == nullptr) {
+      return std::string_view(begin, end - begin);
+    }
+
+    for (char* r = w; r != end;) {
+      if (*r != '&') {
+        *w++ = *r++;
+        continue;
+      }
+
+      char* semicolon = static_cast<char*>(std::memchr(r, ';', end - r));
+      if (semicolon == nullptr) {
+        fail("unterminated entity reference");
+      }
+      const std::string_view entity(r + 1, semicolon - r - 1);
+      if (entity == "lt") {
+        *w++ = '<';
+      } else if (entity == "gt") {
+        *w++ = '>';
+      } else if (entity == "amp") {
+        *w++ = '&';
+      } else if (entity == "quot") {
+        *w++ = '"';
+      } else if (entity == "apos") {
+        *w++ = '\'';
+      } else if (entity.size() > 1 && entity[0] == '#') {
+        const bool hex = entity[1] == 'x' || entity[1] == 'X';
+        char* digits_end = nullptr;
+        const unsigned long cp = std::strtoul(r + (hex ? 3 : 2), &digits_end, hex ? 16 : 10);
+        if (digits_end != semicolon || cp == 0 || cp > 0x10FFFF) {
+          fail("bad character reference &" + std::string(entity) + ';');
+        }
+        // UTF-8; at most as long as the reference itself
+        if (cp < 0x80) {
+          *w++ = char(cp);
+        } else if (cp < 0x800) {
+          *w++ = char(0xC0 | (cp >> 6));
+          *w++ = char(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+          *w++ = char(0xE0 | (cp >> 12));
+          *w++ = char(0x80 | ((cp >> 6) & 0x3F));
+          *w++ = char(0x80 | (cp & 0x3F));
+        } else {
+          *w++ = char(0xF0 | (cp >> 18));
+          *w++ = char(0x80 | ((cp >> 12) & 0x3F));
+          *w++ = char(0x80 | ((cp >> 6) & 0x3F));
+          *w++ = char(0x80 | (cp & 0x3F));
+        }
+      } else {
+        fail("unknown entity &" + std::string(entity) + ';');
+      }
+      r = semicolon + 1;
+    }
+    return std::string_view(begin, w - begin);
+  }
+
+  /// Value of an attribute of the current tag, empty if absent
+  std::string_view get(std::string_view attr) const noexcept
+  {
+    for (const auto& [name, value] : m_attributes) {
+      if (name == attr) {
+        return value;
+      }
+    }
+    return {};
+  }
+
+  void start_element(std::string_view name, bool empty)
+  {
+    if (!m_root) {
+      if (name == "oks-schema") {
+        m_schema = m_root = m_done = true;
+        return;
+      }
+      if (name != "oks-data") {
+        fail("root element <" + std::string(name) + "> is not <oks-data>");
+      }
+      m_root = true;
+      return;
+    }
+
+    auto& loader = m_loader;
+    if (name == "obj") {
+      if (m_in_object) {
+        fail("nested <obj>");
+      }
+      const auto cls = get("class");
+      const auto uid = get("id");
+      if (cls.empty() || uid.empty()) {
+        fail("<obj> without class or id");
+      }
+      if (loader.find(cls, uid) != npos) {
+        fail("duplicate object " + std::string(uid) + '@' + std::string(cls));
+      }
+      m_in_object = true;
+      loader.begin_object(cls, uid);
+    } else if (name == "attr") {
+      if (loader.m_current != npos) {
+        loader.add_attribute(get("name"), get("type"));
+        for (const auto& [attr, value] : m_attributes) {
+          if (attr == "val") {
+            loader.add_value(value);
+          }
+        }
+      }
+      m_in_attribute = !empty;
+    } else if (name == "data") {
+      if (m_in_attribute && loader.m_current != npos) {
+        loader.add_value(get("val"));
+      }
+    } else if (name == "rel") {
+      if (loader.m_current != npos) {
+        loader.add_relationship(get("name"));
+        loader.add_reference(get("class"), get("id"));
+      }
+      m_in_relationship = !empty;
+    } else if (name == "ref") {
+      if (m_in_relationship && loader.m_current != npos) {
+        loader.add_reference(get("class"), get("id"));
+      }
+    } else if (name == "file") {
+      const auto path = get("path");
+      if (!path.empty()) {
+        m_includes.emplace_back(path);
+      }
+    }
+  }
+
+  void end_element(std::string_view name)
+  {
+    if (name == "obj") {
+      m_loader.end_object();
+      m_in_object = false;
+    } else if (name == "attr") {
+      m_in_attribute = false;
+    } else if (name == "rel") {
+      m_in_relationship = false;
+    } else if (name == "oks-data") {
+      m_done = true;
+    }
+  }
+
+  [[noreturn]] void fail(const std::string& reason) const { throw BadDataFile(ERS_HERE, m_path, m_line, reason); }
+
+  StreamingLoader& m_loader;
+  const std::string& m_path;
+  std::vector<std::string>& m_includes;
+  std::ifstream m_in;
+
+  std::string m_buffer;
+  size_t m_pos = 0;
+  size_t m_line = 1;
+  bool m_eof = false;
+  bool m_done = false;
+
+  bool m_root = false;
+  bool m_schema = false;
+  bool m_in_object = false;
+  bool m_in_attribute = false;
+  bool m_in_relationship = false;
+
+  /// Attributes of the current tag, pointing into the buffer
+  std::vector<std::pair<std::string_view, std::string_view>> m_attributes;
+};
+
+StreamingLoader::StreamingLoader(StreamingLoaderParameters parameters)
+  : m_parameters(std::move(parameters))
+  , m_classes(m_parameters.classes.begin(), m_parameters.classes.end())
+{
+}
+
+bool
+StreamingLoader::wanted(std::string_view class_name) const noexcept
+{
+  return m_classes.empty() || m_classes.find(class_name) != m_classes.end();
+}
+
+uint32_t
+StreamingLoader::find(std::string_view class_name, std::string_view uid) const noexcept
+{
+  auto it = m_index.find(Key{ class_name, uid });
+  return it != m_index.end() ? it->second : npos;
+}
+
+std::string_view
+StreamingLoader::attribute(const StreamedObject& obj, std::string_view name) const noexcept
+{
+  for (const auto& a : attributes(obj)) {
+    if (a.name == name) {
+      return a.values.count != 0 ? m_values[a.values.begin] : std::string_view();
+    }
+  }
+  return {};
+}
+
+StreamedRange<uint32_t>
+StreamingLoader::relationship(const StreamedObject& obj, std::string_view name) const noexcept
+{
+  for (const auto& r : relationships(obj)) {
+    if (r.name == name) {
+      return targets(r);
+    }
+  }
+  return range(m_targets, StreamedSpan());
+}
+
+void
+StreamingLoader::begin_object(std::string_view class_name, std::string_view uid)
+{
+  if (!wanted(class_name)) {
+    m_current = npos;
+    return;
+  }
+
+  m_current = m_objects.size();
+  auto& obj = m_objects.emplace_back();
+  obj.class_name = m_strings.intern(class_name);
+  obj.uid = m_strings.intern(uid);
+  obj.attributes.begin = m_attributes.size();
+  obj.relationships.begin = m_relationships.size();
+
+  const Key key{ obj.class_name, obj.uid };
+  m_index.emplace(key, m_current);
+
+  auto it = m_fix_ups.find(key);
+  if (it != m_fix_ups.end()) {
+    for (const auto& f : it->second) {
+      m_targets[f.target] = m_current;
+    }
+    m_fix_ups.erase(it);
+  }
+}
+
+void
+StreamingLoader::add_attribute(std::string_view name, std::string_view type)
+{
+  auto& a = m_attributes.emplace_back();
+  a.name = m_strings.intern(name);
+  a.type = m_strings.intern(type);
+  a.values.begin = m_values.size();
+  ++m_objects[m_current].attributes.count;
+}
+
+void
+StreamingLoader::add_value(std::string_view value)
+{
+  m_values.push_back(m_strings.intern(value));
+  ++m_attributes.back().values.count;
+}
+
+void
+StreamingLoader::add_relationship(std::string_view name)
+{
+  auto& r = m_relationships.emplace_back();
+  r.name = m_strings.intern(name);
+  r.targets.begin = m_targets.size();
+  ++m_objects[m_current].relationships.count;
+}
+
+void
+StreamingLoader::add_reference(std::string_view class_name, std::string_view uid)
+{
+  if (class_name.empty() || uid.empty()) {
+    return;
+  }
+
+  ++m_relationships.back().targets.count;
+  if (!wanted(class_name)) {
+    m_targets.push_back(npos);
+    return;
+  }
+
+  const uint32_t target = find(class_name, uid);
+  if (target == npos) {
+    m_fix_ups[Key{ m_strings.intern(class_name), m_strings.intern(uid) }].push_back(
+      FixUp{ m_current, uint32_t(m_relationships.size() - 1), uint32_t(m_targets.size()) });
+  }
+  m_targets.push_back(target);
+}
+
+void
+StreamingLoader::end_object()
+{
+  if (m_current != npos && m_callback) {
+    m_callback(m_current);
+  }
+  m_current = npos;
+}
+
+void
+StreamingLoader::load(const std::string& path)
+{
+  namespace fs = std::filesystem;
+
+  // included files are looked up next to the including one, then in DUNEDAQ_DB_PATH
+  std::vector<fs::path> search_path;
+  if (const char* db_path = std::getenv("DUNEDAQ_DB_PATH")) {
+    std::string_view list(db_path);
+    for (size_t begin = 0; begin <= list.size();) {
+      size_t colon = std::min(list.find(':', begin), list.size());
+      if (colon != begin) {
+        search_path.emplace_back(list.substr(begin, colon - begin));
+      }
+      begin = colon + 1;
+    }
+  }
+
+  std::deque<std::string> pending{ path };
+  while (!pending.empty()) {
+    const std::string file = fs::weakly_canonical(pending.front()).string();
+    pending.pop_front();
+    if (std::find(m_files.begin(), m_files.end(), file) != m_files.end()) {
+      continue;
+    }
+
+    std::vector<std::string> includes;
+    Parser parser(*this, file, includes);
+    {
+      DUNEDAQDAL_PROFILE_SCOPE("parse", file);
+      parser.run();
+    }
+    if (!parser.is_data()) {
+      continue;
+    }
+    m_files.push_back(file);
+    TLOG_DEBUG(3) << "streamed " << file << ": " << m_objects.size() << " objects, " << m_fix_ups.size()
+                  << " outstanding references";
+
+    if (!m_parameters.follow_includes) {
+      continue;
+    }
+    for (const auto& include : includes) {
+      if (include.size() >= 11 && include.compare(include.size() - 11, 11, ".schema.xml") == 0) {
+        continue;
+      }
+      fs::path found = fs::path(file).parent_path() / include;
+      for (auto dir = search_path.begin(); !fs::exists(found) && dir != search_path.end(); ++dir) {
+        found = *dir / include;
+      }
+      if (!fs::exists(found)) {
+        throw BadDataFile(ERS_HERE, file, 0, "cannot find included file " + include);
+      }
+      pending.push_back(found.string());
+    }
+  }
+
+  m_unresolved.clear();
+  for (const auto& [key, fix_ups] : m_fix_ups) {
+    for (const auto& f : fix_ups) {
+      m_unresolved.push_back(
+        UnresolvedReference{ f.object, m_relationships[f.relationship].name, key.class_name, key.uid });
+    }
+  }
+  std::sort(m_unresolved.begin(), m_unresolved.end(), [](const auto& x, const auto& y) {
+    return std::tie(x.object, x.relationship, x.uid) < std::tie(y.object, y.relationship, y.uid);
+  });
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,117 @@
+/**
+ * @file StringPool.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/StringPool.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Variable.hpp"
+
+#include <cstring>
+
+namespace dunedaq::dal {
+
+StringPool::StringPool(size_t block_size)
+  : m_block_size(block_size)
+{
+}
+
+std::string_view
+StringPool::intern(std::string_view s)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_strings.find(s);
+  if (it != m_strings.end()) {
+    return *it;
+  }
+
+  std::string_view pooled(store(s), s.size());
+  m_strings.insert(pooled);
+  return pooled;
+}
+
+const char*
+StringPool::store(std::string_view s)
+{
+  const size_t needed = s.size() + 1;
+  char* p = nullptr;
+
+  if (needed > m_block_size / 4) {
+    // large strings get a block of their own, so the current block keeps filling up
+    m_large_blocks.emplace_back(new char[needed]);
+    m_capacity += needed;
+    p = m_large_blocks.back().get();
+  } else {
+    if (m_blocks.empty() || m_block_used + needed > m_block_size) {
+      m_blocks.emplace_back(new char[m_block_size]);
+      m_capacity += m_block_size;
+      m_block_used = 0;
+    }
+    p = m_blocks.back().get() + m_block_used;
+    m_block_used += needed;
+  }
+
+  std::memcpy(p, s.data(), s.size());
+  p[s.size()] = '\0';
+  return p;
+}
+
+size_t
+StringPool::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_strings.size();
+}
+
+size_t
+StringPool::capacity() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_capacity;
+}
+
+std::string_view
+interned_data_type(const Connection& c, StringPool& pool)
+{
+  return pool.intern(c.get_data_type());
+}
+
+std::string_view
+interned_uri(const NetworkConnection& c, StringPool& pool)
+{
+  return pool.intern(c.get_uri());
+}
+
+std::string_view
+interned_plugin(const DaqModule& m, StringPool& pool)
+{
+  return pool.intern(m.get_plugin());
+}
+
+std::string_view
+interned_host(const DaqApplication& a, StringPool& pool)
+{
+  return pool.intern(a.get_host());
+}
+
+std::string_view
+interned_name(const Variable& v, StringPool& pool)
+{
+  return pool.intern(v.get_Name());
+}
+
+std::string_view
+interned_value(const Variable& v, StringPool& pool)
+{
+  return pool.intern(v.get_Value());
+}
+
+} // namespace dunedaq::dal
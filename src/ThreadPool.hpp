@@ -0,0 +1,144 @@
+/**
+ * @file ThreadPool.hpp
+ *
+ * Minimal worker pool used internally by the parallel dunedaqdal algorithms
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_SRC_THREADPOOL_HPP_
+#define DUNEDAQDAL_SRC_THREADPOOL_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dunedaq::dal::detail {
+
+/**
+ * @brief Fixed set of worker threads consuming a shared task queue
+ *
+ * Tasks may submit further tasks. wait() returns once the queue is drained
+ * and no task is running, rethrowing the first exception thrown by a task.
+ */
+class ThreadPool
+{
+public:
+  /// Start n_threads workers; 0 means one per hardware thread
+  explicit ThreadPool(unsigned int n_threads = 0)
+  {
+    if (n_threads == 0) {
+      n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(n_threads);
+    for (unsigned int i = 0; i < n_threads; ++i) {
+      m_workers.emplace_back([this] { run(); });
+    }
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& t : m_workers) {
+      t.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  unsigned int size() const noexcept { return m_workers.size(); }
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+      ++m_pending;
+    }
+    m_work_cv.notify_one();
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [this] { return m_pending == 0; });
+    if (m_error) {
+      auto error = m_error;
+      m_error = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  /// Run fn(i) for i in [0, n) split into contiguous chunks over the workers, and wait
+  template<class F>
+  void parallel_for(size_t n, F fn)
+  {
+    const size_t chunks = std::min<size_t>(n, size() * 4);
+    for (size_t c = 0; c < chunks; ++c) {
+      const size_t begin = n * c / chunks;
+      const size_t end = n * (c + 1) / chunks;
+      submit([begin, end, &fn] {
+        for (size_t i = begin; i < end; ++i) {
+          fn(i);
+        }
+      });
+    }
+    wait();
+  }
+
+private:
+  void run()
+  {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_work_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) {
+          m_error = std::current_exception();
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_pending == 0) {
+        m_done_cv.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  size_t m_pending = 0;
+  bool m_stop = false;
+  std::exception_ptr m_error;
+};
+
+} // namespace dunedaq::dal::detail
+
+#endif // DUNEDAQDAL_SRC_THREADPOOL_HPP_
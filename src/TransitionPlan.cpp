@@ -0,0 +1,265 @@
+/**
+ * @file TransitionPlan.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/TransitionPlan.hpp"
+
+#include "ThreadPool.hpp"
+
+#include "dunedaqdal/Issues.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/ControlDependency.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/TransitionTimeout.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <unordered_map>
+
+namespace dunedaq::dal {
+
+namespace {
+
+enum class Direction
+{
+  none,
+  forward, ///< application after depends_on
+  reverse  ///< depends_on after application
+};
+
+bool
+contains(const std::vector<std::string>& transitions, const std::string& transition)
+{
+  return std::find(transitions.begin(), transitions.end(), transition) != transitions.end();
+}
+
+Direction
+direction(const ControlDependency& dependency, const std::string& transition)
+{
+  if (contains(dependency.get_reversed_for(), transition)) {
+    return Direction::reverse;
+  }
+  if (dependency.get_transitions().empty() || contains(dependency.get_transitions(), transition)) {
+    return Direction::forward;
+  }
+  return Direction::none;
+}
+
+/// A cycle through the nodes left over by Kahn's algorithm, each of which has a predecessor among them
+std::string
+find_cycle(const std::vector<const Application*>& nodes,
+           const std::vector<std::vector<size_t>>& predecessors,
+           const std::vector<size_t>& in_degree)
+{
+  size_t n = 0;
+  while (in_degree[n] == 0) {
+    ++n;
+  }
+
+  std::vector<size_t> walk;
+  std::vector<bool> seen(nodes.size(), false);
+  while (!seen[n]) {
+    seen[n] = true;
+    walk.push_back(n);
+    n = *std::find_if(predecessors[n].begin(), predecessors[n].end(), [&](size_t p) { return in_degree[p] != 0; });
+  }
+
+  // the walk follows predecessors: print the cycle in dispatch order
+  std::string path = nodes[n]->UID();
+  for (auto it = walk.rbegin(); it != walk.rend() && *it != n; ++it) {
+    path += " -> " + nodes[*it]->UID();
+  }
+  return path + " -> " + nodes[n]->UID();
+}
+
+} // namespace
+
+TransitionPlan::TransitionPlan(const RCApplication& controller, const std::string& transition)
+  : m_controller(controller)
+  , m_transition(transition)
+  , m_max_concurrent(controller.get_max_concurrent_commands())
+  , m_timeout(controller.get_Timeout())
+{
+  for (const auto* t : controller.get_transition_timeouts()) {
+    if (t->get_transition() == transition) {
+      m_timeout = std::chrono::seconds(t->get_timeout());
+      break;
+    }
+  }
+
+  std::vector<const Application*> nodes;
+  std::unordered_map<const Application*, size_t> index;
+  for (const auto* app : controller.get_ApplicationsControlled()) {
+    if (index.emplace(app, nodes.size()).second) {
+      nodes.push_back(app);
+    }
+  }
+
+  auto node = [&](const ControlDependency& dependency, const Application* app) {
+    auto it = index.find(app);
+    if (it == index.end()) {
+      throw BadControlDependency(ERS_HERE,
+                                 dependency.UID(),
+                                 controller.UID(),
+                                 (app ? app->UID() : std::string("(null)")) + " is not in ApplicationsControlled");
+    }
+    return it->second;
+  };
+
+  std::vector<std::vector<size_t>> successors(nodes.size()), predecessors(nodes.size());
+  std::vector<size_t> in_degree(nodes.size(), 0);
+  for (const auto* dependency : controller.get_dependencies()) {
+    const Direction dir = direction(*dependency, transition);
+    if (dir == Direction::none) {
+      continue;
+    }
+    const size_t app = node(*dependency, dependency->get_application());
+    for (const auto* other : dependency->get_depends_on()) {
+      const size_t dep = node(*dependency, other);
+      const size_t from = dir == Direction::forward ? dep : app;
+      const size_t to = dir == Direction::forward ? app : dep;
+      successors[from].push_back(to);
+      predecessors[to].push_back(from);
+      ++in_degree[to];
+    }
+  }
+
+  // Kahn's algorithm, one level at a time
+  std::vector<size_t> current;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (in_degree[i] == 0) {
+      current.push_back(i);
+    }
+  }
+  while (!current.empty()) {
+    std::vector<size_t> next;
+    auto& level = m_levels.emplace_back();
+    for (size_t i : current) {
+      level.push_back(nodes[i]);
+      for (size_t s : successors[i]) {
+        if (--in_degree[s] == 0) {
+          next.push_back(s);
+        }
+      }
+    }
+    m_size += level.size();
+    std::sort(next.begin(), next.end());
+    current.swap(next);
+  }
+
+  if (m_size != nodes.size()) {
+    throw CircularDependency(ERS_HERE,
+                             "transition " + transition + " of " + controller.full_name(),
+                             find_cycle(nodes, predecessors, in_degree));
+  }
+
+  TLOG_DEBUG(3) << "transition " << transition << " of " << controller.UID() << ": " << m_size << " applications in "
+                << m_levels.size() << " levels";
+}
+
+std::chrono::seconds
+TransitionPlan::worst_case_duration() const noexcept
+{
+  std::chrono::seconds duration(0);
+  for (const auto& level : m_levels) {
+    const size_t waves = m_max_concurrent == 0 ? 1 : (level.size() + m_max_concurrent - 1) / m_max_concurrent;
+    duration += m_timeout * static_cast<long>(waves);
+  }
+  return duration;
+}
+
+std::vector<const Application*>
+TransitionPlan::execute(const Command& command) const
+{
+  std::vector<const Application*> failed;
+  if (m_size == 0) {
+    return failed;
+  }
+
+  size_t widest = 0;
+  for (const auto& level : m_levels) {
+    widest = std::max(widest, level.size());
+  }
+  // commands mostly wait for their application, so the pool is sized by the concurrency, not by the cores
+  detail::ThreadPool pool(m_max_concurrent == 0 ? widest : std::min<size_t>(widest, m_max_concurrent));
+
+  for (size_t l = 0; l < m_levels.size(); ++l) {
+    const auto& level = m_levels[l];
+    std::vector<char> ok(level.size(), 0);
+    std::vector<std::string> reasons(level.size(), "command returned false");
+    for (size_t i = 0; i < level.size(); ++i) {
+      pool.submit([&, i] {
+        // nothing may escape to the pool thread, whatever the command throws
+        try {
+          ok[i] = command(*level[i], m_timeout);
+        } catch (const std::exception& ex) {
+          reasons[i] = ex.what();
+        } catch (...) {
+          reasons[i] = "unknown exception";
+        }
+      });
+    }
+    pool.wait();
+
+    for (size_t i = 0; i < level.size(); ++i) {
+      if (!ok[i]) {
+        failed.push_back(level[i]);
+        ers::error(TransitionFailed(ERS_HERE, m_transition, level[i]->UID(), reasons[i]));
+      }
+    }
+    if (!failed.empty()) {
+      TLOG_DEBUG(3) << "transition " << m_transition << " of " << m_controller.UID() << " stopped at level " << l
+                    << ": " << failed.size() << " failures";
+      break;
+    }
+  }
+  return failed;
+}
+
+TransitionPlans::TransitionPlans(const Session& session)
+  : m_session(session)
+{
+}
+
+std::shared_ptr<const TransitionPlan>
+TransitionPlans::get(const RCApplication& controller, const std::string& transition)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto& plan = m_plans[{ controller.UID(), transition }];
+  if (plan) {
+    return plan;
+  }
+
+  const auto& apps = m_session.get_applications();
+  if (std::find(apps.begin(), apps.end(), &controller) == apps.end()) {
+    m_plans.erase({ controller.UID(), transition });
+    throw ApplicationNotFound(ERS_HERE, controller.UID(), m_session.UID());
+  }
+
+  try {
+    plan = std::make_shared<const TransitionPlan>(controller, transition);
+  } catch (...) {
+    m_plans.erase({ controller.UID(), transition });
+    throw;
+  }
+  return plan;
+}
+
+void
+TransitionPlans::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_plans.clear();
+}
+
+} // namespace dunedaq::dal
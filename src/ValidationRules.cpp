@@ -0,0 +1,326 @@
+/**
+ * @file ValidationRules.cpp
+ *
+ * The rules returned by default_rules().
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ControlTree.hpp"
+#include "dunedaqdal/Placement.hpp"
+#include "dunedaqdal/QueueSettings.hpp"
+#include "dunedaqdal/ResourceEstimator.hpp"
+#include "dunedaqdal/TransitionPlan.hpp"
+#include "dunedaqdal/Validator.hpp"
+
+#include "ObjectGraph.hpp"
+
+#include "dunedaqdal/Application.hpp"
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/ControlDependency.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Host.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/SharedMemoryConnection.hpp"
+
+#include "ers/Issue.hpp"
+#include "oksdbinterfaces/Schema.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <regex>
+#include <set>
+#include <unordered_map>
+
+namespace dunedaq::dal {
+
+namespace {
+
+using Severity = Diagnostic::Severity;
+
+class CardinalityRule : public Rule
+{
+public:
+  std::string name() const override { return "cardinality"; }
+  Domain domain() const override { return Domain::objects; }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    using namespace dunedaq::oksdbinterfaces;
+
+    auto& db = context.configuration();
+    for (size_t i = begin; i < end; ++i) {
+      auto obj = context.objects()[i];
+      const auto& info = db.get_class_info(obj.class_name());
+      const auto data = detail::read_object(db, obj, false);
+
+      for (size_t r = 0; r < info.p_relationships.size(); ++r) {
+        const auto& rel = info.p_relationships[r];
+        const bool required = rel.p_cardinality == only_one || rel.p_cardinality == one_or_many;
+        if (required && data.relationships[r].second.empty()) {
+          out.push_back({ Severity::error, name(), obj.full_name(), "relationship " + rel.p_name + " is empty" });
+        }
+      }
+    }
+  }
+};
+
+class UniqueHostPortRule : public Rule
+{
+public:
+  std::string name() const override { return "unique-host-port"; }
+  Domain domain() const override { return Domain::applications; }
+
+  void prepare(const ValidationContext& context) override
+  {
+    m_users.clear();
+    for (const auto* app : context.applications()) {
+      if (const auto* daq = app->cast<DaqApplication>()) {
+        m_users[key(*daq)].push_back(daq->UID());
+      }
+    }
+  }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    for (size_t i = begin; i < end; ++i) {
+      const auto* daq = context.applications()[i]->cast<DaqApplication>();
+      if (daq == nullptr) {
+        continue;
+      }
+      const auto& users = m_users.at(key(*daq));
+      if (users.size() > 1) {
+        std::string others;
+        for (const auto& uid : users) {
+          if (uid != daq->UID()) {
+            others += (others.empty() ? "" : ", ") + uid;
+          }
+        }
+        out.push_back({ Severity::error, name(), daq->full_name(), key(*daq) + " is also used by " + others });
+      }
+    }
+  }
+
+private:
+  static std::string key(const DaqApplication& app) { return app.get_host() + ':' + std::to_string(app.get_port()); }
+
+  std::unordered_map<std::string, std::vector<std::string>> m_users;
+};
+
+class ConnectionEndpointsRule : public Rule
+{
+public:
+  std::string name() const override { return "connection-endpoints"; }
+  Domain domain() const override { return Domain::connections; }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    const auto& index = context.index();
+    for (size_t i = begin; i < end; ++i) {
+      const auto* c = index.connection(i);
+      const size_t producers = index.producers(i).size();
+      const size_t consumers = index.consumers(i).size();
+
+      auto report = [&](Severity severity, const std::string& message) {
+        out.push_back({ severity, name(), c->full_name(), message });
+      };
+
+      if (producers == 0) {
+        report(Severity::error, "read by " + std::to_string(consumers) + " module(s) but written by none");
+      }
+      if (consumers == 0) {
+        report(Severity::warning, "written by " + std::to_string(producers) + " module(s) but read by none");
+      }
+
+      if (const auto* q = c->cast<Queue>()) {
+        if (!supports(to_queue_type(q->get_queue_type()), producers, consumers)) {
+          report(Severity::error,
+                 q->get_queue_type() + " queue with " + std::to_string(producers) + " producer(s) and " +
+                   std::to_string(consumers) + " consumer(s)");
+        }
+      } else if (const auto* nc = c->cast<NetworkConnection>()) {
+        // the binding end must be unique
+        if (nc->get_connection_type() == "kPubSub" && producers > 1) {
+          report(Severity::error, "kPubSub connection with " + std::to_string(producers) + " publishers");
+        } else if (nc->get_connection_type() != "kPubSub" && consumers > 1) {
+          report(Severity::error, "kSendRecv connection with " + std::to_string(consumers) + " receivers");
+        }
+      } else if (const auto* shm = c->cast<SharedMemoryConnection>()) {
+        if (shm->get_consumer_mode() == "kSingleConsumer" && consumers > 1) {
+          report(Severity::error, "kSingleConsumer segment with " + std::to_string(consumers) + " consumers");
+        }
+      }
+    }
+  }
+};
+
+class TimeoutRangeRule : public Rule
+{
+public:
+  std::string name() const override { return "timeout-range"; }
+  Domain domain() const override { return Domain::applications; }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    for (size_t i = begin; i < end; ++i) {
+      const auto* rc = context.applications()[i]->cast<RCApplication>();
+      if (rc != nullptr && (rc->get_Timeout() < 1 || rc->get_Timeout() > 3600)) {
+        out.push_back({ Severity::error,
+                        name(),
+                        rc->full_name(),
+                        "Timeout " + std::to_string(rc->get_Timeout()) + " s is outside 1..3600" });
+      }
+    }
+  }
+};
+
+class ControlDependencyRule : public Rule
+{
+public:
+  std::string name() const override { return "control-dependencies"; }
+  Domain domain() const override { return Domain::applications; }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    for (size_t i = begin; i < end; ++i) {
+      const auto* rc = context.applications()[i]->cast<RCApplication>();
+      if (rc == nullptr || rc->get_dependencies().empty()) {
+        continue;
+      }
+
+      // every transition named by a dependency, and "" standing for all others
+      std::set<std::string> transitions{ "" };
+      for (const auto* dependency : rc->get_dependencies()) {
+        transitions.insert(dependency->get_transitions().begin(), dependency->get_transitions().end());
+        transitions.insert(dependency->get_reversed_for().begin(), dependency->get_reversed_for().end());
+      }
+
+      for (const auto& transition : transitions) {
+        try {
+          TransitionPlan plan(*rc, transition);
+        } catch (const ers::Issue& ex) {
+          out.push_back({ Severity::error, name(), rc->full_name(), ex.what() });
+          break;
+        }
+      }
+    }
+  }
+};
+
+class ControlTreeRule : public Rule
+{
+public:
+  std::string name() const override { return "control-tree"; }
+  Domain domain() const override { return Domain::session; }
+
+  void check(const ValidationContext& context, size_t, size_t, std::vector<Diagnostic>& out) const override
+  {
+    const ControlTree tree(context.session());
+    for (const auto& issue : tree.issues()) {
+      const auto severity =
+        issue.kind == ControlTreeIssue::Kind::uncontrolled ? Severity::warning : Severity::error;
+      const uint32_t idx = tree.index(issue.application);
+      out.push_back({ severity,
+                      name(),
+                      idx == ControlTree::npos ? issue.application : tree.application(idx)->full_name(),
+                      issue.message() });
+    }
+  }
+};
+
+class UriSyntaxRule : public Rule
+{
+public:
+  std::string name() const override { return "uri-syntax"; }
+  Domain domain() const override { return Domain::connections; }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    for (size_t i = begin; i < end; ++i) {
+      const auto* nc = context.index().connection(i)->cast<NetworkConnection>();
+      if (nc == nullptr) {
+        continue;
+      }
+
+      const std::string& uri = nc->get_uri();
+      std::smatch match;
+      if (!std::regex_match(uri, match, m_syntax)) {
+        out.push_back(
+          { Severity::error, name(), nc->full_name(), "uri \"" + uri + "\" is not scheme://host[:port][/path]" });
+      } else if (match[2].matched && std::strtoul(match[2].str().c_str(), nullptr, 10) > 65535) {
+        out.push_back({ Severity::error, name(), nc->full_name(), "port of uri \"" + uri + "\" is out of range" });
+      }
+    }
+  }
+
+private:
+  // 1: host, 2: port; the host may be a name, an address, '*' or a {placeholder}
+  const std::regex m_syntax{ R"([A-Za-z][A-Za-z0-9+.\-]*://([^\s:/]+)(?::([0-9]{1,5}))?(?:/\S*)?)" };
+};
+
+class HostResourcesRule : public Rule
+{
+public:
+  std::string name() const override { return "host-resources"; }
+  Domain domain() const override { return Domain::session; }
+
+  void check(const ValidationContext& context, size_t, size_t, std::vector<Diagnostic>& out) const override
+  {
+    for (const auto& host : estimate_resources(context.session(), context.index()).hosts) {
+      if (host.memory_oversubscribed) {
+        out.push_back({ Severity::error,
+                        name(),
+                        host.limits->full_name(),
+                        "estimated " + std::to_string(uint64_t(host.usage.memory()) >> 20) + " MiB of memory exceeds " +
+                          std::to_string(host.limits->get_memory_mb()) + " MiB" });
+      }
+      if (host.network_oversubscribed) {
+        const double peak = std::max(host.usage.network_in, host.usage.network_out) * 8 / 1e9;
+        out.push_back({ Severity::error,
+                        name(),
+                        host.limits->full_name(),
+                        "estimated " + std::to_string(peak) + " Gbit/s of network traffic exceeds " +
+                          std::to_string(host.limits->get_network_gbps()) + " Gbit/s" });
+      }
+    }
+  }
+};
+
+class PlacementRule : public Rule
+{
+public:
+  std::string name() const override { return "placement"; }
+  Domain domain() const override { return Domain::session; }
+
+  void check(const ValidationContext& context, size_t, size_t, std::vector<Diagnostic>& out) const override
+  {
+    for (const auto& issue : check_placement(context.session())) {
+      out.push_back({ Severity::error, name(), issue.object, issue.message() });
+    }
+  }
+};
+
+} // namespace
+
+std::vector<std::unique_ptr<Rule>>
+default_rules()
+{
+  std::vector<std::unique_ptr<Rule>> rules;
+  rules.push_back(std::make_unique<CardinalityRule>());
+  rules.push_back(std::make_unique<UniqueHostPortRule>());
+  rules.push_back(std::make_unique<ConnectionEndpointsRule>());
+  rules.push_back(std::make_unique<TimeoutRangeRule>());
+  rules.push_back(std::make_unique<ControlDependencyRule>());
+  rules.push_back(std::make_unique<ControlTreeRule>());
+  rules.push_back(std::make_unique<UriSyntaxRule>());
+  rules.push_back(std::make_unique<PlacementRule>());
+  rules.push_back(std::make_unique<HostResourcesRule>());
+  return rules;
+}
+
+} // namespace dunedaq::dal
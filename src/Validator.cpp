@@ -0,0 +1,109 @@
+/**
+ * @file Validator.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Validator.hpp"
+
+#include "ObjectGraph.hpp"
+#include "ThreadPool.hpp"
+
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace dunedaq::dal {
+
+const char*
+to_string(Diagnostic::Severity severity) noexcept
+{
+  return severity == Diagnostic::Severity::error ? "ERROR" : "WARNING";
+}
+
+ValidationContext::ValidationContext(dunedaq::oksdbinterfaces::Configuration& db, const Session& session)
+  : m_db(db)
+  , m_session(session)
+  , m_index(session)
+  , m_applications(session.get_applications())
+  , m_objects(detail::reachable(db, session.config_object()))
+{
+}
+
+Validator::Validator()
+  : m_rules(default_rules())
+{
+}
+
+Validator::Validator(std::vector<std::unique_ptr<Rule>> rules)
+  : m_rules(std::move(rules))
+{
+}
+
+namespace {
+
+size_t
+domain_size(const ValidationContext& context, Rule::Domain domain)
+{
+  switch (domain) {
+    case Rule::Domain::session: return 1;
+    case Rule::Domain::applications: return context.applications().size();
+    case Rule::Domain::modules: return context.index().num_modules();
+    case Rule::Domain::connections: return context.index().num_connections();
+    case Rule::Domain::objects: return context.objects().size();
+  }
+  return 0;
+}
+
+struct Shard
+{
+  const Rule* rule;
+  size_t begin;
+  size_t end;
+};
+
+} // namespace
+
+std::vector<Diagnostic>
+Validator::run(dunedaq::oksdbinterfaces::Configuration& db, const Session& session, unsigned int n_threads)
+{
+  const ValidationContext context(db, session);
+  detail::ThreadPool pool(n_threads);
+
+  for (auto& rule : m_rules) {
+    rule->prepare(context);
+  }
+
+  // shards depend on the pool size, but each covers a contiguous run of items and results are kept in shard order
+  std::vector<Shard> shards;
+  for (const auto& rule : m_rules) {
+    const size_t n = domain_size(context, rule->domain());
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(n, pool.size() * 4));
+    for (size_t c = 0; c < chunks; ++c) {
+      shards.push_back({ rule.get(), n * c / chunks, n * (c + 1) / chunks });
+    }
+  }
+
+  std::vector<std::vector<Diagnostic>> results(shards.size());
+  pool.parallel_for(shards.size(), [&](size_t i) {
+    if (shards[i].begin != shards[i].end) {
+      shards[i].rule->check(context, shards[i].begin, shards[i].end, results[i]);
+    }
+  });
+
+  std::vector<Diagnostic> diagnostics;
+  for (auto& result : results) {
+    std::move(result.begin(), result.end(), std::back_inserter(diagnostics));
+  }
+
+  TLOG_DEBUG(3) << "validated session " << session.UID() << " with " << m_rules.size() << " rules in "
+                << shards.size() << " shards: " << diagnostics.size() << " diagnostics";
+  return diagnostics;
+}
+
+} // namespace dunedaq::dal
@@ -0,0 +1,417 @@
+/**
+ * @file dunedaqdal_config_benchmark.cxx
+ *
+ * Generate a synthetic Session of configurable size and measure loading,
+ * relationship traversal, environment resolution and memory footprint.
+ * Results are written as one JSON object so they can be tracked across
+ * releases; optionally the timeline of the measurements is written as a
+ * Chrome trace.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/EnvironmentResolver.hpp"
+#include "dunedaqdal/Profiler.hpp"
+#include "dunedaqdal/StreamingLoader.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "logging/Logging.hpp"
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace dunedaq;
+
+namespace {
+
+struct Parameters
+{
+  unsigned applications = 10;
+  unsigned modules = 10;     ///< per application
+  unsigned connections = 4;  ///< outputs per module, alternately Queue and NetworkConnection
+  unsigned variables = 10;   ///< per VariableSet
+  unsigned depth = 3;        ///< nesting of the session VariableSets
+  unsigned repetitions = 5;
+  std::string file;          ///< generated database, removed unless given
+};
+
+void
+usage(const char* argv0)
+{
+  std::cerr << "Usage: " << argv0
+            << " [-a <n>] [-m <n>] [-k <n>] [-v <n>] [-e <n>] [-r <n>] [-f <file>] [-o <json>] [-t <trace>]\n"
+            << "\n"
+            << "  -a  DaqApplications (default 10)\n"
+            << "  -m  DaqModules per application (default 10)\n"
+            << "  -k  output connections per module, alternately Queue and NetworkConnection (default 4)\n"
+            << "  -v  Variables per VariableSet (default 10)\n"
+            << "  -e  nesting depth of the session VariableSets (default 3)\n"
+            << "  -r  repetitions of the warm measurements (default 5)\n"
+            << "  -f  keep the generated database in this file\n"
+            << "  -o  write the results to this file instead of stdout\n"
+            << "  -t  write a Chrome trace of the load phases to this file\n";
+}
+
+using Clock = std::chrono::steady_clock;
+
+double
+ms_since(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double
+median(std::vector<double> values)
+{
+  std::sort(values.begin(), values.end());
+  return values.empty() ? 0. : values[values.size() / 2];
+}
+
+/// Resident set size in bytes
+size_t
+rss()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0, resident = 0;
+  statm >> pages >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+oksdbinterfaces::ConfigObject
+create(oksdbinterfaces::Configuration& db, const std::string& file, const std::string& cls, const std::string& uid)
+{
+  oksdbinterfaces::ConfigObject obj;
+  db.create(file, cls, uid, obj);
+  return obj;
+}
+
+std::vector<const oksdbinterfaces::ConfigObject*>
+pointers(const std::vector<oksdbinterfaces::ConfigObject>& objects)
+{
+  std::vector<const oksdbinterfaces::ConfigObject*> result;
+  for (const auto& obj : objects) {
+    result.push_back(&obj);
+  }
+  return result;
+}
+
+/**
+ * Module m of application a writes its even outputs to a Queue read by module
+ * m+1 of the same application, and its odd outputs to a NetworkConnection read
+ * by module m of application a+1.
+ */
+void
+generate(const Parameters& p, const std::string& session_uid)
+{
+  oksdbinterfaces::Configuration db("oksconfig");
+  db.create(p.file, { "schema/dunedaqdal/dunedaq.schema.xml" });
+
+  // session environment: depth nested sets of p.variables variables each
+  std::vector<oksdbinterfaces::ConfigObject> sets;
+  for (unsigned d = 0; d < p.depth; ++d) {
+    std::vector<oksdbinterfaces::ConfigObject> contents;
+    for (unsigned v = 0; v < p.variables; ++v) {
+      auto var = create(db, p.file, "Variable", "var-" + std::to_string(d) + '-' + std::to_string(v));
+      var.set_by_val<std::string>("Name", "BENCH_VAR_" + std::to_string(v));
+      var.set_by_val<std::string>("Value", "level" + std::to_string(d));
+      contents.push_back(var);
+    }
+    if (d != 0) {
+      contents.push_back(sets.back());
+    }
+    sets.push_back(create(db, p.file, "VariableSet", "set-" + std::to_string(d)));
+    sets.back().set_objs("Contains", pointers(contents));
+  }
+
+  auto name = [](const char* prefix, unsigned a, unsigned m, unsigned k) {
+    return prefix + std::to_string(a) + '-' + std::to_string(m) + '-' + std::to_string(k);
+  };
+
+  std::vector<std::vector<oksdbinterfaces::ConfigObject>> modules(p.applications);
+  std::vector<std::vector<std::vector<oksdbinterfaces::ConfigObject>>> inputs(
+    p.applications, std::vector<std::vector<oksdbinterfaces::ConfigObject>>(p.modules));
+
+  for (unsigned a = 0; a < p.applications; ++a) {
+    for (unsigned m = 0; m < p.modules; ++m) {
+      auto module = create(db, p.file, "DaqModule", name("mod-", a, m, 0));
+      module.set_by_val<std::string>("plugin", "BenchmarkModule");
+
+      std::vector<oksdbinterfaces::ConfigObject> outputs;
+      for (unsigned k = 0; k < p.connections; ++k) {
+        if (k % 2 == 0) {
+          auto q = create(db, p.file, "Queue", name("q-", a, m, k));
+          q.set_by_val<std::string>("data_type", "Fragment");
+          q.set_by_val<uint32_t>("capacity", 1000);
+          outputs.push_back(q);
+          inputs[a][(m + 1) % p.modules].push_back(q);
+        } else {
+          auto nc = create(db, p.file, "NetworkConnection", name("net-", a, m, k));
+          nc.set_by_val<std::string>("data_type", "TimeSync");
+          nc.set_by_val<std::string>("uri",
+                                     "tcp://host" + std::to_string(a) + ':' + std::to_string(10000 + m * 100 + k));
+          nc.set_enum("connection_type", "kSendRecv");
+          outputs.push_back(nc);
+          inputs[(a + 1) % p.applications][m].push_back(nc);
+        }
+      }
+      module.set_objs("outputs", pointers(outputs));
+      modules[a].push_back(module);
+    }
+  }
+
+  std::vector<oksdbinterfaces::ConfigObject> applications;
+  for (unsigned a = 0; a < p.applications; ++a) {
+    for (unsigned m = 0; m < p.modules; ++m) {
+      modules[a][m].set_objs("inputs", pointers(inputs[a][m]));
+    }
+
+    auto own = create(db, p.file, "Variable", "app-var-" + std::to_string(a));
+    own.set_by_val<std::string>("Name", "BENCH_APP");
+    own.set_by_val<std::string>("Value", std::to_string(a));
+
+    auto app = create(db, p.file, "DaqApplication", "app-" + std::to_string(a));
+    app.set_by_val<std::string>("host", "host" + std::to_string(a % 16));
+    app.set_by_val<uint16_t>("port", static_cast<uint16_t>(5000 + a));
+    app.set_objs("modules", pointers(modules[a]));
+    std::vector<const oksdbinterfaces::ConfigObject*> env{ &own };
+    if (!sets.empty()) {
+      env.push_back(&sets.front());
+    }
+    app.set_objs("ApplicationEnvironment", env);
+    applications.push_back(app);
+  }
+
+  auto session = create(db, p.file, "Session", session_uid);
+  session.set_objs("applications", pointers(applications));
+  if (!sets.empty()) {
+    session.set_objs("ProcessEnvironment", { &sets.back() });
+  }
+
+  db.commit("dunedaqdal_config_benchmark");
+}
+
+/// Write back and drop the cached pages of the file, so that the next read comes from the disk
+bool
+evict(const std::string& file)
+{
+  const int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const bool ok = ::fdatasync(fd) == 0 && ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  ::close(fd);
+  return ok;
+}
+
+/// Visit every application, module and connection and read their attributes; returns the number of visits
+size_t
+traverse(const dal::Session& session)
+{
+  size_t objects = 1;
+  size_t checksum = 0;
+  for (const auto* app : session.get_applications()) {
+    ++objects;
+    const auto* daq = app->cast<dal::DaqApplication>();
+    if (daq == nullptr) {
+      continue;
+    }
+    checksum += daq->get_port() + daq->get_host().size();
+    for (const auto* module : daq->get_modules()) {
+      ++objects;
+      checksum += module->get_plugin().size();
+      for (const auto* c : module->get_inputs()) {
+        ++objects;
+        checksum += c->get_data_type().size();
+      }
+      for (const auto* c : module->get_outputs()) {
+        ++objects;
+        checksum += c->get_data_type().size();
+        if (const auto* q = c->cast<dal::Queue>()) {
+          checksum += q->get_capacity();
+        } else if (const auto* nc = c->cast<dal::NetworkConnection>()) {
+          checksum += nc->get_uri().size();
+        }
+      }
+    }
+  }
+  TLOG_DEBUG(5) << "traversal checksum " << checksum;
+  return objects;
+}
+
+size_t
+resolve_environments(dal::EnvironmentResolver& resolver, const dal::Session& session)
+{
+  size_t variables = 0;
+  for (const auto* app : session.get_applications()) {
+    variables += resolver.get(session, *app).size();
+  }
+  return variables;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  const dal::profiling::FlushOnExit flush_profile;
+
+  Parameters p;
+  std::string output, trace;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "a:m:k:v:e:r:f:o:t:h")) != -1) {
+    switch (opt) {
+      case 'a': p.applications = std::max(1, std::atoi(optarg)); break;
+      case 'm': p.modules = std::max(1, std::atoi(optarg)); break;
+      case 'k': p.connections = std::max(0, std::atoi(optarg)); break;
+      case 'v': p.variables = std::max(0, std::atoi(optarg)); break;
+      case 'e': p.depth = std::max(0, std::atoi(optarg)); break;
+      case 'r': p.repetitions = std::max(1, std::atoi(optarg)); break;
+      case 'f': p.file = optarg; break;
+      case 'o': output = optarg; break;
+      case 't': trace = optarg; break;
+      case 'h': usage(argv[0]); return 0;
+      default: usage(argv[0]); return 1;
+    }
+  }
+
+  const bool keep = !p.file.empty();
+  if (!keep) {
+    p.file = "/tmp/dunedaqdal_config_benchmark." + std::to_string(getpid()) + ".data.xml";
+  }
+  const std::string session_uid = "benchmark-session";
+  const std::string spec = "oksconfig:" + p.file;
+
+  try {
+    auto start = Clock::now();
+    generate(p, session_uid);
+    const double generate_ms = ms_since(start);
+
+    if (!trace.empty()) {
+      dal::profiling::enable();
+    }
+
+    // cold: first load of the file in this process, including the first traversal, with the file just written
+    // by generate() evicted from the page cache; the schema may still be cached
+    const bool evicted = evict(p.file);
+    if (!evicted) {
+      TLOG_DEBUG(1) << "cannot evict " << p.file << " from the page cache, the cold load reads cached pages";
+    }
+    const size_t rss_before = rss();
+    start = Clock::now();
+    std::unique_ptr<oksdbinterfaces::Configuration> db;
+    {
+      DUNEDAQDAL_PROFILE_SCOPE("parse", spec);
+      db = std::make_unique<oksdbinterfaces::Configuration>(spec);
+    }
+    const dal::Session* session = nullptr;
+    size_t objects = 0;
+    {
+      DUNEDAQDAL_PROFILE_SCOPE("instantiate", dal::Session::s_class_name);
+      session = db->get<dal::Session>(session_uid);
+      objects = traverse(*session);
+    }
+    const double cold_load_ms = ms_since(start);
+    const size_t rss_after = rss();
+
+    // the same file through the streaming loader, which builds plain records instead of DAL objects
+    std::vector<double> stream_load;
+    size_t streamed_objects = 0;
+    for (unsigned r = 0; r < p.repetitions; ++r) {
+      start = Clock::now();
+      dal::StreamingLoader loader;
+      loader.load(p.file);
+      stream_load.push_back(ms_since(start));
+      streamed_objects = loader.size();
+    }
+
+    // traversal of cached DAL objects
+    std::vector<double> traversal;
+    for (unsigned r = 0; r < p.repetitions; ++r) {
+      start = Clock::now();
+      traverse(*session);
+      traversal.push_back(ms_since(start));
+    }
+
+    // environment, first with an empty resolver cache, then cached
+    dal::EnvironmentResolver resolver(*db);
+    start = Clock::now();
+    const size_t variables = resolve_environments(resolver, *session);
+    const double environment_cold_ms = ms_since(start);
+
+    std::vector<double> environment_warm;
+    for (unsigned r = 0; r < p.repetitions; ++r) {
+      start = Clock::now();
+      resolve_environments(resolver, *session);
+      environment_warm.push_back(ms_since(start));
+    }
+
+    // warm: loads of a file already in the page cache, in a fresh Configuration
+    std::vector<double> warm_load;
+    for (unsigned r = 0; r < p.repetitions; ++r) {
+      start = Clock::now();
+      oksdbinterfaces::Configuration again(spec);
+      traverse(*again.get<dal::Session>(session_uid));
+      warm_load.push_back(ms_since(start));
+    }
+
+    std::ofstream file;
+    if (!output.empty()) {
+      file.open(output);
+    }
+    std::ostream& out = output.empty() ? std::cout : file;
+
+    out << "{\n"
+        << "  \"parameters\": { \"applications\": " << p.applications << ", \"modules\": " << p.modules
+        << ", \"connections\": " << p.connections << ", \"variables\": " << p.variables << ", \"depth\": " << p.depth
+        << ", \"repetitions\": " << p.repetitions << " },\n"
+        << "  \"objects\": " << objects << ",\n"
+        << "  \"environment_variables\": " << variables << ",\n"
+        << "  \"generate_ms\": " << generate_ms << ",\n"
+        << "  \"cold_load_ms\": " << cold_load_ms << ",\n"
+        << "  \"cold_load_evicted\": " << (evicted ? "true" : "false") << ",\n"
+        << "  \"warm_load_ms\": " << median(warm_load) << ",\n"
+        << "  \"stream_load_ms\": " << median(stream_load) << ",\n"
+        << "  \"streamed_objects\": " << streamed_objects << ",\n"
+        << "  \"traversal_ms\": " << median(traversal) << ",\n"
+        << "  \"environment_cold_ms\": " << environment_cold_ms << ",\n"
+        << "  \"environment_warm_ms\": " << median(environment_warm) << ",\n"
+        << "  \"rss_load_bytes\": " << (rss_after > rss_before ? rss_after - rss_before : 0) << ",\n"
+        << "  \"rss_bytes\": " << rss() << "\n"
+        << "}\n";
+
+    if (!trace.empty()) {
+      dal::profiling::write_trace(trace);
+    }
+  } catch (const ers::Issue& ex) {
+    ers::fatal(ex);
+    if (!keep) {
+      std::remove(p.file.c_str());
+    }
+    return 1;
+  }
+
+  if (!keep) {
+    std::remove(p.file.c_str());
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file ChangeSet_test.cxx ChangeSet and diff() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ChangeSet.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE ChangeSet_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(ChangeSet_test)
+
+namespace {
+
+struct Variant
+{
+  uint32_t capacity = 8;          ///< of Queue q, shared by a1 and a2
+  std::string value = "x";        ///< of Variable v in the environment of a2
+  std::string session_env = "p";  ///< of Variable pv in the session environment
+  bool extra_application = false; ///< a3
+};
+
+/// m1 of a1 writes Queue q, read by m2 of a2
+void
+build(TestDatabase& t, const Variant& v)
+{
+  auto q = t.create("Queue", "q");
+  q.set_by_val<std::string>("data_type", "Fragment");
+  q.set_by_val<uint32_t>("capacity", v.capacity);
+  auto m1 = t.create("DaqModule", "m1");
+  m1.set_objs("outputs", refs({ q }));
+  auto m2 = t.create("DaqModule", "m2");
+  m2.set_objs("inputs", refs({ q }));
+
+  auto var = t.create("Variable", "v");
+  var.set_by_val<std::string>("Name", "V");
+  var.set_by_val<std::string>("Value", v.value);
+  auto pv = t.create("Variable", "pv");
+  pv.set_by_val<std::string>("Name", "PV");
+  pv.set_by_val<std::string>("Value", v.session_env);
+
+  auto a1 = t.create("DaqApplication", "a1");
+  a1.set_objs("modules", refs({ m1 }));
+  auto a2 = t.create("DaqApplication", "a2");
+  a2.set_objs("modules", refs({ m2 }));
+  a2.set_objs("ApplicationEnvironment", refs({ var }));
+  std::vector<dunedaq::oksdbinterfaces::ConfigObject> applications{ a1, a2 };
+  if (v.extra_application) {
+    auto m3 = t.create("DaqModule", "m3");
+    auto a3 = t.create("DaqApplication", "a3");
+    a3.set_objs("modules", refs({ m3 }));
+    applications.push_back(a3);
+  }
+
+  auto s = t.create("Session", "s");
+  s.set_objs("applications", refs(applications));
+  s.set_objs("ProcessEnvironment", refs({ pv }));
+  t.commit();
+}
+
+ChangeSet
+diff(const Variant& before, const Variant& after)
+{
+  TestDatabase b("ChangeSet_test_before"), a("ChangeSet_test_after");
+  build(b, before);
+  build(a, after);
+  return dunedaq::dal::diff(b.db(), a.db(), "s");
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Identical)
+{
+  auto cs = diff(Variant{}, Variant{});
+  BOOST_REQUIRE(cs.empty());
+  BOOST_REQUIRE(cs.applications.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ModifiedAttribute)
+{
+  Variant after;
+  after.value = "y";
+  auto cs = diff(Variant{}, after);
+
+  BOOST_REQUIRE_EQUAL(cs.changes.size(), 1);
+  const auto* change = cs.find("v", "Variable");
+  BOOST_REQUIRE(change != nullptr);
+  BOOST_REQUIRE(change->kind == ObjectChange::Kind::modified);
+  BOOST_REQUIRE(change->attributes == std::vector<std::string>{ "Value" });
+  BOOST_REQUIRE(change->relationships.empty());
+  BOOST_REQUIRE(cs.applications == std::vector<std::string>{ "a2" });
+  BOOST_REQUIRE(cs.find("v", "VariableSet") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(SharedObject)
+{
+  Variant after;
+  after.capacity = 16;
+  auto cs = diff(Variant{}, after);
+
+  BOOST_REQUIRE_EQUAL(cs.changes.size(), 1);
+  BOOST_REQUIRE(cs.applications == (std::vector<std::string>{ "a1", "a2" }));
+}
+
+BOOST_AUTO_TEST_CASE(SessionEnvironment)
+{
+  Variant after;
+  after.session_env = "q";
+  auto cs = diff(Variant{}, after);
+
+  // every application inherits the session environment
+  BOOST_REQUIRE(cs.applications == (std::vector<std::string>{ "a1", "a2" }));
+}
+
+BOOST_AUTO_TEST_CASE(AddedAndRemoved)
+{
+  Variant with;
+  with.extra_application = true;
+
+  auto added = diff(Variant{}, with);
+  const auto* a3 = added.find("a3", "DaqApplication");
+  BOOST_REQUIRE(a3 != nullptr);
+  BOOST_REQUIRE(a3->kind == ObjectChange::Kind::added);
+  BOOST_REQUIRE(added.applications == std::vector<std::string>{ "a3" });
+
+  auto removed = diff(with, Variant{});
+  a3 = removed.find("a3", "DaqApplication");
+  BOOST_REQUIRE(a3 != nullptr);
+  BOOST_REQUIRE(a3->kind == ObjectChange::Kind::removed);
+  BOOST_REQUIRE(removed.applications == std::vector<std::string>{ "a3" });
+
+  // the session itself changed its applications
+  const auto* s = removed.find("s", "Session");
+  BOOST_REQUIRE(s != nullptr);
+  BOOST_REQUIRE(s->relationships == std::vector<std::string>{ "applications" });
+}
+
+BOOST_AUTO_TEST_CASE(SortedChanges)
+{
+  Variant after;
+  after.capacity = 16;
+  after.value = "y";
+  after.extra_application = true;
+  auto cs = diff(Variant{}, after);
+
+  for (size_t i = 1; i < cs.changes.size(); ++i) {
+    const auto& x = cs.changes[i - 1];
+    const auto& y = cs.changes[i];
+    BOOST_REQUIRE(x.class_name < y.class_name || (x.class_name == y.class_name && x.uid < y.uid));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
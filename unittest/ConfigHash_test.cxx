@@ -0,0 +1,203 @@
+/**
+ * @file ConfigHash_test.cxx ConfigHasher class Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConfigHash.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE ConfigHash_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(ConfigHash_test)
+
+namespace {
+
+/**
+ * m1 of a1 reads q2 and writes q, read by m2 of a2; a2 has Variable v in its
+ * environment. r1 and r2 control each other, and r1 also controls a1.
+ */
+struct Database
+{
+  TestDatabase t;
+  dunedaq::oksdbinterfaces::ConfigObject s, a1, m1, v, r2;
+
+  Database(const std::string& name, const std::string& value)
+    : t(name)
+  {
+    auto q = t.create("Queue", "q");
+    q.set_by_val<std::string>("data_type", "Fragment");
+    q.set_by_val<uint32_t>("capacity", 8);
+    auto q2 = t.create("Queue", "q2");
+    q2.set_by_val<std::string>("data_type", "Fragment");
+    m1 = t.create("DaqModule", "m1");
+    m1.set_objs("inputs", refs({ q2 }));
+    m1.set_objs("outputs", refs({ q }));
+    auto m2 = t.create("DaqModule", "m2");
+    m2.set_objs("inputs", refs({ q }));
+
+    v = t.create("Variable", "v");
+    v.set_by_val<std::string>("Name", "V");
+    v.set_by_val<std::string>("Value", value);
+
+    a1 = t.create("DaqApplication", "a1");
+    a1.set_objs("modules", refs({ m1 }));
+    auto a2 = t.create("DaqApplication", "a2");
+    a2.set_objs("modules", refs({ m2 }));
+    a2.set_objs("ApplicationEnvironment", refs({ v }));
+
+    auto r1 = t.create("RCApplication", "r1");
+    r2 = t.create("RCApplication", "r2");
+    r2.set_by_val<std::string>("host", "h");
+    r1.set_objs("ApplicationsControlled", refs({ r2, a1 }));
+    r2.set_objs("ApplicationsControlled", refs({ r1 }));
+
+    s = t.create("Session", "s");
+    s.set_objs("applications", refs({ a1, a2, r1, r2 }));
+    t.commit();
+  }
+};
+
+ObjectChange
+modified(const std::string& uid, const std::string& class_name)
+{
+  return { ObjectChange::Kind::modified, uid, class_name, {}, {} };
+}
+
+/// An updated hasher must match one reading the database afresh
+void
+require_same(Database& d, const ConfigHasher& updated)
+{
+  ConfigHasher fresh(d.t.db(), "s", 3);
+  BOOST_REQUIRE(fresh.session() == updated.session());
+  BOOST_REQUIRE_EQUAL(fresh.size(), updated.size());
+  for (const char* uid : { "a1", "a2", "r1", "r2" }) {
+    const auto* x = fresh.application(uid);
+    const auto* y = updated.application(uid);
+    BOOST_REQUIRE_EQUAL(x == nullptr, y == nullptr);
+    if (x != nullptr) {
+      BOOST_REQUIRE(*x == *y);
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Content)
+{
+  Database b("ConfigHash_test_b", "x"), a("ConfigHash_test_a", "x"), c("ConfigHash_test_c", "y");
+
+  // independent of the database file and of the number of threads
+  ConfigHasher hb(b.t.db(), "s", 2), ha(a.t.db(), "s", 1);
+  BOOST_REQUIRE(!hb.session().empty());
+  BOOST_REQUIRE(hb.session() == ha.session());
+  BOOST_REQUIRE_EQUAL(hb.size(), 10);
+  BOOST_REQUIRE_EQUAL(hb.session().str().size(), 32);
+
+  // members of a control cycle still get distinct hashes
+  BOOST_REQUIRE(*hb.application("r1") != *hb.application("r2"));
+
+  ConfigHasher hc(c.t.db(), "s");
+  BOOST_REQUIRE(hc.session() != hb.session());
+  BOOST_REQUIRE(*hc.application("a1") == *hb.application("a1"));
+  BOOST_REQUIRE(*hc.application("a2") != *hb.application("a2"));
+  BOOST_REQUIRE(*hc.application("r1") == *hb.application("r1"));
+
+  BOOST_REQUIRE(hb.find("q", "Queue") != nullptr);
+  BOOST_REQUIRE(hb.find("q", "Variable") == nullptr);
+  BOOST_REQUIRE(hb.application("m1") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalAttribute)
+{
+  Database d("ConfigHash_test", "x");
+  ConfigHasher hasher(d.t.db(), "s", 2);
+
+  d.v.set_by_val<std::string>("Value", "y");
+  // v, then a2 and the session referring to it
+  BOOST_REQUIRE_EQUAL(hasher.update({ modified("v", "Variable") }), 3);
+  require_same(d, hasher);
+
+  BOOST_REQUIRE_EQUAL(hasher.update({ modified("missing", "Queue") }), 0);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalCycle)
+{
+  Database d("ConfigHash_test", "x");
+  ConfigHasher hasher(d.t.db(), "s", 2);
+  const auto a1 = *hasher.application("a1");
+  const auto r1 = *hasher.application("r1");
+
+  d.r2.set_by_val<std::string>("host", "k");
+  hasher.update({ modified("r2", "RCApplication") });
+  BOOST_REQUIRE(*hasher.application("r1") != r1);
+  BOOST_REQUIRE(*hasher.application("a1") == a1);
+  require_same(d, hasher);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalTopology)
+{
+  Database d("ConfigHash_test", "x");
+  ConfigHasher hasher(d.t.db(), "s", 2);
+
+  // a new module under a1; q2 no longer reachable
+  auto q3 = d.t.create("Queue", "q3");
+  q3.set_by_val<std::string>("data_type", "Fragment");
+  auto m3 = d.t.create("DaqModule", "m3");
+  m3.set_objs("outputs", refs({ q3 }));
+  d.a1.set_objs("modules", refs({ d.m1, m3 }));
+  d.m1.set_objs("inputs", {});
+  d.t.commit();
+
+  hasher.update({ modified("a1", "DaqApplication"),
+                  modified("m1", "DaqModule"),
+                  { ObjectChange::Kind::added, "m3", "DaqModule", {}, {} } });
+  BOOST_REQUIRE_EQUAL(hasher.size(), 11);
+  BOOST_REQUIRE(hasher.find("q2", "Queue") == nullptr);
+  BOOST_REQUIRE(hasher.find("q3", "Queue") != nullptr);
+  require_same(d, hasher);
+
+  // dropping an application makes its subtree unreachable
+  d.s.set_objs("applications", refs({ d.a1 }));
+  d.t.commit();
+  hasher.update({ modified("s", "Session") });
+  BOOST_REQUIRE(hasher.application("a2") == nullptr);
+  BOOST_REQUIRE(hasher.application("r1") == nullptr);
+  BOOST_REQUIRE(hasher.find("v", "Variable") == nullptr);
+  require_same(d, hasher);
+}
+
+BOOST_AUTO_TEST_CASE(Compaction)
+{
+  Database d("ConfigHash_test", "x");
+  ConfigHasher hasher(d.t.db(), "s", 2);
+
+  // five of the ten objects dropped, more than half of the five left: the nodes are compacted
+  d.s.set_objs("applications", refs({ d.a1 }));
+  d.t.commit();
+  hasher.update({ modified("s", "Session") });
+  BOOST_REQUIRE_EQUAL(hasher.size(), 5);
+  require_same(d, hasher);
+
+  // the renumbered targets and referrers are followed by the next update
+  d.m1.set_objs("inputs", {});
+  d.t.commit();
+  BOOST_REQUIRE_EQUAL(hasher.update({ modified("m1", "DaqModule") }), 3);
+  BOOST_REQUIRE_EQUAL(hasher.size(), 4);
+  BOOST_REQUIRE(hasher.find("q2", "Queue") == nullptr);
+  require_same(d, hasher);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
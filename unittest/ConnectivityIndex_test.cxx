@@ -0,0 +1,150 @@
+/**
+ * @file ConnectivityIndex_test.cxx ConnectivityIndex class Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE ConnectivityIndex_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(ConnectivityIndex_test)
+
+namespace {
+
+/**
+ * m1 of a1 writes to Queue q, read by m2 of a1, and to NetworkConnection n,
+ * read by m3 of a2; m2 lists q twice. The RCApplication has no modules.
+ */
+struct Fixture
+{
+  TestDatabase t{ "ConnectivityIndex_test" };
+  const Session* session = nullptr;
+
+  Fixture()
+  {
+    auto q = t.create("Queue", "q");
+    q.set_by_val<std::string>("data_type", "Fragment");
+    auto n = t.create("NetworkConnection", "n");
+    n.set_by_val<std::string>("data_type", "TimeSync");
+    n.set_by_val<std::string>("uri", "tcp://host2:5000");
+
+    auto m1 = t.create("DaqModule", "m1");
+    m1.set_objs("outputs", refs({ q, n }));
+    auto m2 = t.create("DaqModule", "m2");
+    m2.set_objs("inputs", refs({ q, q }));
+    auto m3 = t.create("DaqModule", "m3");
+    m3.set_objs("inputs", refs({ n }));
+
+    auto a1 = t.create("DaqApplication", "a1");
+    a1.set_by_val<std::string>("host", "host1");
+    a1.set_objs("modules", refs({ m1, m2 }));
+    auto a2 = t.create("DaqApplication", "a2");
+    a2.set_by_val<std::string>("host", "host2");
+    a2.set_objs("modules", refs({ m3 }));
+    auto rc = t.create("RCApplication", "rc");
+    rc.set_objs("ApplicationsControlled", refs({ a1, a2 }));
+
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs({ rc, a1, a2 }));
+    t.commit();
+
+    session = t.get<Session>("s");
+    BOOST_REQUIRE(session != nullptr);
+  }
+};
+
+std::vector<std::string>
+module_uids(const ConnectivityIndex& index, ConnectivityIndex::Range range)
+{
+  std::vector<std::string> result;
+  for (auto m : range) {
+    result.push_back(index.module(m)->UID());
+  }
+  return result;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Sizes, Fixture)
+{
+  ConnectivityIndex index(*session);
+  BOOST_REQUIRE_EQUAL(index.num_applications(), 2);
+  BOOST_REQUIRE_EQUAL(index.num_modules(), 3);
+  BOOST_REQUIRE_EQUAL(index.num_connections(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(LookupByUID, Fixture)
+{
+  ConnectivityIndex index(*session);
+
+  const auto a1 = index.application_index("a1");
+  BOOST_REQUIRE_NE(a1, ConnectivityIndex::npos);
+  BOOST_REQUIRE_EQUAL(index.application(a1)->UID(), "a1");
+
+  const auto m3 = index.module_index("m3");
+  BOOST_REQUIRE_NE(m3, ConnectivityIndex::npos);
+  BOOST_REQUIRE_EQUAL(index.module(m3)->UID(), "m3");
+  BOOST_REQUIRE_EQUAL(index.application(index.application_of(m3))->UID(), "a2");
+
+  const auto n = index.connection_index("n");
+  BOOST_REQUIRE_NE(n, ConnectivityIndex::npos);
+  BOOST_REQUIRE_EQUAL(index.connection(n)->UID(), "n");
+
+  BOOST_REQUIRE_EQUAL(index.application_index("rc"), ConnectivityIndex::npos);
+  BOOST_REQUIRE_EQUAL(index.module_index("missing"), ConnectivityIndex::npos);
+  BOOST_REQUIRE_EQUAL(index.connection_index("missing"), ConnectivityIndex::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(ProducersAndConsumers, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto q = index.connection_index("q");
+  const auto n = index.connection_index("n");
+
+  BOOST_REQUIRE(module_uids(index, index.producers(q)) == std::vector<std::string>{ "m1" });
+  BOOST_REQUIRE(module_uids(index, index.consumers(q)) == std::vector<std::string>{ "m2" });
+  BOOST_REQUIRE(module_uids(index, index.producers(n)) == std::vector<std::string>{ "m1" });
+  BOOST_REQUIRE(module_uids(index, index.consumers(n)) == std::vector<std::string>{ "m3" });
+
+  auto by_uid = index.consumers("n");
+  BOOST_REQUIRE_EQUAL(by_uid.size(), 1);
+  BOOST_REQUIRE_EQUAL(by_uid[0]->UID(), "m3");
+  BOOST_REQUIRE(index.producers("missing").empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(ModuleRows, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto m1 = index.module_index("m1");
+  const auto m2 = index.module_index("m2");
+
+  BOOST_REQUIRE_EQUAL(index.outputs(m1).size(), 2);
+  BOOST_REQUIRE(index.inputs(m1).empty());
+  BOOST_REQUIRE(module_uids(index, index.modules_of(index.application_index("a1"))) ==
+                (std::vector<std::string>{ "m1", "m2" }));
+
+  // listed twice in DaqModule.inputs, indexed once
+  BOOST_REQUIRE_EQUAL(index.inputs(m2).size(), 1);
+  BOOST_REQUIRE_EQUAL(index.connection(index.inputs(m2)[0])->UID(), "q");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
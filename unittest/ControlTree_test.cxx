@@ -0,0 +1,168 @@
+/**
+ * @file ControlTree_test.cxx ControlTree class and propose_balanced_tree() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ControlTree.hpp"
+
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE ControlTree_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(ControlTree_test)
+
+namespace {
+
+/**
+ * top controls seg, d0, d1 and x, which is not part of the session; seg
+ * controls d2, d3, d4 and d1 again. d5 to d9 have no controller.
+ */
+struct Fixture
+{
+  TestDatabase t{ "ControlTree_test" };
+  const Session* session = nullptr;
+
+  Fixture()
+  {
+    std::vector<dunedaq::oksdbinterfaces::ConfigObject> d;
+    for (int i = 0; i < 10; ++i) {
+      d.push_back(t.create("DaqApplication", "d" + std::to_string(i)));
+    }
+    auto x = t.create("DaqApplication", "x");
+
+    auto seg = t.create("RCApplication", "seg");
+    seg.set_objs("ApplicationsControlled", refs({ d[2], d[3], d[4], d[1] }));
+    auto top = t.create("RCApplication", "top");
+    top.set_objs("ApplicationsControlled", refs({ seg, d[0], d[1], x }));
+
+    std::vector<dunedaq::oksdbinterfaces::ConfigObject> applications{ top, seg };
+    applications.insert(applications.end(), d.begin(), d.end());
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs(applications));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+bool
+has_issue(const ControlTree& tree, ControlTreeIssue::Kind kind, const std::string& application)
+{
+  const auto& issues = tree.issues();
+  return std::any_of(issues.begin(), issues.end(), [&](const ControlTreeIssue& issue) {
+    return issue.kind == kind && issue.application == application;
+  });
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Structure, Fixture)
+{
+  ControlTree tree(*session);
+
+  BOOST_REQUIRE_EQUAL(tree.root(), tree.index("top"));
+  BOOST_REQUIRE_EQUAL(tree.height(), 3);
+  BOOST_REQUIRE_EQUAL(tree.depth(tree.index("d3")), 2);
+  BOOST_REQUIRE_EQUAL(tree.parent(tree.index("d3")), tree.index("seg"));
+  BOOST_REQUIRE_EQUAL(tree.parent(tree.index("top")), ControlTree::npos);
+  BOOST_REQUIRE_EQUAL(tree.subtree_size(tree.root()), 7);
+  BOOST_REQUIRE_EQUAL(tree.depth(tree.index("d7")), ControlTree::npos);
+  BOOST_REQUIRE_EQUAL(tree.index("missing"), ControlTree::npos);
+
+  // the first controller keeps an application controlled twice
+  BOOST_REQUIRE_EQUAL(tree.parent(tree.index("d1")), tree.root());
+
+  const auto fan_out = tree.fan_out();
+  BOOST_REQUIRE_EQUAL(fan_out.controllers, 2);
+  BOOST_REQUIRE_EQUAL(fan_out.min, 3);
+  BOOST_REQUIRE_EQUAL(fan_out.max, 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(Issues, Fixture)
+{
+  ControlTree tree(*session);
+
+  BOOST_REQUIRE(has_issue(tree, ControlTreeIssue::Kind::controlled_twice, "d1"));
+  BOOST_REQUIRE(has_issue(tree, ControlTreeIssue::Kind::not_in_session, "x"));
+  for (int i = 5; i < 10; ++i) {
+    BOOST_REQUIRE(has_issue(tree, ControlTreeIssue::Kind::uncontrolled, "d" + std::to_string(i)));
+  }
+  BOOST_REQUIRE(!has_issue(tree, ControlTreeIssue::Kind::uncontrolled, "top"));
+}
+
+BOOST_FIXTURE_TEST_CASE(BalancedProposal, Fixture)
+{
+  const auto proposal = propose_balanced_tree(*session, 4);
+
+  BOOST_REQUIRE_EQUAL(proposal.fan_out, 4);
+  BOOST_REQUIRE_EQUAL(proposal.leaves, 10);
+  BOOST_REQUIRE_EQUAL(proposal.height, 2);
+  BOOST_REQUIRE_EQUAL(proposal.controllers.size(), 4);
+
+  // existing controllers are reused first, root first
+  BOOST_REQUIRE_EQUAL(proposal.controllers[0].uid, "top");
+  BOOST_REQUIRE(proposal.controllers[0].existing);
+  BOOST_REQUIRE(proposal.controllers[0].parent.empty());
+  BOOST_REQUIRE_EQUAL(proposal.controllers[1].uid, "seg");
+  BOOST_REQUIRE(!proposal.controllers[2].existing);
+
+  std::set<std::string> leaves;
+  std::set<std::string> names;
+  for (const auto& c : proposal.controllers) {
+    BOOST_REQUIRE_LE(c.children.size(), 4);
+    BOOST_REQUIRE(names.insert(c.uid).second);
+    if (&c != &proposal.controllers[0]) {
+      BOOST_REQUIRE_EQUAL(c.parent, "top");
+      leaves.insert(c.children.begin(), c.children.end());
+    }
+  }
+  BOOST_REQUIRE_EQUAL(leaves.size(), 10);
+
+  // leaves shared as evenly as possible
+  for (size_t i = 1; i < proposal.controllers.size(); ++i) {
+    BOOST_REQUIRE_GE(proposal.controllers[i].children.size(), 3);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(UniqueNames, Fixture)
+{
+  // rc-segment-1-1 is taken outside the session, and so is its first alternative
+  t.create("DaqApplication", "rc-segment-1-1");
+  t.create("RCApplication", "rc-segment-1-1-2");
+  t.commit();
+
+  const auto proposal = propose_balanced_tree(*session, 4);
+  BOOST_REQUIRE_EQUAL(proposal.controllers.size(), 4);
+  BOOST_REQUIRE_EQUAL(proposal.controllers[2].uid, "rc-segment-1-1-3");
+  BOOST_REQUIRE_EQUAL(proposal.controllers[3].uid, "rc-segment-1-2");
+  BOOST_REQUIRE_EQUAL(proposal.controllers[2].parent, "top");
+  BOOST_REQUIRE(std::find(proposal.controllers[0].children.begin(),
+                          proposal.controllers[0].children.end(),
+                          "rc-segment-1-1-3") != proposal.controllers[0].children.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(FlatProposal, Fixture)
+{
+  const auto proposal = propose_balanced_tree(*session, 100);
+  BOOST_REQUIRE_EQUAL(proposal.height, 1);
+  BOOST_REQUIRE_EQUAL(proposal.controllers.size(), 1);
+  BOOST_REQUIRE_EQUAL(proposal.controllers[0].children.size(), 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
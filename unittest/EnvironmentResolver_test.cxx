@@ -0,0 +1,166 @@
+/**
+ * @file EnvironmentResolver_test.cxx EnvironmentResolver class Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/EnvironmentResolver.hpp"
+
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Session.hpp"
+#include "dunedaqdal/VariableSet.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE EnvironmentResolver_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(EnvironmentResolver_test)
+
+namespace {
+
+/**
+ * outer contains v1 (A=1) and inner, which contains v2 (B=2); other contains
+ * v3 (A=3). The session environment is outer, the one of application a is
+ * other. c1 and c2 contain each other.
+ */
+struct Fixture
+{
+  TestDatabase t{ "EnvironmentResolver_test" };
+  const Session* session = nullptr;
+  const DaqApplication* application = nullptr;
+
+  Fixture()
+  {
+    auto variable = [this](const std::string& uid, const std::string& name, const std::string& value) {
+      auto v = t.create("Variable", uid);
+      v.set_by_val<std::string>("Name", name);
+      v.set_by_val<std::string>("Value", value);
+      return v;
+    };
+    auto v1 = variable("v1", "A", "1");
+    auto v2 = variable("v2", "B", "2");
+    auto v3 = variable("v3", "A", "3");
+
+    auto inner = t.create("VariableSet", "inner");
+    inner.set_objs("Contains", refs({ v2 }));
+    auto outer = t.create("VariableSet", "outer");
+    outer.set_objs("Contains", refs({ v1, inner }));
+    auto other = t.create("VariableSet", "other");
+    other.set_objs("Contains", refs({ v3 }));
+
+    auto c1 = t.create("VariableSet", "c1");
+    auto c2 = t.create("VariableSet", "c2");
+    c1.set_objs("Contains", refs({ c2 }));
+    c2.set_objs("Contains", refs({ c1 }));
+
+    auto a = t.create("DaqApplication", "a");
+    a.set_objs("ApplicationEnvironment", refs({ other }));
+    auto s = t.create("Session", "s");
+    s.set_objs("ProcessEnvironment", refs({ outer }));
+    s.set_objs("applications", refs({ a }));
+    t.commit();
+
+    session = t.get<Session>("s");
+    application = t.get<DaqApplication>("a");
+  }
+
+  const VariableSet& set(const std::string& uid) { return *t.get<VariableSet>(uid); }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Flatten, Fixture)
+{
+  EnvironmentResolver resolver(t.db());
+
+  const auto env = resolver.get(set("outer"));
+  BOOST_REQUIRE_EQUAL(env->size(), 2);
+  BOOST_REQUIRE_EQUAL(env->at("A"), "1");
+  BOOST_REQUIRE_EQUAL(env->at("B"), "2");
+  // outer and the nested inner
+  BOOST_REQUIRE_EQUAL(resolver.size(), 2);
+  BOOST_REQUIRE_EQUAL(resolver.get(set("outer")), env);
+
+  // application variables override session ones
+  const auto full = resolver.get(*session, *application);
+  BOOST_REQUIRE(full == (Environment{ { "A", "3" }, { "B", "2" } }));
+  BOOST_REQUIRE_EQUAL(resolver.size(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(Cycle, Fixture)
+{
+  EnvironmentResolver resolver(t.db());
+  BOOST_REQUIRE_THROW(resolver.get(set("c1")), CircularDependency);
+}
+
+BOOST_FIXTURE_TEST_CASE(Invalidate, Fixture)
+{
+  EnvironmentResolver resolver(t.db());
+  const auto outer = resolver.get(set("outer"));
+  resolver.get(set("other"));
+  BOOST_REQUIRE_EQUAL(resolver.size(), 3);
+
+  // inner and outer, which contains it, are dropped; other is kept
+  resolver.invalidate("v2");
+  BOOST_REQUIRE_EQUAL(resolver.size(), 1);
+  BOOST_REQUIRE_NE(resolver.get(set("outer")), outer);
+  BOOST_REQUIRE_EQUAL(resolver.size(), 3);
+
+  resolver.invalidate("inner");
+  BOOST_REQUIRE_EQUAL(resolver.size(), 1);
+  resolver.invalidate("v3");
+  BOOST_REQUIRE_EQUAL(resolver.size(), 0);
+
+  // an unknown object drops nothing
+  resolver.get(set("outer"));
+  resolver.invalidate("missing");
+  BOOST_REQUIRE_EQUAL(resolver.size(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(Update, Fixture)
+{
+  EnvironmentResolver resolver(t.db());
+  resolver.get(set("outer"));
+  resolver.get(set("other"));
+
+  // reported to the resolver through its ConfigAction::update()
+  dunedaq::oksdbinterfaces::ConfigObject v1;
+  t.db().get("Variable", "v1", v1);
+  v1.set_by_val<std::string>("Value", "9");
+  // outer is dropped, inner and other are kept
+  BOOST_REQUIRE_EQUAL(resolver.size(), 2);
+
+  resolver.clear();
+  BOOST_REQUIRE_EQUAL(resolver.size(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(Strings, Fixture)
+{
+  EnvironmentResolver resolver(t.db());
+  const auto env = resolver.get(set("outer"));
+  const auto other = resolver.get(set("other"));
+  const auto pool = resolver.strings();
+  // A, 1, B, 2 and 3: the name of v1 and v3 is stored once
+  BOOST_REQUIRE_EQUAL(pool->size(), 5);
+  BOOST_REQUIRE_EQUAL(env->begin()->first.data(), other->begin()->first.data());
+
+  // a new generation; the old environments and pool stay valid
+  resolver.clear();
+  BOOST_REQUIRE_NE(resolver.strings(), pool);
+  BOOST_REQUIRE_EQUAL(resolver.strings()->size(), 0);
+  BOOST_REQUIRE_EQUAL(pool->size(), 5);
+  BOOST_REQUIRE_EQUAL(env->at("B"), "2");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
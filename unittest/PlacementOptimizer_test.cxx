@@ -0,0 +1,234 @@
+/**
+ * @file PlacementOptimizer_test.cxx optimize_placement() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/PlacementOptimizer.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE PlacementOptimizer_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(PlacementOptimizer_test)
+
+namespace {
+
+/**
+ * a1 and a3 run on h1, a2 and a4 on h2, with one module each. a1 sends
+ * 100 kB/s to a2 and a3 as much to a4, a2 sends 1 kB/s to a3. The hosts
+ * have the given number of CPUs, 0 for no limit, and 1 GiB of memory when
+ * limited. With shared_memory a1 also writes a segment read by a3.
+ */
+struct Fixture
+{
+  TestDatabase t{ "PlacementOptimizer_test" };
+  const Session* session = nullptr;
+
+  explicit Fixture(uint32_t cpus = 2, bool shared_memory = false)
+  {
+    auto connection = [this](const std::string& uid, const std::string& data_type) {
+      auto c = t.create("NetworkConnection", uid);
+      c.set_by_val<std::string>("data_type", data_type);
+      c.set_by_val<std::string>("uri", "tcp://{host}:5000");
+      return c;
+    };
+    auto n12 = connection("n12", "Fragment");
+    auto n34 = connection("n34", "Fragment");
+    auto n23 = connection("n23", "TimeSync");
+    auto shm = t.create("SharedMemoryConnection", "shm");
+    shm.set_by_val<std::string>("data_type", "Fragment");
+    shm.set_by_val<std::string>("segment_name", "/shm");
+    shm.set_by_val<uint64_t>("segment_size", 1 << 20);
+
+    auto m1 = t.create("DaqModule", "m1");
+    m1.set_objs("outputs", shared_memory ? refs({ n12, shm }) : refs({ n12 }));
+    auto m2 = t.create("DaqModule", "m2");
+    m2.set_objs("inputs", refs({ n12 }));
+    m2.set_objs("outputs", refs({ n23 }));
+    auto m3 = t.create("DaqModule", "m3");
+    m3.set_objs("inputs", shared_memory ? refs({ n23, shm }) : refs({ n23 }));
+    m3.set_objs("outputs", refs({ n34 }));
+    auto m4 = t.create("DaqModule", "m4");
+    m4.set_objs("inputs", refs({ n34 }));
+
+    using dunedaq::oksdbinterfaces::ConfigObject;
+    auto application = [this](const std::string& uid, const std::string& host, const ConfigObject& m) {
+      auto app = t.create("DaqApplication", uid);
+      app.set_by_val<std::string>("host", host);
+      app.set_objs("modules", refs({ m }));
+      return app;
+    };
+    auto a1 = application("a1", "h1", m1);
+    auto a2 = application("a2", "h2", m2);
+    auto a3 = application("a3", "h1", m3);
+    auto a4 = application("a4", "h2", m4);
+
+    auto profile = [this](const std::string& data_type, uint64_t size, double rate) {
+      auto dtp = t.create("DataTypeProfile", data_type);
+      dtp.set_by_val<std::string>("data_type", data_type);
+      dtp.set_by_val<uint64_t>("payload_size", size);
+      dtp.set_by_val<float>("rate_hz", rate);
+      return dtp;
+    };
+    auto fragment = profile("Fragment", 1000, 100);
+    auto timesync = profile("TimeSync", 100, 10);
+
+    auto host = [this, cpus](const std::string& name) {
+      auto h = t.create("Host", name);
+      h.set_by_val<std::string>("hostname", name);
+      h.set_by_val<uint32_t>("cpus", cpus);
+      h.set_by_val<uint64_t>("memory_mb", cpus != 0 ? 1024 : 0);
+      return h;
+    };
+    auto h1 = host("h1");
+    auto h2 = host("h2");
+
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs({ a1, a2, a3, a4 }));
+    s.set_objs("data_type_profiles", refs({ fragment, timesync }));
+    s.set_objs("hosts", refs({ h1, h2 }));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+struct Unlimited : Fixture
+{
+  Unlimited()
+    : Fixture(0)
+  {
+  }
+};
+
+struct SingleCpu : Fixture
+{
+  SingleCpu()
+    : Fixture(1)
+  {
+  }
+};
+
+struct SharedMemory : Fixture
+{
+  SharedMemory()
+    : Fixture(3, true)
+  {
+  }
+};
+
+const std::string&
+host_of(const PlacementPlan& plan, const std::string& uid)
+{
+  for (const auto& a : plan.assignments) {
+    if (a.application->UID() == uid) {
+      return a.host;
+    }
+  }
+  BOOST_FAIL("no assignment for " << uid);
+  throw std::logic_error(uid);
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Pairs, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto plan = optimize_placement(*session, index);
+  BOOST_REQUIRE_EQUAL(plan.assignments.size(), 4);
+  BOOST_REQUIRE(plan.feasible);
+
+  // the heavy pairs share a host, only the light connection crosses
+  BOOST_REQUIRE_EQUAL(host_of(plan, "a1"), host_of(plan, "a2"));
+  BOOST_REQUIRE_EQUAL(host_of(plan, "a3"), host_of(plan, "a4"));
+  BOOST_REQUIRE_NE(host_of(plan, "a1"), host_of(plan, "a3"));
+  BOOST_REQUIRE_CLOSE(plan.traffic_before, 201000, 1e-6);
+  BOOST_REQUIRE_CLOSE(plan.traffic_after, 1000, 1e-6);
+}
+
+BOOST_FIXTURE_TEST_CASE(Balanced, Unlimited)
+{
+  // without limits each host takes at most 1.1 times half of the four CPUs
+  ConnectivityIndex index(*session);
+  const auto plan = optimize_placement(*session, index);
+  BOOST_REQUIRE(plan.feasible);
+  BOOST_REQUIRE_EQUAL(host_of(plan, "a1"), host_of(plan, "a2"));
+  BOOST_REQUIRE_EQUAL(host_of(plan, "a3"), host_of(plan, "a4"));
+  BOOST_REQUIRE_NE(host_of(plan, "a1"), host_of(plan, "a3"));
+
+  PlacementOptimizerParameters parameters;
+  parameters.imbalance = 2;
+  BOOST_REQUIRE_EQUAL(optimize_placement(*session, index, {}, parameters).traffic_after, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(SegmentPeers, SharedMemory)
+{
+  ConnectivityIndex index(*session);
+  const auto plan = optimize_placement(*session, index);
+  BOOST_REQUIRE(plan.feasible);
+  BOOST_REQUIRE_EQUAL(host_of(plan, "a1"), host_of(plan, "a3"));
+}
+
+BOOST_FIXTURE_TEST_CASE(Infeasible, SingleCpu)
+{
+  ConnectivityIndex index(*session);
+  const auto plan = optimize_placement(*session, index);
+  BOOST_REQUIRE_EQUAL(plan.assignments.size(), 4);
+  BOOST_REQUIRE(!plan.feasible);
+}
+
+BOOST_FIXTURE_TEST_CASE(Apply, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto plan = optimize_placement(*session, index);
+  size_t changed = 0;
+  for (const auto& a : plan.assignments) {
+    changed += a.changed();
+  }
+  BOOST_REQUIRE_EQUAL(changed, 2);
+
+  apply(plan);
+  t.commit();
+  for (const auto& uid : { "a1", "a2", "a3", "a4" }) {
+    auto obj = t.get<DaqApplication>(uid)->config_object();
+    std::string host;
+    obj.get("host", host);
+    BOOST_REQUIRE_EQUAL(host, host_of(plan, uid));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NoHosts)
+{
+  TestDatabase t("PlacementOptimizer_test_NoHosts");
+  auto m = t.create("DaqModule", "m");
+  auto a = t.create("DaqApplication", "a");
+  a.set_objs("modules", refs({ m }));
+  auto s = t.create("Session", "s");
+  s.set_objs("applications", refs({ a }));
+  t.commit();
+
+  const auto* session = t.get<Session>("s");
+  ConnectivityIndex index(*session);
+  const auto plan = optimize_placement(*session, index);
+  BOOST_REQUIRE(plan.assignments.empty());
+  BOOST_REQUIRE_EQUAL(plan.levels, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
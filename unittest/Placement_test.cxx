@@ -0,0 +1,53 @@
+/**
+ * @file Placement_test.cxx CPU list parsing Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Placement.hpp"
+
+#define BOOST_TEST_MODULE Placement_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+
+using namespace dunedaq::dal;
+
+BOOST_AUTO_TEST_SUITE(Placement_test)
+
+BOOST_AUTO_TEST_CASE(ParseCpuList)
+{
+  BOOST_REQUIRE(parse_cpu_list("").empty());
+  BOOST_REQUIRE(parse_cpu_list("5") == (CpuSet{ 5 }));
+  BOOST_REQUIRE(parse_cpu_list("0-3, 8,10-11,2") == (CpuSet{ 0, 1, 2, 3, 8, 10, 11 }));
+  BOOST_REQUIRE(parse_cpu_list(" 4 - 5 ") == (CpuSet{ 4, 5 }));
+}
+
+BOOST_AUTO_TEST_CASE(ParseCpuListErrors)
+{
+  for (const std::string list : { "3-1", "a", "1,,2", ",1", "-3", "3-", "1-2-3", "1.5", "99999999", "0-65536" }) {
+    BOOST_TEST_CONTEXT("cpu list \"" << list << '"')
+    {
+      BOOST_REQUIRE_THROW(parse_cpu_list(list), dunedaq::dal::BadCpuList);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FormatCpuList)
+{
+  BOOST_REQUIRE_EQUAL(format_cpu_list({}), "");
+  BOOST_REQUIRE_EQUAL(format_cpu_list({ 0, 1, 2, 3, 8, 10, 11 }), "0-3,8,10-11");
+  BOOST_REQUIRE_EQUAL(format_cpu_list(parse_cpu_list("7,1-2,3")), "1-3,7");
+}
+
+BOOST_AUTO_TEST_CASE(Intersection)
+{
+  BOOST_REQUIRE(intersection({ 0, 1, 2, 3 }, { 2, 3, 4 }) == (CpuSet{ 2, 3 }));
+  BOOST_REQUIRE(intersection({ 0, 1 }, { 2, 3 }).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+/**
+ * @file PollingScheduler_test.cxx PollingScheduler class Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/PollingScheduler.hpp"
+
+#define BOOST_TEST_MODULE PollingScheduler_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <limits>
+
+using namespace dunedaq::dal;
+using ms = std::chrono::milliseconds;
+
+BOOST_AUTO_TEST_SUITE(PollingScheduler_test)
+
+namespace {
+
+PollingParameters
+parameters(ms min, ms max, double backoff)
+{
+  PollingParameters p;
+  for (auto& interval : p.intervals) {
+    interval = PollingInterval{ min, max, backoff };
+  }
+  return p;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(DueImmediately)
+{
+  const auto t = PollingScheduler::Clock::now();
+  PollingScheduler scheduler(parameters(ms(50), ms(300), 2.), t);
+  BOOST_REQUIRE(scheduler.due(ConnectionType::send_recv, t));
+  BOOST_REQUIRE(scheduler.due(ConnectionType::pub_sub, t));
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(50));
+}
+
+BOOST_AUTO_TEST_CASE(BackoffGrowsToMaximum)
+{
+  const auto t = PollingScheduler::Clock::now();
+  PollingScheduler scheduler(parameters(ms(50), ms(300), 2.), t);
+
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(100));
+  BOOST_REQUIRE(scheduler.next(ConnectionType::send_recv) == t + ms(100));
+  BOOST_REQUIRE(!scheduler.due(ConnectionType::send_recv, t + ms(99)));
+
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(200));
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(300));
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(300));
+
+  // the other type is independent
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::pub_sub) == ms(50));
+  BOOST_REQUIRE(scheduler.next() == t);
+}
+
+BOOST_AUTO_TEST_CASE(ShortIntervalsKeepGrowing)
+{
+  const auto t = PollingScheduler::Clock::now();
+  PollingScheduler scheduler(parameters(ms(1), ms(10), 1.2), t);
+
+  // 1.2 ms and 2.4 ms are rounded up rather than truncated back to the current interval
+  scheduler.polled(ConnectionType::pub_sub, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::pub_sub) == ms(2));
+  scheduler.polled(ConnectionType::pub_sub, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::pub_sub) == ms(3));
+}
+
+BOOST_AUTO_TEST_CASE(HugeBackoff)
+{
+  const auto t = PollingScheduler::Clock::now();
+  for (double backoff : { 1e300, std::numeric_limits<double>::infinity() }) {
+    BOOST_TEST_CONTEXT("backoff " << backoff)
+    {
+      PollingScheduler scheduler(parameters(ms(50), ms(300), backoff), t);
+      scheduler.polled(ConnectionType::send_recv, t, false);
+      BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(300));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NoBackoff)
+{
+  const auto t = PollingScheduler::Clock::now();
+  PollingScheduler scheduler(parameters(ms(40), ms(1000), 1.), t);
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(40));
+}
+
+BOOST_AUTO_TEST_CASE(MissesAndTransitionsReset)
+{
+  const auto t = PollingScheduler::Clock::now();
+  PollingScheduler scheduler(parameters(ms(50), ms(1000), 4.), t);
+
+  scheduler.polled(ConnectionType::send_recv, t, false);
+  scheduler.polled(ConnectionType::pub_sub, t, false);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(200));
+
+  scheduler.polled(ConnectionType::send_recv, t, true);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::send_recv) == ms(50));
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::pub_sub) == ms(200));
+
+  const auto later = t + ms(10);
+  scheduler.transition(later);
+  BOOST_REQUIRE(scheduler.interval(ConnectionType::pub_sub) == ms(50));
+  BOOST_REQUIRE(scheduler.due(ConnectionType::pub_sub, later));
+}
+
+BOOST_AUTO_TEST_CASE(ConnectionTypeNames)
+{
+  BOOST_REQUIRE(to_connection_type("kPubSub") == ConnectionType::pub_sub);
+  BOOST_REQUIRE(to_connection_type("kSendRecv") == ConnectionType::send_recv);
+  BOOST_REQUIRE(to_connection_type("") == ConnectionType::send_recv);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
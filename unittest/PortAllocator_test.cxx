@@ -0,0 +1,245 @@
+/**
+ * @file PortAllocator_test.cxx parse_port_list() and assign_ports() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/PortAllocator.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/NetworkConnection.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE PortAllocator_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(PortAllocator_test)
+
+namespace {
+
+/**
+ * a and b both use port 30000 of h1, c has no port on h2. n1 is bound by c,
+ * its consumer, n2 by b, its publisher; n3 is an inproc connection. 30001 is
+ * reserved on every host and 30003 on h1.
+ */
+struct Fixture
+{
+  TestDatabase t{ "PortAllocator_test" };
+  const Session* session = nullptr;
+
+  explicit Fixture(uint16_t last_port = 30005)
+  {
+    auto n1 = t.create("NetworkConnection", "n1");
+    n1.set_by_val<std::string>("data_type", "TimeSync");
+    n1.set_by_val<std::string>("connection_type", "kSendRecv");
+    n1.set_by_val<std::string>("uri", "tcp://{h}:31000/x");
+    auto n2 = t.create("NetworkConnection", "n2");
+    n2.set_by_val<std::string>("data_type", "TimeSync");
+    n2.set_by_val<std::string>("connection_type", "kPubSub");
+    n2.set_by_val<std::string>("uri", "tcp://old:30000");
+    auto n3 = t.create("NetworkConnection", "n3");
+    n3.set_by_val<std::string>("data_type", "TimeSync");
+    n3.set_by_val<std::string>("uri", "inproc://foo");
+
+    auto ma = t.create("DaqModule", "ma");
+    ma.set_objs("outputs", refs({ n1, n3 }));
+    auto mb = t.create("DaqModule", "mb");
+    mb.set_objs("outputs", refs({ n2 }));
+    auto mc = t.create("DaqModule", "mc");
+    mc.set_objs("inputs", refs({ n1, n2 }));
+
+    auto a = t.create("DaqApplication", "a");
+    a.set_by_val<std::string>("host", "h1");
+    a.set_by_val<uint16_t>("port", 30000);
+    a.set_objs("modules", refs({ ma }));
+    auto b = t.create("DaqApplication", "b");
+    b.set_by_val<std::string>("host", "h1");
+    b.set_by_val<uint16_t>("port", 30000);
+    b.set_objs("modules", refs({ mb }));
+    auto c = t.create("DaqApplication", "c");
+    c.set_by_val<std::string>("host", "h2");
+    c.set_by_val<uint16_t>("port", 0);
+    c.set_objs("modules", refs({ mc }));
+
+    auto h = t.create("Host", "H");
+    h.set_by_val<std::string>("hostname", "h1");
+    h.set_by_val<std::string>("reserved_ports", "30003, 30010-30020");
+
+    auto s = t.create("Session", "s");
+    s.set_by_val<uint16_t>("first_port", 30000);
+    s.set_by_val<uint16_t>("last_port", last_port);
+    s.set_by_val<std::string>("reserved_ports", "30001");
+    s.set_objs("hosts", refs({ h }));
+    s.set_objs("applications", refs({ a, b, c }));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+struct SmallRange : Fixture
+{
+  SmallRange()
+    : Fixture(30002)
+  {
+  }
+};
+
+const PortAssignment&
+find(const std::vector<PortAssignment>& assignments, const std::string& uid)
+{
+  for (const auto& pa : assignments) {
+    if ((pa.application != nullptr ? pa.application->UID() : pa.connection->UID()) == uid) {
+      return pa;
+    }
+  }
+  BOOST_FAIL("no assignment for " << uid);
+  throw std::logic_error(uid);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ParsePortList)
+{
+  BOOST_REQUIRE(parse_port_list("").empty());
+  BOOST_REQUIRE(parse_port_list("5432, 8000-8100") == (PortRanges{ { 5432, 5432 }, { 8000, 8100 } }));
+  // sorted, adjacent and overlapping ranges merged
+  BOOST_REQUIRE(parse_port_list("5,1-3,4") == (PortRanges{ { 1, 5 } }));
+  BOOST_REQUIRE(parse_port_list("10-20,15-30,40") == (PortRanges{ { 10, 30 }, { 40, 40 } }));
+
+  for (const char* list : { "3-1", "0", "65536", "a", "1-", "-1", "1-2-3", "123456" }) {
+    BOOST_TEST_CONTEXT(list) { BOOST_REQUIRE_THROW(parse_port_list(list), BadPortList); }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Contains)
+{
+  const auto ranges = parse_port_list("10-20,40");
+  BOOST_REQUIRE(contains(ranges, 10));
+  BOOST_REQUIRE(contains(ranges, 15));
+  BOOST_REQUIRE(contains(ranges, 20));
+  BOOST_REQUIRE(contains(ranges, 40));
+  BOOST_REQUIRE(!contains(ranges, 9));
+  BOOST_REQUIRE(!contains(ranges, 21));
+  BOOST_REQUIRE(!contains(ranges, 65535));
+  BOOST_REQUIRE(!contains(PortRanges{}, 10));
+}
+
+BOOST_FIXTURE_TEST_CASE(Conflicts, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto assignments = assign_ports(*session, index);
+  BOOST_REQUIRE_EQUAL(assignments.size(), 5);
+
+  // a keeps its port, b moves past the port reserved on every host
+  const auto& a = find(assignments, "a");
+  BOOST_REQUIRE_EQUAL(a.port, 30000);
+  BOOST_REQUIRE(!a.changed());
+  const auto& b = find(assignments, "b");
+  BOOST_REQUIRE_EQUAL(b.host, "h1");
+  BOOST_REQUIRE_EQUAL(b.old_port, 30000);
+  BOOST_REQUIRE_EQUAL(b.port, 30002);
+  BOOST_REQUIRE(b.changed());
+
+  // c is alone on h2
+  BOOST_REQUIRE_EQUAL(find(assignments, "c").port, 30000);
+}
+
+BOOST_FIXTURE_TEST_CASE(ConnectionUris, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto assignments = assign_ports(*session, index);
+
+  // bound by b on h1, skipping the port reserved on h1
+  const auto& n2 = find(assignments, "n2");
+  BOOST_REQUIRE_EQUAL(n2.host, "h1");
+  BOOST_REQUIRE_EQUAL(n2.port, 30004);
+  BOOST_REQUIRE_EQUAL(n2.uri, "tcp://h1:30004");
+
+  // bound by c on h2, keeping its port and path
+  const auto& n1 = find(assignments, "n1");
+  BOOST_REQUIRE_EQUAL(n1.host, "h2");
+  BOOST_REQUIRE_EQUAL(n1.port, 31000);
+  BOOST_REQUIRE_EQUAL(n1.uri, "tcp://h2:31000/x");
+  BOOST_REQUIRE(n1.changed());
+
+  for (const auto& pa : assignments) {
+    BOOST_REQUIRE(pa.connection == nullptr || pa.connection->UID() != "n3");
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(ReassignAll, Fixture)
+{
+  PortAssignmentParameters parameters;
+  parameters.reassign_all = true;
+  ConnectivityIndex index(*session);
+  const auto assignments = assign_ports(*session, index, parameters);
+
+  for (const auto& pa : assignments) {
+    BOOST_REQUIRE_NE(pa.port, 30001);
+    BOOST_REQUIRE(pa.host != "h1" || pa.port != 30003);
+    BOOST_REQUIRE_GE(pa.port, 30000);
+    BOOST_REQUIRE_LE(pa.port, 30005);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(HostOverride, Fixture)
+{
+  // b moved to h2 by a placement not applied yet, taking n2 with it
+  PortAssignmentParameters parameters;
+  parameters.hosts = { { "b", "h2" } };
+  ConnectivityIndex index(*session);
+  const auto assignments = assign_ports(*session, index, parameters);
+
+  const auto& b = find(assignments, "b");
+  BOOST_REQUIRE_EQUAL(b.host, "h2");
+  BOOST_REQUIRE_EQUAL(b.port, 30000);
+  BOOST_REQUIRE_EQUAL(find(assignments, "c").port, 30002);
+
+  const auto& n2 = find(assignments, "n2");
+  BOOST_REQUIRE_EQUAL(n2.host, "h2");
+  BOOST_REQUIRE_EQUAL(n2.uri, "tcp://h2:30003");
+  BOOST_REQUIRE(n2.changed());
+}
+
+BOOST_FIXTURE_TEST_CASE(Exhausted, SmallRange)
+{
+  PortAssignmentParameters parameters;
+  parameters.reassign_all = true;
+  ConnectivityIndex index(*session);
+  // h1 has 30000 and 30002 for a, b and n2
+  BOOST_REQUIRE_THROW(assign_ports(*session, index, parameters), PortsExhausted);
+}
+
+BOOST_FIXTURE_TEST_CASE(Apply, Fixture)
+{
+  ConnectivityIndex index(*session);
+  apply(assign_ports(*session, index));
+  t.commit();
+
+  auto b = t.get<DaqApplication>("b")->config_object();
+  uint16_t port = 0;
+  b.get("port", port);
+  BOOST_REQUIRE_EQUAL(port, 30002);
+
+  auto n2 = t.get<NetworkConnection>("n2")->config_object();
+  std::string uri;
+  n2.get("uri", uri);
+  BOOST_REQUIRE_EQUAL(uri, "tcp://h1:30004");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,207 @@
+/**
+ * @file QueueAdvisor_test.cxx advise_queues() and read_rate_profile() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/QueueAdvisor.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Queue.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE QueueAdvisor_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(QueueAdvisor_test)
+
+namespace {
+
+/**
+ * m1 writes q1, q2, q3 and q4, m3 writes q2; m2 reads q1, q2, q3 and q4, m3
+ * reads q3. q4 already has the recommended type and capacity; n is not a
+ * Queue.
+ */
+struct Fixture
+{
+  TestDatabase t{ "QueueAdvisor_test" };
+  const Session* session = nullptr;
+
+  Fixture()
+  {
+    auto queue = [this](const std::string& uid, uint32_t capacity) {
+      auto q = t.create("Queue", uid);
+      q.set_by_val<std::string>("data_type", "Fragment");
+      q.set_by_val<uint32_t>("capacity", capacity);
+      return q;
+    };
+    auto q1 = queue("q1", 10);
+    auto q2 = queue("q2", 3);
+    auto q3 = queue("q3", 10);
+    auto q4 = queue("q4", 16);
+    auto n = t.create("NetworkConnection", "n");
+    n.set_by_val<std::string>("data_type", "TimeSync");
+    n.set_by_val<std::string>("uri", "tcp://host1:5000");
+
+    auto m1 = t.create("DaqModule", "m1");
+    m1.set_objs("outputs", refs({ q1, q2, q3, q4, n }));
+    auto m2 = t.create("DaqModule", "m2");
+    m2.set_objs("inputs", refs({ q1, q2, q3, q4, n }));
+    auto m3 = t.create("DaqModule", "m3");
+    m3.set_objs("inputs", refs({ q3 }));
+    m3.set_objs("outputs", refs({ q2 }));
+
+    auto a = t.create("DaqApplication", "a");
+    a.set_by_val<std::string>("host", "host1");
+    a.set_objs("modules", refs({ m1, m2, m3 }));
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs({ a }));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+const QueueAdvice&
+find(const std::vector<QueueAdvice>& advice, const std::string& uid)
+{
+  for (const auto& a : advice) {
+    if (a.queue->UID() == uid) {
+      return a;
+    }
+  }
+  BOOST_FAIL("no advice for " << uid);
+  throw std::logic_error(uid);
+}
+
+/// Rate profile in a temporary file, removed with it
+class Profile
+{
+public:
+  explicit Profile(const std::string& content)
+    : m_path("/tmp/dunedaqdal_QueueAdvisor_test." + std::to_string(getpid()) + ".rates")
+  {
+    std::ofstream(m_path) << content;
+  }
+
+  ~Profile() { std::remove(m_path.c_str()); }
+
+  const std::string& path() const noexcept { return m_path; }
+
+private:
+  std::string m_path;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Types, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto advice = advise_queues(index);
+  BOOST_REQUIRE_EQUAL(advice.size(), 4);
+
+  const auto& q1 = find(advice, "q1");
+  BOOST_REQUIRE_EQUAL(q1.producers, 1);
+  BOOST_REQUIRE_EQUAL(q1.consumers, 1);
+  BOOST_REQUIRE_EQUAL(q1.queue_type, "kFollySPSCQueue");
+  BOOST_REQUIRE(!q1.unsafe_type);
+
+  // the default kFollySPSCQueue cannot take two producers
+  const auto& q2 = find(advice, "q2");
+  BOOST_REQUIRE_EQUAL(q2.producers, 2);
+  BOOST_REQUIRE_EQUAL(q2.queue_type, "kLockFreeMPSCRing");
+  BOOST_REQUIRE(q2.unsafe_type);
+
+  const auto& q3 = find(advice, "q3");
+  BOOST_REQUIRE_EQUAL(q3.consumers, 2);
+  BOOST_REQUIRE_EQUAL(q3.queue_type, "kFollyMPMCQueue");
+  BOOST_REQUIRE(q3.unsafe_type);
+}
+
+BOOST_FIXTURE_TEST_CASE(Capacity, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto advice = advise_queues(index);
+
+  // without a rate the current capacity is rounded up, to at least min_capacity
+  BOOST_REQUIRE_EQUAL(find(advice, "q1").capacity, 16);
+  BOOST_REQUIRE_EQUAL(find(advice, "q2").capacity, 8);
+  BOOST_REQUIRE(find(advice, "q1").changed());
+  BOOST_REQUIRE(!find(advice, "q4").changed());
+
+  QueueAdvisorParameters parameters;
+  parameters.min_capacity = 64;
+  BOOST_REQUIRE_EQUAL(find(advise_queues(index, {}, parameters), "q1").capacity, 64);
+}
+
+BOOST_FIXTURE_TEST_CASE(Rates, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const RateProfile rates{ { "q1", 100000. },
+                           { "q2", 1e300 },
+                           { "q3", std::numeric_limits<double>::quiet_NaN() },
+                           { "q4", -5. } };
+  const auto advice = advise_queues(index, rates);
+
+  // 1000 messages in 10 ms
+  BOOST_REQUIRE_EQUAL(find(advice, "q1").capacity, 1024);
+  BOOST_REQUIRE_EQUAL(find(advice, "q1").rate_hz, 100000.);
+  BOOST_REQUIRE_EQUAL(find(advice, "q2").capacity, uint32_t(1) << 31);
+  BOOST_REQUIRE_EQUAL(find(advice, "q3").capacity, 8);
+  BOOST_REQUIRE_EQUAL(find(advice, "q4").capacity, 8);
+}
+
+BOOST_FIXTURE_TEST_CASE(Apply, Fixture)
+{
+  ConnectivityIndex index(*session);
+  apply(advise_queues(index));
+  t.commit();
+
+  auto q2 = t.get<Queue>("q2")->config_object();
+  uint32_t capacity = 0;
+  std::string type;
+  q2.get("capacity", capacity);
+  q2.get("queue_type", type);
+  BOOST_REQUIRE_EQUAL(capacity, 8);
+  BOOST_REQUIRE_EQUAL(type, "kLockFreeMPSCRing");
+}
+
+BOOST_AUTO_TEST_CASE(ReadRateProfile)
+{
+  const Profile profile("# measured rates\n\nq1 1000\n  q2\t2.5e3  \nq1 10\n");
+  const auto rates = read_rate_profile(profile.path());
+  BOOST_REQUIRE_EQUAL(rates.size(), 2);
+  // the last line for a queue wins
+  BOOST_REQUIRE_EQUAL(rates.at("q1"), 10.);
+  BOOST_REQUIRE_EQUAL(rates.at("q2"), 2500.);
+
+  for (const char* content : { "q1\n", "q1 -1\n", "q1 x\n", "q1 inf\n", "q1 nan\n" }) {
+    BOOST_TEST_CONTEXT(content)
+    {
+      const Profile bad(content);
+      BOOST_REQUIRE_THROW(read_rate_profile(bad.path()), BadRateProfile);
+    }
+  }
+  BOOST_REQUIRE_THROW(read_rate_profile("/tmp/dunedaqdal_QueueAdvisor_test.missing.rates"), BadRateProfile);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
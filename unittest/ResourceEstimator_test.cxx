@@ -0,0 +1,217 @@
+/**
+ * @file ResourceEstimator_test.cxx estimate_resources() and network_flows() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/ResourceEstimator.hpp"
+
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/DaqApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE ResourceEstimator_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(ResourceEstimator_test)
+
+namespace {
+
+constexpr double MiB = 1 << 20;
+
+/**
+ * a and b run on h1, c on h2; a reserves two 2 MiB and one 1 GiB huge
+ * pages. Fragments are 1000 bytes at 100 Hz, TimeSyncs 100 bytes at 10 Hz.
+ *
+ * - Queue q (16 fragments) from a to b, Queue u of an unknown data type
+ *   from b to a, and SharedMemoryConnection shm of 1 MiB written by b only;
+ * - kSendRecv n of fragments from a to c, kSendRecv n2 of fragments from c
+ *   to a and b, shared by the receivers, and kPubSub p of TimeSyncs from c
+ *   to a and b, each receiving all of it.
+ *
+ * h1 has 1 MiB of memory and 100 kB/s of network bandwidth.
+ */
+struct Fixture
+{
+  TestDatabase t{ "ResourceEstimator_test" };
+  const Session* session = nullptr;
+
+  Fixture()
+  {
+    auto connection = [this](const std::string& class_name, const std::string& uid, const std::string& data_type) {
+      auto c = t.create(class_name, uid);
+      c.set_by_val<std::string>("data_type", data_type);
+      return c;
+    };
+    auto q = connection("Queue", "q", "Fragment");
+    q.set_by_val<uint32_t>("capacity", 16);
+    auto u = connection("Queue", "u", "Unknown");
+    auto shm = connection("SharedMemoryConnection", "shm", "Fragment");
+    shm.set_by_val<std::string>("segment_name", "/shm");
+    shm.set_by_val<uint64_t>("segment_size", 1 << 20);
+    auto n = connection("NetworkConnection", "n", "Fragment");
+    n.set_by_val<std::string>("uri", "tcp://h2:5000");
+    auto n2 = connection("NetworkConnection", "n2", "Fragment");
+    n2.set_by_val<std::string>("uri", "tcp://h2:5001");
+    auto p = connection("NetworkConnection", "p", "TimeSync");
+    p.set_by_val<std::string>("uri", "tcp://h2:5002");
+    p.set_enum("connection_type", "kPubSub");
+
+    auto ma = t.create("DaqModule", "ma");
+    ma.set_objs("inputs", refs({ u, n2, p }));
+    ma.set_objs("outputs", refs({ q, n }));
+    auto mb = t.create("DaqModule", "mb");
+    mb.set_objs("inputs", refs({ q, n2, p }));
+    mb.set_objs("outputs", refs({ u, shm }));
+    auto mc = t.create("DaqModule", "mc");
+    mc.set_objs("inputs", refs({ n }));
+    mc.set_objs("outputs", refs({ n2, p }));
+
+    auto placement = t.create("ProcessPlacement", "pa");
+    placement.set_by_val<uint32_t>("hugepages_2M", 2);
+    placement.set_by_val<uint32_t>("hugepages_1G", 1);
+
+    using dunedaq::oksdbinterfaces::ConfigObject;
+    auto application = [this](const std::string& uid, const std::string& host, const ConfigObject& m) {
+      auto app = t.create("DaqApplication", uid);
+      app.set_by_val<std::string>("host", host);
+      app.set_objs("modules", refs({ m }));
+      return app;
+    };
+    auto a = application("a", "h1", ma);
+    a.set_obj("placement", &placement);
+    auto b = application("b", "h1", mb);
+    auto c = application("c", "h2", mc);
+
+    auto profile = [this](const std::string& uid, const std::string& data_type, uint64_t size, double rate) {
+      auto dtp = t.create("DataTypeProfile", uid);
+      dtp.set_by_val<std::string>("data_type", data_type);
+      dtp.set_by_val<uint64_t>("payload_size", size);
+      dtp.set_by_val<float>("rate_hz", rate);
+      return dtp;
+    };
+    auto fragment = profile("fragment", "Fragment", 1000, 100);
+    auto timesync = profile("timesync", "TimeSync", 100, 10);
+    auto ignored = profile("ignored", "Fragment", 5, 1);
+
+    auto h1 = t.create("Host", "H1");
+    h1.set_by_val<std::string>("hostname", "h1");
+    h1.set_by_val<uint64_t>("memory_mb", 1);
+    h1.set_by_val<float>("network_gbps", 0.0008);
+
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs({ a, b, c }));
+    s.set_objs("data_type_profiles", refs({ fragment, timesync, ignored }));
+    s.set_objs("hosts", refs({ h1 }));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+/// Sum of the flows between two applications
+double
+traffic(const ConnectivityIndex& index,
+        const std::vector<NetworkFlow>& flows,
+        const std::string& from,
+        const std::string& to)
+{
+  double total = 0;
+  for (const auto& flow : flows) {
+    if (index.application(flow.from)->UID() == from && index.application(flow.to)->UID() == to) {
+      total += flow.bytes_per_s;
+    }
+  }
+  return total;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Registry, Fixture)
+{
+  const auto registry = data_type_registry(*session);
+  BOOST_REQUIRE_EQUAL(registry.size(), 2);
+  // the first profile of a data type wins
+  BOOST_REQUIRE_EQUAL(registry.at("Fragment").payload_size, 1000);
+  BOOST_REQUIRE_CLOSE(registry.at("TimeSync").rate_hz, 10., 1e-6);
+}
+
+BOOST_FIXTURE_TEST_CASE(NetworkFlows, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto flows = network_flows(*session, index);
+  BOOST_REQUIRE_EQUAL(flows.size(), 5);
+
+  BOOST_REQUIRE_CLOSE(traffic(index, flows, "a", "c"), 1e5, 1e-6);
+  // n2 shared by its receivers plus all of p for each subscriber
+  BOOST_REQUIRE_CLOSE(traffic(index, flows, "c", "a"), 5e4 + 1000, 1e-6);
+  BOOST_REQUIRE_CLOSE(traffic(index, flows, "c", "b"), 5e4 + 1000, 1e-6);
+  // queues and the segment are not network traffic
+  BOOST_REQUIRE_EQUAL(traffic(index, flows, "a", "b"), 0);
+
+  // measured rates override the profile
+  const auto measured = network_flows(*session, index, { { "n", 200. } });
+  BOOST_REQUIRE_CLOSE(traffic(index, measured, "a", "c"), 2e5, 1e-6);
+}
+
+BOOST_FIXTURE_TEST_CASE(Applications, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto estimate = estimate_resources(*session, index);
+  BOOST_REQUIRE_EQUAL(estimate.applications.size(), 3);
+
+  const auto& a = estimate.applications[0].usage;
+  BOOST_REQUIRE_EQUAL(estimate.applications[0].application->UID(), "a");
+  BOOST_REQUIRE_EQUAL(a.hugepages, 2 * 2 * MiB + 1024 * MiB);
+  BOOST_REQUIRE_EQUAL(a.queue_memory, 0);
+  BOOST_REQUIRE_CLOSE(a.network_out, 1e5, 1e-6);
+  BOOST_REQUIRE_CLOSE(a.network_in, 51000, 1e-6);
+  BOOST_REQUIRE_EQUAL(a.modules, 1);
+
+  // q lives with its consumer, shm with its only producer
+  const auto& b = estimate.applications[1].usage;
+  BOOST_REQUIRE_EQUAL(b.queue_memory, 16 * 1000 + MiB);
+  BOOST_REQUIRE_CLOSE(b.network_in, 51000, 1e-6);
+  BOOST_REQUIRE_EQUAL(b.network_out, 0);
+
+  const auto& c = estimate.applications[2].usage;
+  BOOST_REQUIRE_CLOSE(c.network_out, 102000, 1e-6);
+  BOOST_REQUIRE_CLOSE(c.network_in, 1e5, 1e-6);
+
+  BOOST_REQUIRE(estimate.unknown_data_types == std::vector<std::string>{ "Unknown" });
+}
+
+BOOST_FIXTURE_TEST_CASE(Hosts, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto estimate = estimate_resources(*session, index);
+  BOOST_REQUIRE_EQUAL(estimate.hosts.size(), 2);
+
+  const auto& h1 = estimate.hosts[0];
+  BOOST_REQUIRE_EQUAL(h1.host, "h1");
+  BOOST_REQUIRE(h1.limits != nullptr);
+  BOOST_REQUIRE_EQUAL(h1.usage.applications, 2);
+  BOOST_REQUIRE(h1.memory_oversubscribed);
+  // 102 kB/s received over 100 kB/s
+  BOOST_REQUIRE(h1.network_oversubscribed);
+
+  // without a Host nothing is oversubscribed
+  const auto& h2 = estimate.hosts[1];
+  BOOST_REQUIRE_EQUAL(h2.host, "h2");
+  BOOST_REQUIRE(h2.limits == nullptr);
+  BOOST_REQUIRE(!h2.oversubscribed());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
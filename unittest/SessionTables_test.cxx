@@ -0,0 +1,227 @@
+/**
+ * @file SessionTables_test.cxx make_tables() and write_csv() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/SessionTables.hpp"
+
+#include "dunedaqdal/Connection.hpp"
+#include "dunedaqdal/ConnectivityIndex.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE SessionTables_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(SessionTables_test)
+
+namespace {
+
+/**
+ * a (m1, m2) and b (m3) run on h1, c (m4) on h2. Queue q goes from m1 to
+ * m2, kPubSub n from m2 to m3 and SharedMemoryConnection shm from m3 to m1.
+ * The session environment holds v1 and v2; a adds v2 and v3, b adds the
+ * set t, which contains v3, twice.
+ */
+struct Fixture
+{
+  TestDatabase t{ "SessionTables_test" };
+  const Session* session = nullptr;
+
+  Fixture()
+  {
+    auto q = t.create("Queue", "q");
+    q.set_by_val<std::string>("data_type", "Fragment");
+    q.set_by_val<uint32_t>("capacity", 32);
+    auto n = t.create("NetworkConnection", "n");
+    n.set_by_val<std::string>("data_type", "TimeSync");
+    n.set_by_val<std::string>("uri", "tcp://h1:5000");
+    n.set_by_val<std::string>("connection_type", "kPubSub");
+    auto shm = t.create("SharedMemoryConnection", "shm");
+    shm.set_by_val<std::string>("data_type", "Fragment");
+    shm.set_by_val<std::string>("segment_name", "/shm");
+
+    auto m1 = t.create("DaqModule", "m1");
+    m1.set_by_val<std::string>("plugin", "Writer");
+    m1.set_objs("inputs", refs({ shm }));
+    m1.set_objs("outputs", refs({ q }));
+    auto m2 = t.create("DaqModule", "m2");
+    m2.set_by_val<std::string>("plugin", "Reader");
+    m2.set_objs("inputs", refs({ q }));
+    m2.set_objs("outputs", refs({ n }));
+    auto m3 = t.create("DaqModule", "m3");
+    m3.set_by_val<std::string>("plugin", "Reader");
+    m3.set_objs("inputs", refs({ n }));
+    m3.set_objs("outputs", refs({ shm }));
+    auto m4 = t.create("DaqModule", "m4");
+
+    auto variable = [this](const std::string& uid, const std::string& name, const std::string& value) {
+      auto v = t.create("Variable", uid);
+      v.set_by_val<std::string>("Name", name);
+      v.set_by_val<std::string>("Value", value);
+      return v;
+    };
+    auto v1 = variable("v1", "A", "1");
+    auto v2 = variable("v2", "B", "x,\"y\"");
+    auto v3 = variable("v3", "C", "3");
+    auto set = t.create("VariableSet", "t");
+    set.set_objs("Contains", refs({ v3 }));
+
+    using dunedaq::oksdbinterfaces::ConfigObject;
+    auto application = [this](const std::string& uid, const std::string& host, const std::vector<ConfigObject>& m) {
+      auto app = t.create("DaqApplication", uid);
+      app.set_by_val<std::string>("host", host);
+      app.set_by_val<uint16_t>("port", 5000);
+      app.set_objs("modules", refs(m));
+      return app;
+    };
+    auto a = application("a", "h1", { m1, m2 });
+    a.set_objs("ApplicationEnvironment", refs({ v2, v3 }));
+    auto b = application("b", "h1", { m3 });
+    b.set_objs("ApplicationEnvironment", refs({ set, set }));
+    auto c = application("c", "h2", { m4 });
+
+    auto s = t.create("Session", "s");
+    s.set_objs("ProcessEnvironment", refs({ v1, v2 }));
+    s.set_objs("applications", refs({ a, b, c }));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+std::vector<uint32_t>
+list(columns::IndexListColumn::Range range)
+{
+  return std::vector<uint32_t>(range.begin(), range.end());
+}
+
+std::string
+read(const std::filesystem::path& path)
+{
+  std::ifstream in(path);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Columns)
+{
+  columns::StringColumn strings;
+  for (const char* value : { "h1", "h2", "h1", "h1" }) {
+    strings.push_back(value);
+  }
+  BOOST_REQUIRE_EQUAL(strings.size(), 4);
+  BOOST_REQUIRE_EQUAL(strings.dictionary.size(), 2);
+  BOOST_REQUIRE(strings.codes == (std::vector<uint32_t>{ 0, 1, 0, 0 }));
+  BOOST_REQUIRE_EQUAL(strings[2], "h1");
+
+  columns::IndexListColumn lists;
+  lists.rows.push_back(3);
+  lists.rows.push_back(1);
+  lists.end_row();
+  lists.end_row();
+  BOOST_REQUIRE_EQUAL(lists.size(), 2);
+  BOOST_REQUIRE(list(lists[0]) == (std::vector<uint32_t>{ 3, 1 }));
+  BOOST_REQUIRE(lists[1].empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(Tables, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto t = make_tables(*session, index);
+
+  BOOST_REQUIRE_EQUAL(t.applications.size(), 3);
+  BOOST_REQUIRE_EQUAL(t.applications.uid[1], "b");
+  BOOST_REQUIRE_EQUAL(t.applications.host.dictionary.size(), 2);
+  BOOST_REQUIRE_EQUAL(t.applications.port[2], 5000);
+  BOOST_REQUIRE(list(t.applications.modules[0]) == (std::vector<uint32_t>{ 0, 1 }));
+
+  BOOST_REQUIRE_EQUAL(t.modules.size(), 4);
+  BOOST_REQUIRE_EQUAL(t.modules.plugin[2], "Reader");
+  BOOST_REQUIRE_EQUAL(t.modules.plugin.dictionary.size(), 3);
+  BOOST_REQUIRE_EQUAL(t.modules.application[2], 1);
+  BOOST_REQUIRE(t.modules.inputs[3].empty());
+
+  // in ConnectivityIndex order
+  BOOST_REQUIRE_EQUAL(t.connections.size(), 3);
+  for (uint32_t c = 0; c < 3; ++c) {
+    BOOST_REQUIRE_EQUAL(t.connections.uid[c], index.connection(c)->UID());
+  }
+  const uint32_t n = index.connection_index("n");
+  BOOST_REQUIRE_EQUAL(t.connections.class_name[n], "NetworkConnection");
+  BOOST_REQUIRE(list(t.connections.producers[n]) == (std::vector<uint32_t>{ 1 }));
+  BOOST_REQUIRE(list(t.connections.consumers[n]) == (std::vector<uint32_t>{ 2 }));
+
+  BOOST_REQUIRE_EQUAL(t.queues.size(), 1);
+  BOOST_REQUIRE_EQUAL(t.queues.connection[0], index.connection_index("q"));
+  BOOST_REQUIRE_EQUAL(t.queues.capacity[0], 32);
+  BOOST_REQUIRE_EQUAL(t.network_connections.size(), 1);
+  BOOST_REQUIRE_EQUAL(t.network_connections.connection_type[0], "kPubSub");
+  BOOST_REQUIRE_EQUAL(t.shared_memory_connections.size(), 1);
+  BOOST_REQUIRE_EQUAL(t.shared_memory_connections.segment_name[0], "/shm");
+}
+
+BOOST_FIXTURE_TEST_CASE(Variables, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto t = make_tables(*session, index);
+
+  // each variable once, the session ones first
+  BOOST_REQUIRE_EQUAL(t.variables.size(), 3);
+  BOOST_REQUIRE_EQUAL(t.variables.uid[0], "v1");
+  BOOST_REQUIRE_EQUAL(t.variables.uid[1], "v2");
+  BOOST_REQUIRE_EQUAL(t.variables.name[2], "C");
+  BOOST_REQUIRE(t.variables.session == (std::vector<uint8_t>{ 1, 1, 0 }));
+
+  // sets expanded, a set listed twice contributes once
+  BOOST_REQUIRE(list(t.applications.variables[0]) == (std::vector<uint32_t>{ 1, 2 }));
+  BOOST_REQUIRE(list(t.applications.variables[1]) == (std::vector<uint32_t>{ 2 }));
+  BOOST_REQUIRE(t.applications.variables[2].empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(Csv, Fixture)
+{
+  ConnectivityIndex index(*session);
+  const auto t = make_tables(*session, index);
+
+  std::ostringstream variables;
+  write_csv(variables, t.variables);
+  BOOST_REQUIRE_EQUAL(variables.str(), "uid,name,value,session\nv1,A,1,1\nv2,B,\"x,\"\"y\"\"\",1\nv3,C,3,0\n");
+
+  std::ostringstream applications;
+  write_csv(applications, t.applications);
+  BOOST_REQUIRE_EQUAL(applications.str(),
+                      "uid,host,port,modules,variables\na,h1,5000,0 1,1 2\nb,h1,5000,2,2\nc,h2,5000,3,\n");
+
+  const auto directory =
+    std::filesystem::temp_directory_path() / ("dunedaqdal_SessionTables_test." + std::to_string(getpid()));
+  std::filesystem::create_directories(directory);
+  write_csv(t, directory.string());
+  BOOST_REQUIRE_EQUAL(read(directory / "variables.csv"), variables.str());
+  BOOST_REQUIRE(std::filesystem::exists(directory / "shared_memory_connections.csv"));
+  std::filesystem::remove_all(directory);
+
+  BOOST_REQUIRE_THROW(write_csv(t, directory.string()), BadTableExport);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,232 @@
+/**
+ * @file Snapshot_test.cxx snapshot writer and Reader Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Snapshot.hpp"
+
+#include "dunedaqdal/EnvironmentResolver.hpp"
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE Snapshot_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dunedaq::dal;
+using namespace dunedaq::dal::snapshot;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(Snapshot_test)
+
+namespace {
+
+/// Snapshot of a session where m1 of a1 writes Queue q, read by m2 of a2; a1 has BENCH=1 in its environment
+class Fixture
+{
+public:
+  Fixture()
+  {
+    auto q = t.create("Queue", "q");
+    q.set_by_val<std::string>("data_type", "Fragment");
+    auto m1 = t.create("DaqModule", "m1");
+    m1.set_objs("outputs", refs({ q }));
+    auto m2 = t.create("DaqModule", "m2");
+    m2.set_objs("inputs", refs({ q }));
+
+    auto var = t.create("Variable", "var");
+    var.set_by_val<std::string>("Name", "BENCH");
+    var.set_by_val<std::string>("Value", "1");
+
+    auto a1 = t.create("DaqApplication", "a1");
+    a1.set_by_val<std::string>("host", "host1");
+    a1.set_by_val<uint16_t>("port", 5001);
+    a1.set_objs("modules", refs({ m1 }));
+    a1.set_objs("ApplicationEnvironment", refs({ var }));
+    auto a2 = t.create("DaqApplication", "a2");
+    a2.set_by_val<std::string>("host", "host2");
+    a2.set_objs("modules", refs({ m2 }));
+
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs({ a1, a2 }));
+    t.commit();
+
+    EnvironmentResolver resolver(t.db());
+    const auto blob = snapshot::make(*t.get<Session>("s"), resolver);
+    m_words.resize((blob.size() + 7) / 8);
+    std::memcpy(m_words.data(), blob.data(), blob.size());
+    m_size = blob.size();
+  }
+
+  /// 8-byte aligned copy of the blob, as a mapped file would be
+  char* data() noexcept { return reinterpret_cast<char*>(m_words.data()); }
+  size_t size() const noexcept { return m_size; }
+  Header& header() noexcept { return *reinterpret_cast<Header*>(data()); }
+
+  template<class R>
+  R* records(Section s) noexcept
+  {
+    return reinterpret_cast<R*>(data() + header().sections[s].offset);
+  }
+
+  TestDatabase t{ "Snapshot_test" };
+
+private:
+  std::vector<uint64_t> m_words;
+  size_t m_size = 0;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(RoundTrip, Fixture)
+{
+  Reader reader(data(), size());
+  BOOST_REQUIRE_EQUAL(reader.session(), "s");
+  BOOST_REQUIRE_EQUAL(reader.num_applications(), 2);
+  BOOST_REQUIRE_EQUAL(reader.num_modules(), 2);
+  BOOST_REQUIRE_EQUAL(reader.num_connections(), 1);
+
+  const auto a1 = reader.find_application("a1");
+  BOOST_REQUIRE_NE(a1, snapshot::npos);
+  const auto& app = reader.application(a1);
+  BOOST_REQUIRE_EQUAL(reader.string(app.host), "host1");
+  BOOST_REQUIRE_EQUAL(app.port, 5001);
+  BOOST_REQUIRE_EQUAL(reader.getenv(app, "BENCH"), "1");
+
+  bool found = true;
+  reader.getenv(app, "MISSING", &found);
+  BOOST_REQUIRE(!found);
+
+  const auto q = reader.find_connection("q");
+  BOOST_REQUIRE_NE(q, snapshot::npos);
+  const auto consumers = reader.indices(reader.connection(q).consumers);
+  BOOST_REQUIRE_EQUAL(consumers.size(), 1);
+  BOOST_REQUIRE_EQUAL(reader.string(reader.module(consumers[0]).uid), "m2");
+  BOOST_REQUIRE_EQUAL(reader.find_module("missing"), snapshot::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(BadHeader, Fixture)
+{
+  BOOST_REQUIRE_THROW(Reader(data(), sizeof(Header) - 1), BadSnapshot);
+  BOOST_REQUIRE_THROW(Reader(data(), size() - 8), BadSnapshot);
+
+  Header saved = header();
+
+  header().magic[0] = 'X';
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+
+  header().version = format_version + 1;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+
+  header().byte_order = 0x04030201;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+
+  BOOST_REQUIRE_NO_THROW(Reader(data(), size()));
+}
+
+BOOST_FIXTURE_TEST_CASE(Misaligned, Fixture)
+{
+  std::vector<uint64_t> words(size() / 8 + 2);
+  char* shifted = reinterpret_cast<char*>(words.data()) + 4;
+  std::memcpy(shifted, data(), size());
+  BOOST_REQUIRE_THROW(Reader(shifted, size()), BadSnapshot);
+}
+
+BOOST_FIXTURE_TEST_CASE(SectionsOutOfBounds, Fixture)
+{
+  Header saved = header();
+
+  header().sections[Section::modules].count = size();
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+
+  header().sections[Section::strings].offset = size() + 8;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+
+  header().sections[Section::indices].offset += 4;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+
+  // UID index not covering every record
+  header().sections[Section::modules_by_uid].count -= 1;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  header() = saved;
+}
+
+BOOST_FIXTURE_TEST_CASE(RecordIndicesOutOfRange, Fixture)
+{
+  auto* modules = records<ModuleRecord>(Section::modules);
+  auto* applications = records<ApplicationRecord>(Section::applications);
+  auto* connections = records<ConnectionRecord>(Section::connections);
+  auto* indices = records<uint32_t>(Section::indices);
+  auto* modules_by_uid = records<uint32_t>(Section::modules_by_uid);
+
+  const auto module = modules[0];
+  modules[0].application = 2;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  modules[0] = module;
+
+  const auto application = applications[0];
+  applications[0].modules.begin = header().sections[Section::indices].count;
+  applications[0].modules.count = 1;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  applications[0] = application;
+
+  const auto connection = connections[0];
+  connections[0].consumers.count = 0xffffffff;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  connections[0] = connection;
+
+  // an entry of the index section naming a module that does not exist
+  const uint32_t consumer = connections[0].consumers.begin;
+  const auto value = indices[consumer];
+  indices[consumer] = 7;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  indices[consumer] = value;
+
+  const auto by_uid = modules_by_uid[0];
+  modules_by_uid[0] = 2;
+  BOOST_REQUIRE_THROW(Reader(data(), size()), BadSnapshot);
+  modules_by_uid[0] = by_uid;
+
+  BOOST_REQUIRE_NO_THROW(Reader(data(), size()));
+}
+
+BOOST_FIXTURE_TEST_CASE(Files, Fixture)
+{
+  const std::string path = "/tmp/dunedaqdal_Snapshot_test." + std::to_string(getpid()) + ".snap";
+
+  BOOST_REQUIRE_THROW(Reader{ path }, BadSnapshot);
+
+  std::ofstream(path).close();
+  BOOST_REQUIRE_THROW(Reader{ path }, BadSnapshot);
+
+  std::ofstream(path, std::ios::binary).write(data(), size() / 2);
+  BOOST_REQUIRE_THROW(Reader{ path }, BadSnapshot);
+
+  std::ofstream(path, std::ios::binary).write(data(), size());
+  Reader reader(path);
+  BOOST_REQUIRE_EQUAL(reader.num_applications(), 2);
+
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,275 @@
+/**
+ * @file StreamingLoader_test.cxx StreamingLoader class Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/StreamingLoader.hpp"
+
+#include "dunedaqdal/Issues.hpp"
+
+#define BOOST_TEST_MODULE StreamingLoader_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dunedaq::dal;
+
+BOOST_AUTO_TEST_SUITE(StreamingLoader_test)
+
+namespace {
+
+/// Data files in a temporary directory, removed with it
+class Files
+{
+public:
+  Files()
+    : m_dir(std::filesystem::temp_directory_path() / ("dunedaqdal_StreamingLoader_test." + std::to_string(getpid())))
+  {
+    std::filesystem::create_directories(m_dir);
+  }
+
+  ~Files() { std::filesystem::remove_all(m_dir); }
+
+  /// Write the file and return its path
+  std::string write(const std::string& name, const std::string& content)
+  {
+    const auto path = (m_dir / name).string();
+    std::ofstream(path) << content;
+    return path;
+  }
+
+  /// Write an OKS data file: the includes, then the objects
+  std::string data(const std::string& name, const std::string& objects, const std::vector<std::string>& includes = {})
+  {
+    std::string content = "<?xml version=\"1.0\" encoding=\"ASCII\"?>\n"
+                          "<!-- oks-data version 2.2 -->\n"
+                          "<oks-data>\n"
+                          "<info name=\"\" type=\"\" num-of-items=\"0\"/>\n"
+                          "<include>\n"
+                          " <file path=\"schema/dunedaqdal/dunedaq.schema.xml\"/>\n";
+    for (const auto& include : includes) {
+      content += " <file path=\"" + include + "\"/>\n";
+    }
+    return write(name, content + "</include>\n" + objects + "</oks-data>\n");
+  }
+
+private:
+  std::filesystem::path m_dir;
+};
+
+/// q is written by m1 and read by m2, both defined after the references to them
+const std::string session_objects = R"(
+<obj class="DaqApplication" id="a1">
+ <attr name="host" type="string" val="host1"/>
+ <rel name="modules">
+  <ref class="DaqModule" id="m1"/>
+  <ref class="DaqModule" id="m2"/>
+ </rel>
+</obj>
+<obj class="DaqModule" id="m1">
+ <attr name="plugin" type="string" val="DataWriter"/>
+ <rel name="outputs">
+  <ref class="Queue" id="q"/>
+ </rel>
+</obj>
+<obj class="Queue" id="q">
+ <attr name="data_type" type="string" val="Fragment"/>
+ <attr name="capacity" type="u32" val="8"/>
+</obj>
+<obj class="DaqModule" id="m2">
+ <attr name="plugin" type="string" val="DataWriter"/>
+ <attr name="tags" type="string">
+  <data val="x"/>
+  <data val="y &amp; z"/>
+ </attr>
+ <rel name="inputs" class="Queue" id="q"/>
+ <rel name="outputs">
+  <ref class="Queue" id="missing"/>
+ </rel>
+</obj>
+)";
+
+std::vector<std::string>
+uids(const StreamingLoader& loader, StreamedRange<uint32_t> targets)
+{
+  std::vector<std::string> result;
+  for (auto t : targets) {
+    result.emplace_back(t == StreamingLoader::npos ? "npos" : loader.object(t).uid);
+  }
+  return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Objects)
+{
+  Files files;
+  const auto path = files.data("session.data.xml", session_objects);
+
+  // small chunks split tags and values across reads
+  for (size_t chunk_size : { size_t(1) << 20, size_t(7) }) {
+    BOOST_TEST_CONTEXT("chunk size " << chunk_size)
+    {
+      StreamingLoaderParameters parameters;
+      parameters.chunk_size = chunk_size;
+      StreamingLoader loader(parameters);
+      loader.load(path);
+
+      BOOST_REQUIRE_EQUAL(loader.size(), 4);
+      BOOST_REQUIRE_EQUAL(loader.files().size(), 1);
+
+      const auto q = loader.find("Queue", "q");
+      BOOST_REQUIRE_NE(q, StreamingLoader::npos);
+      BOOST_REQUIRE_EQUAL(loader.attribute(loader.object(q), "capacity"), "8");
+      BOOST_REQUIRE_EQUAL(loader.attribute(loader.object(q), "missing"), "");
+      BOOST_REQUIRE_EQUAL(loader.find("DaqModule", "q"), StreamingLoader::npos);
+
+      const auto& m2 = loader.object(loader.find("DaqModule", "m2"));
+      for (const auto& attr : loader.attributes(m2)) {
+        if (attr.name == "tags") {
+          const auto values = loader.values(attr);
+          BOOST_REQUIRE_EQUAL(values.size(), 2);
+          BOOST_REQUIRE_EQUAL(values[0], "x");
+          BOOST_REQUIRE_EQUAL(values[1], "y & z");
+        }
+      }
+
+      // interned: both modules share the plugin value
+      const auto& m1 = loader.object(loader.find("DaqModule", "m1"));
+      BOOST_REQUIRE_EQUAL(loader.attribute(m1, "plugin").data(), loader.attribute(m2, "plugin").data());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ForwardReferences)
+{
+  Files files;
+  StreamingLoader loader;
+  loader.load(files.data("session.data.xml", session_objects));
+
+  const auto& a1 = loader.object(loader.find("DaqApplication", "a1"));
+  const auto modules = loader.relationship(a1, "modules");
+  BOOST_REQUIRE_EQUAL(modules.size(), 2);
+  BOOST_REQUIRE_EQUAL(modules[0], loader.find("DaqModule", "m1"));
+  BOOST_REQUIRE_EQUAL(modules[1], loader.find("DaqModule", "m2"));
+
+  const auto& m1 = loader.object(modules[0]);
+  BOOST_REQUIRE(uids(loader, loader.relationship(m1, "outputs")) == std::vector<std::string>{ "q" });
+
+  // single-valued <rel> to an object read before
+  const auto& m2 = loader.object(modules[1]);
+  BOOST_REQUIRE(uids(loader, loader.relationship(m2, "inputs")) == std::vector<std::string>{ "q" });
+  BOOST_REQUIRE(loader.relationship(m2, "missing").empty());
+
+  BOOST_REQUIRE_EQUAL(loader.unresolved().size(), 1);
+  const auto& u = loader.unresolved()[0];
+  BOOST_REQUIRE_EQUAL(u.object, modules[1]);
+  BOOST_REQUIRE_EQUAL(u.relationship, "outputs");
+  BOOST_REQUIRE_EQUAL(u.class_name, "Queue");
+  BOOST_REQUIRE_EQUAL(u.uid, "missing");
+  BOOST_REQUIRE(uids(loader, loader.relationship(m2, "outputs")) == std::vector<std::string>{ "npos" });
+}
+
+BOOST_AUTO_TEST_CASE(Callback)
+{
+  Files files;
+  StreamingLoader loader;
+  std::vector<std::string> seen;
+  loader.on_object([&](uint32_t idx) { seen.emplace_back(loader.object(idx).uid); });
+  loader.load(files.data("session.data.xml", session_objects));
+
+  BOOST_REQUIRE(seen == (std::vector<std::string>{ "a1", "m1", "q", "m2" }));
+}
+
+BOOST_AUTO_TEST_CASE(Includes)
+{
+  Files files;
+  files.data("queues.data.xml", R"(<obj class="Queue" id="missing"/>)");
+  files.data("modules.data.xml", session_objects, { "queues.data.xml" });
+  const auto top = files.data(
+    "top.data.xml",
+    R"(<obj class="Session" id="s"><rel name="applications" class="DaqApplication" id="a1"/></obj>)",
+    { "modules.data.xml", "queues.data.xml" });
+
+  StreamingLoader loader;
+  loader.load(top);
+  BOOST_REQUIRE_EQUAL(loader.files().size(), 3);
+  BOOST_REQUIRE_EQUAL(loader.size(), 6);
+  // the reference to a1 and the one to the queue of an included file were fixed up
+  BOOST_REQUIRE(loader.unresolved().empty());
+  const auto& s = loader.object(loader.find("Session", "s"));
+  BOOST_REQUIRE_EQUAL(loader.relationship(s, "applications")[0], loader.find("DaqApplication", "a1"));
+
+  // loading a file again is a no-op
+  loader.load(top);
+  BOOST_REQUIRE_EQUAL(loader.size(), 6);
+
+  StreamingLoaderParameters parameters;
+  parameters.follow_includes = false;
+  StreamingLoader shallow(parameters);
+  shallow.load(top);
+  BOOST_REQUIRE_EQUAL(shallow.size(), 1);
+  BOOST_REQUIRE_EQUAL(shallow.unresolved().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ClassFilter)
+{
+  Files files;
+  StreamingLoaderParameters parameters;
+  parameters.classes = { "DaqModule" };
+  StreamingLoader loader(parameters);
+  loader.load(files.data("session.data.xml", session_objects));
+
+  BOOST_REQUIRE_EQUAL(loader.size(), 2);
+  BOOST_REQUIRE_EQUAL(loader.find("DaqApplication", "a1"), StreamingLoader::npos);
+
+  // references to filtered classes are left at npos without being reported
+  const auto& m1 = loader.object(loader.find("DaqModule", "m1"));
+  BOOST_REQUIRE(uids(loader, loader.relationship(m1, "outputs")) == std::vector<std::string>{ "npos" });
+  BOOST_REQUIRE(loader.unresolved().empty());
+}
+
+BOOST_AUTO_TEST_CASE(SchemaFiles)
+{
+  Files files;
+  StreamingLoader loader;
+  loader.load(
+    files.write("x.schema.xml", "<?xml version=\"1.0\"?>\n<oks-schema>\n<class name=\"X\"/>\n</oks-schema>\n"));
+  BOOST_REQUIRE_EQUAL(loader.size(), 0);
+  BOOST_REQUIRE(loader.files().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BadFiles)
+{
+  Files files;
+  const std::vector<std::string> bad{
+    files.write("root.data.xml", "<?xml version=\"1.0\"?>\n<oks-config></oks-config>\n"),
+    files.write("empty.data.xml", ""),
+    files.write("unterminated.data.xml", "<oks-data>\n<obj class=\"Queue\" id=\"q\"\n"),
+    files.data("open.data.xml", "<obj class=\"Queue\" id=\"q\">\n"),
+    files.data("nested.data.xml", "<obj class=\"Queue\" id=\"q\"><obj class=\"Queue\" id=\"r\"/></obj>\n"),
+    files.data("anonymous.data.xml", "<obj class=\"Queue\"/>\n"),
+    files.data("duplicate.data.xml", "<obj class=\"Queue\" id=\"q\"/>\n<obj class=\"Queue\" id=\"q\"/>\n"),
+    files.data("include.data.xml", "", { "nowhere.data.xml" }),
+    (std::filesystem::temp_directory_path() / "dunedaqdal_StreamingLoader_test.missing.data.xml").string()
+  };
+
+  for (const auto& path : bad) {
+    BOOST_TEST_CONTEXT(path)
+    {
+      StreamingLoader loader;
+      BOOST_REQUIRE_THROW(loader.load(path), BadDataFile);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,79 @@
+/**
+ * @file TestDatabase.hpp
+ *
+ * Writable OKS database in a temporary file, created with the dunedaqdal
+ * schema, for the unit tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef DUNEDAQDAL_UNITTEST_TESTDATABASE_HPP_
+#define DUNEDAQDAL_UNITTEST_TESTDATABASE_HPP_
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace dunedaq::dal::test {
+
+/// The database file is removed when the TestDatabase goes out of scope
+class TestDatabase
+{
+public:
+  explicit TestDatabase(const std::string& name)
+    : m_file("/tmp/dunedaqdal_" + name + '.' + std::to_string(getpid()) + ".data.xml")
+    , m_db("oksconfig")
+  {
+    m_db.create(m_file, { "schema/dunedaqdal/dunedaq.schema.xml" });
+  }
+
+  ~TestDatabase() { std::remove(m_file.c_str()); }
+
+  TestDatabase(const TestDatabase&) = delete;
+  TestDatabase& operator=(const TestDatabase&) = delete;
+
+  oksdbinterfaces::Configuration& db() noexcept { return m_db; }
+  const std::string& file() const noexcept { return m_file; }
+
+  oksdbinterfaces::ConfigObject create(const std::string& class_name, const std::string& uid)
+  {
+    oksdbinterfaces::ConfigObject obj;
+    m_db.create(m_file, class_name, uid, obj);
+    return obj;
+  }
+
+  /// DAL object of a created object
+  template<class T>
+  const T* get(const std::string& uid)
+  {
+    return m_db.get<T>(uid);
+  }
+
+  void commit() { m_db.commit("dunedaqdal unit test"); }
+
+private:
+  std::string m_file;
+  oksdbinterfaces::Configuration m_db;
+};
+
+/// Value of ConfigObject::set_objs()
+inline std::vector<const oksdbinterfaces::ConfigObject*>
+refs(const std::vector<oksdbinterfaces::ConfigObject>& objects)
+{
+  std::vector<const oksdbinterfaces::ConfigObject*> result;
+  for (const auto& obj : objects) {
+    result.push_back(&obj);
+  }
+  return result;
+}
+
+} // namespace dunedaq::dal::test
+
+#endif // DUNEDAQDAL_UNITTEST_TESTDATABASE_HPP_
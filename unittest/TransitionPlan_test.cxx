@@ -0,0 +1,228 @@
+/**
+ * @file TransitionPlan_test.cxx TransitionPlan class Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/TransitionPlan.hpp"
+
+#include "dunedaqdal/Issues.hpp"
+#include "dunedaqdal/RCApplication.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE TransitionPlan_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(TransitionPlan_test)
+
+namespace {
+
+enum class Dependencies
+{
+  acyclic, ///< a3 after a0 and a1 (reversed for stop), a5 after a3 for start only
+  cycle,   ///< in addition a0 after a5, and a5 after a3 for every transition
+  foreign  ///< a3 after an application rc does not control
+};
+
+/// rc controls a0 to a5, at most two at a time, with a timeout of 20 s or 100 s for conf
+struct Fixture
+{
+  TestDatabase t{ "TransitionPlan_test" };
+
+  const RCApplication* build(Dependencies dependencies)
+  {
+    std::vector<dunedaq::oksdbinterfaces::ConfigObject> a;
+    for (int i = 0; i < 6; ++i) {
+      a.push_back(t.create("DaqApplication", "a" + std::to_string(i)));
+    }
+    auto outsider = t.create("DaqApplication", "outsider");
+
+    auto d = t.create("ControlDependency", "d");
+    d.set_obj("application", &a[3]);
+    d.set_objs("depends_on", dependencies == Dependencies::foreign ? refs({ a[0], outsider }) : refs({ a[0], a[1] }));
+    d.set_by_val<std::vector<std::string>>("reversed_for", { "stop" });
+
+    auto d2 = t.create("ControlDependency", "d2");
+    d2.set_obj("application", &a[5]);
+    d2.set_objs("depends_on", refs({ a[3] }));
+    if (dependencies != Dependencies::cycle) {
+      d2.set_by_val<std::vector<std::string>>("transitions", { "start" });
+    }
+    std::vector<dunedaq::oksdbinterfaces::ConfigObject> all{ d, d2 };
+
+    if (dependencies == Dependencies::cycle) {
+      auto d3 = t.create("ControlDependency", "d3");
+      d3.set_obj("application", &a[0]);
+      d3.set_objs("depends_on", refs({ a[5] }));
+      all.push_back(d3);
+    }
+
+    auto conf = t.create("TransitionTimeout", "conf-timeout");
+    conf.set_by_val<std::string>("transition", "conf");
+    conf.set_by_val<uint16_t>("timeout", 100);
+
+    auto rc = t.create("RCApplication", "rc");
+    rc.set_by_val<uint16_t>("Timeout", 20);
+    rc.set_by_val<uint32_t>("max_concurrent_commands", 2);
+    rc.set_objs("ApplicationsControlled", refs(a));
+    rc.set_objs("dependencies", refs(all));
+    rc.set_objs("transition_timeouts", refs({ conf }));
+
+    std::vector<dunedaq::oksdbinterfaces::ConfigObject> applications{ rc };
+    applications.insert(applications.end(), a.begin(), a.end());
+    applications.push_back(outsider);
+    auto s = t.create("Session", "s");
+    s.set_objs("applications", refs(applications));
+    t.commit();
+
+    session = t.get<Session>("s");
+    return t.get<RCApplication>("rc");
+  }
+
+  const Session* session = nullptr;
+};
+
+std::vector<std::vector<std::string>>
+uids(const TransitionPlan& plan)
+{
+  std::vector<std::vector<std::string>> result;
+  for (const auto& level : plan.levels()) {
+    auto& names = result.emplace_back();
+    for (const auto* app : level) {
+      names.push_back(app->UID());
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Levels, Fixture)
+{
+  const auto* rc = build(Dependencies::acyclic);
+
+  TransitionPlan start(*rc, "start");
+  using Levels = std::vector<std::vector<std::string>>;
+  BOOST_REQUIRE(uids(start) == (Levels{ { "a0", "a1", "a2", "a4" }, { "a3" }, { "a5" } }));
+  BOOST_REQUIRE_EQUAL(start.size(), 6);
+  BOOST_REQUIRE_EQUAL(start.max_concurrent(), 2);
+
+  // reversed: a3 goes before a0 and a1; d2 does not apply
+  TransitionPlan stop(*rc, "stop");
+  BOOST_REQUIRE(uids(stop) == (Levels{ { "a2", "a3", "a4", "a5" }, { "a0", "a1" } }));
+}
+
+BOOST_FIXTURE_TEST_CASE(Timeouts, Fixture)
+{
+  const auto* rc = build(Dependencies::acyclic);
+
+  TransitionPlan start(*rc, "start");
+  BOOST_REQUIRE(start.timeout() == std::chrono::seconds(20));
+  // four applications two at a time, then a3, then a5
+  BOOST_REQUIRE(start.worst_case_duration() == std::chrono::seconds(4 * 20));
+
+  TransitionPlan conf(*rc, "conf");
+  BOOST_REQUIRE(conf.timeout() == std::chrono::seconds(100));
+}
+
+BOOST_FIXTURE_TEST_CASE(CycleDetection, Fixture)
+{
+  const auto* rc = build(Dependencies::cycle);
+  BOOST_REQUIRE_THROW(TransitionPlan(*rc, "start"), CircularDependency);
+
+  try {
+    TransitionPlan plan(*rc, "conf");
+    BOOST_FAIL("cycle not detected");
+  } catch (const CircularDependency& ex) {
+    const std::string message = ex.what();
+    for (const char* uid : { "a0", "a3", "a5" }) {
+      BOOST_REQUIRE(message.find(uid) != std::string::npos);
+    }
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(ForeignDependency, Fixture)
+{
+  const auto* rc = build(Dependencies::foreign);
+  BOOST_REQUIRE_THROW(TransitionPlan(*rc, "start"), BadControlDependency);
+}
+
+BOOST_FIXTURE_TEST_CASE(Cached, Fixture)
+{
+  const auto* rc = build(Dependencies::acyclic);
+
+  TransitionPlans plans(*session);
+  const auto start = plans.get(*rc, "start");
+  BOOST_REQUIRE_EQUAL(start, plans.get(*rc, "start"));
+  BOOST_REQUIRE_NE(start, plans.get(*rc, "stop"));
+
+  // recomputed after a clear(), while the plan held still works
+  plans.clear();
+  BOOST_REQUIRE_NE(start, plans.get(*rc, "start"));
+  BOOST_REQUIRE_EQUAL(start->size(), plans.get(*rc, "start")->size());
+
+  t.create("RCApplication", "lonely");
+  BOOST_REQUIRE_THROW(plans.get(*t.get<RCApplication>("lonely"), "start"), ApplicationNotFound);
+}
+
+BOOST_FIXTURE_TEST_CASE(Execute, Fixture)
+{
+  const auto* rc = build(Dependencies::acyclic);
+  TransitionPlan plan(*rc, "start");
+
+  std::atomic<int> running{ 0 }, peak{ 0 };
+  std::vector<std::string> order;
+  std::vector<std::chrono::seconds> timeouts;
+  std::mutex mutex;
+  auto failed = plan.execute([&](const Application& app, std::chrono::seconds timeout) {
+    const int now = ++running;
+    int seen = peak;
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(app.UID());
+      timeouts.push_back(timeout);
+    }
+    --running;
+    if (app.UID() == "a1") {
+      return false;
+    }
+    if (app.UID() == "a2") {
+      throw std::runtime_error("a2 failed");
+    }
+    if (app.UID() == "a4") {
+      throw 4;
+    }
+    return true;
+  });
+
+  BOOST_REQUIRE_LE(peak.load(), 2);
+  // false, a std::exception and anything else thrown all count as failures
+  BOOST_REQUIRE_EQUAL(failed.size(), 3);
+  // the first level failed, so a3 and a5 were never sent the transition
+  BOOST_REQUIRE_EQUAL(order.size(), 4);
+  for (auto timeout : timeouts) {
+    BOOST_REQUIRE(timeout == std::chrono::seconds(20));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,202 @@
+/**
+ * @file Validator_test.cxx Validator class and default_rules() Unit Tests
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dunedaqdal/Validator.hpp"
+
+#include "dunedaqdal/DaqModule.hpp"
+#include "dunedaqdal/Session.hpp"
+
+#include "TestDatabase.hpp"
+
+#define BOOST_TEST_MODULE Validator_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::dal;
+using dunedaq::dal::test::refs;
+using dunedaq::dal::test::TestDatabase;
+
+BOOST_AUTO_TEST_SUITE(Validator_test)
+
+namespace {
+
+/**
+ * top controls a and b, which both use h1:5000; c on h2 is not controlled.
+ * Queue q is written by ma and mb and read by mc, network connection n is
+ * written by ma and read by nobody and n2 is read by mc and written by
+ * nobody. The session environment is a VariableSet without variables.
+ */
+struct Fixture
+{
+  TestDatabase t{ "Validator_test" };
+  const Session* session = nullptr;
+
+  Fixture()
+  {
+    auto q = t.create("Queue", "q");
+    q.set_by_val<std::string>("data_type", "Fragment");
+    auto n = t.create("NetworkConnection", "n");
+    n.set_by_val<std::string>("data_type", "TimeSync");
+    n.set_by_val<std::string>("uri", "tcp://h1:70000");
+    auto n2 = t.create("NetworkConnection", "n2");
+    n2.set_by_val<std::string>("data_type", "TimeSync");
+    n2.set_by_val<std::string>("uri", "h2:5001");
+
+    auto ma = t.create("DaqModule", "ma");
+    ma.set_objs("outputs", refs({ q, n }));
+    auto mb = t.create("DaqModule", "mb");
+    mb.set_objs("outputs", refs({ q }));
+    auto mc = t.create("DaqModule", "mc");
+    mc.set_objs("inputs", refs({ q, n2 }));
+
+    using dunedaq::oksdbinterfaces::ConfigObject;
+    auto application = [this](const std::string& uid, const std::string& host, const ConfigObject& m) {
+      auto app = t.create("DaqApplication", uid);
+      app.set_by_val<std::string>("host", host);
+      app.set_by_val<uint16_t>("port", 5000);
+      app.set_objs("modules", refs({ m }));
+      return app;
+    };
+    auto a = application("a", "h1", ma);
+    auto b = application("b", "h1", mb);
+    auto c = application("c", "h2", mc);
+
+    auto top = t.create("RCApplication", "top");
+    top.set_objs("ApplicationsControlled", refs({ a, b }));
+
+    auto empty = t.create("VariableSet", "empty");
+    auto s = t.create("Session", "s");
+    s.set_objs("ProcessEnvironment", refs({ empty }));
+    s.set_objs("applications", refs({ top, a, b, c }));
+    t.commit();
+
+    session = t.get<Session>("s");
+  }
+};
+
+std::vector<Diagnostic>
+select(const std::vector<Diagnostic>& diagnostics, const std::string& rule)
+{
+  std::vector<Diagnostic> result;
+  for (const auto& d : diagnostics) {
+    if (d.rule == rule) {
+      result.push_back(d);
+    }
+  }
+  return result;
+}
+
+/// One warning per module, naming the module and the number of prepare() calls
+class ModuleRule : public Rule
+{
+public:
+  std::string name() const override { return "modules"; }
+  Domain domain() const override { return Domain::modules; }
+
+  void prepare(const ValidationContext&) override { ++m_prepared; }
+
+  void check(const ValidationContext& context, size_t begin, size_t end, std::vector<Diagnostic>& out) const override
+  {
+    for (size_t i = begin; i < end; ++i) {
+      out.push_back(
+        { Diagnostic::Severity::warning, name(), context.index().module(i)->UID(), std::to_string(m_prepared) });
+    }
+  }
+
+private:
+  int m_prepared = 0;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(Cardinality, Fixture)
+{
+  const auto diagnostics = select(Validator().run(t.db(), *session), "cardinality");
+  BOOST_REQUIRE_EQUAL(diagnostics.size(), 1);
+  BOOST_REQUIRE(diagnostics[0].severity == Diagnostic::Severity::error);
+  BOOST_REQUIRE_EQUAL(diagnostics[0].object, "empty@VariableSet");
+  BOOST_REQUIRE_EQUAL(diagnostics[0].message, "relationship Contains is empty");
+}
+
+BOOST_FIXTURE_TEST_CASE(UniqueHostPort, Fixture)
+{
+  const auto diagnostics = select(Validator().run(t.db(), *session), "unique-host-port");
+  BOOST_REQUIRE_EQUAL(diagnostics.size(), 2);
+  BOOST_REQUIRE_EQUAL(diagnostics[0].object, "a@DaqApplication");
+  BOOST_REQUIRE_EQUAL(diagnostics[0].message, "h1:5000 is also used by b");
+  BOOST_REQUIRE_EQUAL(diagnostics[1].object, "b@DaqApplication");
+}
+
+BOOST_FIXTURE_TEST_CASE(ConnectionEndpoints, Fixture)
+{
+  const auto diagnostics = select(Validator().run(t.db(), *session), "connection-endpoints");
+  BOOST_REQUIRE_EQUAL(diagnostics.size(), 3);
+
+  // in connection index order: q, n, n2
+  BOOST_REQUIRE_EQUAL(diagnostics[0].object, "q@Queue");
+  BOOST_REQUIRE(diagnostics[0].severity == Diagnostic::Severity::error);
+  BOOST_REQUIRE_EQUAL(diagnostics[0].message, "kFollySPSCQueue queue with 2 producer(s) and 1 consumer(s)");
+  BOOST_REQUIRE_EQUAL(diagnostics[1].object, "n@NetworkConnection");
+  BOOST_REQUIRE(diagnostics[1].severity == Diagnostic::Severity::warning);
+  BOOST_REQUIRE_EQUAL(diagnostics[2].object, "n2@NetworkConnection");
+  BOOST_REQUIRE(diagnostics[2].severity == Diagnostic::Severity::error);
+  BOOST_REQUIRE_EQUAL(diagnostics[2].message, "read by 1 module(s) but written by none");
+}
+
+BOOST_FIXTURE_TEST_CASE(UriSyntax, Fixture)
+{
+  const auto diagnostics = select(Validator().run(t.db(), *session), "uri-syntax");
+  BOOST_REQUIRE_EQUAL(diagnostics.size(), 2);
+  BOOST_REQUIRE_EQUAL(diagnostics[0].object, "n@NetworkConnection");
+  BOOST_REQUIRE_EQUAL(diagnostics[0].message, "port of uri \"tcp://h1:70000\" is out of range");
+  BOOST_REQUIRE_EQUAL(diagnostics[1].object, "n2@NetworkConnection");
+  BOOST_REQUIRE_EQUAL(diagnostics[1].message, "uri \"h2:5001\" is not scheme://host[:port][/path]");
+}
+
+BOOST_FIXTURE_TEST_CASE(ControlTreeIssues, Fixture)
+{
+  const auto diagnostics = select(Validator().run(t.db(), *session), "control-tree");
+  BOOST_REQUIRE_EQUAL(diagnostics.size(), 1);
+  BOOST_REQUIRE(diagnostics[0].severity == Diagnostic::Severity::warning);
+  BOOST_REQUIRE_EQUAL(diagnostics[0].object, "c@DaqApplication");
+}
+
+BOOST_FIXTURE_TEST_CASE(Deterministic, Fixture)
+{
+  Validator validator;
+  const auto one = validator.run(t.db(), *session, 1);
+  const auto many = validator.run(t.db(), *session, 8);
+  BOOST_REQUIRE_EQUAL(one.size(), many.size());
+  for (size_t i = 0; i < one.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(one[i].rule, many[i].rule);
+    BOOST_REQUIRE_EQUAL(one[i].object, many[i].object);
+    BOOST_REQUIRE_EQUAL(one[i].message, many[i].message);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(CustomRule, Fixture)
+{
+  std::vector<std::unique_ptr<Rule>> rules;
+  rules.push_back(std::make_unique<ModuleRule>());
+  Validator validator(std::move(rules));
+  BOOST_REQUIRE_EQUAL(validator.rules().size(), 1);
+
+  // items sharded over the threads come back in order, each checked once after a single prepare()
+  const auto diagnostics = validator.run(t.db(), *session, 3);
+  BOOST_REQUIRE_EQUAL(diagnostics.size(), 3);
+  BOOST_REQUIRE_EQUAL(diagnostics[0].object, "ma");
+  BOOST_REQUIRE_EQUAL(diagnostics[1].object, "mb");
+  BOOST_REQUIRE_EQUAL(diagnostics[2].object, "mc");
+  BOOST_REQUIRE_EQUAL(diagnostics[2].message, "1");
+}
+
+BOOST_AUTO_TEST_SUITE_END()